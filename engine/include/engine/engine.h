@@ -4,12 +4,30 @@
 #include <cstdint>
 
 
+struct EngineFramePacingInfo
+{
+    // Max main loop frequency, 0 - uncapped
+    uint32_t maxFPS = 0;
+
+    // While the main window is minimized (or unfocused if throttleWhenUnfocused is set), the main loop
+    // blocks on OS events for up to this timeout instead of polling them
+    double idleEventsWaitTimeoutSec = 0.1;
+    bool throttleWhenUnfocused = true;
+
+    // Simulation runs in fixed steps independently of the main loop frequency (it may be lower than the render rate,
+    // rendered state is interpolated between the last two steps)
+    double simulationTickRate = 60.0;
+    // Caps simulation steps per frame, 0 - unlimited. Exceeding time is dropped so a slow frame can't snowball
+    uint32_t maxSimulationStepsPerFrame = 5;
+};
+
+
 class Engine
 {
 public:
     static Engine& GetInstance() noexcept;
 
-    static bool Init(const char* title, uint32_t width, uint32_t height, bool enableVSync) noexcept;
+    static bool Init(const char* title, uint32_t width, uint32_t height, bool enableVSync, const EngineFramePacingInfo& framePacing = {}) noexcept;
     static void Terminate() noexcept;
 
 public:
@@ -27,14 +45,81 @@ public:
 
     bool IsRunning() const noexcept;
     bool IsInitialized() const noexcept;
+
+    bool IsIdle() const noexcept { return m_isIdle; }
+
+    // Share of the last frame the main thread didn't spend blocked on OS events or frame limiter sleep
+    float GetMainThreadUtilization() const noexcept { return m_mainThreadUtilization; }
+
+    // Scenes with heavy overdraw benefit from depth prepass, while for simple ones it just doubles geometry processing
+    void SetDepthPrepassEnabled(bool enabled) noexcept { m_isDepthPrepassEnabled = enabled; }
+    bool IsDepthPrepassEnabled() const noexcept { return m_isDepthPrepassEnabled; }
+
+    // Instances hidden behind the previous frame depth are skipped by geometry passes. Disoccluded objects appear one frame late
+    void SetOcclusionCullingEnabled(bool enabled) noexcept { m_isOcclusionCullingEnabled = enabled; }
+    bool IsOcclusionCullingEnabled() const noexcept { return m_isOcclusionCullingEnabled; }
+
+    // Internal resolution is scaled down to fit GPU frame time into the target, then upscaled to the framebuffer.
+    // Target should leave some headroom below the display refresh period
+    void SetDynamicResolutionEnabled(bool enabled) noexcept { m_isDynamicResolutionEnabled = enabled; }
+    bool IsDynamicResolutionEnabled() const noexcept { return m_isDynamicResolutionEnabled; }
+
+    void SetDynamicResolutionTargetFrameTime(float targetGPUFrameTimeMs) noexcept { m_targetGPUFrameTimeMs = targetGPUFrameTimeMs; }
+    float GetDynamicResolutionTargetFrameTime() const noexcept { return m_targetGPUFrameTimeMs; }
+
+    void SetDynamicResolutionMinScale(float minScale) noexcept { m_minResolutionScale = minScale; }
+    float GetDynamicResolutionMinScale() const noexcept { return m_minResolutionScale; }
+
+    // Internal resolution scale used while dynamic resolution is disabled
+    void SetResolutionScale(float scale) noexcept { m_resolutionScale = scale; }
+    float GetResolutionScale() const noexcept { return m_resolutionScale; }
+
+    // Jitters projection every frame and accumulates the low resolution frames into the output one. Bilinear upscale is used otherwise
+    void SetTemporalUpscalingEnabled(bool enabled) noexcept { m_isTemporalUpscalingEnabled = enabled; }
+    bool IsTemporalUpscalingEnabled() const noexcept { return m_isTemporalUpscalingEnabled; }
+
+    // Geometry writes only instance and triangle indices, and a fullscreen pass reconstructs attributes and shades them.
+    // Saves GBuffer write bandwidth at high resolutions and with small triangles, at the cost of attribute fetches during shading
+    void SetVisibilityBufferEnabled(bool enabled) noexcept { m_isVisibilityBufferEnabled = enabled; }
+    bool IsVisibilityBufferEnabled() const noexcept { return m_isVisibilityBufferEnabled; }
+
+    // Dynamic point and spot lights orbiting the scene. Clustered lighting keeps per pixel cost bound by lights per cluster
+    void SetDemoLightsCount(uint32_t count) noexcept { m_demoLightsCount = count; }
+    uint32_t GetDemoLightsCount() const noexcept { return m_demoLightsCount; }
     
 private:
-    Engine(const char* title, uint32_t width, uint32_t height, bool enableVSync);
+    Engine(const char* title, uint32_t width, uint32_t height, bool enableVSync, const EngineFramePacingInfo& framePacing);
+
+    void UpdateUtilizationStatistics(double frameTimeSec, double blockedTimeSec) noexcept;
 
     Engine(Engine&& other) noexcept = default;
     Engine& operator=(Engine&& other) noexcept = default;
 
 private:
+    EngineFramePacingInfo m_framePacing = {};
+
+    double m_frameBlockedTimeSec = 0.0;
+
+    // Accumulated since the last idle state switch
+    double m_periodTimeSec = 0.0;
+    double m_periodBlockedTimeSec = 0.0;
+    double m_periodStartCPUTimeSec = 0.0;
+
+    float m_mainThreadUtilization = 1.f;
+
+    uint32_t m_demoLightsCount = 256;
+
+    // 60 Hz with ~10% headroom
+    float m_targetGPUFrameTimeMs = 15.f;
+    float m_minResolutionScale = 0.5f;
+    float m_resolutionScale = 1.f;
+
+    bool m_isIdle = false;
+    bool m_isDepthPrepassEnabled = true;
+    bool m_isOcclusionCullingEnabled = true;
+    bool m_isDynamicResolutionEnabled = true;
+    bool m_isTemporalUpscalingEnabled = true;
+    bool m_isVisibilityBufferEnabled = false;
     bool m_isInitialized = false;
 };
 
@@ -66,4 +66,14 @@
 #endif
 
 
-#define ENG_USE_INVERTED_Z
\ No newline at end of file
+#define ENG_USE_INVERTED_Z
+
+
+// Bandwidth optimized GBuffer: albedo with packed roughness and metalness, octahedral normals in RG16, R11G11B10F color,
+// no specular target and view position reconstructed from depth
+// #define ENG_GBUFFER_COMPACT
+
+
+// Runs CPU side render benchmarks during render system initialization and GPU ones (GBuffer layout, clustered lighting scaling)
+// over the first frames, and logs their results
+// #define ENG_RUN_RENDER_BENCHMARKS
\ No newline at end of file
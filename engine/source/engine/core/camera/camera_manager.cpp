@@ -38,6 +38,8 @@ void Camera::Destroy() noexcept
     
     m_zNear = 0.f;
     m_zFar = 0.f;
+
+    m_projJitter = M3D_ZEROF2;
 }
 
 
@@ -177,6 +179,18 @@ void Camera::SetOrthoBottom(float bottom) noexcept
 }
 
 
+void Camera::SetProjectionJitter(const glm::vec2& jitter) noexcept
+{
+    ASSERT_CAMERA_REGISTER_STATUS(this);
+
+    // Jitter is a fraction of a pixel, which is below epsilon of approximate comparison at high resolutions
+    if (m_projJitter != jitter) {
+        m_projJitter = jitter;
+        RequestRecalcProjMatrix();
+    }
+}
+
+
 void Camera::Move(const glm::vec3& offset) noexcept
 {
     ASSERT_CAMERA_REGISTER_STATUS(this);
@@ -298,13 +312,16 @@ void Camera::RecalcProjMatrix() noexcept
         m_matProjection = glm::perspective(glm::radians(m_fovDegrees), m_aspectRatio, zNear, zFar);
     } else if (IsOrthoProj()) {
         m_matProjection = glm::ortho(m_left, m_right, m_bottom, m_top, zNear, zFar);
-    }   
+    }
+
+    // Offset is applied after projection, so it's the same fraction of a pixel for any depth and projection type
+    m_matProjection = glm::translate(M3D_MAT4_IDENTITY, glm::vec3(m_projJitter, 0.f)) * m_matProjection;
 }
 
 
 void Camera::RecalcViewMatrix() noexcept
 {
-    m_matWCS = glm::mat4_cast(m_rotation) * glm::translate(M3D_MAT4_IDENTITY, -m_position);
+    m_matWCS = camComputeViewMatrix(m_position, m_rotation);
 }
 
 
@@ -428,4 +445,9 @@ void engTerminateCameraManager() noexcept
 bool engIsCameraManagerInitialized() noexcept
 {
     return pCameraMngInst && pCameraMngInst->IsInitialized();
-}
\ No newline at end of file
+}
+
+glm::mat4x4 camComputeViewMatrix(const glm::vec3& position, const glm::quat& rotation) noexcept
+{
+    return glm::mat4_cast(rotation) * glm::translate(M3D_MAT4_IDENTITY, -position);
+}
@@ -39,6 +39,10 @@ public:
     void SetOrthoTop(float top) noexcept;
     void SetOrthoBottom(float bottom) noexcept;
 
+    // Sub-pixel offset of the projected image in NDC units. Temporal upscaling changes it every frame,
+    // so that samples of consecutive frames cover different points of every pixel
+    void SetProjectionJitter(const glm::vec2& jitter) noexcept;
+
     void Move(const glm::vec3& offset) noexcept;
     void MoveAlongDir(const glm::vec3& dir, float distance) noexcept;
 
@@ -59,6 +63,8 @@ public:
     float GetOrthoTop() const noexcept { return m_top; }
     float GetOrthoBottom() const noexcept { return m_bottom; }
 
+    const glm::vec2& GetProjectionJitter() const noexcept { return m_projJitter; }
+
     glm::vec3 GetXDir() const noexcept { return m_matWCS[0]; }
     glm::vec3 GetYDir() const noexcept { return m_matWCS[1]; }
     glm::vec3 GetZDir() const noexcept { return m_matWCS[2]; }
@@ -127,6 +133,8 @@ private:
     float m_zNear = 0.f;
     float m_zFar = 0.f;
 
+    glm::vec2 m_projJitter = M3D_ZEROF2;
+
     CameraFlags m_flags = {};
     CameraID m_ID;
 };
@@ -194,6 +202,9 @@ private:
 };
 
 
+glm::mat4x4 camComputeViewMatrix(const glm::vec3& position, const glm::quat& rotation) noexcept;
+
+
 constexpr inline bool camIsFovDegreesValid(float degrees) noexcept
 {
     return degrees > M3D_EPS && degrees < 180.f;
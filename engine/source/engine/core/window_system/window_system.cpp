@@ -6,6 +6,8 @@
 
 #include <GLFW/glfw3.h>
 
+#include <chrono>
+
 
 #define ASSERT_WINDOW_SYSTEM_INIT_STATUS() ENG_ASSERT_WINDOW(engIsWindowSystemInitialized(), "Window system is not initialized")
 #define ASSERT_WINDOW_INIT_STATUS(pWindow) ENG_ASSERT_WINDOW(pWindow && pWindow->IsInitialized(), "Window is not initialized")
@@ -167,6 +169,13 @@ static MouseButton GLFWButtonToCustomMouseButton(int32_t glfwButton) noexcept
 }
 
 
+static uint64_t GetInputTimestampNs() noexcept
+{
+    namespace chr = std::chrono;
+    return chr::duration_cast<chr::nanoseconds>(chr::steady_clock::now().time_since_epoch()).count();
+}
+
+
 static detail::WinSysEventListenerIDDataHandler ListenerIDToWinSysEventListenerIDDataHandler(es::ListenerID ID) noexcept
 {
     detail::WinSysEventListenerIDDataHandler handler = {};
@@ -318,6 +327,8 @@ void Input::Destroy() noexcept
     m_mouseWheelDX = 0.f;
     m_mouseWheelDY = 0.f;
 
+    m_eventsHistory.Clear();
+
     es::EventDispatcher& dispatcher = es::EventDispatcher::GetInstance();
 
     for (detail::WinSysEventListenerIDDataHandler& handler : m_inputListenersIDHandlers) {
@@ -362,12 +373,14 @@ MouseButtonState Input::GetMouseButtonState(MouseButton button) const noexcept
 void Input::OnKeyEvent(KeyboardKey key, KeyState state) noexcept
 {
     m_keyStates[static_cast<size_t>(key)] = state;
+    RecordEvent(InputEventType::TYPE_KEY, static_cast<uint8_t>(key), static_cast<uint8_t>(state));
 }
 
 
 void Input::OnMouseButtonEvent(MouseButton button, MouseButtonState state) noexcept
 {
     m_mouseButtonStates[static_cast<size_t>(button)] = state;
+    RecordEvent(InputEventType::TYPE_MOUSE_BUTTON, static_cast<uint8_t>(button), static_cast<uint8_t>(state));
 }
 
 
@@ -377,6 +390,8 @@ void Input::OnMouseMoveEvent(double xpos, double ypos) noexcept
     
     m_currCursorPosition.x = static_cast<float>(xpos);
     m_currCursorPosition.y = static_cast<float>(ypos);
+
+    RecordEvent(InputEventType::TYPE_CURSOR_MOVE, 0, 0);
 }
 
 
@@ -384,6 +399,20 @@ void Input::OnWheelEvent(float xOffset, float yOffset) noexcept
 {
     m_mouseWheelDX = xOffset;
     m_mouseWheelDY = yOffset;
+
+    RecordEvent(InputEventType::TYPE_MOUSE_WHEEL, 0, 0);
+}
+
+
+void Input::RecordEvent(InputEventType type, uint8_t code, uint8_t state) noexcept
+{
+    InputEventRecord record = {};
+    record.timestampNs = GetInputTimestampNs();
+    record.type = type;
+    record.code = code;
+    record.state = state;
+
+    m_eventsHistory.Push(record);
 }
 
 
@@ -566,6 +595,15 @@ void Window::Destroy() noexcept
     m_framebufferWidth = 0;
     m_framebufferHeight = 0;
 
+    {
+        std::scoped_lock lock(m_inputLatencyHistoryMutex);
+        m_frameInputTagsHistory.Clear();
+        m_inputLatencyHistory.Clear();
+    }
+    
+    m_currFrameInputTag = {};
+    m_lastSampledInputTimestampNs = 0;
+
     m_state.reset();
 }
 
@@ -577,6 +615,13 @@ void Window::PollEvents() noexcept
 }
 
 
+void Window::WaitEvents(double timeoutSec) noexcept
+{
+    ASSERT_WINDOW_INIT_STATUS(this);
+    glfwWaitEventsTimeout(timeoutSec);
+}
+
+
 void Window::DisableCursor() noexcept
 {
     ASSERT_WINDOW_INIT_STATUS(this);
@@ -603,17 +648,102 @@ void Window::EnableCursor() noexcept
 }
 
 
-void Window::Update() noexcept
+void Window::Update(double eventsWaitTimeoutSec) noexcept
 {
     m_input.Update();
-    PollEvents();
+
+    if (eventsWaitTimeoutSec > 0.0) {
+        WaitEvents(eventsWaitTimeoutSec);
+    } else {
+        PollEvents();
+    }
+
+    // Tag current frame with the newest input it is going to consume. Events that were already
+    // sampled by previous frames don't produce latency samples
+    ++m_currFrameInputTag.frameIndex;
+    m_currFrameInputTag.swapTimestampNs = 0;
+    
+    const InputEventRecord* pNewestEvent = m_input.GetNewestEvent();
+    const bool hasNewInput = pNewestEvent && pNewestEvent->timestampNs > m_lastSampledInputTimestampNs;
+
+    m_currFrameInputTag.newestInputTimestampNs = hasNewInput ? pNewestEvent->timestampNs : 0;
+
+    if (hasNewInput) {
+        m_lastSampledInputTimestampNs = pNewestEvent->timestampNs;
+    }
 }
 
 
-void Window::SwapBuffers() noexcept
+void Window::SwapBuffers(const FrameInputTag& frameInputTag) noexcept
 {
     ASSERT_WINDOW_INIT_STATUS(this);
     glfwSwapBuffers(static_cast<GLFWwindow*>(m_pNativeWindow));
+
+    FrameInputTag presentedFrameTag = frameInputTag;
+    presentedFrameTag.swapTimestampNs = GetInputTimestampNs();
+
+    std::scoped_lock lock(m_inputLatencyHistoryMutex);
+
+    if (presentedFrameTag.newestInputTimestampNs != 0) {
+        const uint64_t latencyNs = presentedFrameTag.swapTimestampNs - presentedFrameTag.newestInputTimestampNs;
+        m_inputLatencyHistory.Push(static_cast<float>(latencyNs / 1'000'000.0));
+    }
+
+    m_frameInputTagsHistory.Push(presentedFrameTag);
+}
+
+
+void Window::MakeContextCurrent() noexcept
+{
+    ASSERT_WINDOW_INIT_STATUS(this);
+    glfwMakeContextCurrent(static_cast<GLFWwindow*>(m_pNativeWindow));
+}
+
+
+void Window::ReleaseContext() noexcept
+{
+    glfwMakeContextCurrent(nullptr);
+}
+
+
+FrameInputTag Window::GetLastPresentedFrameInputTag() const noexcept
+{
+    std::scoped_lock lock(m_inputLatencyHistoryMutex);
+    return m_frameInputTagsHistory.IsEmpty() ? FrameInputTag{} : m_frameInputTagsHistory.Back();
+}
+
+
+InputLatencyStats Window::GetInputLatencyStats() const noexcept
+{
+    std::scoped_lock lock(m_inputLatencyHistoryMutex);
+
+    InputLatencyStats stats = {};
+    stats.samplesCount = static_cast<uint32_t>(m_inputLatencyHistory.GetSize());
+
+    if (stats.samplesCount == 0) {
+        return stats;
+    }
+
+    std::array<float, INPUT_LATENCY_HISTORY_SIZE> samples;
+    
+    double latencySum = 0.0;
+
+    for (size_t i = 0; i < stats.samplesCount; ++i) {
+        samples[i] = m_inputLatencyHistory[i];
+        latencySum += samples[i];
+    }
+
+    const auto samplesBegin = samples.begin();
+    const auto samplesEnd = samples.begin() + stats.samplesCount;
+
+    const size_t p99Idx = (stats.samplesCount * 99) / 100;
+    std::nth_element(samplesBegin, samplesBegin + p99Idx, samplesEnd);
+
+    stats.minMs = *std::min_element(samplesBegin, samplesEnd);
+    stats.avgMs = latencySum / stats.samplesCount;
+    stats.p99Ms = samples[p99Idx];
+
+    return stats;
 }
 
 
@@ -669,6 +799,13 @@ void Window::SetTitle(const char *title) noexcept
 }
 
 
+void Window::SetSize(uint32_t width, uint32_t height) noexcept
+{
+    ASSERT_WINDOW_INIT_STATUS(this);
+    glfwSetWindowSize(static_cast<GLFWwindow*>(m_pNativeWindow), static_cast<int32_t>(width), static_cast<int32_t>(height));
+}
+
+
 WindowSystem& WindowSystem::GetInstance() noexcept
 {
     ASSERT_WINDOW_SYSTEM_INIT_STATUS();
@@ -2,7 +2,10 @@
 
 #include "window_system_events.h"
 
+#include "utils/data_structures/ring_buffer.h"
+
 #include <bitset>
+#include <mutex>
 
 
 enum class KeyboardKey : uint8_t
@@ -166,6 +169,44 @@ struct CursorPositon
 };
 
 
+enum class InputEventType : uint8_t
+{
+    TYPE_KEY,
+    TYPE_MOUSE_BUTTON,
+    TYPE_CURSOR_MOVE,
+    TYPE_MOUSE_WHEEL,
+
+    TYPE_COUNT,
+    TYPE_INVALID
+};
+
+
+struct InputEventRecord
+{
+    uint64_t       timestampNs; // steady clock time the event was received by input callbacks
+    InputEventType type = InputEventType::TYPE_INVALID;
+    uint8_t        code;        // KeyboardKey or MouseButton depending on type
+    uint8_t        state;       // KeyState or MouseButtonState depending on type
+};
+
+
+struct FrameInputTag
+{
+    uint64_t frameIndex;
+    uint64_t newestInputTimestampNs; // 0 if frame hasn't sampled any new input
+    uint64_t swapTimestampNs;
+};
+
+
+struct InputLatencyStats
+{
+    double   minMs;
+    double   avgMs;
+    double   p99Ms;
+    uint32_t samplesCount;
+};
+
+
 namespace detail
 {
     // Represents es::ListenerID, needs to avoid including event_dispatcher.h in this file
@@ -204,7 +245,13 @@ public:
     float GetMouseWheelDx() const noexcept { return m_mouseWheelDX; }
     float GetMouseWheelDy() const noexcept { return m_mouseWheelDY; }
 
+    const InputEventRecord* GetNewestEvent() const noexcept { return m_eventsHistory.IsEmpty() ? nullptr : &m_eventsHistory.Back(); }
+    const auto& GetEventsHistory() const noexcept { return m_eventsHistory; }
+
     bool IsInitialized() const noexcept { return m_isIntialized; }
+
+public:
+    static inline constexpr size_t EVENTS_HISTORY_SIZE = 256;
     
 private:
     bool Init(Window* pWindow) noexcept;
@@ -233,9 +280,14 @@ private:
     void OnMouseButtonEvent(MouseButton button, MouseButtonState state) noexcept;
     void OnMouseMoveEvent(double xpos, double ypos) noexcept;
     void OnWheelEvent(float xOffset, float yOffset) noexcept;
+
+    void RecordEvent(InputEventType type, uint8_t code, uint8_t state) noexcept;
     
 
 private:
+    ds::RingBuffer<InputEventRecord, EVENTS_HISTORY_SIZE> m_eventsHistory;
+
+
     std::array<KeyState, static_cast<size_t>(KeyboardKey::KEY_COUNT)> m_keyStates;
     std::array<detail::WinSysEventListenerIDDataHandler, InputEventIndex::IDX_COUNT> m_inputListenersIDHandlers;
 
@@ -289,8 +341,16 @@ public:
     Window(Window&& other) = delete;
     Window& operator=(Window&& other) = delete;
 
-    void Update() noexcept;
-    void SwapBuffers() noexcept;
+    // If eventsWaitTimeoutSec is greater than zero, blocks the thread until any event is received or timeout is expired
+    void Update(double eventsWaitTimeoutSec = 0.0) noexcept;
+    // Can be called from the thread the context is current on. frameInputTag is the tag returned by
+    // GetCurrFrameInputTag() on the main thread for the frame being presented
+    void SwapBuffers(const FrameInputTag& frameInputTag) noexcept;
+
+    // Makes window's graphics context current on the calling thread
+    void MakeContextCurrent() noexcept;
+    // Detaches any graphics context from the calling thread
+    void ReleaseContext() noexcept;
 
     void Show() noexcept;
     void Hide() noexcept;
@@ -309,6 +369,9 @@ public:
     const char* GetTitle() const noexcept;
     void SetTitle(const char* title) noexcept;
 
+    // Requests client area size. New size is seen once resize events are received, OS may clamp it to the screen
+    void SetSize(uint32_t width, uint32_t height) noexcept;
+
     bool IsClosed() const noexcept { return !m_state.test(STATE_BIT_OPENED); }
     bool IsFocused() const noexcept { return m_state.test(STATE_BIT_FOCUSED); }
     bool IsMaximized() const noexcept { return m_state.test(STATE_BIT_MAXIMIZED); }
@@ -318,11 +381,21 @@ public:
 
     bool IsInitialized() const noexcept { return m_pNativeWindow != nullptr; }
 
+    // Latency between the newest input event sampled by a frame and the moment this frame's SwapBuffers returned
+    InputLatencyStats GetInputLatencyStats() const noexcept;
+    FrameInputTag GetLastPresentedFrameInputTag() const noexcept;
+    
+    const FrameInputTag& GetCurrFrameInputTag() const noexcept { return m_currFrameInputTag; }
+
+public:
+    static inline constexpr size_t INPUT_LATENCY_HISTORY_SIZE = 512;
+
 private:
     bool Init(const WindowCreateInfo& createInfo) noexcept;
     void Destroy() noexcept;
 
     void PollEvents() noexcept;
+    void WaitEvents(double timeoutSec) noexcept;
 
     void DisableCursor() noexcept;
     void EnableCursor() noexcept;
@@ -344,6 +417,13 @@ private:
 
     Input m_input;
 
+    ds::RingBuffer<FrameInputTag, INPUT_LATENCY_HISTORY_SIZE> m_frameInputTagsHistory;
+    ds::RingBuffer<float, INPUT_LATENCY_HISTORY_SIZE> m_inputLatencyHistory;
+    mutable std::mutex m_inputLatencyHistoryMutex;
+    
+    FrameInputTag m_currFrameInputTag = {};
+    uint64_t m_lastSampledInputTimestampNs = 0;
+
     std::array<detail::WinSysEventListenerIDDataHandler, WindowEventIndex::IDX_COUNT> m_windowEventListenersIDHandlers;
 
     void* m_pNativeWindow = nullptr;
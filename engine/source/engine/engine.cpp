@@ -5,17 +5,267 @@
 #include "core/window_system/window_system.h"
 
 #include "render/render_system/render_system.h"
+#include "render/render_system/render_frame_benchmark.h"
 #include "core/camera/camera_manager.h"
 
 #include "utils/debug/assertion.h"
+#include "utils/timer/fixed_timestep.h"
+#include "utils/timer/frame_limiter.h"
+#include "utils/timer/startup_timeline.h"
+#include "utils/timer/timer.h"
+
+#include <chrono>
 
 
 #define ENG_CHECK_REND_SYS_INITIALIZATION() ENG_ASSERT(engIsRenderSystemInitialized(), "Render system is not initialized");
 
+#define INIT_CALL(CALL, ...) { StartupTimelineScopedStage stage(#CALL); if (!CALL(__VA_ARGS__)) { return; } }
+
+
+namespace chr = std::chrono;
+
 
 static std::unique_ptr<Engine> pEngineInst = nullptr;
 static Window* pMainWindowInst = nullptr;
 
+struct CameraTransform
+{
+    glm::quat rotation;
+    glm::vec3 position;
+};
+
+
+static Camera* pMainCam = nullptr;
+// Main camera state before the last simulation step. Used to interpolate rendered view between steps
+static CameraTransform prevMainCamTransform = {};
+// Index of the main camera projection jitter in the Halton sequence
+static uint32_t mainCamJitterIdx = 0;
+
+static FramePacket* pCurrFramePacket = nullptr;
+
+// Static demo scene instances, copied into every frame packet. Meshes are created by the render system
+static std::vector<FramePacketDrawItem> demoSceneDrawItems;
+
+#if defined(ENG_RUN_RENDER_BENCHMARKS)
+// Overrides frame packets settings until all render benchmarks are logged
+static RenderFrameBenchmark renderFrameBenchmark;
+#endif
+
+static FrameLimiter frameLimiter;
+static FixedTimestepScheduler simulationScheduler;
+static Timer frameTimer;
+static chr::steady_clock::time_point frameStartTime;
+
+static constexpr double RENDER_STATS_LOG_PERIOD_SEC = 5.0;
+static double renderStatsLogTimeSec = 0.0;
+
+
+static double GetDurationInSec(const chr::steady_clock::time_point& A, const chr::steady_clock::time_point& B) noexcept
+{
+    return chr::duration<double>(B - A).count();
+}
+
+
+static bool InitMainCamera() noexcept
+{
+    CameraManager& cameraManager = CameraManager::GetInstance();
+
+    pMainCam = cameraManager.RegisterCamera();
+    
+    if (!(pMainCam && pMainCam->IsRegistered())) {
+        ENG_ASSERT_FAIL("Failed to register main camera");
+        return false;
+    }
+    
+    pMainCam->SetPerspProjection();
+    
+    pMainCam->SetZNear(0.01f);
+    pMainCam->SetZFar(100.f);
+
+    pMainCam->SetPosition(glm::vec3(0.f, 0.f, 2.f));
+    pMainCam->SetRotation(glm::quatLookAt(-M3D_AXIS_Z, M3D_AXIS_Y));
+
+    prevMainCamTransform.position = pMainCam->GetPosition();
+    prevMainCamTransform.rotation = pMainCam->GetRotationQuat();
+
+    pMainCam->SetAspectRatio(pMainWindowInst->GetFramebufferWidth(), pMainWindowInst->GetFramebufferHeight());
+    pMainCam->SetFovDegress(90.f);
+
+    cameraManager.SubscribeCamera<EventFramebufferResized>(*pMainCam, [](const void* pEvent) {
+        const EventFramebufferResized& event = es::EventCast<EventFramebufferResized>(pEvent);
+        const uint32_t width = event.GetWidth();
+        const uint32_t height = event.GetHeight();
+
+        const float halfWidth = width * 0.5f;
+        const float halfHeight = height * 0.5f;
+        
+        if (width > 0 && height > 0) {
+            pMainCam->SetAspectRatio(width, height);
+            
+            pMainCam->SetOrthoLeft(-halfWidth);
+            pMainCam->SetOrthoRight(halfWidth);
+            pMainCam->SetOrthoBottom(-halfHeight);
+            pMainCam->SetOrthoTop(halfHeight);
+        }
+    });
+
+    return true;
+}
+
+
+static void SimulateMainCamera(const Input& input, float stepTime) noexcept
+{
+    prevMainCamTransform.position = pMainCam->GetPosition();
+    prevMainCamTransform.rotation = pMainCam->GetRotationQuat();
+
+    glm::vec3 offset(0.f);
+    
+    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_W) * (-pMainCam->GetZDir());
+    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_S) * (pMainCam->GetZDir());
+    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_D) * (pMainCam->GetXDir());
+    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_A) * (-pMainCam->GetXDir());
+    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_E) * (pMainCam->GetYDir());
+    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_Q) * (-pMainCam->GetYDir());
+
+    if (!amIsZero(offset)) {
+        pMainCam->Move(glm::normalize(offset) * stepTime);
+    }
+}
+
+
+// Mouse wheel delta is a per frame event, so it's applied once per frame rather than per simulation step
+static void UpdateMainCameraFov(const Input& input) noexcept
+{
+    const float fovDegrees = pMainCam->GetFovDegrees() - input.GetMouseWheelDy();
+    if (camIsFovDegreesValid(fovDegrees)) {
+        pMainCam->SetFovDegress(fovDegrees);
+    }
+}
+
+
+// Radical inverse of the index in the base. Consecutive points are spread evenly over [0, 1)
+static float Halton(uint32_t index, uint32_t base) noexcept
+{
+    float result = 0.f;
+    float fraction = 1.f;
+
+    for (; index > 0; index /= base) {
+        fraction /= base;
+        result += fraction * (index % base);
+    }
+
+    return result;
+}
+
+
+// Jitter is set before camera matrices update, so the frame packet gets the jittered projection. Sequence length grows as internal
+// resolution drops, so that each output pixel still receives about 8 samples. Offsets are relative to the last reported render size,
+// render thread removes exactly the offset baked into the projection, so a stale size only changes sample positions slightly
+static void UpdateMainCameraJitter(bool isTemporalUpscalingEnabled) noexcept
+{
+    const RenderFrameStatistics renderStats = RenderSystem::GetInstance().GetLastFrameStatistics();
+
+    if (!isTemporalUpscalingEnabled || renderStats.renderWidth == 0 || renderStats.renderHeight == 0) {
+        pMainCam->SetProjectionJitter(M3D_ZEROF2);
+        mainCamJitterIdx = 0;
+        return;
+    }
+
+    const float scale = std::max(renderStats.resolutionScale, 0.1f);
+    const uint32_t sequenceLength = static_cast<uint32_t>(std::ceil(8.f / (scale * scale)));
+
+    mainCamJitterIdx = (mainCamJitterIdx + 1) % sequenceLength;
+
+    // Halton points start from index 1, since the zero index is the corner of a pixel
+    const glm::vec2 jitterPixels(Halton(mainCamJitterIdx + 1, 2) - 0.5f, Halton(mainCamJitterIdx + 1, 3) - 0.5f);
+    pMainCam->SetProjectionJitter(2.f * jitterPixels / glm::vec2(renderStats.renderWidth, renderStats.renderHeight));
+}
+
+
+static bool InitDemoScene() noexcept
+{
+    demoSceneDrawItems.clear();
+    demoSceneDrawItems.emplace_back(FramePacketDrawItem { M3D_MAT4_IDENTITY, ds::StrID("cube"), 0 });
+
+    return true;
+}
+
+
+// Lights orbit the scene origin on a few rings. Every fourth light is a spot looking at the origin
+static void FillDemoLights(std::vector<FramePacketLight>& lights, uint32_t lightsCount, float time) noexcept
+{
+    constexpr float GOLDEN_ANGLE = 2.39996323f;
+    constexpr uint32_t RINGS_COUNT = 4;
+
+    lights.clear();
+    lights.reserve(lightsCount);
+
+    for (uint32_t i = 0; i < lightsCount; ++i) {
+        const float t = (i + 0.5f) / lightsCount;
+        const float y = 1.f - 2.f * t;
+        const float ringRadius = 0.9f + 0.2f * (i % RINGS_COUNT);
+        const float angle = i * GOLDEN_ANGLE + time * (0.25f + 0.1f * (i % RINGS_COUNT));
+        const float horizontalRadius = glm::sqrt(glm::max(1.f - y * y, 0.f));
+
+        const float hue = glm::fract(i * 0.618034f);
+
+        FramePacketLight light = {};
+        light.position = ringRadius * glm::vec3(horizontalRadius * glm::cos(angle), y, horizontalRadius * glm::sin(angle));
+        light.range = 0.6f;
+        light.color = glm::clamp(glm::abs(glm::fract(glm::vec3(hue) + glm::vec3(1.f, 2.f / 3.f, 1.f / 3.f)) * 6.f - 3.f) - 1.f, 0.f, 1.f);
+        light.intensity = 2.f;
+
+        if (i % 4 == 3) {
+            light.type = FramePacketLightType::SPOT;
+            light.direction = glm::normalize(-light.position);
+            light.range = 1.2f;
+            light.spotInnerAngle = glm::radians(15.f);
+            light.spotOuterAngle = glm::radians(30.f);
+        } else {
+            light.type = FramePacketLightType::POINT;
+        }
+
+        lights.emplace_back(light);
+    }
+}
+
+
+static void UpdateMainWindowTitle(double frameTimeSec) noexcept
+{
+    const RenderFrameStatistics renderStats = RenderSystem::GetInstance().GetLastFrameStatistics();
+
+    char title[128];
+    sprintf_s(title, "%.3f ms | %.1f FPS | res: %ux%u (%.0f%%) | upscale: %s", frameTimeSec * 1000.0, 1.0 / frameTimeSec, 
+        renderStats.renderWidth, renderStats.renderHeight, renderStats.resolutionScale * 100.f, renderStats.isTemporalUpscaled ? "temporal" : "bilinear");
+    
+    pMainWindowInst->SetTitle(title);
+}
+
+
+// Detailed statistics don't fit the window title, so they are logged once per period
+static void LogRenderStatistics(double frameTimeSec) noexcept
+{
+    renderStatsLogTimeSec += frameTimeSec;
+
+    if (renderStatsLogTimeSec < RENDER_STATS_LOG_PERIOD_SEC) {
+        return;
+    }
+
+    renderStatsLogTimeSec = 0.0;
+
+    const InputLatencyStats inputLatencyStats = pMainWindowInst->GetInputLatencyStats();
+    const RenderFrameStatistics renderStats = RenderSystem::GetInstance().GetLastFrameStatistics();
+
+    ENG_LOG_INFO("Render statistics: input latency min {:.2f} ms, avg {:.2f} ms, p99 {:.2f} ms | GL state calls: {} issued, {} skipped | GPU {:.2f} ms", 
+        inputLatencyStats.minMs, inputLatencyStats.avgMs, inputLatencyStats.p99Ms, renderStats.issuedStateCallsCount, renderStats.skippedStateCallsCount,
+        renderStats.gpuFrameTimeMs);
+    ENG_LOG_INFO("    GBuffer: {} B/px, overdraw {:.2f}, {:.3f} ms | occluded: {}/{}, {:.3f} ms | upscale {:.3f} ms", renderStats.gBufferBytesPerPixel, 
+        renderStats.gBufferOverdraw, renderStats.gBufferPassTimeMs, renderStats.occludedInstancesCount, renderStats.drawItemsCount, 
+        renderStats.occlusionCullingTimeMs + renderStats.hiZPassTimeMs, renderStats.upscalePassTimeMs);
+    ENG_LOG_INFO("    lights: {}, {:.1f} avg / {} max per cluster | culling {:.3f} ms | lighting {:.3f} ms", renderStats.lightsCount, 
+        renderStats.avgLightsPerLitCluster, renderStats.maxLightsPerCluster, renderStats.lightCullingTimeMs, renderStats.colorPassTimeMs);
+}
+
 
 Engine& Engine::GetInstance() noexcept
 {
@@ -24,14 +274,14 @@ Engine& Engine::GetInstance() noexcept
 }
 
 
-bool Engine::Init(const char* title, uint32_t width, uint32_t height, bool enableVSync) noexcept
+bool Engine::Init(const char* title, uint32_t width, uint32_t height, bool enableVSync, const EngineFramePacingInfo& framePacing) noexcept
 {
     if (engIsEngineInitialized()) {
         ENG_LOG_WARN("Engine is already initialized!");
         return true;
     }
 
-    pEngineInst = std::unique_ptr<Engine>(new Engine(title, width, height, enableVSync));
+    pEngineInst = std::unique_ptr<Engine>(new Engine(title, width, height, enableVSync, framePacing));
 
     if (!pEngineInst) {
         ENG_ASSERT_GRAPHICS_API_FAIL("Failed to allocate memory for engine");
@@ -55,8 +305,14 @@ void Engine::Terminate() noexcept
 
 Engine::~Engine()
 {
-    pMainWindowInst = nullptr;
     engTerminateRenderSystem();
+    
+    pCurrFramePacket = nullptr;
+    pMainCam = nullptr;
+
+    demoSceneDrawItems.clear();
+    pMainWindowInst = nullptr;
+
     engTerminateCameraManager();
     engTerminateWindowSystem();    
     engTerminateLogSystem();
@@ -65,43 +321,139 @@ Engine::~Engine()
 
 void Engine::Update() noexcept
 {
-    pMainWindowInst->Update();
-    CameraManager::GetInstance().Update(1.f);
+    const bool isIdle = pMainWindowInst->IsMinimized() || (m_framePacing.throttleWhenUnfocused && !pMainWindowInst->IsFocused());
+
+    if (isIdle != m_isIdle) {
+        // Both loads are measured over the whole period, so consecutive switches give before and after figures of the idle policy
+        const double cpuTimeSec = engGetProcessCPUTimeInSec();
+        ENG_MAYBE_UNUSED const double processCPULoad = m_periodTimeSec > 0.0 ? (cpuTimeSec - m_periodStartCPUTimeSec) / m_periodTimeSec : 0.0;
+
+        ENG_LOG_INFO("Main loop {} idle mode. Previous period: {:.2f} s, main thread utilization: {:.1f}%, process CPU load: {:.1f}% of a core", 
+            isIdle ? "entered" : "left", m_periodTimeSec, m_periodTimeSec > 0.0 ? 100.0 * (1.0 - m_periodBlockedTimeSec / m_periodTimeSec) : 100.0,
+            100.0 * processCPULoad);
+        
+        m_periodTimeSec = 0.0;
+        m_periodBlockedTimeSec = 0.0;
+        m_periodStartCPUTimeSec = cpuTimeSec;
+        m_isIdle = isIdle;
+    }
+
+    if (m_isIdle) {
+        const chr::steady_clock::time_point waitStartTime = chr::steady_clock::now();
+        pMainWindowInst->Update(m_framePacing.idleEventsWaitTimeoutSec);
+        m_frameBlockedTimeSec += GetDurationInSec(waitStartTime, chr::steady_clock::now());
+    } else {
+        pMainWindowInst->Update();
+    }
+
+    frameTimer.Tick();
+
+    const Input& input = pMainWindowInst->GetInput();
+    const float stepTime = static_cast<float>(simulationScheduler.GetStepTimeInSec());
+
+    const uint32_t stepsCount = simulationScheduler.Advance(frameTimer.GetDeltaTimeInSec());
+
+    for (uint32_t i = 0; i < stepsCount; ++i) {
+        SimulateMainCamera(input, stepTime);
+    }
+
+    UpdateMainCameraFov(input);
+    UpdateMainCameraJitter(m_isTemporalUpscalingEnabled);
+
+    CameraManager::GetInstance().Update(static_cast<float>(frameTimer.GetDeltaTimeInSec()));
 }
 
 
 void Engine::BeginFrame() noexcept
 {
-    RenderSystem::GetInstance().BeginFrame();
+    // Blocks if render thread is behind by the max number of frames in flight
+    const chr::steady_clock::time_point acquireStartTime = chr::steady_clock::now();
+    pCurrFramePacket = RenderSystem::GetInstance().AcquireFramePacket();
+    m_frameBlockedTimeSec += GetDurationInSec(acquireStartTime, chr::steady_clock::now());
 }
 
 
 void Engine::EndFrame() noexcept
 {
-    RenderSystem::GetInstance().EndFrame();
-    pMainWindowInst->SwapBuffers();
+    if (pCurrFramePacket) {
+        RenderSystem::GetInstance().SubmitFramePacket(pCurrFramePacket);
+        pCurrFramePacket = nullptr;
+    }
+
+    frameLimiter.Wait();
+    m_frameBlockedTimeSec += frameLimiter.GetLastSleepTimeInSec();
+
+    const chr::steady_clock::time_point frameEndTime = chr::steady_clock::now();
+    const double frameTimeSec = GetDurationInSec(frameStartTime, frameEndTime);
+
+    UpdateUtilizationStatistics(frameTimeSec, m_frameBlockedTimeSec);
+    
+    if (!pMainWindowInst->IsMinimized()) {
+        UpdateMainWindowTitle(frameTimeSec);
+        LogRenderStatistics(frameTimeSec);
+    }
+
+    frameStartTime = frameEndTime;
+    m_frameBlockedTimeSec = 0.0;
 }
 
 
 void Engine::RenderFrame() noexcept
 {
-    if (pMainWindowInst->IsMinimized()) {
+    // Builds immutable frame packet. Actual GL submission happens on the render thread
+    if (!pCurrFramePacket) {
+        return;
+    }
+
+    FramePacket& packet = *pCurrFramePacket;
+
+    packet.inputTag = pMainWindowInst->GetCurrFrameInputTag();
+    packet.frameIndex = packet.inputTag.frameIndex;
+
+    // Nothing is rendered while minimized, so there is nothing to present
+    packet.skipRendering = pMainWindowInst->IsMinimized();
+
+    if (packet.skipRendering) {
         return;
     }
 
-    RenderSystem& renderSys = RenderSystem::GetInstance();
+    // Rendered view lags simulation by up to one step, but moves smoothly when tick rate is lower than frame rate
+    const float alpha = simulationScheduler.GetInterpolationAlpha();
+
+    const glm::vec3 camPosition = glm::mix(prevMainCamTransform.position, pMainCam->GetPosition(), alpha);
+    const glm::quat camRotation = glm::slerp(prevMainCamTransform.rotation, pMainCam->GetRotationQuat(), alpha);
+
+    packet.viewMatrix = camComputeViewMatrix(camPosition, camRotation);
+    packet.projMatrix = pMainCam->GetProjectionMatrix();
+    packet.viewProjMatrix = packet.projMatrix * packet.viewMatrix;
+    packet.projJitter = pMainCam->GetProjectionJitter();
+    packet.zNear = pMainCam->GetZNear();
+    packet.zFar = pMainCam->GetZFar();
+
+    packet.elapsedTime = frameTimer.GetElapsedTimeInSec();
+    packet.deltaTime = frameTimer.GetDeltaTimeInSec();
 
-    // Depth Prepass
-    renderSys.RunDepthPrepass();
+    packet.framebufferWidth = pMainWindowInst->GetFramebufferWidth();
+    packet.framebufferHeight = pMainWindowInst->GetFramebufferHeight();
 
-    // GBuffer Pass
-    renderSys.RunGBufferPass();
+    packet.isDepthPrepassEnabled = m_isDepthPrepassEnabled;
+    packet.isOcclusionCullingEnabled = m_isOcclusionCullingEnabled;
+    packet.isDynamicResolutionEnabled = m_isDynamicResolutionEnabled;
+    packet.targetGPUFrameTimeMs = m_targetGPUFrameTimeMs;
+    packet.minResolutionScale = m_minResolutionScale;
+    packet.resolutionScale = m_resolutionScale;
+    packet.isTemporalUpscalingEnabled = m_isTemporalUpscalingEnabled;
+    packet.isVisibilityBufferEnabled = m_isVisibilityBufferEnabled;
 
-    // Forward + Lighting Pass
-    renderSys.RunColorPass();
+    packet.drawItems.assign(demoSceneDrawItems.begin(), demoSceneDrawItems.end());
 
-    // Post Process
-    renderSys.RunPostprocessingPass();
+    FillDemoLights(packet.lights, m_demoLightsCount, packet.elapsedTime);
+
+#if defined(ENG_RUN_RENDER_BENCHMARKS)
+    if (!renderFrameBenchmark.IsFinished()) {
+        renderFrameBenchmark.Update(packet, RenderSystem::GetInstance().GetLastFrameStatistics(), *pMainWindowInst);
+    }
+#endif
 }
 
 
@@ -117,40 +469,66 @@ bool Engine::IsInitialized() const noexcept
 }
 
 
-Engine::Engine(const char* title, uint32_t width, uint32_t height, bool enableVSync)
+void Engine::UpdateUtilizationStatistics(double frameTimeSec, double blockedTimeSec) noexcept
 {
-    engInitLogSystem();
+    m_mainThreadUtilization = frameTimeSec > 0.0 ? std::clamp(static_cast<float>(1.0 - blockedTimeSec / frameTimeSec), 0.f, 1.f) : 1.f;
 
-    if (!engInitWindowSystem()) {
-        return;
+    m_periodTimeSec += frameTimeSec;
+    m_periodBlockedTimeSec += blockedTimeSec;
+}
+
+
+Engine::Engine(const char* title, uint32_t width, uint32_t height, bool enableVSync, const EngineFramePacingInfo& framePacing)
+    : m_framePacing(framePacing)
+{
+    StartupTimeline::Begin();
+
+    {
+        StartupTimelineScopedStage stage("engInitLogSystem");
+        engInitLogSystem();
     }
 
+    INIT_CALL(engInitWindowSystem);
+
     WindowCreateInfo mainWindowCreateInfo = {};
     mainWindowCreateInfo.pTitle = title;
     mainWindowCreateInfo.width = width;
     mainWindowCreateInfo.height = height;
     mainWindowCreateInfo.enableVSync = enableVSync;
 
-    pMainWindowInst = WindowSystem::GetInstance().CreateWindow(WINDOW_TAG_MAIN, mainWindowCreateInfo);
-
-    if (!(pMainWindowInst && pMainWindowInst->IsInitialized())) {
-        return;
+    {
+        StartupTimelineScopedStage stage("CreateMainWindow");
+        pMainWindowInst = WindowSystem::GetInstance().CreateWindow(WINDOW_TAG_MAIN, mainWindowCreateInfo);
     }
 
-    if (!engInitCameraManager()) {
+    if (!(pMainWindowInst && pMainWindowInst->IsInitialized())) {
         return;
     }
 
-    if (!engInitRenderSystem()) {
-        return;
-    }
+    INIT_CALL(engInitCameraManager);
+    INIT_CALL(engInitRenderSystem);
+    INIT_CALL(InitMainCamera);
+    INIT_CALL(InitDemoScene);
 
     // Notify all subscribed systems to resized their resources
     es::EventDispatcher::GetInstance().Notify<EventFramebufferResized>(pMainWindowInst->GetFramebufferWidth(), pMainWindowInst->GetFramebufferHeight());
 
+    RenderSystem::GetInstance().StartRenderThread();
+
+    frameLimiter.SetTargetFPS(m_framePacing.maxFPS);
+    
+    simulationScheduler.SetTickRate(m_framePacing.simulationTickRate);
+    simulationScheduler.SetMaxStepsPerFrame(m_framePacing.maxSimulationStepsPerFrame);
+
+    frameTimer.Tick();
+    frameStartTime = chr::steady_clock::now();
+    m_periodStartCPUTimeSec = engGetProcessCPUTimeInSec();
+
     m_isInitialized = true;
 
     pMainWindowInst->Show();
+
+    StartupTimeline::LogReport();
 }
 
 
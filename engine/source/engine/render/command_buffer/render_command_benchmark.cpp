@@ -0,0 +1,236 @@
+#include "pch.h"
+#include "render_command_benchmark.h"
+
+#include "render_command_buffer.h"
+
+#include "utils/algorithm/radix_sort.h"
+#include "utils/thread/worker_pool.h"
+#include "utils/debug/assertion.h"
+
+#include <chrono>
+
+
+namespace chr = std::chrono;
+
+
+static constexpr uint32_t BENCHMARK_ITERATIONS_COUNT = 5;
+
+static constexpr uint32_t BENCHMARK_PIPELINES_COUNT = 16;
+static constexpr uint32_t BENCHMARK_MATERIALS_COUNT = 256;
+static constexpr uint32_t BENCHMARK_MESHES_COUNT = 1024;
+
+static constexpr size_t SORT_BENCHMARK_SIZES[] = { 1'000, 10'000, 100'000, 1'000'000 };
+
+
+struct SortBenchmarkItem
+{
+    uint64_t key;
+    uint32_t payload;
+};
+
+
+enum class SortBenchmarkKeysType
+{
+    RANDOM,
+    RENDER_SORT_KEYS,
+};
+
+
+// Commands only store object pointers, so fake addresses are enough as long as nothing is executed
+template <typename T>
+static T* GetFakeObject(uint32_t index) noexcept
+{
+    return reinterpret_cast<T*>(static_cast<uintptr_t>(index + 1) * alignof(std::max_align_t));
+}
+
+
+static uint32_t GetPseudoRandomValue(uint32_t seed) noexcept
+{
+    seed ^= seed >> 16;
+    seed *= 0x7feb352du;
+    seed ^= seed >> 15;
+    seed *= 0x846ca68bu;
+    seed ^= seed >> 16;
+
+    return seed;
+}
+
+
+static void RecordBenchmarkDraws(RenderCommandBuffer& cmdBuffer, uint32_t firstDraw, uint32_t lastDraw) noexcept
+{
+    for (uint32_t i = firstDraw; i < lastDraw; ++i) {
+        const uint32_t random = GetPseudoRandomValue(i);
+
+        const uint32_t pipeline = random % BENCHMARK_PIPELINES_COUNT;
+        const uint32_t material = (random >> 4) % BENCHMARK_MATERIALS_COUNT;
+        const uint32_t mesh = (random >> 12) % BENCHMARK_MESHES_COUNT;
+        const uint32_t depth = random >> 16;
+
+        cmdBuffer.BeginPacket(RenderSortKey::Make(0, RenderSortKey::PASS_STAGE_DRAW, pipeline, material, mesh, depth));
+        cmdBuffer.BindPipeline(GetFakeObject<Pipeline>(pipeline));
+        cmdBuffer.BindConstBuffer(0, GetFakeObject<MemoryBuffer>(0));
+        cmdBuffer.BindTexture(0, GetFakeObject<Texture>(material), GetFakeObject<TextureSamplerState>(0));
+        cmdBuffer.DrawIndexed(GetFakeObject<MeshObj>(mesh), 36, 0, 0, 1);
+        cmdBuffer.EndPacket();
+    }
+}
+
+
+static uint64_t GetRenderSortKey(uint32_t seed) noexcept
+{
+    const uint32_t random = GetPseudoRandomValue(seed);
+
+    const uint32_t pipeline = random % BENCHMARK_PIPELINES_COUNT;
+    const uint32_t material = (random >> 4) % BENCHMARK_MATERIALS_COUNT;
+    const uint32_t mesh = (random >> 12) % BENCHMARK_MESHES_COUNT;
+    const uint32_t depth = random >> 16;
+
+    return RenderSortKey::Make(seed % 3, RenderSortKey::PASS_STAGE_DRAW, pipeline, material, mesh, depth);
+}
+
+
+static double GetDurationInMillisec(const chr::steady_clock::time_point& A, const chr::steady_clock::time_point& B) noexcept
+{
+    return chr::duration<double, std::milli>(B - A).count();
+}
+
+
+void engRunCommandRecordingBenchmark(uint32_t drawsCount, uint32_t maxThreadsCount) noexcept
+{
+    ENG_ASSERT(maxThreadsCount > 0, "Benchmark requires at least one thread");
+
+    ENG_LOG_INFO("Command recording benchmark: {} draws, {} iterations (threads | record + sort ms | merge ms | total ms | speedup):", 
+        drawsCount, BENCHMARK_ITERATIONS_COUNT);
+
+    std::vector<RenderCommandPacket> mergedPackets;
+    // Speedup is only logged, which is compiled out in release
+    ENG_MAYBE_UNUSED double singleThreadTotalTime = 0.0;
+
+    for (uint32_t threadsCount = 1; threadsCount <= maxThreadsCount; ++threadsCount) {
+        WorkerThreadPool workers;
+        workers.Start(threadsCount - 1);
+
+        std::vector<RenderCommandBuffer> cmdBuffers(threadsCount);
+
+        double bestRecordTime = std::numeric_limits<double>::max();
+        double bestMergeTime = std::numeric_limits<double>::max();
+
+        // The first iteration warms up allocators storage
+        for (uint32_t iteration = 0; iteration <= BENCHMARK_ITERATIONS_COUNT; ++iteration) {
+            for (RenderCommandBuffer& cmdBuffer : cmdBuffers) {
+                cmdBuffer.Clear();
+            }
+
+            const chr::steady_clock::time_point recordStartTime = chr::steady_clock::now();
+
+            workers.Execute(threadsCount, [&](uint32_t jobIndex) {
+                const uint32_t firstDraw = static_cast<uint32_t>(uint64_t(drawsCount) * jobIndex / threadsCount);
+                const uint32_t lastDraw = static_cast<uint32_t>(uint64_t(drawsCount) * (jobIndex + 1) / threadsCount);
+
+                RecordBenchmarkDraws(cmdBuffers[jobIndex], firstDraw, lastDraw);
+                cmdBuffers[jobIndex].Sort();
+            });
+
+            const chr::steady_clock::time_point mergeStartTime = chr::steady_clock::now();
+
+            RenderCommandBuffer::MergeSorted(cmdBuffers.data(), cmdBuffers.size(), mergedPackets);
+
+            const chr::steady_clock::time_point endTime = chr::steady_clock::now();
+
+            ENG_ASSERT(mergedPackets.size() == drawsCount, "Merged packets count mismatch");
+
+            if (iteration > 0) {
+                bestRecordTime = std::min(bestRecordTime, GetDurationInMillisec(recordStartTime, mergeStartTime));
+                bestMergeTime = std::min(bestMergeTime, GetDurationInMillisec(mergeStartTime, endTime));
+            }
+        }
+
+        const double totalTime = bestRecordTime + bestMergeTime;
+
+        if (threadsCount == 1) {
+            singleThreadTotalTime = totalTime;
+        }
+
+        ENG_LOG_INFO("    {} | {} | {} | {} | {}x", threadsCount, bestRecordTime, bestMergeTime, totalTime, 
+            totalTime > 0.0 ? singleThreadTotalTime / totalTime : 0.0);
+
+        workers.Stop();
+    }
+}
+
+
+template <typename SortFunc>
+static double MeasureSort(const std::vector<SortBenchmarkItem>& source, std::vector<SortBenchmarkItem>& items, SortFunc sort) noexcept
+{
+    double bestTime = std::numeric_limits<double>::max();
+
+    for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS_COUNT; ++iteration) {
+        items = source;
+
+        const chr::steady_clock::time_point startTime = chr::steady_clock::now();
+        sort(items);
+        bestTime = std::min(bestTime, GetDurationInMillisec(startTime, chr::steady_clock::now()));
+    }
+
+    return bestTime;
+}
+
+
+void engRunSortKeysBenchmark(uint32_t maxThreadsCount) noexcept
+{
+    ENG_ASSERT(maxThreadsCount > 0, "Benchmark requires at least one thread");
+
+    WorkerThreadPool workers;
+    workers.Start(maxThreadsCount - 1);
+
+    const auto CompareItems = [](const SortBenchmarkItem& left, const SortBenchmarkItem& right) { return left.key < right.key; };
+    const auto GetItemKey = [](const SortBenchmarkItem& item) { return item.key; };
+
+    std::vector<SortBenchmarkItem> source;
+    std::vector<SortBenchmarkItem> items;
+    std::vector<SortBenchmarkItem> scratch;
+    std::vector<SortBenchmarkItem> reference;
+
+    for (SortBenchmarkKeysType keysType : { SortBenchmarkKeysType::RANDOM, SortBenchmarkKeysType::RENDER_SORT_KEYS }) {
+        ENG_LOG_INFO("Sort benchmark, {} keys, {} threads (count | std::sort ms | std::stable_sort ms | radix ms | parallel radix ms):", 
+            keysType == SortBenchmarkKeysType::RANDOM ? "random" : "render sort", maxThreadsCount);
+
+        for (size_t count : SORT_BENCHMARK_SIZES) {
+            source.resize(count);
+            scratch.resize(count);
+
+            for (size_t i = 0; i < count; ++i) {
+                const uint32_t seed = static_cast<uint32_t>(i);
+                
+                source[i].key = keysType == SortBenchmarkKeysType::RANDOM ? 
+                    (uint64_t(GetPseudoRandomValue(seed)) << 32) | GetPseudoRandomValue(~seed) : GetRenderSortKey(seed);
+                source[i].payload = seed;
+            }
+
+            // Times are only logged, which is compiled out in release. Sorts still run to check radix sort result
+            ENG_MAYBE_UNUSED const double stdSortTime = MeasureSort(source, items, [&](std::vector<SortBenchmarkItem>& data) {
+                std::sort(data.begin(), data.end(), CompareItems);
+            });
+
+            ENG_MAYBE_UNUSED const double stdStableSortTime = MeasureSort(source, reference, [&](std::vector<SortBenchmarkItem>& data) {
+                std::stable_sort(data.begin(), data.end(), CompareItems);
+            });
+
+            ENG_MAYBE_UNUSED const double radixSortTime = MeasureSort(source, items, [&](std::vector<SortBenchmarkItem>& data) {
+                amRadixSort(data.data(), scratch.data(), data.size(), GetItemKey);
+            });
+
+            ENG_ASSERT(std::equal(items.begin(), items.end(), reference.begin(), [](const SortBenchmarkItem& left, const SortBenchmarkItem& right) {
+                return left.key == right.key && left.payload == right.payload;
+            }), "Radix sort result doesn't match stable sort");
+
+            ENG_MAYBE_UNUSED const double parallelRadixSortTime = MeasureSort(source, items, [&](std::vector<SortBenchmarkItem>& data) {
+                amRadixSort(data.data(), scratch.data(), data.size(), GetItemKey, &workers);
+            });
+
+            ENG_LOG_INFO("    {} | {} | {} | {} | {}", count, stdSortTime, stdStableSortTime, radixSortTime, parallelRadixSortTime);
+        }
+    }
+
+    workers.Stop();
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+
+// CPU only benchmarks of the render commands recording. Don't require graphics context, results are logged
+
+// Records drawsCount draws split between 1 to maxThreadsCount threads, sorts per thread buffers and merges them
+void engRunCommandRecordingBenchmark(uint32_t drawsCount, uint32_t maxThreadsCount) noexcept;
+
+// Compares amRadixSort (single threaded and parallel) with std::sort and std::stable_sort on 64-bit key + payload pairs, 1k to 1M elements
+void engRunSortKeysBenchmark(uint32_t maxThreadsCount) noexcept;
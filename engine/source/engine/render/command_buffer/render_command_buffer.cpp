@@ -0,0 +1,250 @@
+#include "pch.h"
+#include "render_command_buffer.h"
+
+#include "utils/algorithm/radix_sort.h"
+#include "utils/debug/assertion.h"
+
+#include <cmath>
+
+
+static constexpr size_t AlignCommandSize(size_t size) noexcept
+{
+    return (size + RenderCommandBuffer::COMMAND_ALIGNMENT - 1) & ~(RenderCommandBuffer::COMMAND_ALIGNMENT - 1);
+}
+
+
+static_assert(sizeof(RenderCommandHeader) <= RenderCommandBuffer::COMMAND_ALIGNMENT, "Command header must fit into one alignment slot");
+static_assert(sizeof(RenderDrawIndexedIndirectArgs) == 5 * sizeof(uint32_t), "Indirect args must be tightly packed");
+
+
+uint64_t RenderSortKey::Make(uint32_t pass, PassStage stage, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth) noexcept
+{
+    ENG_ASSERT(pass <= Mask(BITS_PER_PASS), "Sort key pass {} is out of range", pass);
+    ENG_ASSERT(stage <= Mask(BITS_PER_PASS_STAGE), "Sort key pass stage {} is out of range", (uint32_t)stage);
+    ENG_ASSERT(pipeline <= Mask(BITS_PER_PIPELINE), "Sort key pipeline {} is out of range", pipeline);
+    ENG_ASSERT(material <= Mask(BITS_PER_MATERIAL), "Sort key material {} is out of range", material);
+    ENG_ASSERT(mesh <= Mask(BITS_PER_MESH), "Sort key mesh {} is out of range", mesh);
+    ENG_ASSERT(depth <= Mask(BITS_PER_DEPTH), "Sort key depth {} is out of range", depth);
+
+    return ((uint64_t)(pass & Mask(BITS_PER_PASS)) << PASS_SHIFT) |
+        ((uint64_t)(stage & Mask(BITS_PER_PASS_STAGE)) << PASS_STAGE_SHIFT) |
+        ((uint64_t)(pipeline & Mask(BITS_PER_PIPELINE)) << PIPELINE_SHIFT) |
+        ((uint64_t)(material & Mask(BITS_PER_MATERIAL)) << MATERIAL_SHIFT) |
+        ((uint64_t)(mesh & Mask(BITS_PER_MESH)) << MESH_SHIFT) |
+        ((uint64_t)(depth & Mask(BITS_PER_DEPTH)) << DEPTH_SHIFT);
+}
+
+
+uint32_t RenderSortKey::QuantizeDepth(float normalizedDepth) noexcept
+{
+    const float clampedDepth = std::fmin(std::fmax(normalizedDepth, 0.f), 1.f);
+    return static_cast<uint32_t>(clampedDepth * static_cast<float>(Mask(BITS_PER_DEPTH)));
+}
+
+
+void RenderCommandBuffer::MergeSorted(const RenderCommandBuffer* pBuffers, size_t buffersCount, std::vector<RenderCommandPacket>& outPackets) noexcept
+{
+    ENG_ASSERT(pBuffers || buffersCount == 0, "pBuffers is nullptr");
+
+    outPackets.clear();
+
+    size_t packetsCount = 0;
+    for (size_t i = 0; i < buffersCount; ++i) {
+        ENG_ASSERT(!pBuffers[i].IsRecordingPacket(), "Merging command buffer {} while packet is being recorded", i);
+        packetsCount += pBuffers[i].GetPacketsCount();
+    }
+
+    outPackets.reserve(packetsCount);
+
+    // Buffers count is about recording threads count, so linear search of the minimal head is cheaper than a heap
+    std::vector<size_t> heads(buffersCount, 0);
+
+    while (outPackets.size() < packetsCount) {
+        size_t minBufferIdx = buffersCount;
+        uint64_t minKey = 0;
+
+        for (size_t i = 0; i < buffersCount; ++i) {
+            const std::vector<RenderCommandPacket>& packets = pBuffers[i].GetPackets();
+            
+            if (heads[i] < packets.size() && (minBufferIdx == buffersCount || packets[heads[i]].sortKey < minKey)) {
+                minBufferIdx = i;
+                minKey = packets[heads[i]].sortKey;
+            }
+        }
+
+        outPackets.emplace_back(pBuffers[minBufferIdx].GetPackets()[heads[minBufferIdx]++]);
+    }
+}
+
+
+void RenderCommandBuffer::Reserve(size_t packetsCount) noexcept
+{
+    m_packets.reserve(packetsCount);
+}
+
+
+void RenderCommandBuffer::Clear() noexcept
+{
+    ENG_ASSERT(!m_isRecordingPacket, "Clearing command buffer while packet is being recorded");
+
+    m_packets.clear();
+    m_commandsAllocator.Reset();
+    
+    m_pPacketBegin = nullptr;
+    m_pCommandsCursor = nullptr;
+    m_pCommandsChunkEnd = nullptr;
+
+    m_commandsCount = 0;
+}
+
+
+void RenderCommandBuffer::BeginPacket(uint64_t sortKey) noexcept
+{
+    ENG_ASSERT(!m_isRecordingPacket, "Previous packet was not ended");
+
+    RenderCommandPacket packet = {};
+    packet.sortKey = sortKey;
+
+    m_packets.emplace_back(packet);
+
+    m_pPacketBegin = m_pCommandsCursor;
+
+    m_isRecordingPacket = true;
+}
+
+
+void RenderCommandBuffer::EndPacket() noexcept
+{
+    ENG_ASSERT(m_isRecordingPacket, "Packet was not begun");
+
+    RenderCommandPacket& packet = m_packets.back();
+    packet.pCommands = m_pPacketBegin;
+    packet.commandsSize = static_cast<uint32_t>(m_pCommandsCursor - m_pPacketBegin);
+
+    m_isRecordingPacket = false;
+}
+
+
+void RenderCommandBuffer::BeginRenderPass(Pipeline* pPipeline) noexcept
+{
+    ENG_ASSERT(pPipeline, "pPipeline is nullptr");
+    PushCommand(RenderCommandType::BEGIN_RENDER_PASS, RenderCmdBeginRenderPass { pPipeline });
+}
+
+
+void RenderCommandBuffer::EndRenderPass(Pipeline* pPipeline) noexcept
+{
+    ENG_ASSERT(pPipeline, "pPipeline is nullptr");
+    PushCommand(RenderCommandType::END_RENDER_PASS, RenderCmdEndRenderPass { pPipeline });
+}
+
+
+void RenderCommandBuffer::BindPipeline(Pipeline* pPipeline) noexcept
+{
+    ENG_ASSERT(pPipeline, "pPipeline is nullptr");
+    PushCommand(RenderCommandType::BIND_PIPELINE, RenderCmdBindPipeline { pPipeline });
+}
+
+
+void RenderCommandBuffer::BindTexture(uint32_t unit, Texture* pTexture, TextureSamplerState* pSampler) noexcept
+{
+    ENG_ASSERT(pTexture, "pTexture is nullptr");
+    PushCommand(RenderCommandType::BIND_TEXTURE, RenderCmdBindTexture { pTexture, pSampler, unit });
+}
+
+
+void RenderCommandBuffer::BindConstBuffer(uint32_t binding, MemoryBuffer* pBuffer, uint64_t offset, uint64_t size) noexcept
+{
+    ENG_ASSERT(pBuffer, "pBuffer is nullptr");
+    ENG_ASSERT(size > 0 || offset == 0, "Whole buffer binding can't have offset");
+    PushCommand(RenderCommandType::BIND_CONST_BUFFER, RenderCmdBindConstBuffer { pBuffer, offset, size, binding });
+}
+
+
+void RenderCommandBuffer::Draw(const MeshObj* pMesh, uint32_t vertexCount, uint32_t firstVertex, uint32_t instanceCount, uint32_t baseInstance) noexcept
+{
+    PushCommand(RenderCommandType::DRAW, RenderCmdDraw { pMesh, vertexCount, firstVertex, instanceCount, baseInstance });
+}
+
+
+void RenderCommandBuffer::DrawIndexed(const MeshObj* pMesh, uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, uint32_t instanceCount, uint32_t baseInstance) noexcept
+{
+    ENG_ASSERT(pMesh, "pMesh is nullptr");
+    PushCommand(RenderCommandType::DRAW_INDEXED, RenderCmdDrawIndexed { pMesh, indexCount, firstIndex, baseVertex, instanceCount, baseInstance });
+}
+
+
+void RenderCommandBuffer::DrawIndexedIndirect(const MeshObj* pMesh, MemoryBuffer* pArgsBuffer, uint64_t argsOffset, uint32_t drawCount) noexcept
+{
+    ENG_ASSERT(pMesh, "pMesh is nullptr");
+    ENG_ASSERT(pArgsBuffer, "pArgsBuffer is nullptr");
+    ENG_ASSERT(argsOffset % sizeof(uint32_t) == 0, "Indirect args offset must be 4 bytes aligned");
+
+    PushCommand(RenderCommandType::DRAW_INDEXED_INDIRECT, RenderCmdDrawIndexedIndirect { pMesh, pArgsBuffer, argsOffset, drawCount });
+}
+
+
+void RenderCommandBuffer::Dispatch(uint32_t groupsCountX, uint32_t groupsCountY, uint32_t groupsCountZ) noexcept
+{
+    PushCommand(RenderCommandType::DISPATCH, RenderCmdDispatch { groupsCountX, groupsCountY, groupsCountZ });
+}
+
+
+void RenderCommandBuffer::Sort(WorkerThreadPool* pWorkers) noexcept
+{
+    ENG_ASSERT(!m_isRecordingPacket, "Sorting command buffer while packet is being recorded");
+
+    m_sortScratch.resize(m_packets.size());
+
+    amRadixSort(m_packets.data(), m_sortScratch.data(), m_packets.size(), 
+        [](const RenderCommandPacket& packet) { return packet.sortKey; }, pWorkers);
+}
+
+
+template <typename CommandType>
+void RenderCommandBuffer::PushCommand(RenderCommandType type, const CommandType& command) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<CommandType>, "Render commands must be PODs");
+    static_assert(alignof(CommandType) <= COMMAND_ALIGNMENT, "Render command alignment is too strict");
+
+    ENG_ASSERT(m_isRecordingPacket, "Commands must be recorded between BeginPacket and EndPacket");
+
+    constexpr size_t headerSize = AlignCommandSize(sizeof(RenderCommandHeader));
+    constexpr size_t payloadSize = AlignCommandSize(sizeof(CommandType));
+
+    static_assert(payloadSize <= std::numeric_limits<uint16_t>::max(), "Render command is too big");
+
+    constexpr size_t commandSize = headerSize + payloadSize;
+
+    if (m_pCommandsCursor == nullptr || m_pCommandsCursor + commandSize > m_pCommandsChunkEnd) {
+        AllocateCommandsChunk(commandSize);
+    }
+
+    RenderCommandHeader header = {};
+    header.type = type;
+    header.size = static_cast<uint16_t>(payloadSize);
+
+    memcpy(m_pCommandsCursor, &header, sizeof(header));
+    memcpy(m_pCommandsCursor + headerSize, &command, sizeof(command));
+
+    m_pCommandsCursor += commandSize;
+    ++m_commandsCount;
+}
+
+
+void RenderCommandBuffer::AllocateCommandsChunk(size_t requiredSize) noexcept
+{
+    const size_t packetSize = static_cast<size_t>(m_pCommandsCursor - m_pPacketBegin);
+    const size_t chunkSize = std::max(COMMANDS_CHUNK_SIZE, packetSize + requiredSize);
+
+    uint8_t* pChunk = static_cast<uint8_t*>(m_commandsAllocator.Allocate(chunkSize, COMMAND_ALIGNMENT));
+    ENG_ASSERT(pChunk, "Failed to allocate commands chunk");
+
+    if (packetSize > 0) {
+        memcpy(pChunk, m_pPacketBegin, packetSize);
+    }
+
+    m_pPacketBegin = pChunk;
+    m_pCommandsCursor = pChunk + packetSize;
+    m_pCommandsChunkEnd = pChunk + chunkSize;
+}
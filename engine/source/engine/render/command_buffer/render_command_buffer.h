@@ -0,0 +1,250 @@
+#pragma once
+
+#include "core.h"
+
+#include "utils/memory/linear_allocator.h"
+#include "utils/thread/worker_pool.h"
+
+#include <vector>
+
+
+class Pipeline;
+class Texture;
+class TextureSamplerState;
+class MemoryBuffer;
+class MeshObj;
+
+
+// Packed 64-bit sort key. Higher fields have higher sorting priority:
+// | pass (6) | pass stage (2) | pipeline (12) | material (14) | mesh (14) | depth (16) |
+struct RenderSortKey
+{
+    static inline constexpr uint32_t BITS_PER_PASS = 6;
+    static inline constexpr uint32_t BITS_PER_PASS_STAGE = 2;
+    static inline constexpr uint32_t BITS_PER_PIPELINE = 12;
+    static inline constexpr uint32_t BITS_PER_MATERIAL = 14;
+    static inline constexpr uint32_t BITS_PER_MESH = 14;
+    static inline constexpr uint32_t BITS_PER_DEPTH = 16;
+
+    static inline constexpr uint32_t DEPTH_SHIFT = 0;
+    static inline constexpr uint32_t MESH_SHIFT = DEPTH_SHIFT + BITS_PER_DEPTH;
+    static inline constexpr uint32_t MATERIAL_SHIFT = MESH_SHIFT + BITS_PER_MESH;
+    static inline constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + BITS_PER_MATERIAL;
+    static inline constexpr uint32_t PASS_STAGE_SHIFT = PIPELINE_SHIFT + BITS_PER_PIPELINE;
+    static inline constexpr uint32_t PASS_SHIFT = PASS_STAGE_SHIFT + BITS_PER_PASS_STAGE;
+
+    static_assert(PASS_SHIFT + BITS_PER_PASS == 64, "Sort key fields must cover exactly 64 bits");
+
+    // Commands of the same pass are ordered by stage first, so clears always go before draws
+    enum PassStage : uint32_t
+    {
+        PASS_STAGE_BEGIN,
+        PASS_STAGE_DRAW,
+        PASS_STAGE_END,
+    };
+
+    static constexpr uint64_t Mask(uint32_t bitsCount) noexcept { return (1ull << bitsCount) - 1ull; }
+
+    static uint64_t Make(uint32_t pass, PassStage stage, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth) noexcept;
+
+    // Quantizes normalized [0, 1] depth. Use (1 - depth) to get back to front order
+    static uint32_t QuantizeDepth(float normalizedDepth) noexcept;
+
+    static uint32_t GetPass(uint64_t key) noexcept { return static_cast<uint32_t>((key >> PASS_SHIFT) & Mask(BITS_PER_PASS)); }
+    static uint32_t GetPipeline(uint64_t key) noexcept { return static_cast<uint32_t>((key >> PIPELINE_SHIFT) & Mask(BITS_PER_PIPELINE)); }
+};
+
+
+enum class RenderCommandType : uint8_t
+{
+    BEGIN_RENDER_PASS,
+    END_RENDER_PASS,
+    BIND_PIPELINE,
+    BIND_TEXTURE,
+    BIND_CONST_BUFFER,
+    DRAW,
+    DRAW_INDEXED,
+    DRAW_INDEXED_INDIRECT,
+    DISPATCH,
+
+    COUNT
+};
+
+
+struct RenderCommandHeader
+{
+    RenderCommandType type;
+    uint16_t          size; // Size of the command payload following the header (including alignment padding)
+};
+
+
+// Commands are PODs referencing engine objects, so they can be recorded without graphics context
+struct RenderCmdBeginRenderPass
+{
+    Pipeline* pPipeline;
+};
+
+
+struct RenderCmdEndRenderPass
+{
+    Pipeline* pPipeline;
+};
+
+
+struct RenderCmdBindPipeline
+{
+    Pipeline* pPipeline;
+};
+
+
+struct RenderCmdBindTexture
+{
+    Texture*             pTexture;
+    TextureSamplerState* pSampler;
+    uint32_t             unit;
+};
+
+
+struct RenderCmdBindConstBuffer
+{
+    MemoryBuffer* pBuffer;
+    uint64_t      offset;
+    uint64_t      size; // 0 binds the whole buffer
+    uint32_t      binding;
+};
+
+
+struct RenderCmdDraw
+{
+    const MeshObj* pMesh; // nullptr keeps the currently bound vertex array
+    uint32_t       vertexCount;
+    uint32_t       firstVertex;
+    uint32_t       instanceCount;
+    uint32_t       baseInstance;
+};
+
+
+struct RenderCmdDrawIndexed
+{
+    const MeshObj* pMesh;
+    uint32_t       indexCount;
+    uint32_t       firstIndex;
+    int32_t        baseVertex;
+    uint32_t       instanceCount;
+    uint32_t       baseInstance;
+};
+
+
+// Layout of one indexed indirect draw record in indirect args buffers
+struct RenderDrawIndexedIndirectArgs
+{
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t  baseVertex;
+    uint32_t baseInstance;
+};
+
+
+// Submits drawCount consecutive RenderDrawIndexedIndirectArgs records at once. All of them use vertex arrays of pMesh
+struct RenderCmdDrawIndexedIndirect
+{
+    const MeshObj* pMesh;
+    MemoryBuffer*  pArgsBuffer;
+    uint64_t       argsOffset;
+    uint32_t       drawCount;
+};
+
+
+struct RenderCmdDispatch
+{
+    uint32_t groupsCountX;
+    uint32_t groupsCountY;
+    uint32_t groupsCountZ;
+};
+
+
+// Sortable range of commands. Commands of one packet are always executed together in recording order
+struct RenderCommandPacket
+{
+    uint64_t       sortKey;
+    const uint8_t* pCommands;
+    uint32_t       commandsSize;
+};
+
+
+// Backend agnostic list of render commands. Recording doesn't touch graphics API,
+// execution is done by a backend (see engOpenGLExecuteCommandBuffer).
+// Each recording thread must use its own command buffer, sorted buffers are combined with MergeSorted
+class RenderCommandBuffer
+{
+public:
+    static inline constexpr size_t COMMAND_ALIGNMENT = alignof(void*);
+    static inline constexpr size_t COMMANDS_CHUNK_SIZE = 4 * 1024;
+
+public:
+    // Merges packets of already sorted command buffers. Packets with equal keys are ordered by buffer index
+    static void MergeSorted(const RenderCommandBuffer* pBuffers, size_t buffersCount, std::vector<RenderCommandPacket>& outPackets) noexcept;
+
+public:
+    RenderCommandBuffer() = default;
+
+    RenderCommandBuffer(const RenderCommandBuffer& other) = delete;
+    RenderCommandBuffer& operator=(const RenderCommandBuffer& other) = delete;
+    RenderCommandBuffer(RenderCommandBuffer&& other) noexcept = default;
+    RenderCommandBuffer& operator=(RenderCommandBuffer&& other) noexcept = default;
+
+    void Reserve(size_t packetsCount) noexcept;
+
+    // Keeps allocated storage. Invalidates packets of the buffer merged before
+    void Clear() noexcept;
+
+    void BeginPacket(uint64_t sortKey) noexcept;
+    void EndPacket() noexcept;
+
+    // Apply the pipeline frame buffer attachments load and store ops
+    void BeginRenderPass(Pipeline* pPipeline) noexcept;
+    void EndRenderPass(Pipeline* pPipeline) noexcept;
+
+    void BindPipeline(Pipeline* pPipeline) noexcept;
+    void BindTexture(uint32_t unit, Texture* pTexture, TextureSamplerState* pSampler) noexcept;
+    void BindConstBuffer(uint32_t binding, MemoryBuffer* pBuffer, uint64_t offset = 0, uint64_t size = 0) noexcept;
+
+    void Draw(const MeshObj* pMesh, uint32_t vertexCount, uint32_t firstVertex, uint32_t instanceCount, uint32_t baseInstance = 0) noexcept;
+    void DrawIndexed(const MeshObj* pMesh, uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, uint32_t instanceCount, uint32_t baseInstance = 0) noexcept;
+    void DrawIndexedIndirect(const MeshObj* pMesh, MemoryBuffer* pArgsBuffer, uint64_t argsOffset, uint32_t drawCount) noexcept;
+    void Dispatch(uint32_t groupsCountX, uint32_t groupsCountY, uint32_t groupsCountZ) noexcept;
+
+    // Stable radix sort of packets by their keys. Pass is the major key field, so packets end up grouped per pass
+    void Sort(WorkerThreadPool* pWorkers = nullptr) noexcept;
+
+    const std::vector<RenderCommandPacket>& GetPackets() const noexcept { return m_packets; }
+
+    size_t GetPacketsCount() const noexcept { return m_packets.size(); }
+    size_t GetCommandsCount() const noexcept { return m_commandsCount; }
+    size_t GetCommandsMemorySize() const noexcept { return m_commandsAllocator.GetAllocatedSize(); }
+
+    bool IsEmpty() const noexcept { return m_packets.empty(); }
+    bool IsRecordingPacket() const noexcept { return m_isRecordingPacket; }
+
+private:
+    template <typename CommandType>
+    void PushCommand(RenderCommandType type, const CommandType& command) noexcept;
+
+    // Packet commands must stay contiguous, so the recorded part of the current packet is moved to the new chunk
+    void AllocateCommandsChunk(size_t requiredSize) noexcept;
+
+private:
+    std::vector<RenderCommandPacket> m_packets;
+    std::vector<RenderCommandPacket> m_sortScratch;
+
+    LinearAllocator m_commandsAllocator;
+
+    uint8_t* m_pPacketBegin = nullptr;
+    uint8_t* m_pCommandsCursor = nullptr;
+    uint8_t* m_pCommandsChunkEnd = nullptr;
+
+    size_t m_commandsCount = 0;
+
+    bool m_isRecordingPacket = false;
+};
@@ -0,0 +1,424 @@
+#include "pch.h"
+#include "frame_graph.h"
+
+#include "utils/debug/assertion.h"
+
+
+static constexpr uint32_t INVALID_PASS_IDX = UINT32_MAX;
+
+
+FrameGraphTextureHandle FrameGraphPassBuilder::CreateTexture(ds::StrID name, const RTTextureDesc& desc) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(desc.width > 0 && desc.height > 0, "Invalid frame graph texture \'{}\' size: {}x{}", name.CStr(), desc.width, desc.height);
+
+    FrameGraph::TextureResource texture = {};
+    texture.name = name;
+    texture.desc = desc;
+    texture.pTexture = nullptr;
+    texture.readersCount = 0;
+    texture.firstPassIdx = INVALID_PASS_IDX;
+    texture.lastPassIdx = 0;
+    texture.isImported = false;
+
+    m_pGraph->m_textures.emplace_back(std::move(texture));
+
+    return FrameGraphTextureHandle { static_cast<uint32_t>(m_pGraph->m_textures.size() - 1) };
+}
+
+
+FrameGraphTextureHandle FrameGraphPassBuilder::Read(FrameGraphTextureHandle texture) noexcept
+{
+    FrameGraph::TextureResource& resource = m_pGraph->GetTextureResource(texture);
+    FrameGraph::Pass& pass = m_pGraph->m_passes[m_passIdx];
+
+    if (std::find(pass.readTextures.cbegin(), pass.readTextures.cend(), texture.index) == pass.readTextures.cend()) {
+        pass.readTextures.emplace_back(texture.index);
+        ++resource.readersCount;
+    }
+
+    m_pGraph->AddPassTexture(m_passIdx, texture.index);
+
+    return texture;
+}
+
+
+FrameGraphTextureHandle FrameGraphPassBuilder::Write(FrameGraphTextureHandle texture) noexcept
+{
+    FrameGraph::TextureResource& resource = m_pGraph->GetTextureResource(texture);
+    FrameGraph::Pass& pass = m_pGraph->m_passes[m_passIdx];
+
+    if (std::find(pass.writeTextures.cbegin(), pass.writeTextures.cend(), texture.index) == pass.writeTextures.cend()) {
+        pass.writeTextures.emplace_back(texture.index);
+        resource.writerPasses.emplace_back(m_passIdx);
+    }
+
+    // Results of passes writing imported textures are consumed outside of the graph
+    pass.hasSideEffects |= resource.isImported;
+
+    m_pGraph->AddPassTexture(m_passIdx, texture.index);
+
+    return texture;
+}
+
+
+FrameGraphTextureHandle FrameGraphPassBuilder::WriteColorAttachment(FrameGraphTextureHandle texture, uint32_t index) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(index < FrameBuffer::GetMaxColorAttachmentsCount(), "Invalid color attachment index: {}", index);
+
+    FrameGraph::Pass& pass = m_pGraph->m_passes[m_passIdx];
+
+    pass.attachments.emplace_back(FrameBufferAttachment { nullptr, FrameBufferAttachmentType::COLOR_ATTACHMENT, index });
+    pass.attachmentTextures.emplace_back(texture.index);
+
+    return Write(texture);
+}
+
+
+FrameGraphTextureHandle FrameGraphPassBuilder::WriteDepthAttachment(FrameGraphTextureHandle texture) noexcept
+{
+    FrameGraph::Pass& pass = m_pGraph->m_passes[m_passIdx];
+
+    pass.attachments.emplace_back(FrameBufferAttachment { nullptr, FrameBufferAttachmentType::DEPTH_ATTACHMENT, 0 });
+    pass.attachmentTextures.emplace_back(texture.index);
+
+    return Write(texture);
+}
+
+
+void FrameGraphPassBuilder::SetFrameBuffer(RTFrameBufferID frameBufferID) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(frameBufferID < RTFrameBufferID::COUNT, "Invalid frame buffer ID");
+    m_pGraph->m_passes[m_passIdx].frameBufferID = frameBufferID;
+}
+
+
+FrameGraph::~FrameGraph()
+{
+    Reset();
+}
+
+
+void FrameGraph::Reset() noexcept
+{
+    if (!m_pooledTextures.empty()) {
+        RenderTargetManager& rtManager = RenderTargetManager::GetInstance();
+
+        for (Texture* pTexture : m_pooledTextures) {
+            rtManager.ReleasePooledTexture(pTexture);
+        }
+
+        m_pooledTextures.clear();
+    }
+
+    m_textures.clear();
+    m_passes.clear();
+
+    m_statistics = {};
+
+    m_isCompiled = false;
+}
+
+
+FrameGraphTextureHandle FrameGraph::ImportTexture(ds::StrID name, Texture* pTexture) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(!m_isCompiled, "Attempt to import \'{}\' texture into compiled frame graph", name.CStr());
+
+    TextureResource texture = {};
+    texture.name = name;
+    texture.desc = {};
+    texture.pTexture = pTexture;
+    texture.readersCount = 0;
+    texture.firstPassIdx = INVALID_PASS_IDX;
+    texture.lastPassIdx = 0;
+    texture.isImported = true;
+
+    m_textures.emplace_back(std::move(texture));
+
+    return FrameGraphTextureHandle { static_cast<uint32_t>(m_textures.size() - 1) };
+}
+
+
+void FrameGraph::AddPass(ds::StrID name, const SetupFunc& setup, ExecuteFunc&& execute) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(!m_isCompiled, "Attempt to add \'{}\' pass into compiled frame graph", name.CStr());
+
+    Pass pass = {};
+    pass.name = name;
+    pass.execute = std::move(execute);
+    pass.frameBufferID = RTFrameBufferID::INVALID;
+    pass.producedCount = 0;
+    pass.hasSideEffects = false;
+    pass.isCulled = false;
+
+    m_passes.emplace_back(std::move(pass));
+
+    FrameGraphPassBuilder builder(this, static_cast<uint32_t>(m_passes.size() - 1));
+    setup(builder);
+}
+
+
+void FrameGraph::Compile() noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(!m_isCompiled, "Frame graph is already compiled");
+
+    CullPasses();
+    ComputeLifetimes();
+    AliasTransientTextures();
+    PrepareFrameBuffers();
+    PrepareInvalidations();
+
+    m_isCompiled = true;
+
+    ENG_LOG_INFO("Frame graph: {}/{} passes culled, {} transient textures aliased onto {}, render targets memory {} MB -> {} MB, {} attachments discarded",
+        m_statistics.culledPassesCount, m_statistics.passesCount, m_statistics.transientTexturesCount, m_statistics.pooledTexturesCount,
+        m_statistics.rtMemorySize / (1024.f * 1024.f), m_statistics.aliasedRTMemorySize / (1024.f * 1024.f), m_statistics.discardedAttachmentsCount);
+}
+
+
+void FrameGraph::Execute() noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(m_isCompiled, "Frame graph is not compiled");
+
+    RenderTargetManager& rtManager = RenderTargetManager::GetInstance();
+
+    for (Pass& pass : m_passes) {
+        if (pass.isCulled) {
+            continue;
+        }
+
+        pass.execute();
+
+        for (const FrameBufferInvalidation& invalidation : pass.invalidations) {
+            rtManager.GetFrameBuffer(invalidation.frameBufferID)->Invalidate(invalidation.colorAttachmentsMask, invalidation.invalidateDepthStencil);
+        }
+    }
+}
+
+
+Texture* FrameGraph::GetTexture(FrameGraphTextureHandle texture) const noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(m_isCompiled, "Frame graph is not compiled");
+    ENG_ASSERT_GRAPHICS_API(texture.index < m_textures.size(), "Invalid frame graph texture handle");
+
+    const TextureResource& resource = m_textures[texture.index];
+    ENG_ASSERT_GRAPHICS_API(resource.pTexture || resource.isImported, "Frame graph texture \'{}\' isn't used by any pass", resource.name.CStr());
+
+    return resource.pTexture;
+}
+
+
+// Reference counting from the graph outputs: pass is culled once nothing reads textures it writes
+void FrameGraph::CullPasses() noexcept
+{
+    std::vector<uint32_t> refCounts(m_textures.size());
+    std::vector<uint32_t> unreferencedTextures;
+
+    for (size_t i = 0; i < m_textures.size(); ++i) {
+        refCounts[i] = m_textures[i].readersCount;
+    }
+
+    const auto cullPass = [&](Pass& pass) {
+        pass.isCulled = true;
+
+        for (uint32_t textureIdx : pass.readTextures) {
+            if (--refCounts[textureIdx] == 0) {
+                unreferencedTextures.emplace_back(textureIdx);
+            }
+        }
+    };
+
+    for (size_t i = 0; i < m_textures.size(); ++i) {
+        if (refCounts[i] == 0 && !m_textures[i].isImported) {
+            unreferencedTextures.emplace_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    for (Pass& pass : m_passes) {
+        pass.producedCount = static_cast<uint32_t>(pass.writeTextures.size());
+
+        if (pass.producedCount == 0 && !pass.hasSideEffects) {
+            cullPass(pass);
+        }
+    }
+
+    while (!unreferencedTextures.empty()) {
+        const uint32_t textureIdx = unreferencedTextures.back();
+        unreferencedTextures.pop_back();
+
+        if (m_textures[textureIdx].isImported) {
+            continue;
+        }
+
+        for (uint32_t passIdx : m_textures[textureIdx].writerPasses) {
+            Pass& pass = m_passes[passIdx];
+
+            if (pass.isCulled || pass.hasSideEffects) {
+                continue;
+            }
+
+            if (--pass.producedCount == 0) {
+                cullPass(pass);
+            }
+        }
+    }
+
+    m_statistics.passesCount = static_cast<uint32_t>(m_passes.size());
+    m_statistics.culledPassesCount = static_cast<uint32_t>(std::count_if(m_passes.cbegin(), m_passes.cend(),
+        [](const Pass& pass) { return pass.isCulled; }));
+}
+
+
+void FrameGraph::ComputeLifetimes() noexcept
+{
+    for (uint32_t passIdx = 0; passIdx < m_passes.size(); ++passIdx) {
+        const Pass& pass = m_passes[passIdx];
+
+        if (pass.isCulled) {
+            continue;
+        }
+
+        for (uint32_t textureIdx : pass.textures) {
+            TextureResource& texture = m_textures[textureIdx];
+
+            texture.firstPassIdx = std::min(texture.firstPassIdx, passIdx);
+            texture.lastPassIdx = std::max(texture.lastPassIdx, passIdx);
+        }
+    }
+}
+
+
+// Passes are executed in order, so textures whose lifetime ended are handed over to textures starting their lifetime later.
+// Textures are matched by their pooled descriptions, so textures of the same size bucket are aliased as well
+void FrameGraph::AliasTransientTextures() noexcept
+{
+    RenderTargetManager& rtManager = RenderTargetManager::GetInstance();
+
+    struct FreeTexture
+    {
+        Texture*      pTexture;
+        RTTextureDesc desc;
+    };
+
+    std::vector<FreeTexture> freeTextures;
+
+    for (uint32_t passIdx = 0; passIdx < m_passes.size(); ++passIdx) {
+        const Pass& pass = m_passes[passIdx];
+
+        if (pass.isCulled) {
+            continue;
+        }
+
+        for (uint32_t textureIdx : pass.textures) {
+            TextureResource& texture = m_textures[textureIdx];
+
+            if (texture.isImported || texture.firstPassIdx != passIdx) {
+                continue;
+            }
+
+            const RTTextureDesc pooledDesc = rtManager.GetPooledTextureDesc(texture.desc);
+
+            auto freeTexIt = std::find_if(freeTextures.begin(), freeTextures.end(),
+                [&pooledDesc](const FreeTexture& freeTex) { return freeTex.desc == pooledDesc; });
+
+            if (freeTexIt != freeTextures.end()) {
+                texture.pTexture = freeTexIt->pTexture;
+                freeTextures.erase(freeTexIt);
+            } else {
+                texture.pTexture = rtManager.AcquirePooledTexture(texture.desc);
+                m_pooledTextures.emplace_back(texture.pTexture);
+
+                m_statistics.aliasedRTMemorySize += engGetTextureMemorySize(pooledDesc.format, pooledDesc.width, pooledDesc.height);
+            }
+
+            m_statistics.rtMemorySize += engGetTextureMemorySize(pooledDesc.format, pooledDesc.width, pooledDesc.height);
+            ++m_statistics.transientTexturesCount;
+        }
+
+        for (uint32_t textureIdx : pass.textures) {
+            const TextureResource& texture = m_textures[textureIdx];
+
+            if (!texture.isImported && texture.lastPassIdx == passIdx) {
+                freeTextures.emplace_back(FreeTexture { texture.pTexture, rtManager.GetPooledTextureDesc(texture.desc) });
+            }
+        }
+    }
+
+    m_statistics.pooledTexturesCount = static_cast<uint32_t>(m_pooledTextures.size());
+}
+
+
+void FrameGraph::PrepareFrameBuffers() noexcept
+{
+    RenderTargetManager& rtManager = RenderTargetManager::GetInstance();
+
+    for (Pass& pass : m_passes) {
+        if (pass.isCulled || pass.frameBufferID == RTFrameBufferID::INVALID) {
+            continue;
+        }
+
+        for (size_t i = 0; i < pass.attachments.size(); ++i) {
+            const TextureResource& texture = m_textures[pass.attachmentTextures[i]];
+            ENG_ASSERT_GRAPHICS_API(texture.pTexture, "Texture \'{}\' can't be attachment of \'{}\' pass frame buffer",
+                texture.name.CStr(), pass.name.CStr());
+
+            pass.attachments[i].pTexure = texture.pTexture;
+        }
+
+        rtManager.SetFrameBufferAttachments(pass.frameBufferID, pass.attachments.data(), static_cast<uint32_t>(pass.attachments.size()), pass.name);
+    }
+}
+
+
+// Transient attachment is invalidated through the frame buffer it was written to, after the last pass which uses it
+void FrameGraph::PrepareInvalidations() noexcept
+{
+    for (const Pass& pass : m_passes) {
+        if (pass.isCulled || pass.frameBufferID == RTFrameBufferID::INVALID) {
+            continue;
+        }
+
+        for (size_t i = 0; i < pass.attachments.size(); ++i) {
+            const TextureResource& texture = m_textures[pass.attachmentTextures[i]];
+
+            if (texture.isImported) {
+                continue;
+            }
+
+            std::vector<FrameBufferInvalidation>& invalidations = m_passes[texture.lastPassIdx].invalidations;
+
+            auto invalidationIt = std::find_if(invalidations.begin(), invalidations.end(),
+                [&pass](const FrameBufferInvalidation& invalidation) { return invalidation.frameBufferID == pass.frameBufferID; });
+
+            if (invalidationIt == invalidations.end()) {
+                invalidationIt = invalidations.emplace(invalidations.end(), FrameBufferInvalidation { pass.frameBufferID, 0, false });
+            }
+
+            const FrameBufferAttachment& attachment = pass.attachments[i];
+
+            if (attachment.type == FrameBufferAttachmentType::COLOR_ATTACHMENT) {
+                invalidationIt->colorAttachmentsMask |= 1u << attachment.index;
+            } else {
+                invalidationIt->invalidateDepthStencil = true;
+            }
+
+            ++m_statistics.discardedAttachmentsCount;
+        }
+    }
+}
+
+
+FrameGraph::TextureResource& FrameGraph::GetTextureResource(FrameGraphTextureHandle texture) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(texture.index < m_textures.size(), "Invalid frame graph texture handle");
+    return m_textures[texture.index];
+}
+
+
+void FrameGraph::AddPassTexture(uint32_t passIdx, uint32_t textureIdx) noexcept
+{
+    std::vector<uint32_t>& textures = m_passes[passIdx].textures;
+
+    if (std::find(textures.cbegin(), textures.cend(), textureIdx) == textures.cend()) {
+        textures.emplace_back(textureIdx);
+    }
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "render/rt_manager/rt_manager.h"
+
+#include <functional>
+#include <vector>
+
+
+struct FrameGraphTextureHandle
+{
+    static inline constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index = INVALID_INDEX;
+
+    bool IsValid() const noexcept { return index != INVALID_INDEX; }
+};
+
+
+struct FrameGraphStatistics
+{
+    uint32_t passesCount;
+    uint32_t culledPassesCount;
+
+    uint32_t transientTexturesCount;
+    uint32_t pooledTexturesCount;  // Textures transient ones were aliased onto
+
+    // Render targets memory if each transient texture had its own storage and after aliasing
+    uint64_t rtMemorySize;
+    uint64_t aliasedRTMemorySize;
+
+    // Attachments invalidated after the last pass using their textures
+    uint32_t discardedAttachmentsCount;
+};
+
+
+class FrameGraph;
+
+
+// Declares pass resources accesses. Valid only inside of the pass setup function
+class FrameGraphPassBuilder
+{
+    friend class FrameGraph;
+
+public:
+    FrameGraphTextureHandle CreateTexture(ds::StrID name, const RTTextureDesc& desc) noexcept;
+
+    FrameGraphTextureHandle Read(FrameGraphTextureHandle texture) noexcept;
+    FrameGraphTextureHandle Write(FrameGraphTextureHandle texture) noexcept;
+
+    // Attachment writes define attachments of the pass frame buffer
+    FrameGraphTextureHandle WriteColorAttachment(FrameGraphTextureHandle texture, uint32_t index) noexcept;
+    FrameGraphTextureHandle WriteDepthAttachment(FrameGraphTextureHandle texture) noexcept;
+
+    void SetFrameBuffer(RTFrameBufferID frameBufferID) noexcept;
+
+private:
+    FrameGraphPassBuilder(FrameGraph* pGraph, uint32_t passIdx) noexcept
+        : m_pGraph(pGraph), m_passIdx(passIdx) {}
+
+private:
+    FrameGraph* m_pGraph;
+    uint32_t m_passIdx;
+};
+
+
+// Passes declare textures they read and write. Compile culls passes whose results are never consumed, computes
+// transient textures lifetimes and aliases textures with non overlapping lifetimes onto the same pooled textures.
+// Graph is built once and recompiled only when its passes or textures descriptions change, e.g. on resize.
+// Aliased texture content is undefined at the first write, so transient textures must be fully overwritten or cleared by their first writer.
+// Transient attachments are invalidated once their last pass is executed, so their contents are never written back to memory.
+// Must be used only on the thread which owns graphics context
+class FrameGraph
+{
+    friend class FrameGraphPassBuilder;
+
+public:
+    using SetupFunc = std::function<void(FrameGraphPassBuilder& builder)>;
+    using ExecuteFunc = std::function<void()>;
+
+public:
+    FrameGraph() = default;
+    ~FrameGraph();
+
+    FrameGraph(const FrameGraph& other) = delete;
+    FrameGraph& operator=(const FrameGraph& other) = delete;
+
+    // Returns pooled textures and removes all passes and resources
+    void Reset() noexcept;
+
+    // Imported textures are never aliased and passes writing them are never culled.
+    // nullptr stands for the default frame buffer or resources the graph doesn't track, e.g. storage buffers,
+    // whose handles only order passes writing and reading them
+    FrameGraphTextureHandle ImportTexture(ds::StrID name, Texture* pTexture) noexcept;
+
+    // Passes are executed in the order they are added
+    void AddPass(ds::StrID name, const SetupFunc& setup, ExecuteFunc&& execute) noexcept;
+
+    void Compile() noexcept;
+    void Execute() noexcept;
+
+    // Valid after compilation
+    Texture* GetTexture(FrameGraphTextureHandle texture) const noexcept;
+
+    const FrameGraphStatistics& GetStatistics() const noexcept { return m_statistics; }
+
+    bool IsCompiled() const noexcept { return m_isCompiled; }
+
+private:
+    struct TextureResource
+    {
+        ds::StrID     name;
+        RTTextureDesc desc;
+
+        Texture* pTexture;
+
+        std::vector<uint32_t> writerPasses;
+
+        uint32_t readersCount;
+        uint32_t firstPassIdx;
+        uint32_t lastPassIdx;
+
+        bool isImported;
+    };
+
+    struct FrameBufferInvalidation
+    {
+        RTFrameBufferID frameBufferID;
+        uint32_t        colorAttachmentsMask;
+        bool            invalidateDepthStencil;
+    };
+
+    struct Pass
+    {
+        ds::StrID   name;
+        ExecuteFunc execute;
+
+        std::vector<uint32_t> readTextures;
+        std::vector<uint32_t> writeTextures;
+        // Unique textures of both reads and writes
+        std::vector<uint32_t> textures;
+
+        std::vector<FrameBufferAttachment> attachments;
+        std::vector<uint32_t> attachmentTextures;
+        RTFrameBufferID frameBufferID;
+
+        // Attachments whose textures lifetime ends with the pass
+        std::vector<FrameBufferInvalidation> invalidations;
+
+        uint32_t producedCount;
+        bool hasSideEffects;
+        bool isCulled;
+    };
+
+private:
+    void CullPasses() noexcept;
+    void ComputeLifetimes() noexcept;
+    void AliasTransientTextures() noexcept;
+    void PrepareFrameBuffers() noexcept;
+    void PrepareInvalidations() noexcept;
+
+    TextureResource& GetTextureResource(FrameGraphTextureHandle texture) noexcept;
+    void AddPassTexture(uint32_t passIdx, uint32_t textureIdx) noexcept;
+
+private:
+    std::vector<TextureResource> m_textures;
+    std::vector<Pass> m_passes;
+
+    // Acquired from render target manager pool, returned on reset
+    std::vector<Texture*> m_pooledTextures;
+
+    FrameGraphStatistics m_statistics = {};
+
+    bool m_isCompiled = false;
+};
@@ -4,6 +4,7 @@
 #include "utils/debug/assertion.h"
 
 #include "render/platform/OpenGL/opengl_driver.h"
+#include "render/platform/OpenGL/opengl_retire_queue.h"
 
 
 static std::unique_ptr<MemoryBufferManager> pMemoryBufferMngInst = nullptr;
@@ -33,6 +34,8 @@ static GLenum TranslateMemoryBufferTypeToGL(MemoryBufferType type) noexcept
         case MemoryBufferType::TYPE_INDEX_BUFFER:            return GL_ELEMENT_ARRAY_BUFFER;
         case MemoryBufferType::TYPE_CONSTANT_BUFFER:         return GL_UNIFORM_BUFFER;
         case MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER: return GL_SHADER_STORAGE_BUFFER;
+        case MemoryBufferType::TYPE_INDIRECT_ARGS_BUFFER:    return GL_DRAW_INDIRECT_BUFFER;
+        case MemoryBufferType::TYPE_STAGING_BUFFER:          return GL_PIXEL_UNPACK_BUFFER;
         default:
             ENG_ASSERT_FAIL("Invalid memory buffer type");
             return GL_NONE;
@@ -47,6 +50,8 @@ static bool IsBufferIndexedBindable(MemoryBufferType type) noexcept
         case MemoryBufferType::TYPE_INDEX_BUFFER:            return false;
         case MemoryBufferType::TYPE_CONSTANT_BUFFER:         return true;
         case MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER: return true;
+        case MemoryBufferType::TYPE_INDIRECT_ARGS_BUFFER:    return true;
+        case MemoryBufferType::TYPE_STAGING_BUFFER:          return false;
         default:
             ENG_ASSERT_FAIL("Invalid memory buffer type");
             return GL_NONE;
@@ -54,6 +59,13 @@ static bool IsBufferIndexedBindable(MemoryBufferType type) noexcept
 }
 
 
+// Indirect args are bound to storage buffer slots, so that GPU culling can write them
+static GLenum TranslateMemoryBufferTypeToIndexedGL(MemoryBufferType type) noexcept
+{
+    return type == MemoryBufferType::TYPE_INDIRECT_ARGS_BUFFER ? GL_SHADER_STORAGE_BUFFER : TranslateMemoryBufferTypeToGL(type);
+}
+
+
 MemoryBuffer::MemoryBuffer(MemoryBuffer &&other) noexcept
 {
 #if defined(ENG_DEBUG)
@@ -94,6 +106,18 @@ void MemoryBuffer::FillSubdata(size_t offset, size_t size, const void *pData) no
 }
 
 
+void MemoryBuffer::CopySubdata(const MemoryBuffer& srcBuffer, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) noexcept
+{
+    ENG_ASSERT(IsValid(), "Memory buffer '{}' is invalid", m_dbgName.CStr());
+    ENG_ASSERT(srcBuffer.IsValid(), "Source memory buffer '{}' is invalid", srcBuffer.GetDebugName().CStr());
+    ENG_ASSERT(srcOffset + size <= srcBuffer.GetSize() && dstOffset + size <= m_size, 
+        "Copy from '{}' to '{}' memory buffer is out of bounds", srcBuffer.GetDebugName().CStr(), m_dbgName.CStr());
+    
+    glCopyNamedBufferSubData(srcBuffer.m_renderID, m_renderID, static_cast<GLintptr>(srcOffset), static_cast<GLintptr>(dstOffset), 
+        static_cast<GLsizeiptr>(size));
+}
+
+
 void MemoryBuffer::Clear(size_t offset, size_t size, const void *pData) noexcept
 {
     ENG_ASSERT(IsValid(), "Memory buffer \'{}\' is invalid", m_dbgName.CStr());
@@ -112,7 +136,7 @@ void MemoryBuffer::Bind() noexcept
     ENG_ASSERT(IsValid(), "Memory buffer \'{}\' is invalid", m_dbgName.CStr());
 
     const GLenum target = TranslateMemoryBufferTypeToGL(m_type);
-    glBindBuffer(target, m_renderID);
+    engOpenGLBindBuffer(target, m_renderID);
 }
 
 
@@ -121,8 +145,19 @@ void MemoryBuffer::BindIndexed(uint32_t index) noexcept
     ENG_ASSERT(IsValid(), "Memory buffer \'{}\' is invalid", m_dbgName.CStr());
     ENG_ASSERT(IsBufferIndexedBindable(m_type), "Memory buffer \'{}\' is not indexed bindable", m_dbgName.CStr());
 
-    const GLenum target = TranslateMemoryBufferTypeToGL(m_type);
-    glBindBufferBase(target, index, m_renderID);
+    const GLenum target = TranslateMemoryBufferTypeToIndexedGL(m_type);
+    engOpenGLBindBufferBase(target, index, m_renderID);
+}
+
+
+void MemoryBuffer::BindIndexedRange(uint32_t index, uint64_t offset, uint64_t size) noexcept
+{
+    ENG_ASSERT(IsValid(), "Memory buffer \'{}\' is invalid", m_dbgName.CStr());
+    ENG_ASSERT(IsBufferIndexedBindable(m_type), "Memory buffer \'{}\' is not indexed bindable", m_dbgName.CStr());
+    ENG_ASSERT(size > 0 && offset + size <= m_size, "Memory buffer \'{}\' bind range is out of bounds", m_dbgName.CStr());
+
+    const GLenum target = TranslateMemoryBufferTypeToIndexedGL(m_type);
+    engOpenGLBindBufferRange(target, index, m_renderID, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
 }
 
 
@@ -156,6 +191,19 @@ void* MemoryBuffer::MapReadWrite() noexcept
 }
 
 
+void* MemoryBuffer::MapPersistentWrite() noexcept
+{
+    ENG_ASSERT(IsValid(), "Memory buffer \'{}\' is invalid", m_dbgName.CStr());
+    ENG_ASSERT(IsWritable(), "Memory buffer \'{}\' was not created with BUFFER_CREATION_FLAG_WRITABLE flag", m_dbgName.CStr());
+    ENG_ASSERT(IsPersistent(), "Memory buffer \'{}\' was not created with BUFFER_CREATION_FLAG_PERSISTENT flag", m_dbgName.CStr());
+
+    // Without coherent mapping written ranges must be flushed explicitly
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | (IsCoherent() ? GL_MAP_COHERENT_BIT : GL_MAP_FLUSH_EXPLICIT_BIT);
+
+    return glMapNamedBufferRange(m_renderID, 0, static_cast<GLsizeiptr>(m_size), access);
+}
+
+
 bool MemoryBuffer::Unmap() const noexcept
 {
     ENG_ASSERT(IsValid(), "Memory buffer \'{}\' is invalid", m_dbgName.CStr());
@@ -229,7 +277,7 @@ void MemoryBuffer::Destroy() noexcept
         return;
     }
 
-    glDeleteBuffers(1, &m_renderID);
+    engOpenGLRetireObject(OpenGLObjectType::BUFFER, m_renderID);
 
 #if defined(ENG_DEBUG)
     m_dbgName = "";
@@ -346,4 +394,16 @@ void engTerminateMemoryBufferManager() noexcept
 bool engIsMemoryBufferManagerInitialized() noexcept
 {
     return pMemoryBufferMngInst && pMemoryBufferMngInst->IsInitialized();
-}
\ No newline at end of file
+}
+
+
+uint64_t engGetMemoryBufferOffsetAlignment(MemoryBufferType type) noexcept
+{
+    switch (type) {
+        case MemoryBufferType::TYPE_CONSTANT_BUFFER:         return engGetOpenGLUniformBufferOffsetAlignment();
+        case MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER: return engGetOpenGLShaderStorageBufferOffsetAlignment();
+        case MemoryBufferType::TYPE_INDIRECT_ARGS_BUFFER:    return engGetOpenGLShaderStorageBufferOffsetAlignment();
+        case MemoryBufferType::TYPE_STAGING_BUFFER:          return sizeof(uint32_t);
+        default:                                             return 16;
+    }
+}
@@ -14,6 +14,8 @@ enum class MemoryBufferType : uint8_t
     TYPE_INDEX_BUFFER,
     TYPE_CONSTANT_BUFFER,
     TYPE_UNORDERED_ACCESS_BUFFER,
+    TYPE_INDIRECT_ARGS_BUFFER,
+    TYPE_STAGING_BUFFER,        // Source of buffer to buffer copies and texture uploads
 
     TYPE_COUNT,
     TYPE_INVALID,
@@ -64,11 +66,13 @@ public:
     void Destroy() noexcept;
 
     void FillSubdata(size_t offset, size_t size, const void* pData) noexcept;
+    void CopySubdata(const MemoryBuffer& srcBuffer, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) noexcept;
     void Clear(size_t offset, size_t size, const void* pData) noexcept;
     void Clear() noexcept;
 
     void Bind() noexcept;
     void BindIndexed(uint32_t index) noexcept;
+    void BindIndexedRange(uint32_t index, uint64_t offset, uint64_t size) noexcept;
 
     const void* MapRead() noexcept;
     template <typename Type>
@@ -82,6 +86,9 @@ public:
     template <typename Type>
     Type* MapReadWrite() noexcept { return static_cast<Type*>(MapReadWrite()); }
 
+    // Maps the whole buffer for writing while GPU may use it. Stays valid until Unmap or Destroy
+    void* MapPersistentWrite() noexcept;
+
     bool Unmap() const noexcept;
 
     bool IsValid() const noexcept;
@@ -100,6 +107,8 @@ public:
     bool IsIndexBuffer() const noexcept { return m_type == MemoryBufferType::TYPE_INDEX_BUFFER; }
     bool IsConstantBuffer() const noexcept { return m_type == MemoryBufferType::TYPE_CONSTANT_BUFFER; }
     bool IsUnorderedAccessBuffer() const noexcept { return m_type == MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER; }
+    bool IsIndirectArgsBuffer() const noexcept { return m_type == MemoryBufferType::TYPE_INDIRECT_ARGS_BUFFER; }
+    bool IsStagingBuffer() const noexcept { return m_type == MemoryBufferType::TYPE_STAGING_BUFFER; }
 
     MemoryBufferCreationFlags GetCreationFlags() const noexcept { return m_creationFlags; }
     bool IsDynamicStorage() const noexcept { return m_creationFlags & BUFFER_CREATION_FLAG_DYNAMIC_STORAGE; }
@@ -163,4 +172,13 @@ private:
 
 bool engInitMemoryBufferManager() noexcept;
 void engTerminateMemoryBufferManager() noexcept;
-bool engIsMemoryBufferManagerInitialized() noexcept;
\ No newline at end of file
+bool engIsMemoryBufferManagerInitialized() noexcept;
+
+// Required alignment of offsets buffers of this type are bound or sourced at
+uint64_t engGetMemoryBufferOffsetAlignment(MemoryBufferType type) noexcept;
+
+// Rounds value up to a multiple of alignment, which isn't required to be a power of two
+inline uint64_t engAlignUp(uint64_t value, uint64_t alignment) noexcept
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "pch.h"
+#include "const_buffer_allocator.h"
+
+#include "utils/debug/assertion.h"
+
+
+ConstBufferAllocator::~ConstBufferAllocator()
+{
+    Destroy();
+}
+
+
+bool ConstBufferAllocator::Create(MemoryBufferType type, uint64_t pageSize, uint64_t transientFrameRegionSize, ds::StrID debugName) noexcept
+{
+    ENG_ASSERT(!IsValid(), "Attempt to create already valid const buffer allocator: {}", debugName.CStr());
+    ENG_ASSERT(type == MemoryBufferType::TYPE_CONSTANT_BUFFER || type == MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER,
+        "Const buffer allocator \'{}\' type must be constant or unordered access buffer", debugName.CStr());
+    ENG_ASSERT(pageSize > 0, "Invalid \'{}\' const buffer allocator page size", debugName.CStr());
+
+    m_type = type;
+    m_alignment = engGetMemoryBufferOffsetAlignment(type);
+    m_pageSize = engAlignUp(pageSize, m_alignment);
+    m_debugName = debugName;
+
+    return m_transientRingBuffer.Create(type, transientFrameRegionSize, debugName);
+}
+
+
+void ConstBufferAllocator::Destroy() noexcept
+{
+    if (!IsValid()) {
+        return;
+    }
+
+    MemoryBufferManager& memBufferManager = MemoryBufferManager::GetInstance();
+
+    for (Page& page : m_pages) {
+        ENG_ASSERT(page.usedSize == 0, "Const buffer allocator \'{}\' page is destroyed with {} bytes still allocated",
+            m_debugName.CStr(), page.usedSize);
+
+        page.pBuffer->Destroy();
+        memBufferManager.UnregisterBuffer(page.pBuffer);
+    }
+
+    m_pages.clear();
+
+    m_transientRingBuffer.Destroy();
+
+    m_pageSize = 0;
+    m_alignment = 0;
+    m_type = MemoryBufferType::TYPE_INVALID;
+}
+
+
+void ConstBufferAllocator::BeginFrame() noexcept
+{
+    m_transientRingBuffer.BeginFrame();
+}
+
+
+void ConstBufferAllocator::EndFrame() noexcept
+{
+    m_transientRingBuffer.EndFrame();
+}
+
+
+ConstBufferAllocation ConstBufferAllocator::Allocate(uint64_t size) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(IsValid(), "Const buffer allocator \'{}\' is invalid", m_debugName.CStr());
+    ENG_ASSERT_GRAPHICS_API(size > 0, "Zero sized allocation from const buffer allocator \'{}\'", m_debugName.CStr());
+
+    // Keeps all free blocks offsets and sizes aligned, so any of them can be bound
+    const uint64_t alignedSize = engAlignUp(size, m_alignment);
+
+    uint64_t offset = 0;
+    uint32_t pageIdx = 0;
+
+    for (; pageIdx < m_pages.size(); ++pageIdx) {
+        if (AllocateFromPage(m_pages[pageIdx], alignedSize, offset)) {
+            break;
+        }
+    }
+
+    if (pageIdx == m_pages.size()) {
+        pageIdx = CreatePage(std::max(alignedSize, m_pageSize));
+
+        if (pageIdx == UINT32_MAX || !AllocateFromPage(m_pages[pageIdx], alignedSize, offset)) {
+            ENG_ASSERT_GRAPHICS_API_FAIL("Failed to allocate {} bytes from const buffer allocator \'{}\'", size, m_debugName.CStr());
+            return {};
+        }
+    }
+
+    ConstBufferAllocation allocation = {};
+    allocation.pBuffer = m_pages[pageIdx].pBuffer;
+    allocation.offset = offset;
+    allocation.size = alignedSize;
+    allocation.pageIdx = pageIdx;
+
+    return allocation;
+}
+
+
+void ConstBufferAllocator::Free(ConstBufferAllocation& allocation) noexcept
+{
+    if (!allocation.IsValid()) {
+        return;
+    }
+
+    ENG_ASSERT_GRAPHICS_API(allocation.pageIdx < m_pages.size() && m_pages[allocation.pageIdx].pBuffer == allocation.pBuffer,
+        "Allocation doesn't belong to const buffer allocator \'{}\'", m_debugName.CStr());
+
+    Page& page = m_pages[allocation.pageIdx];
+    std::vector<FreeBlock>& freeBlocks = page.freeBlocks;
+
+    auto nextIt = std::lower_bound(freeBlocks.begin(), freeBlocks.end(), allocation.offset,
+        [](const FreeBlock& block, uint64_t offset) { return block.offset < offset; });
+
+    ENG_ASSERT_GRAPHICS_API(nextIt == freeBlocks.end() || nextIt->offset >= allocation.offset + allocation.size,
+        "Double free in const buffer allocator \'{}\'", m_debugName.CStr());
+
+    const bool mergesWithPrev = nextIt != freeBlocks.begin() && (nextIt - 1)->offset + (nextIt - 1)->size == allocation.offset;
+    const bool mergesWithNext = nextIt != freeBlocks.end() && allocation.offset + allocation.size == nextIt->offset;
+
+    if (mergesWithPrev && mergesWithNext) {
+        (nextIt - 1)->size += allocation.size + nextIt->size;
+        freeBlocks.erase(nextIt);
+    } else if (mergesWithPrev) {
+        (nextIt - 1)->size += allocation.size;
+    } else if (mergesWithNext) {
+        nextIt->offset = allocation.offset;
+        nextIt->size += allocation.size;
+    } else {
+        freeBlocks.insert(nextIt, FreeBlock { allocation.offset, allocation.size });
+    }
+
+    page.usedSize -= allocation.size;
+
+    allocation = {};
+}
+
+
+void ConstBufferAllocator::Update(const ConstBufferAllocation& allocation, const void* pData, uint64_t size, uint64_t offset) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(allocation.IsValid(), "Update of invalid allocation of const buffer allocator \'{}\'", m_debugName.CStr());
+    ENG_ASSERT_GRAPHICS_API(offset + size <= allocation.size, "Update is out of allocation bounds in const buffer allocator \'{}\'", m_debugName.CStr());
+
+    allocation.pBuffer->FillSubdata(allocation.offset + offset, size, pData);
+}
+
+
+ConstBufferAllocatorStatistics ConstBufferAllocator::GetStatistics() const noexcept
+{
+    ConstBufferAllocatorStatistics statistics = {};
+    statistics.pagesCount = m_pages.size();
+
+    for (const Page& page : m_pages) {
+        statistics.capacity += page.pBuffer->GetSize();
+        statistics.usedSize += page.usedSize;
+        statistics.freeBlocksCount += page.freeBlocks.size();
+
+        for (const FreeBlock& block : page.freeBlocks) {
+            statistics.largestFreeBlockSize = std::max(statistics.largestFreeBlockSize, block.size);
+        }
+    }
+
+    statistics.transientCapacity = m_transientRingBuffer.GetFrameRegionSize();
+    statistics.transientUsedSize = m_transientRingBuffer.GetFrameAllocatedSize();
+
+    const uint64_t freeSize = statistics.capacity - statistics.usedSize;
+
+    statistics.utilization = statistics.capacity > 0 ? (float)statistics.usedSize / statistics.capacity : 0.f;
+    statistics.fragmentation = freeSize > 0 ? 1.f - (float)statistics.largestFreeBlockSize / freeSize : 0.f;
+
+    return statistics;
+}
+
+
+uint32_t ConstBufferAllocator::CreatePage(uint64_t size) noexcept
+{
+    MemoryBufferCreateInfo createInfo = {};
+    createInfo.type = m_type;
+    createInfo.dataSize = size;
+    createInfo.elementSize = 1;
+    createInfo.creationFlags = BUFFER_CREATION_FLAG_DYNAMIC_STORAGE;
+    createInfo.pData = nullptr;
+
+    MemoryBuffer* pBuffer = MemoryBufferManager::GetInstance().RegisterBuffer();
+    ENG_ASSERT(pBuffer, "Failed to register \'{}\' const buffer allocator page", m_debugName.CStr());
+
+    if (!pBuffer->Create(createInfo)) {
+        MemoryBufferManager::GetInstance().UnregisterBuffer(pBuffer);
+        return UINT32_MAX;
+    }
+
+    pBuffer->SetDebugName(m_debugName);
+
+    Page page = {};
+    page.pBuffer = pBuffer;
+    page.freeBlocks.emplace_back(FreeBlock { 0, size });
+    page.usedSize = 0;
+
+    m_pages.emplace_back(std::move(page));
+
+    return static_cast<uint32_t>(m_pages.size() - 1);
+}
+
+
+bool ConstBufferAllocator::AllocateFromPage(Page& page, uint64_t size, uint64_t& outOffset) noexcept
+{
+    auto blockIt = std::find_if(page.freeBlocks.begin(), page.freeBlocks.end(),
+        [size](const FreeBlock& block) { return block.size >= size; });
+
+    if (blockIt == page.freeBlocks.end()) {
+        return false;
+    }
+
+    outOffset = blockIt->offset;
+
+    if (blockIt->size == size) {
+        page.freeBlocks.erase(blockIt);
+    } else {
+        blockIt->offset += size;
+        blockIt->size -= size;
+    }
+
+    page.usedSize += size;
+
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "dynamic_ring_buffer.h"
+
+#include <vector>
+
+
+// Long-lived block of a constant buffer page. Stays valid until Free
+struct ConstBufferAllocation
+{
+    MemoryBuffer* pBuffer;
+    uint64_t      offset; // Aligned to buffer type offset alignment, use with glBindBufferRange
+    uint64_t      size;
+    uint32_t      pageIdx;
+
+    bool IsValid() const noexcept { return pBuffer != nullptr; }
+};
+
+
+struct ConstBufferAllocatorStatistics
+{
+    uint64_t pagesCount;
+    uint64_t capacity;              // Bytes of all pages
+    uint64_t usedSize;              // Bytes of live allocations including alignment padding
+    uint64_t freeBlocksCount;
+    uint64_t largestFreeBlockSize;
+
+    uint64_t transientCapacity;     // Bytes of one frame region of transient allocations
+    uint64_t transientUsedSize;     // Bytes allocated by the current frame
+
+    float utilization;              // usedSize / capacity
+    float fragmentation;            // 1 - largestFreeBlockSize / free bytes. 0 if all free memory is contiguous
+};
+
+
+// Packs many small constant blocks into a few large buffers:
+// - long-lived allocations come from fixed size pages managed with first fit free lists and updated with FillSubdata
+// - transient allocations live until the end of the frame and come from a persistently mapped DynamicRingBuffer
+// Must be used only on the thread which owns graphics context
+class ConstBufferAllocator
+{
+public:
+    static inline constexpr uint64_t DEFAULT_PAGE_SIZE = 256 * 1024;
+
+public:
+    ConstBufferAllocator() = default;
+    ~ConstBufferAllocator();
+
+    ConstBufferAllocator(const ConstBufferAllocator& other) = delete;
+    ConstBufferAllocator& operator=(const ConstBufferAllocator& other) = delete;
+    ConstBufferAllocator(ConstBufferAllocator&& other) noexcept = delete;
+    ConstBufferAllocator& operator=(ConstBufferAllocator&& other) noexcept = delete;
+
+    // type is TYPE_CONSTANT_BUFFER or TYPE_UNORDERED_ACCESS_BUFFER
+    bool Create(MemoryBufferType type, uint64_t pageSize, uint64_t transientFrameRegionSize, ds::StrID debugName) noexcept;
+    void Destroy() noexcept;
+
+    void BeginFrame() noexcept;
+    void EndFrame() noexcept;
+
+    // Allocations bigger than a page get a dedicated page
+    ConstBufferAllocation Allocate(uint64_t size) noexcept;
+    template <typename Type>
+    ConstBufferAllocation Allocate() noexcept { return Allocate(sizeof(Type)); }
+
+    // Block may be reused right away, since FillSubdata of its next owner is ordered after commands still reading it
+    void Free(ConstBufferAllocation& allocation) noexcept;
+
+    void Update(const ConstBufferAllocation& allocation, const void* pData, uint64_t size, uint64_t offset = 0) noexcept;
+
+    DynamicRingBufferAllocation AllocateTransient(uint64_t size) noexcept { return m_transientRingBuffer.Allocate(size); }
+    template <typename Type>
+    DynamicRingBufferAllocation AllocateTransient() noexcept { return m_transientRingBuffer.Allocate<Type>(); }
+
+    ConstBufferAllocatorStatistics GetStatistics() const noexcept;
+
+    bool IsValid() const noexcept { return m_transientRingBuffer.IsValid(); }
+
+private:
+    struct FreeBlock
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct Page
+    {
+        MemoryBuffer* pBuffer;
+        std::vector<FreeBlock> freeBlocks; // Sorted by offset, neighbours are always coalesced
+        uint64_t usedSize;
+    };
+
+    uint32_t CreatePage(uint64_t size) noexcept;
+    bool AllocateFromPage(Page& page, uint64_t size, uint64_t& outOffset) noexcept;
+
+private:
+    DynamicRingBuffer m_transientRingBuffer;
+
+    std::vector<Page> m_pages;
+
+    ds::StrID m_debugName = "";
+
+    uint64_t m_pageSize = 0;
+    uint64_t m_alignment = 0;
+
+    MemoryBufferType m_type = MemoryBufferType::TYPE_INVALID;
+};
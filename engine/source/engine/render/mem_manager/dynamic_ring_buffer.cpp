@@ -0,0 +1,192 @@
+#include "pch.h"
+#include "dynamic_ring_buffer.h"
+
+#include "utils/debug/assertion.h"
+
+#include "render/platform/OpenGL/opengl_driver.h"
+
+
+static constexpr GLuint64 FRAME_FENCE_WAIT_TIMEOUT_NS = 1'000'000;
+
+
+DynamicRingBuffer::~DynamicRingBuffer()
+{
+    Destroy();
+}
+
+
+bool DynamicRingBuffer::Create(MemoryBufferType type, uint64_t frameRegionSize, ds::StrID debugName) noexcept
+{
+    ENG_ASSERT(!IsValid(), "Attempt to create already valid dynamic ring buffer: {}", debugName.CStr());
+    ENG_ASSERT(frameRegionSize > 0, "Invalid \'{}\' dynamic ring buffer frame region size", debugName.CStr());
+
+    m_type = type;
+    m_alignment = engGetMemoryBufferOffsetAlignment(type);
+    m_debugName = debugName;
+
+    m_pBuffer = MemoryBufferManager::GetInstance().RegisterBuffer();
+    ENG_ASSERT(m_pBuffer, "Failed to register \'{}\' dynamic ring buffer", debugName.CStr());
+
+    return CreateStorage(frameRegionSize);
+}
+
+
+void DynamicRingBuffer::Destroy() noexcept
+{
+    if (!m_pBuffer) {
+        return;
+    }
+
+    DestroyStorage();
+
+    MemoryBufferManager::GetInstance().UnregisterBuffer(m_pBuffer);
+    m_pBuffer = nullptr;
+
+    m_type = MemoryBufferType::TYPE_INVALID;
+    m_alignment = 0;
+    m_frameIdx = 0;
+    m_stalledFramesCount = 0;
+    m_isFrameActive = false;
+}
+
+
+void DynamicRingBuffer::BeginFrame(uint64_t requiredSize) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(IsValid(), "Dynamic ring buffer \'{}\' is invalid", m_debugName.CStr());
+    ENG_ASSERT_GRAPHICS_API(!m_isFrameActive, "Dynamic ring buffer \'{}\' frame was not ended", m_debugName.CStr());
+
+    m_frameIdx = (m_frameIdx + 1) % FRAMES_IN_FLIGHT;
+
+    if (requiredSize > m_frameRegionSize) {
+        DestroyStorage();
+        CreateStorage(std::max(requiredSize, 2 * m_frameRegionSize));
+    } else {
+        WaitFrameFence(m_frameIdx);
+    }
+
+    m_frameAllocatedSize = 0;
+    m_isFrameActive = true;
+}
+
+
+void DynamicRingBuffer::EndFrame() noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(m_isFrameActive, "Dynamic ring buffer \'{}\' frame was not begun", m_debugName.CStr());
+
+    ENG_ASSERT_GRAPHICS_API(m_frameFences[m_frameIdx] == nullptr, "Dynamic ring buffer \'{}\' frame fence was not waited", m_debugName.CStr());
+    m_frameFences[m_frameIdx] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_isFrameActive = false;
+}
+
+
+DynamicRingBufferAllocation DynamicRingBuffer::Allocate(uint64_t size) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(m_isFrameActive, "Allocation from dynamic ring buffer \'{}\' outside of frame", m_debugName.CStr());
+    ENG_ASSERT_GRAPHICS_API(size > 0, "Zero sized allocation from dynamic ring buffer \'{}\'", m_debugName.CStr());
+
+    const uint64_t offset = engAlignUp(m_frameAllocatedSize, m_alignment);
+
+    if (offset + size > m_frameRegionSize) {
+        ENG_ASSERT_GRAPHICS_API_FAIL("Dynamic ring buffer \'{}\' frame region overflow: {} of {} bytes",
+            m_debugName.CStr(), offset + size, m_frameRegionSize);
+        return {};
+    }
+
+    m_frameAllocatedSize = offset + size;
+
+    const uint64_t bufferOffset = m_frameIdx * m_frameRegionSize + offset;
+
+    DynamicRingBufferAllocation allocation = {};
+    allocation.pData = m_pMappedData + bufferOffset;
+    allocation.pBuffer = m_pBuffer;
+    allocation.offset = bufferOffset;
+    allocation.size = size;
+
+    return allocation;
+}
+
+
+bool DynamicRingBuffer::CanAllocate(uint64_t size) const noexcept
+{
+    return m_isFrameActive && engAlignUp(m_frameAllocatedSize, m_alignment) + size <= m_frameRegionSize;
+}
+
+
+bool DynamicRingBuffer::CreateStorage(uint64_t frameRegionSize) noexcept
+{
+    // Keeps every region start aligned
+    m_frameRegionSize = engAlignUp(frameRegionSize, m_alignment);
+
+    MemoryBufferCreateInfo createInfo = {};
+    createInfo.type = m_type;
+    createInfo.dataSize = m_frameRegionSize * FRAMES_IN_FLIGHT;
+    createInfo.elementSize = 1;
+    createInfo.creationFlags = static_cast<MemoryBufferCreationFlags>(
+        BUFFER_CREATION_FLAG_WRITABLE | BUFFER_CREATION_FLAG_PERSISTENT | BUFFER_CREATION_FLAG_COHERENT);
+    createInfo.pData = nullptr;
+
+    m_pBuffer->Create(createInfo);
+    ENG_ASSERT(m_pBuffer->IsValid(), "Failed to create \'{}\' dynamic ring buffer", m_debugName.CStr());
+    m_pBuffer->SetDebugName(m_debugName);
+
+    m_pMappedData = static_cast<uint8_t*>(m_pBuffer->MapPersistentWrite());
+    ENG_ASSERT(m_pMappedData, "Failed to map \'{}\' dynamic ring buffer", m_debugName.CStr());
+
+    return m_pMappedData != nullptr;
+}
+
+
+void DynamicRingBuffer::DestroyStorage() noexcept
+{
+    DeleteFrameFences();
+
+    if (m_pBuffer->IsValid()) {
+        m_pBuffer->Unmap();
+        m_pBuffer->Destroy();
+    }
+
+    m_pMappedData = nullptr;
+    m_frameRegionSize = 0;
+    m_frameAllocatedSize = 0;
+}
+
+
+void DynamicRingBuffer::WaitFrameFence(uint32_t frameIdx) noexcept
+{
+    GLsync fence = static_cast<GLsync>(m_frameFences[frameIdx]);
+
+    if (!fence) {
+        return;
+    }
+
+    GLbitfield waitFlags = 0;
+    GLenum waitResult = glClientWaitSync(fence, waitFlags, 0);
+
+    if (waitResult == GL_TIMEOUT_EXPIRED) {
+        ++m_stalledFramesCount;
+
+        // Commands may still be in client queue, so they are flushed to make the fence reachable
+        waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+        do {
+            waitResult = glClientWaitSync(fence, waitFlags, FRAME_FENCE_WAIT_TIMEOUT_NS);
+        } while (waitResult == GL_TIMEOUT_EXPIRED);
+    }
+
+    ENG_ASSERT_GRAPHICS_API(waitResult != GL_WAIT_FAILED, "Failed to wait dynamic ring buffer \'{}\' frame fence", m_debugName.CStr());
+
+    glDeleteSync(fence);
+    m_frameFences[frameIdx] = nullptr;
+}
+
+
+void DynamicRingBuffer::DeleteFrameFences() noexcept
+{
+    for (void*& pFence : m_frameFences) {
+        if (pFence) {
+            glDeleteSync(static_cast<GLsync>(pFence));
+            pFence = nullptr;
+        }
+    }
+}
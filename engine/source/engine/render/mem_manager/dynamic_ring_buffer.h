@@ -0,0 +1,90 @@
+#pragma once
+
+#include "buffer_manager.h"
+
+#include <array>
+
+
+struct DynamicRingBufferAllocation
+{
+    void*         pData;  // Persistently mapped pointer, written data is visible to GPU without flushes
+    MemoryBuffer* pBuffer;
+    uint64_t      offset; // Use with glBindBufferRange or as indirect args offset
+    uint64_t      size;
+
+    template <typename Type>
+    Type* As() const noexcept { return static_cast<Type*>(pData); }
+
+    bool IsValid() const noexcept { return pData != nullptr; }
+};
+
+
+// Persistent coherent buffer split into FRAMES_IN_FLIGHT regions. Every frame allocates linearly from its own region,
+// which is reused only after the fence placed at the end of the frame that used it last is signaled.
+// Must be used only on the thread which owns graphics context
+class DynamicRingBuffer
+{
+public:
+    static inline constexpr uint32_t FRAMES_IN_FLIGHT = 3;
+
+public:
+    DynamicRingBuffer() = default;
+    ~DynamicRingBuffer();
+
+    DynamicRingBuffer(const DynamicRingBuffer& other) = delete;
+    DynamicRingBuffer& operator=(const DynamicRingBuffer& other) = delete;
+    DynamicRingBuffer(DynamicRingBuffer&& other) noexcept = delete;
+    DynamicRingBuffer& operator=(DynamicRingBuffer&& other) noexcept = delete;
+
+    bool Create(MemoryBufferType type, uint64_t frameRegionSize, ds::StrID debugName) noexcept;
+    void Destroy() noexcept;
+
+    // Waits for GPU to finish the frame which used the next region. Region grows if it's smaller than requiredSize.
+    // Growth recreates the buffer, previous storage is retired until in flight frames are done with it
+    void BeginFrame(uint64_t requiredSize = 0) noexcept;
+    // Fences commands which use allocations of the current frame
+    void EndFrame() noexcept;
+
+    // Returns invalid allocation if the frame region is exhausted
+    DynamicRingBufferAllocation Allocate(uint64_t size) noexcept;
+    bool CanAllocate(uint64_t size) const noexcept;
+
+    template <typename Type>
+    DynamicRingBufferAllocation Allocate(size_t count = 1) noexcept { return Allocate(sizeof(Type) * count); }
+
+    MemoryBuffer* GetBuffer() const noexcept { return m_pBuffer; }
+
+    uint64_t GetFrameRegionSize() const noexcept { return m_frameRegionSize; }
+    uint64_t GetFrameAllocatedSize() const noexcept { return m_frameAllocatedSize; }
+
+    // Frames which had to wait for GPU since creation
+    uint64_t GetStalledFramesCount() const noexcept { return m_stalledFramesCount; }
+
+    bool IsValid() const noexcept { return m_pBuffer && m_pBuffer->IsValid(); }
+
+private:
+    bool CreateStorage(uint64_t frameRegionSize) noexcept;
+    void DestroyStorage() noexcept;
+
+    void WaitFrameFence(uint32_t frameIdx) noexcept;
+    void DeleteFrameFences() noexcept;
+
+private:
+    MemoryBuffer* m_pBuffer = nullptr;
+    uint8_t* m_pMappedData = nullptr;
+
+    // GLsync objects, nullptr if region is not used by GPU
+    std::array<void*, FRAMES_IN_FLIGHT> m_frameFences = {};
+
+    ds::StrID m_debugName = "";
+
+    uint64_t m_frameRegionSize = 0;
+    uint64_t m_frameAllocatedSize = 0;
+    uint64_t m_alignment = 0;
+    uint64_t m_stalledFramesCount = 0;
+
+    MemoryBufferType m_type = MemoryBufferType::TYPE_INVALID;
+
+    uint32_t m_frameIdx = 0;
+    bool m_isFrameActive = false;
+};
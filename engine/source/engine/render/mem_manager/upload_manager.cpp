@@ -0,0 +1,336 @@
+#include "pch.h"
+#include "upload_manager.h"
+
+#include "utils/debug/assertion.h"
+
+#include "render/platform/OpenGL/opengl_driver.h"
+
+
+static std::unique_ptr<UploadManager> pUploadMngInst = nullptr;
+
+static constexpr uint64_t INVALID_STAGING_OFFSET = UINT64_MAX;
+
+
+UploadManager& UploadManager::GetInstance() noexcept
+{
+    ENG_ASSERT(engIsUploadManagerInitialized(), "Upload manager is not initialized");
+    return *pUploadMngInst;
+}
+
+
+UploadManager::~UploadManager()
+{
+    Terminate();
+}
+
+
+void UploadManager::UploadBuffer(MemoryBuffer* pDstBuffer, uint64_t dstOffset, const void* pData, uint64_t size) noexcept
+{
+    ENG_ASSERT(pDstBuffer && pDstBuffer->IsValid(), "Upload destination buffer is invalid");
+    ENG_ASSERT(pData, "pData is nullptr");
+    ENG_ASSERT(size > 0 && dstOffset + size <= pDstBuffer->GetSize(), "Upload to \'{}\' buffer is out of bounds", pDstBuffer->GetDebugName().CStr());
+
+    BufferCopy copy = {};
+    copy.pDstBuffer = pDstBuffer;
+    copy.dstOffset = dstOffset;
+    copy.size = size;
+
+    // Deferred requests go first, so that later writes to the same memory win
+    copy.srcOffset = m_deferredUploads.empty() ? Stage(pData, size) : INVALID_STAGING_OFFSET;
+
+    if (copy.srcOffset != INVALID_STAGING_OFFSET) {
+        m_bufferCopies.emplace_back(copy);
+        return;
+    }
+
+    DeferredUpload upload = {};
+    upload.bufferCopy = copy;
+    upload.isTexture = false;
+
+    Defer(pData, size, std::move(upload));
+}
+
+
+void UploadManager::UploadTexture2D(Texture* pDstTexture, const TextureRegion2D& region, const TextureInputData& inputData, bool generateMipmaps) noexcept
+{
+    ENG_ASSERT(pDstTexture && pDstTexture->IsValid(), "Upload destination texture is invalid");
+    ENG_ASSERT(inputData.pData, "Texture \'{}\' input data is nullptr", pDstTexture->GetName().CStr());
+
+    const uint64_t size = engGetTextureInputDataSize(inputData.format, inputData.dataType, region.width, region.height);
+    ENG_ASSERT(size > 0, "Empty upload region of texture \'{}\'", pDstTexture->GetName().CStr());
+
+    TextureCopy copy = {};
+    copy.pDstTexture = pDstTexture;
+    copy.region = region;
+    copy.format = inputData.format;
+    copy.dataType = inputData.dataType;
+    copy.generateMipmaps = generateMipmaps;
+
+    copy.srcOffset = m_deferredUploads.empty() ? Stage(inputData.pData, size) : INVALID_STAGING_OFFSET;
+
+    if (copy.srcOffset != INVALID_STAGING_OFFSET) {
+        m_textureCopies.emplace_back(copy);
+        return;
+    }
+
+    DeferredUpload upload = {};
+    upload.textureCopy = copy;
+    upload.isTexture = true;
+
+    Defer(inputData.pData, size, std::move(upload));
+}
+
+
+void UploadManager::Flush() noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(IsInitialized(), "Upload manager is not initialized");
+
+    m_lastFlushStatistics = {};
+
+    IssueBufferCopies();
+    IssueTextureCopies();
+
+    // Fences the copies, so the region is reused only after GPU has read it
+    m_stagingBuffer.EndFrame();
+
+    // Grows staging region if the next deferred request can't fit into it
+    const uint64_t nextDeferredSize = m_deferredUploads.empty() ? 0 : m_deferredUploads.front().data.size();
+    m_stagingBuffer.BeginFrame(std::max(m_frameBudget, nextDeferredSize));
+
+    m_frameStagedSize = 0;
+
+    StageDeferredUploads();
+
+    m_lastFlushStatistics.pendingSize = m_deferredSize;
+    m_lastFlushStatistics.stagingStalledFramesCount = m_stagingBuffer.GetStalledFramesCount();
+}
+
+
+void UploadManager::SetFrameBudget(uint64_t budget) noexcept
+{
+    ENG_ASSERT(budget > 0, "Upload frame budget must be positive");
+    m_frameBudget = budget;
+}
+
+
+UploadManagerStatistics UploadManager::GetStatistics() const noexcept
+{
+    return m_lastFlushStatistics;
+}
+
+
+bool UploadManager::Init() noexcept
+{
+    if (IsInitialized()) {
+        return true;
+    }
+
+    if (!m_stagingBuffer.Create(MemoryBufferType::TYPE_STAGING_BUFFER, m_frameBudget, "__UPLOAD_STAGING_BUFFER__")) {
+        return false;
+    }
+
+    // Staging frame is always active, so requests can be staged at any time, e.g. during resources creation
+    m_stagingBuffer.BeginFrame();
+
+    m_isInitialized = true;
+
+    return true;
+}
+
+
+void UploadManager::Terminate() noexcept
+{
+    if (!IsInitialized()) {
+        return;
+    }
+
+    if (!m_deferredUploads.empty() || !m_bufferCopies.empty() || !m_textureCopies.empty()) {
+        ENG_LOG_WARN("Upload manager is terminated with unflushed requests");
+    }
+
+    m_bufferCopies.clear();
+    m_textureCopies.clear();
+    m_deferredUploads.clear();
+
+    m_deferredSize = 0;
+    m_frameStagedSize = 0;
+
+    m_stagingBuffer.EndFrame();
+    m_stagingBuffer.Destroy();
+
+    m_isInitialized = false;
+}
+
+
+uint64_t UploadManager::Stage(const void* pData, uint64_t size) noexcept
+{
+    // Request bigger than the budget is staged only into an empty frame
+    const bool fitsBudget = m_frameStagedSize == 0 || m_frameStagedSize + size <= m_frameBudget;
+
+    if (!fitsBudget || !m_stagingBuffer.CanAllocate(size)) {
+        return INVALID_STAGING_OFFSET;
+    }
+
+    const DynamicRingBufferAllocation allocation = m_stagingBuffer.Allocate(size);
+    memcpy(allocation.pData, pData, size);
+
+    m_frameStagedSize += size;
+
+    return allocation.offset;
+}
+
+
+void UploadManager::Defer(const void* pData, uint64_t size, DeferredUpload&& upload) noexcept
+{
+    const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+    upload.data.assign(pBytes, pBytes + size);
+
+    m_deferredSize += size;
+
+    m_deferredUploads.emplace_back(std::move(upload));
+}
+
+
+void UploadManager::StageDeferredUploads() noexcept
+{
+    while (!m_deferredUploads.empty()) {
+        DeferredUpload& upload = m_deferredUploads.front();
+
+        const uint64_t size = upload.data.size();
+        const uint64_t srcOffset = Stage(upload.data.data(), size);
+
+        if (srcOffset == INVALID_STAGING_OFFSET) {
+            break;
+        }
+
+        if (upload.isTexture) {
+            upload.textureCopy.srcOffset = srcOffset;
+            m_textureCopies.emplace_back(upload.textureCopy);
+        } else {
+            upload.bufferCopy.srcOffset = srcOffset;
+            m_bufferCopies.emplace_back(upload.bufferCopy);
+        }
+
+        m_deferredSize -= size;
+
+        m_deferredUploads.pop_front();
+    }
+}
+
+
+void UploadManager::IssueBufferCopies() noexcept
+{
+    if (m_bufferCopies.empty()) {
+        return;
+    }
+
+    // Stable sort keeps submission order of copies to the same buffer, so overlapping writes are applied in order
+    std::stable_sort(m_bufferCopies.begin(), m_bufferCopies.end(), [](const BufferCopy& left, const BufferCopy& right) {
+        return left.pDstBuffer->GetRenderID() < right.pDstBuffer->GetRenderID();
+    });
+
+    const MemoryBuffer& stagingBuffer = *m_stagingBuffer.GetBuffer();
+
+    // Neighbour requests contiguous both in staging and destination buffers are merged into one copy
+    BufferCopy mergedCopy = m_bufferCopies.front();
+
+    for (size_t i = 1; i <= m_bufferCopies.size(); ++i) {
+        if (i < m_bufferCopies.size()) {
+            const BufferCopy& copy = m_bufferCopies[i];
+
+            const bool isContiguous = copy.pDstBuffer == mergedCopy.pDstBuffer &&
+                copy.srcOffset == mergedCopy.srcOffset + mergedCopy.size && copy.dstOffset == mergedCopy.dstOffset + mergedCopy.size;
+
+            if (isContiguous) {
+                mergedCopy.size += copy.size;
+                continue;
+            }
+        }
+
+        mergedCopy.pDstBuffer->CopySubdata(stagingBuffer, mergedCopy.srcOffset, mergedCopy.dstOffset, mergedCopy.size);
+
+        m_lastFlushStatistics.uploadedSize += mergedCopy.size;
+        ++m_lastFlushStatistics.bufferCopiesCount;
+
+        if (i < m_bufferCopies.size()) {
+            mergedCopy = m_bufferCopies[i];
+        }
+    }
+
+    m_lastFlushStatistics.bufferUploadsCount = static_cast<uint32_t>(m_bufferCopies.size());
+
+    m_bufferCopies.clear();
+}
+
+
+void UploadManager::IssueTextureCopies() noexcept
+{
+    if (m_textureCopies.empty()) {
+        return;
+    }
+
+    MemoryBuffer& stagingBuffer = *m_stagingBuffer.GetBuffer();
+
+    for (const TextureCopy& copy : m_textureCopies) {
+        copy.pDstTexture->CopyFromStagingBuffer(stagingBuffer, copy.srcOffset, copy.region, copy.format, copy.dataType);
+
+        if (copy.generateMipmaps) {
+            copy.pDstTexture->GenerateMipmaps();
+        }
+
+        m_lastFlushStatistics.uploadedSize += engGetTextureInputDataSize(copy.format, copy.dataType, copy.region.width, copy.region.height);
+    }
+
+    // Client memory texture uploads require no unpack buffer bound
+    engOpenGLBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    m_lastFlushStatistics.textureCopiesCount = static_cast<uint32_t>(m_textureCopies.size());
+
+    m_textureCopies.clear();
+}
+
+
+bool UploadManager::IsInitialized() const noexcept
+{
+    return m_isInitialized;
+}
+
+
+bool engInitUploadManager() noexcept
+{
+    if (engIsUploadManagerInitialized()) {
+        ENG_LOG_WARN("Upload manager is already initialized!");
+        return true;
+    }
+
+    if (!engIsMemoryBufferManagerInitialized()) {
+        ENG_ASSERT_FAIL("Memory buffer manager must be initialized before upload manager");
+        return false;
+    }
+
+    pUploadMngInst = std::unique_ptr<UploadManager>(new UploadManager);
+
+    if (!pUploadMngInst) {
+        ENG_ASSERT_FAIL("Failed to allocate memory for upload manager");
+        return false;
+    }
+
+    if (!pUploadMngInst->Init()) {
+        ENG_ASSERT_FAIL("Failed to initialized upload manager");
+        return false;
+    }
+
+    return true;
+}
+
+
+void engTerminateUploadManager() noexcept
+{
+    pUploadMngInst = nullptr;
+}
+
+
+bool engIsUploadManagerInitialized() noexcept
+{
+    return pUploadMngInst && pUploadMngInst->IsInitialized();
+}
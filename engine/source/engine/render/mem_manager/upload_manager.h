@@ -0,0 +1,128 @@
+#pragma once
+
+#include "dynamic_ring_buffer.h"
+
+#include "render/texture_manager/texture_mng.h"
+
+#include <deque>
+#include <vector>
+
+
+struct UploadManagerStatistics
+{
+    uint64_t uploadedSize;          // Bytes copied to destinations by the last flush
+    uint64_t pendingSize;           // Bytes of requests deferred because of the frame budget
+    uint32_t bufferUploadsCount;    // Buffer requests copied by the last flush
+    uint32_t bufferCopiesCount;     // Copy calls they were coalesced into
+    uint32_t textureCopiesCount;
+    uint64_t stagingStalledFramesCount;
+};
+
+
+// Stages uploads into a persistent mapped buffer and issues all copies at once in Flush:
+// - buffer uploads are coalesced into as few glCopyNamedBufferSubData calls as possible
+// - texture uploads are sourced from the staging buffer bound as pixel unpack buffer
+// Frame budget limits bytes staged between flushes. Requests exceeding it are kept in CPU memory and staged by the next flushes
+// in submission order, so streaming spreads over several frames instead of causing spikes.
+// Destinations must stay valid until their requests are flushed. Must be used only on the thread which owns graphics context
+class UploadManager
+{
+    friend bool engInitUploadManager() noexcept;
+    friend void engTerminateUploadManager() noexcept;
+    friend bool engIsUploadManagerInitialized() noexcept;
+
+public:
+    static inline constexpr uint64_t DEFAULT_FRAME_BUDGET = 8 * 1024 * 1024;
+
+public:
+    static UploadManager& GetInstance() noexcept;
+
+public:
+    UploadManager(const UploadManager& other) = delete;
+    UploadManager& operator=(const UploadManager& other) = delete;
+    UploadManager(UploadManager&& other) noexcept = delete;
+    UploadManager& operator=(UploadManager&& other) noexcept = delete;
+
+    ~UploadManager();
+
+    // Data is copied right away, so it can be released after the call
+    void UploadBuffer(MemoryBuffer* pDstBuffer, uint64_t dstOffset, const void* pData, uint64_t size) noexcept;
+    void UploadTexture2D(Texture* pDstTexture, const TextureRegion2D& region, const TextureInputData& inputData, bool generateMipmaps = false) noexcept;
+
+    // Issues copies of staged requests and stages deferred ones within the frame budget. Called once per frame
+    void Flush() noexcept;
+
+    // Single request bigger than the budget is still staged, but alone
+    void SetFrameBudget(uint64_t budget) noexcept;
+    uint64_t GetFrameBudget() const noexcept { return m_frameBudget; }
+
+    UploadManagerStatistics GetStatistics() const noexcept;
+
+private:
+    struct BufferCopy
+    {
+        MemoryBuffer* pDstBuffer;
+        uint64_t      srcOffset;
+        uint64_t      dstOffset;
+        uint64_t      size;
+    };
+
+    struct TextureCopy
+    {
+        Texture*               pDstTexture;
+        uint64_t               srcOffset;
+        TextureRegion2D        region;
+        TextureInputDataFormat format;
+        TextureInputDataType   dataType;
+        bool                   generateMipmaps;
+    };
+
+    // Only one of copies is used. Its source offset is assigned when the data is staged
+    struct DeferredUpload
+    {
+        std::vector<uint8_t> data;
+
+        BufferCopy  bufferCopy;
+        TextureCopy textureCopy;
+
+        bool isTexture;
+    };
+
+private:
+    UploadManager() = default;
+
+    bool Init() noexcept;
+    void Terminate() noexcept;
+
+    // Returns staging offset or UINT64_MAX if the request doesn't fit into the frame budget
+    uint64_t Stage(const void* pData, uint64_t size) noexcept;
+    void Defer(const void* pData, uint64_t size, DeferredUpload&& upload) noexcept;
+
+    void StageDeferredUploads() noexcept;
+
+    void IssueBufferCopies() noexcept;
+    void IssueTextureCopies() noexcept;
+
+    bool IsInitialized() const noexcept;
+
+private:
+    DynamicRingBuffer m_stagingBuffer;
+
+    std::vector<BufferCopy> m_bufferCopies;
+    std::vector<TextureCopy> m_textureCopies;
+
+    std::deque<DeferredUpload> m_deferredUploads;
+
+    uint64_t m_frameBudget = DEFAULT_FRAME_BUDGET;
+    uint64_t m_frameStagedSize = 0;
+    uint64_t m_deferredSize = 0;
+
+    UploadManagerStatistics m_lastFlushStatistics = {};
+
+    bool m_isInitialized = false;
+};
+
+
+bool engInitUploadManager() noexcept;
+void engTerminateUploadManager() noexcept;
+bool engIsUploadManagerInitialized() noexcept;
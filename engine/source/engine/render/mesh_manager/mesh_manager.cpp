@@ -2,6 +2,7 @@
 #include "mesh_manager.h"
 
 #include "render/platform/OpenGL/opengl_driver.h"
+#include "render/platform/OpenGL/opengl_retire_queue.h"
 
 static std::unique_ptr<MeshManager> pMeshMngInst = nullptr;
 static std::unique_ptr<MeshDataManager> pMeshDataMngInst = nullptr;
@@ -470,6 +471,10 @@ MeshObj::MeshObj(MeshObj&& other) noexcept
     std::swap(m_name, other.m_name);
     std::swap(m_pVertexLayout, other.m_pVertexLayout);
     std::swap(m_pBufferData, other.m_pBufferData);
+    std::swap(m_pPositionStream, other.m_pPositionStream);
+    std::swap(m_boundsMin, other.m_boundsMin);
+    std::swap(m_boundsMax, other.m_boundsMax);
+    std::swap(m_hasBounds, other.m_hasBounds);
 }
 
 
@@ -482,6 +487,10 @@ MeshObj& MeshObj::operator=(MeshObj&& other) noexcept
     std::swap(m_name, other.m_name);
     std::swap(m_pVertexLayout, other.m_pVertexLayout);
     std::swap(m_pBufferData, other.m_pBufferData);
+    std::swap(m_pPositionStream, other.m_pPositionStream);
+    std::swap(m_boundsMin, other.m_boundsMin);
+    std::swap(m_boundsMax, other.m_boundsMax);
+    std::swap(m_hasBounds, other.m_hasBounds);
 
     return *this;
 }
@@ -531,19 +540,47 @@ void MeshObj::Destroy() noexcept
         return; 
     }
 
-    glDeleteVertexArrays(1, &m_vaoRenderID);
+    engOpenGLRetireObject(OpenGLObjectType::VERTEX_ARRAY, m_vaoRenderID);
     m_vaoRenderID = 0;
     
     m_name = "_INVALID_";
     m_pVertexLayout = nullptr;
     m_pBufferData = nullptr;
+    m_pPositionStream = nullptr;
+    m_hasBounds = false;
 }
 
 
 void MeshObj::Bind() const noexcept
 {
     ENG_ASSERT(IsValid(), "Mesh object \'{}\' is invalid", m_name.CStr());
-    glBindVertexArray(m_vaoRenderID);
+    engOpenGLBindVertexArray(m_vaoRenderID);
+}
+
+
+void MeshObj::SetPositionStream(const MeshObj* pPositionStream) noexcept
+{
+    ENG_ASSERT(IsValid(), "Mesh object \'{}\' is invalid", m_name.CStr());
+    ENG_ASSERT(!pPositionStream || pPositionStream->IsValid(), "Mesh object \'{}\' position stream is invalid", m_name.CStr());
+
+    // Position stream is drawn with the indirect args of this mesh
+    ENG_ASSERT(!pPositionStream || pPositionStream->GetGPUBufferData()->GetIndexBuffer().GetElementCount() == m_pBufferData->GetIndexBuffer().GetElementCount(),
+        "Mesh object \'{}\' position stream indices don't match mesh indices", m_name.CStr());
+    ENG_ASSERT(!pPositionStream || pPositionStream->GetVertexLayout()->GetActiveAttribsCount() == 1, 
+        "Mesh object \'{}\' position stream must have position attribute only", m_name.CStr());
+
+    m_pPositionStream = pPositionStream;
+}
+
+
+void MeshObj::SetBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax) noexcept
+{
+    ENG_ASSERT(IsValid(), "Mesh object \'{}\' is invalid", m_name.CStr());
+    ENG_ASSERT(glm::all(glm::lessThanEqual(boundsMin, boundsMax)), "Mesh object \'{}\' bounds are inverted", m_name.CStr());
+
+    m_boundsMin = boundsMin;
+    m_boundsMax = boundsMax;
+    m_hasBounds = true;
 }
 
 
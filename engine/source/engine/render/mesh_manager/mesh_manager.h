@@ -3,6 +3,7 @@
 #include "render/mem_manager/buffer_manager.h"
 
 #include "utils/data_structures/strid.h"
+#include "utils/math/common_math.h"
 
 
 enum class MeshVertexAttribDataType : uint8_t
@@ -225,6 +226,17 @@ public:
 
     void Bind() const noexcept;
 
+    // Mesh with the same indices, whose vertices hold positions only. Depth only passes fetch less vertex data with it
+    void SetPositionStream(const MeshObj* pPositionStream) noexcept;
+    // Returns the mesh itself if it has no separate position stream
+    const MeshObj* GetPositionStream() const noexcept { return m_pPositionStream ? m_pPositionStream : this; }
+
+    // Object space bounding box. Instances of meshes without bounds are never occlusion culled
+    void SetBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax) noexcept;
+    const glm::vec3& GetBoundsMin() const noexcept { return m_boundsMin; }
+    const glm::vec3& GetBoundsMax() const noexcept { return m_boundsMax; }
+    bool HasBounds() const noexcept { return m_hasBounds; }
+
     bool IsVertexLayoutValid() const noexcept;
     bool IsGPUBufferDataValid() const noexcept;
 
@@ -233,6 +245,9 @@ public:
     ds::StrID GetName() const noexcept { return m_name; }
     MeshID GetID() const noexcept { return m_ID; }
 
+    const MeshVertexLayout* GetVertexLayout() const noexcept { return m_pVertexLayout; }
+    const MeshGPUBufferData* GetGPUBufferData() const noexcept { return m_pBufferData; }
+
 private:
     uint32_t m_vaoRenderID = 0;
     MeshID m_ID;
@@ -241,6 +256,12 @@ private:
 
     MeshVertexLayout* m_pVertexLayout = nullptr;
     MeshGPUBufferData* m_pBufferData = nullptr;
+
+    const MeshObj* m_pPositionStream = nullptr;
+
+    glm::vec3 m_boundsMin = glm::vec3(0.f);
+    glm::vec3 m_boundsMax = glm::vec3(0.f);
+    bool m_hasBounds = false;
 };
 
 
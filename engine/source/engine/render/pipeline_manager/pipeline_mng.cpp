@@ -11,6 +11,8 @@ static constexpr size_t ENG_MAX_PIPELINES_COUNT = 8192; // TODO: make it configu
 
 static std::unique_ptr<PipelineManager> pPipelineMngInst = nullptr;
 
+static PipelineAttachmentOpsStatistics g_attachmentOpsStatistics = {};
+
 
 static constexpr GLenum CompressedBlendFactorToGLEnum(uint32_t compressedBlendFactor) noexcept
 {
@@ -129,13 +131,13 @@ static void EnablePolygonOffset(PolygonMode mode) noexcept
 {
     switch(mode) {
         case PolygonMode::POLYGON_MODE_FILL:
-            glEnable(GL_POLYGON_OFFSET_FILL);
+            engOpenGLSetCapabilityEnabled(GL_POLYGON_OFFSET_FILL, true);
             break;
         case PolygonMode::POLYGON_MODE_LINE:
-            glEnable(GL_POLYGON_OFFSET_LINE);
+            engOpenGLSetCapabilityEnabled(GL_POLYGON_OFFSET_LINE, true);
             break;
         case PolygonMode::POLYGON_MODE_POINT:
-            glEnable(GL_POLYGON_OFFSET_POINT);
+            engOpenGLSetCapabilityEnabled(GL_POLYGON_OFFSET_POINT, true);
             break;
         default:
             ENG_ASSERT_GRAPHICS_API_FAIL("Invalid polygon mode");
@@ -148,13 +150,13 @@ static void DisablePolygonOffset(PolygonMode mode) noexcept
 {
     switch(mode) {
         case PolygonMode::POLYGON_MODE_FILL:
-            glDisable(GL_POLYGON_OFFSET_FILL);
+            engOpenGLSetCapabilityEnabled(GL_POLYGON_OFFSET_FILL, false);
             break;
         case PolygonMode::POLYGON_MODE_LINE:
-            glDisable(GL_POLYGON_OFFSET_LINE);
+            engOpenGLSetCapabilityEnabled(GL_POLYGON_OFFSET_LINE, false);
             break;
         case PolygonMode::POLYGON_MODE_POINT:
-            glDisable(GL_POLYGON_OFFSET_POINT);
+            engOpenGLSetCapabilityEnabled(GL_POLYGON_OFFSET_POINT, false);
             break;
         default:
             ENG_ASSERT_GRAPHICS_API_FAIL("Invalid polygon mode");
@@ -173,7 +175,7 @@ static void SetupPolygonOffset(PolygonMode mode, float biasConstFactor, float bi
 
     if (enabled) {
         EnablePolygonOffset(mode);
-        glPolygonOffsetClamp(biasConstFactor, biasSlopeFactor, biasClamp);
+        engOpenGLPolygonOffsetClamp(biasConstFactor, biasSlopeFactor, biasClamp);
     } else {
         DisablePolygonOffset(mode);
     }
@@ -183,14 +185,14 @@ static void SetupPolygonOffset(PolygonMode mode, float biasConstFactor, float bi
 static void SetupFaceStencilTesting(GLenum face, GLuint mask, uint32_t sfOp, uint32_t spdfOp, uint32_t spdpOp, bool enabled)
 {
     if (enabled) {
-        glStencilMaskSeparate(face, mask);
+        engOpenGLStencilMaskSeparate(face, mask);
 
         const GLenum frontFaceStencilFailOp = CompressedStencilOpToGLEnum(sfOp);
         const GLenum frontFaceStencilPassDepthFailOp = CompressedStencilOpToGLEnum(spdfOp);
         const GLenum frontFaceStencilPassDepthPassOp = CompressedStencilOpToGLEnum(spdpOp);
-        glStencilOpSeparate(face, frontFaceStencilFailOp, frontFaceStencilPassDepthFailOp, frontFaceStencilPassDepthPassOp);
+        engOpenGLStencilOpSeparate(face, frontFaceStencilFailOp, frontFaceStencilPassDepthFailOp, frontFaceStencilPassDepthPassOp);
     } else {
-        glStencilMaskSeparate(face, 0x00);
+        engOpenGLStencilMaskSeparate(face, 0x00);
     }
 }
 
@@ -199,19 +201,19 @@ static void SetupFaceCulling(CullMode mode) noexcept
 {
     switch(mode) {
         case CullMode::CULL_MODE_NONE:
-            glDisable(GL_CULL_FACE);
+            engOpenGLSetCapabilityEnabled(GL_CULL_FACE, false);
             break;
         case CullMode::CULL_MODE_FRONT:
-            glEnable(GL_CULL_FACE);
-            glCullFace(GL_FRONT);
+            engOpenGLSetCapabilityEnabled(GL_CULL_FACE, true);
+            engOpenGLCullFace(GL_FRONT);
             break;
         case CullMode::CULL_MODE_BACK:
-            glEnable(GL_CULL_FACE);
-            glCullFace(GL_BACK);
+            engOpenGLSetCapabilityEnabled(GL_CULL_FACE, true);
+            engOpenGLCullFace(GL_BACK);
             break;
         case CullMode::CULL_MODE_FRONT_AND_BACK:
-            glEnable(GL_CULL_FACE);
-            glCullFace(GL_FRONT_AND_BACK);
+            engOpenGLSetCapabilityEnabled(GL_CULL_FACE, true);
+            engOpenGLCullFace(GL_FRONT_AND_BACK);
             break;
         default:
             ENG_ASSERT_GRAPHICS_API_FAIL("Invalid cull face mode");
@@ -276,24 +278,91 @@ Pipeline &Pipeline::operator=(Pipeline &&other) noexcept
 }
 
 
-void Pipeline::ClearFrameBuffer() noexcept
+void Pipeline::BeginRenderPass() noexcept
 {
     ENG_ASSERT(IsValid(), "Pipeline is invalid");
 
     static constexpr float BIT8_TO_FLOAT_COEF = 1.f / 255.f;
 
-    for (uint32_t colorAttachmentIdx = 0; colorAttachmentIdx < m_frameBufferColorAttachmentStates.size(); ++colorAttachmentIdx) {
-        const CompressedClearColor& clearColor = m_frameBufferColorAttachmentStates[colorAttachmentIdx].clearColor;
-        
-        const float r = BIT8_TO_FLOAT_COEF * clearColor.r;
-        const float g = BIT8_TO_FLOAT_COEF * clearColor.g;
-        const float b = BIT8_TO_FLOAT_COEF * clearColor.b;
-        const float a = BIT8_TO_FLOAT_COEF * clearColor.a;
+    uint32_t discardedColorAttachmentsMask = 0;
+
+    for (uint32_t colorAttachmentIdx = 0; colorAttachmentIdx < m_pFrameBuffer->GetColorAttachmentsCount(); ++colorAttachmentIdx) {
+        const CompressedColorAttachmentState& state = m_frameBufferColorAttachmentStates[colorAttachmentIdx];
+
+        switch (static_cast<AttachmentLoadOp>(state.blendState.loadOp)) {
+            case AttachmentLoadOp::LOAD_OP_CLEAR:
+            {
+                const float r = BIT8_TO_FLOAT_COEF * state.clearColor.r;
+                const float g = BIT8_TO_FLOAT_COEF * state.clearColor.g;
+                const float b = BIT8_TO_FLOAT_COEF * state.clearColor.b;
+                const float a = BIT8_TO_FLOAT_COEF * state.clearColor.a;
+
+                m_pFrameBuffer->ClearColor(colorAttachmentIdx, r, g, b, a);
+                ++g_attachmentOpsStatistics.clearedAttachmentsCount;
+                break;
+            }
+            case AttachmentLoadOp::LOAD_OP_DONT_CARE:
+                discardedColorAttachmentsMask |= 1u << colorAttachmentIdx;
+                ++g_attachmentOpsStatistics.discardedOnLoadAttachmentsCount;
+                break;
+            default:
+                ++g_attachmentOpsStatistics.loadedAttachmentsCount;
+                break;
+        }
+    }
+
+    bool discardDepthStencil = false;
+
+    if (m_pFrameBuffer->HasDepthAttachment() || m_pFrameBuffer->HasStencilAttachment()) {
+        switch (static_cast<AttachmentLoadOp>(m_compressedGlobalState.depthStencilLoadOp)) {
+            case AttachmentLoadOp::LOAD_OP_CLEAR:
+                m_pFrameBuffer->ClearDepthStencil(m_depthClearValue, m_stencilClearValue);
+                ++g_attachmentOpsStatistics.clearedAttachmentsCount;
+                break;
+            case AttachmentLoadOp::LOAD_OP_DONT_CARE:
+                discardDepthStencil = true;
+                ++g_attachmentOpsStatistics.discardedOnLoadAttachmentsCount;
+                break;
+            default:
+                ++g_attachmentOpsStatistics.loadedAttachmentsCount;
+                break;
+        }
+    }
+
+    m_pFrameBuffer->Invalidate(discardedColorAttachmentsMask, discardDepthStencil);
+}
+
+
+void Pipeline::EndRenderPass() noexcept
+{
+    ENG_ASSERT(IsValid(), "Pipeline is invalid");
+
+    uint32_t discardedColorAttachmentsMask = 0;
+
+    for (uint32_t colorAttachmentIdx = 0; colorAttachmentIdx < m_pFrameBuffer->GetColorAttachmentsCount(); ++colorAttachmentIdx) {
+        const CompressedColorAttachmentState& state = m_frameBufferColorAttachmentStates[colorAttachmentIdx];
+
+        if (state.blendState.storeOp == uint32_t(AttachmentStoreOp::STORE_OP_DONT_CARE)) {
+            discardedColorAttachmentsMask |= 1u << colorAttachmentIdx;
+            ++g_attachmentOpsStatistics.discardedOnStoreAttachmentsCount;
+        } else {
+            ++g_attachmentOpsStatistics.storedAttachmentsCount;
+        }
+    }
+
+    bool discardDepthStencil = false;
 
-        m_pFrameBuffer->ClearColor(colorAttachmentIdx, r, g, b, a);
+    if (m_pFrameBuffer->HasDepthAttachment() || m_pFrameBuffer->HasStencilAttachment()) {
+        discardDepthStencil = m_compressedGlobalState.depthStencilStoreOp == uint64_t(AttachmentStoreOp::STORE_OP_DONT_CARE);
+
+        if (discardDepthStencil) {
+            ++g_attachmentOpsStatistics.discardedOnStoreAttachmentsCount;
+        } else {
+            ++g_attachmentOpsStatistics.storedAttachmentsCount;
+        }
     }
 
-    m_pFrameBuffer->ClearDepthStencil(m_depthClearValue, m_stencilClearValue);
+    m_pFrameBuffer->Invalidate(discardedColorAttachmentsMask, discardDepthStencil);
 }
 
 
@@ -311,12 +380,12 @@ void Pipeline::Bind() noexcept
     const CompressedGlobalState& state = m_compressedGlobalState;
 
     const GLenum frontFace = state.frontFace == uint64_t(FrontFace::FRONT_FACE_CLOCKWISE) ? GL_CW : GL_CCW;
-    glFrontFace(frontFace);
+    engOpenGLFrontFace(frontFace);
 
     SetupFaceCulling(static_cast<CullMode>(state.cullMode));
 
     if (state.polygonMode == uint64_t(PolygonMode::POLYGON_MODE_LINE)) {
-        glLineWidth(m_lineWidth);
+        engOpenGLLineWidth(m_lineWidth);
     }
 }
 
@@ -400,10 +469,10 @@ void Pipeline::SetupColorAttachments() noexcept
         const GLboolean bMask = (blendState.colorWriteMask & ColorComponentFlags::COLOR_COMPONENT_B_BIT) != 0 ? GL_TRUE : GL_FALSE;
         const GLboolean aMask = (blendState.colorWriteMask & ColorComponentFlags::COLOR_COMPONENT_A_BIT) != 0 ? GL_TRUE : GL_FALSE;
 
-        glColorMaski(index, rMask, gMask, bMask, aMask);
+        engOpenGLColorMaskIndexed(index, rMask, gMask, bMask, aMask);
 
         if (blendState.blendEnable) {
-            glEnablei(GL_BLEND, index);
+            engOpenGLSetCapabilityEnabledIndexed(GL_BLEND, index, true);
 
             const GLenum srcRGBBlendFactor = CompressedBlendFactorToGLEnum(blendState.srcRGBBlendFactor);
             const GLenum dstRGBBlendFactor = CompressedBlendFactorToGLEnum(blendState.dstRGBBlendFactor);
@@ -413,8 +482,8 @@ void Pipeline::SetupColorAttachments() noexcept
             const GLenum rgbBlendOp = CompressedBlendOpToGLEnum(blendState.rgbBlendOp);
             const GLenum alphaBlendOp = CompressedBlendOpToGLEnum(blendState.alphaBlendOp);
 
-            glBlendEquationSeparatei(index, rgbBlendOp, alphaBlendOp);
-            glBlendFuncSeparatei(index, srcRGBBlendFactor, dstRGBBlendFactor, srcAlphaBlendFactor, dstAlphaBlendFactor);
+            engOpenGLBlendEquationSeparateIndexed(index, rgbBlendOp, alphaBlendOp);
+            engOpenGLBlendFuncSeparateIndexed(index, srcRGBBlendFactor, dstRGBBlendFactor, srcAlphaBlendFactor, dstAlphaBlendFactor);
 
             isAnyBlendFactorConstant = isAnyBlendFactorConstant
                 || IsBlendFactorConstant(srcRGBBlendFactor)
@@ -422,7 +491,7 @@ void Pipeline::SetupColorAttachments() noexcept
                 || IsBlendFactorConstant(srcAlphaBlendFactor)
                 || IsBlendFactorConstant(dstAlphaBlendFactor);
         } else {
-            glDisablei(GL_BLEND, index);
+            engOpenGLSetCapabilityEnabledIndexed(GL_BLEND, index, false);
         }
     }
 
@@ -431,15 +500,15 @@ void Pipeline::SetupColorAttachments() noexcept
     const float blendConstBlue = m_blendConstants[2] * isAnyBlendFactorConstant;
     const float blendConstAlpha = m_blendConstants[3] * isAnyBlendFactorConstant;
 
-    glBlendColor(blendConstRed, blendConstGreen, blendConstBlue, blendConstAlpha);
+    engOpenGLBlendColor(blendConstRed, blendConstGreen, blendConstBlue, blendConstAlpha);
 
     if (m_compressedGlobalState.colorBlendLogicOpEnable) {
-        glEnable(GL_COLOR_LOGIC_OP);
+        engOpenGLSetCapabilityEnabled(GL_COLOR_LOGIC_OP, true);
 
         const GLenum colorLogicOp = CompressedLogicOpToGLEnum(m_compressedGlobalState.colorBlendLogicOp);
-        glLogicOp(colorLogicOp);
+        engOpenGLLogicOp(colorLogicOp);
     } else {
-        glDisable(GL_COLOR_LOGIC_OP);
+        engOpenGLSetCapabilityEnabled(GL_COLOR_LOGIC_OP, false);
     }
 
     std::array<GLenum, FrameBuffer::GetMaxColorAttachmentsCount()> drawColorBuffers = { GL_NONE };
@@ -456,21 +525,21 @@ void Pipeline::SetupDepthTesting() noexcept
     const CompressedGlobalState& state = m_compressedGlobalState;
 
     if (state.depthTestEnable) {
-        glEnable(GL_DEPTH_TEST);
+        engOpenGLSetCapabilityEnabled(GL_DEPTH_TEST, true);
 
         if (state.depthWriteEnable) {
-            glDepthMask(GL_TRUE);
+            engOpenGLDepthMask(GL_TRUE);
 
             const PolygonMode polygonMode = static_cast<PolygonMode>(state.polygonMode);
             SetupPolygonOffset(polygonMode, m_depthBiasConstantFactor, m_depthBiasSlopeFactor, m_depthBiasClamp, state.depthBiasEnabled);
 
             const GLenum depthCompareFunc = CompressedCompareFuncToGLEnum(state.depthCompareFunc);
-            glDepthFunc(depthCompareFunc);
+            engOpenGLDepthFunc(depthCompareFunc);
         } else {
-            glDepthMask(GL_FALSE);
+            engOpenGLDepthMask(GL_FALSE);
         }
     } else {
-        glDisable(GL_DEPTH_TEST);
+        engOpenGLSetCapabilityEnabled(GL_DEPTH_TEST, false);
     }
 }
 
@@ -478,7 +547,7 @@ void Pipeline::SetupDepthTesting() noexcept
 void Pipeline::SetupStencilTesting() noexcept
 {
     if (m_compressedGlobalState.stencilTestEnable) {
-        glEnable(GL_STENCIL_TEST);
+        engOpenGLSetCapabilityEnabled(GL_STENCIL_TEST, true);
 
         SetupFaceStencilTesting(
             GL_FRONT, 
@@ -496,7 +565,7 @@ void Pipeline::SetupStencilTesting() noexcept
             m_compressedGlobalState.backFaceStencilPassDepthPassOp, 
             m_compressedGlobalState.stencilBackWriteEnable);
     } else {
-        glDisable(GL_STENCIL_TEST);
+        engOpenGLSetCapabilityEnabled(GL_STENCIL_TEST, false);
     }
 }
 
@@ -518,11 +587,12 @@ bool Pipeline::Create(const PipelineCreateInfo &createInfo) noexcept
     const FrameBufferClearValues& frameBufferClearValues = *createInfo.pFrameBufferClearValues;
     const ColorBlendStateCreateInfo& colorBlendState = *createInfo.pColorBlendState;
 
-    ENG_ASSERT(frameBufferClearValues.pColorAttachmentClearColors, "frameBufferClearValues.pColorAttachmentClearColors is nullptr");
-    ENG_ASSERT(colorBlendState.pAttachmentStates, "colorBlendState.pAttachmentStates is nullptr");
-
     const uint32_t frameBufferColorAttachmentsCount = createInfo.pFrameBuffer->GetColorAttachmentsCount();
 
+    // Depth only frame buffers have no color attachments states
+    ENG_ASSERT(frameBufferClearValues.pColorAttachmentClearColors || frameBufferColorAttachmentsCount == 0, "frameBufferClearValues.pColorAttachmentClearColors is nullptr");
+    ENG_ASSERT(colorBlendState.pAttachmentStates || frameBufferColorAttachmentsCount == 0, "colorBlendState.pAttachmentStates is nullptr");
+
     ENG_ASSERT(frameBufferClearValues.colorAttachmentsCount == frameBufferColorAttachmentsCount &&
         colorBlendState.attachmentCount == frameBufferColorAttachmentsCount, "Clear colors count must be equal to blend states count and equal to frame buffer color attachments count");
     
@@ -551,11 +621,33 @@ bool Pipeline::Create(const PipelineCreateInfo &createInfo) noexcept
         internalBlendState.dstAlphaBlendFactor = static_cast<uint32_t>(inputBlendState.dstAlphaBlendFactor);
         internalBlendState.alphaBlendOp        = static_cast<uint32_t>(inputBlendState.alphaBlendOp);
         internalBlendState.blendEnable         = inputBlendState.blendEnable;
+        internalBlendState.loadOp              = static_cast<uint32_t>(AttachmentLoadOp::LOAD_OP_CLEAR);
+        internalBlendState.storeOp             = static_cast<uint32_t>(AttachmentStoreOp::STORE_OP_STORE);
     }
 
     m_depthClearValue = frameBufferClearValues.depthClearValue;
     m_stencilClearValue = frameBufferClearValues.stencilClearValue;
 
+    m_compressedGlobalState.depthStencilLoadOp = static_cast<uint32_t>(AttachmentLoadOp::LOAD_OP_CLEAR);
+    m_compressedGlobalState.depthStencilStoreOp = static_cast<uint32_t>(AttachmentStoreOp::STORE_OP_STORE);
+
+    if (createInfo.pFrameBufferAttachmentOps) {
+        const FrameBufferAttachmentOps& attachmentOps = *createInfo.pFrameBufferAttachmentOps;
+
+        ENG_ASSERT(attachmentOps.pColorAttachmentLoadOps || frameBufferColorAttachmentsCount == 0, "attachmentOps.pColorAttachmentLoadOps is nullptr");
+        ENG_ASSERT(attachmentOps.pColorAttachmentStoreOps || frameBufferColorAttachmentsCount == 0, "attachmentOps.pColorAttachmentStoreOps is nullptr");
+        ENG_ASSERT(attachmentOps.colorAttachmentsCount == frameBufferColorAttachmentsCount, "Attachment ops count must be equal to frame buffer color attachments count");
+
+        for (size_t index = 0; index < frameBufferColorAttachmentsCount; ++index) {
+            CompressedColorAttachmentBlendState& internalBlendState = m_frameBufferColorAttachmentStates[index].blendState;
+            internalBlendState.loadOp  = static_cast<uint32_t>(attachmentOps.pColorAttachmentLoadOps[index]);
+            internalBlendState.storeOp = static_cast<uint32_t>(attachmentOps.pColorAttachmentStoreOps[index]);
+        }
+
+        m_compressedGlobalState.depthStencilLoadOp = static_cast<uint32_t>(attachmentOps.depthStencilLoadOp);
+        m_compressedGlobalState.depthStencilStoreOp = static_cast<uint32_t>(attachmentOps.depthStencilStoreOp);
+    }
+
     const InputAssemblyStateCreateInfo& inputAssemblyState = *createInfo.pInputAssemblyState;
     m_compressedGlobalState.primitiveTopology = static_cast<uint32_t>(inputAssemblyState.topology);
 
@@ -698,6 +790,18 @@ uint64_t amHash(const Pipeline &pipeline) noexcept
 }
 
 
+PipelineAttachmentOpsStatistics engGetPipelineAttachmentOpsStatistics() noexcept
+{
+    return g_attachmentOpsStatistics;
+}
+
+
+void engResetPipelineAttachmentOpsStatistics() noexcept
+{
+    g_attachmentOpsStatistics = {};
+}
+
+
 bool engInitPipelineManager() noexcept
 {
     if (engIsRenderPipelineInitialized()) {
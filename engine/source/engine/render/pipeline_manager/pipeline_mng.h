@@ -241,6 +241,48 @@ struct FrameBufferClearValues
 };
 
 
+enum class AttachmentLoadOp : uint32_t
+{
+    LOAD_OP_LOAD,       // Preserve contents written by previous passes
+    LOAD_OP_CLEAR,      // Clear with the pipeline clear value
+    LOAD_OP_DONT_CARE,  // Contents are undefined, the pass overwrites every pixel it reads
+
+    LOAD_OP_COUNT
+};
+
+
+enum class AttachmentStoreOp : uint32_t
+{
+    STORE_OP_STORE,      // Contents are read by the next passes
+    STORE_OP_DONT_CARE,  // Contents are discarded at the end of the pass
+
+    STORE_OP_COUNT
+};
+
+
+struct FrameBufferAttachmentOps
+{
+    const AttachmentLoadOp*  pColorAttachmentLoadOps;
+    const AttachmentStoreOp* pColorAttachmentStoreOps;
+    uint32_t                 colorAttachmentsCount;
+    AttachmentLoadOp         depthStencilLoadOp;
+    AttachmentStoreOp        depthStencilStoreOp;
+};
+
+
+// Attachments processed by pipelines render passes since the last reset
+struct PipelineAttachmentOpsStatistics
+{
+    uint32_t loadedAttachmentsCount;
+    uint32_t clearedAttachmentsCount;
+    uint32_t storedAttachmentsCount;
+
+    // Invalidated instead of being loaded or stored
+    uint32_t discardedOnLoadAttachmentsCount;
+    uint32_t discardedOnStoreAttachmentsCount;
+};
+
+
 struct PipelineCreateInfo
 {
     const InputAssemblyStateCreateInfo* pInputAssemblyState = nullptr;
@@ -248,6 +290,7 @@ struct PipelineCreateInfo
     const DepthStencilStateCreateInfo*  pDepthStencilState = nullptr;
     const ColorBlendStateCreateInfo*    pColorBlendState = nullptr;
     const FrameBufferClearValues*       pFrameBufferClearValues = nullptr;
+    const FrameBufferAttachmentOps*     pFrameBufferAttachmentOps = nullptr; // Attachments are cleared and stored if nullptr
     FrameBuffer*                        pFrameBuffer = nullptr;
     ShaderProgram*                      pShaderProgram = nullptr;
 };
@@ -273,7 +316,10 @@ public:
     bool Create(const PipelineCreateInfo& createInfo) noexcept;
     void Destroy();
 
-    void ClearFrameBuffer() noexcept;
+    // Apply attachments load and store ops. Load ops must be applied before any draw of the pass
+    void BeginRenderPass() noexcept;
+    void EndRenderPass() noexcept;
+
     void Bind() noexcept;
 
     uint64_t Hash() const noexcept;
@@ -283,6 +329,8 @@ public:
     const FrameBuffer& GetFrameBuffer() noexcept;
     const ShaderProgram& GetShaderProgram() noexcept;
 
+    PipelineID GetID() const noexcept { return m_ID; }
+
 private:
     void SetupColorAttachments() noexcept;
 
@@ -300,7 +348,9 @@ private:
         BITS_PER_CULL_MODE = 4,
         BITS_PER_DEPTH_COMPARE_FUNC = 4,
         BITS_PER_STENCIL_OP = 4,
-        BITS_PER_POLYGON_MODE = 2
+        BITS_PER_POLYGON_MODE = 2,
+        BITS_PER_ATTACHMENT_LOAD_OP = 2,
+        BITS_PER_ATTACHMENT_STORE_OP = 1
     };
 
     struct CompressedColorAttachmentBlendState
@@ -313,7 +363,9 @@ private:
         uint32_t rgbBlendOp : BITS_PER_COLOR_ATTACHMENT_BLEND_OP;
         uint32_t alphaBlendOp : BITS_PER_COLOR_ATTACHMENT_BLEND_OP;
         uint32_t blendEnable : 1;
-        uint32_t _PADDING : 5;
+        uint32_t loadOp : BITS_PER_ATTACHMENT_LOAD_OP;
+        uint32_t storeOp : BITS_PER_ATTACHMENT_STORE_OP;
+        uint32_t _PADDING : 2;
     };
 
     static_assert(sizeof(CompressedColorAttachmentBlendState) == sizeof(uint32_t));
@@ -339,7 +391,9 @@ private:
         uint64_t colorBlendLogicOpEnable : 1;
         uint64_t stencilFrontWriteEnable : 1;
         uint64_t stencilBackWriteEnable : 1;
-        uint64_t _PADDING : 13;
+        uint64_t depthStencilLoadOp : BITS_PER_ATTACHMENT_LOAD_OP;
+        uint64_t depthStencilStoreOp : BITS_PER_ATTACHMENT_STORE_OP;
+        uint64_t _PADDING : 10;
     };
 
     static_assert(sizeof(CompressedGlobalState) == sizeof(uint64_t));
@@ -428,6 +482,10 @@ private:
 uint64_t amHash(const Pipeline& pipeline) noexcept;
 
 
+PipelineAttachmentOpsStatistics engGetPipelineAttachmentOpsStatistics() noexcept;
+void engResetPipelineAttachmentOpsStatistics() noexcept;
+
+
 bool engInitPipelineManager() noexcept;
 void engTerminatePipelineManager() noexcept;
 bool engIsRenderPipelineInitialized() noexcept;
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "pch.h"
+#include "opengl_cmd_executor.h"
+
+#include "opengl_driver.h"
+
+#include "render/command_buffer/render_command_buffer.h"
+
+#include "render/pipeline_manager/pipeline_mng.h"
+#include "render/texture_manager/texture_mng.h"
+#include "render/mem_manager/buffer_manager.h"
+#include "render/mesh_manager/mesh_manager.h"
+
+#include "utils/debug/assertion.h"
+
+
+static GLenum GetMeshIndexTypeGL(const MeshObj& mesh) noexcept
+{
+    switch (mesh.GetGPUBufferData()->GetIndexBuffer().GetElementSize()) {
+        case sizeof(uint8_t): return GL_UNSIGNED_BYTE;
+        case sizeof(uint16_t): return GL_UNSIGNED_SHORT;
+        case sizeof(uint32_t): return GL_UNSIGNED_INT;
+        default:
+            ENG_ASSERT_GRAPHICS_API_FAIL("Invalid mesh \'{}\' index size", mesh.GetName().CStr());
+            return GL_NONE;
+    }
+}
+
+
+template <typename CommandType>
+static CommandType ReadCommand(const uint8_t* pPayload) noexcept
+{
+    CommandType command;
+    memcpy(&command, pPayload, sizeof(CommandType));
+    
+    return command;
+}
+
+
+static void ExecuteCommand(RenderCommandType type, const uint8_t* pPayload) noexcept
+{
+    switch (type) {
+        case RenderCommandType::BEGIN_RENDER_PASS:
+        {
+            const RenderCmdBeginRenderPass cmd = ReadCommand<RenderCmdBeginRenderPass>(pPayload);
+            cmd.pPipeline->BeginRenderPass();
+            break;
+        }
+        case RenderCommandType::END_RENDER_PASS:
+        {
+            const RenderCmdEndRenderPass cmd = ReadCommand<RenderCmdEndRenderPass>(pPayload);
+            cmd.pPipeline->EndRenderPass();
+            break;
+        }
+        case RenderCommandType::BIND_PIPELINE:
+        {
+            const RenderCmdBindPipeline cmd = ReadCommand<RenderCmdBindPipeline>(pPayload);
+            cmd.pPipeline->Bind();
+            break;
+        }
+        case RenderCommandType::BIND_TEXTURE:
+        {
+            const RenderCmdBindTexture cmd = ReadCommand<RenderCmdBindTexture>(pPayload);
+            
+            cmd.pTexture->Bind(cmd.unit);
+            
+            if (cmd.pSampler) {
+                cmd.pSampler->Bind(cmd.unit);
+            }
+            break;
+        }
+        case RenderCommandType::BIND_CONST_BUFFER:
+        {
+            const RenderCmdBindConstBuffer cmd = ReadCommand<RenderCmdBindConstBuffer>(pPayload);
+
+            if (cmd.size > 0) {
+                cmd.pBuffer->BindIndexedRange(cmd.binding, cmd.offset, cmd.size);
+            } else {
+                cmd.pBuffer->BindIndexed(cmd.binding);
+            }
+            break;
+        }
+        case RenderCommandType::DRAW:
+        {
+            const RenderCmdDraw cmd = ReadCommand<RenderCmdDraw>(pPayload);
+
+            if (cmd.pMesh) {
+                cmd.pMesh->Bind();
+            }
+
+            glDrawArraysInstancedBaseInstance(GL_TRIANGLES, static_cast<GLint>(cmd.firstVertex), static_cast<GLsizei>(cmd.vertexCount), 
+                static_cast<GLsizei>(cmd.instanceCount), cmd.baseInstance);
+            break;
+        }
+        case RenderCommandType::DRAW_INDEXED:
+        {
+            const RenderCmdDrawIndexed cmd = ReadCommand<RenderCmdDrawIndexed>(pPayload);
+            ENG_ASSERT_GRAPHICS_API(cmd.pMesh->IsValid(), "Invalid mesh \'{}\' in command buffer", cmd.pMesh->GetName().CStr());
+            
+            cmd.pMesh->Bind();
+
+            const uint64_t indexSize = cmd.pMesh->GetGPUBufferData()->GetIndexBuffer().GetElementSize();
+            const void* pIndicesOffset = reinterpret_cast<const void*>(static_cast<uintptr_t>(cmd.firstIndex * indexSize));
+
+            glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(cmd.indexCount), GetMeshIndexTypeGL(*cmd.pMesh), 
+                pIndicesOffset, static_cast<GLsizei>(cmd.instanceCount), cmd.baseVertex, cmd.baseInstance);
+            break;
+        }
+        case RenderCommandType::DRAW_INDEXED_INDIRECT:
+        {
+            const RenderCmdDrawIndexedIndirect cmd = ReadCommand<RenderCmdDrawIndexedIndirect>(pPayload);
+            ENG_ASSERT_GRAPHICS_API(cmd.pMesh->IsValid(), "Invalid mesh \'{}\' in command buffer", cmd.pMesh->GetName().CStr());
+            ENG_ASSERT_GRAPHICS_API(cmd.pArgsBuffer->IsIndirectArgsBuffer(), "Memory buffer \'{}\' is not indirect args buffer", 
+                cmd.pArgsBuffer->GetDebugName().CStr());
+
+            cmd.pMesh->Bind();
+            cmd.pArgsBuffer->Bind();
+
+            const void* pArgsOffset = reinterpret_cast<const void*>(static_cast<uintptr_t>(cmd.argsOffset));
+
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GetMeshIndexTypeGL(*cmd.pMesh), pArgsOffset, 
+                static_cast<GLsizei>(cmd.drawCount), sizeof(RenderDrawIndexedIndirectArgs));
+            break;
+        }
+        case RenderCommandType::DISPATCH:
+        {
+            const RenderCmdDispatch cmd = ReadCommand<RenderCmdDispatch>(pPayload);
+            glDispatchCompute(cmd.groupsCountX, cmd.groupsCountY, cmd.groupsCountZ);
+            break;
+        }
+        default:
+            ENG_ASSERT_GRAPHICS_API_FAIL("Invalid render command type: {}", static_cast<uint32_t>(type));
+            break;
+    }
+}
+
+
+void engOpenGLExecuteCommandPackets(const RenderCommandPacket* pPackets, size_t packetsCount) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(pPackets || packetsCount == 0, "pPackets is nullptr");
+
+    for (size_t i = 0; i < packetsCount; ++i) {
+        const RenderCommandPacket& packet = pPackets[i];
+
+        const uint8_t* pCommand = packet.pCommands;
+        const uint8_t* pPacketEnd = pCommand + packet.commandsSize;
+
+        while (pCommand < pPacketEnd) {
+            const RenderCommandHeader header = ReadCommand<RenderCommandHeader>(pCommand);
+            const uint8_t* pPayload = pCommand + RenderCommandBuffer::COMMAND_ALIGNMENT;
+            
+            ExecuteCommand(header.type, pPayload);
+            
+            pCommand = pPayload + header.size;
+        }
+    }
+}
+
+
+void engOpenGLExecuteCommandBuffer(const RenderCommandBuffer& cmdBuffer) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(!cmdBuffer.IsRecordingPacket(), "Executing command buffer while packet is being recorded");
+
+    const std::vector<RenderCommandPacket>& packets = cmdBuffer.GetPackets();
+    engOpenGLExecuteCommandPackets(packets.data(), packets.size());
+}
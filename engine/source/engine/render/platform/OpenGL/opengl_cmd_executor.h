@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+
+class RenderCommandBuffer;
+struct RenderCommandPacket;
+
+
+// Executes packets in their current order. Must be called by graphics context owner
+void engOpenGLExecuteCommandPackets(const RenderCommandPacket* pPackets, size_t packetsCount) noexcept;
+void engOpenGLExecuteCommandBuffer(const RenderCommandBuffer& cmdBuffer) noexcept;
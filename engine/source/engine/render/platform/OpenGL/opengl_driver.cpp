@@ -98,6 +98,8 @@ struct OpenGLGlobalInfo
     int32_t minViewportBoundRange;
     int32_t maxViewportBoundRange;
     int32_t maxElementIndex;
+    int32_t uniformBufferOffsetAlignment;
+    int32_t shaderStorageBufferOffsetAlignment;
 
     const char* pVendorName;
     const char* pRendererName;
@@ -110,6 +112,165 @@ static OpenGLGlobalInfo g_globalInfo = {};
 static bool g_isInitialized = false;
 
 
+static constexpr uint32_t CACHED_TEXTURE_UNITS_COUNT = 32;
+static constexpr uint32_t CACHED_BUFFER_BINDINGS_COUNT = 64;
+static constexpr uint32_t CACHED_DRAW_BUFFERS_COUNT = 8;
+
+// Marks cached value as unknown, so the next call is always issued
+static constexpr GLuint UNKNOWN_STATE = UINT32_MAX;
+
+
+struct OpenGLBlendState
+{
+    GLenum rgbMode;
+    GLenum alphaMode;
+    GLenum srcRGB;
+    GLenum dstRGB;
+    GLenum srcAlpha;
+    GLenum dstAlpha;
+    GLuint colorMask;
+    GLuint isEnabled;
+};
+
+
+struct OpenGLStencilFaceState
+{
+    GLuint mask;
+    GLenum stencilFail;
+    GLenum depthFail;
+    GLenum depthPass;
+};
+
+
+struct OpenGLCapabilityState
+{
+    GLenum capability;
+    GLuint isEnabled;
+};
+
+
+struct OpenGLBufferTargetState
+{
+    GLenum target;
+    GLuint buffer;
+};
+
+
+// Whole buffer bindings are stored with zero size
+struct OpenGLIndexedBufferBinding
+{
+    GLuint     buffer;
+    GLintptr   offset;
+    GLsizeiptr size;
+
+    bool operator==(const OpenGLIndexedBufferBinding& other) const noexcept
+    {
+        return buffer == other.buffer && offset == other.offset && size == other.size;
+    }
+};
+
+
+struct OpenGLStateCache
+{
+    std::array<GLuint, CACHED_TEXTURE_UNITS_COUNT> textureUnits;
+    std::array<GLuint, CACHED_TEXTURE_UNITS_COUNT> samplerUnits;
+
+    std::array<OpenGLIndexedBufferBinding, CACHED_BUFFER_BINDINGS_COUNT> uniformBufferBindings;
+    std::array<OpenGLIndexedBufferBinding, CACHED_BUFFER_BINDINGS_COUNT> storageBufferBindings;
+
+    // GL_ELEMENT_ARRAY_BUFFER is a part of VAO state, so it's never cached
+    std::array<OpenGLBufferTargetState, 8> bufferTargets = {
+        OpenGLBufferTargetState { GL_ARRAY_BUFFER, UNKNOWN_STATE },
+        OpenGLBufferTargetState { GL_UNIFORM_BUFFER, UNKNOWN_STATE },
+        OpenGLBufferTargetState { GL_SHADER_STORAGE_BUFFER, UNKNOWN_STATE },
+        OpenGLBufferTargetState { GL_DRAW_INDIRECT_BUFFER, UNKNOWN_STATE },
+        OpenGLBufferTargetState { GL_DISPATCH_INDIRECT_BUFFER, UNKNOWN_STATE },
+        OpenGLBufferTargetState { GL_PIXEL_UNPACK_BUFFER, UNKNOWN_STATE },
+        OpenGLBufferTargetState { GL_COPY_READ_BUFFER, UNKNOWN_STATE },
+        OpenGLBufferTargetState { GL_COPY_WRITE_BUFFER, UNKNOWN_STATE },
+    };
+
+    std::array<OpenGLCapabilityState, 9> capabilities = {
+        OpenGLCapabilityState { GL_DEPTH_TEST, UNKNOWN_STATE },
+        OpenGLCapabilityState { GL_STENCIL_TEST, UNKNOWN_STATE },
+        OpenGLCapabilityState { GL_CULL_FACE, UNKNOWN_STATE },
+        OpenGLCapabilityState { GL_COLOR_LOGIC_OP, UNKNOWN_STATE },
+        OpenGLCapabilityState { GL_POLYGON_OFFSET_FILL, UNKNOWN_STATE },
+        OpenGLCapabilityState { GL_POLYGON_OFFSET_LINE, UNKNOWN_STATE },
+        OpenGLCapabilityState { GL_POLYGON_OFFSET_POINT, UNKNOWN_STATE },
+        OpenGLCapabilityState { GL_SCISSOR_TEST, UNKNOWN_STATE },
+        OpenGLCapabilityState { GL_FRAMEBUFFER_SRGB, UNKNOWN_STATE },
+    };
+
+    std::array<OpenGLBlendState, CACHED_DRAW_BUFFERS_COUNT> blendStates;
+    std::array<OpenGLStencilFaceState, 2> stencilFaceStates;
+
+    std::array<GLfloat, 4> blendColor;
+    std::array<GLfloat, 3> polygonOffset;
+    std::array<GLint, 4> viewport;
+    std::array<GLint, 4> scissor;
+
+    GLuint program;
+    GLuint framebuffer;
+    GLuint vertexArray;
+
+    GLenum logicOp;
+    GLenum depthFunc;
+    GLenum cullFace;
+    GLenum frontFace;
+
+    GLuint depthMask;
+    
+    GLfloat lineWidth;
+};
+
+
+static OpenGLStateCache g_stateCache = {};
+static OpenGLStateCacheStatistics g_stateCacheStatistics = {};
+
+
+// Returns true if cached state was changed and the call must be issued
+template <typename T>
+static bool UpdateCachedState(T& cachedValue, const T& value) noexcept
+{
+    if (cachedValue == value) {
+        ++g_stateCacheStatistics.skippedCallsCount;
+        return false;
+    }
+
+    cachedValue = value;
+    ++g_stateCacheStatistics.issuedCallsCount;
+    
+    return true;
+}
+
+
+static void IssueUncachedCall() noexcept
+{
+    ++g_stateCacheStatistics.issuedCallsCount;
+}
+
+
+static OpenGLStencilFaceState* GetStencilFaceStates(GLenum face, size_t& count) noexcept
+{
+    switch (face) {
+        case GL_FRONT:
+            count = 1;
+            return &g_stateCache.stencilFaceStates[0];
+        case GL_BACK:
+            count = 1;
+            return &g_stateCache.stencilFaceStates[1];
+        case GL_FRONT_AND_BACK:
+            count = 2;
+            return &g_stateCache.stencilFaceStates[0];
+        default:
+            ENG_ASSERT_GRAPHICS_API_FAIL("Invalid stencil face: {}", face);
+            count = 0;
+            return nullptr;
+    }
+}
+
+
 #define CHECK_DRV_INIT() ENG_ASSERT(engIsOpenGLDriverInitialized(), "OpenGL is not intialized")
 
 
@@ -272,12 +433,17 @@ bool engInitOpenGLDriver() noexcept
     g_globalInfo.maxViewportBoundRange = bounds[1];
 
     glGetIntegerv(GL_MAX_ELEMENT_INDEX, &g_globalInfo.maxElementIndex);
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &g_globalInfo.uniformBufferOffsetAlignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &g_globalInfo.shaderStorageBufferOffsetAlignment);
 
     g_globalInfo.pVendorName = (const char*)glGetString(GL_VENDOR);
     g_globalInfo.pRendererName = (const char*)glGetString(GL_RENDERER);
     g_globalInfo.pHardwareVersionName = (const char*)glGetString(GL_VERSION);
     g_globalInfo.pShadingLanguageName = (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION);    
 
+    engInvalidateOpenGLStateCache();
+    engResetOpenGLStateCacheStatistics();
+
     g_isInitialized = true;
 
     return true;
@@ -907,6 +1073,20 @@ uint32_t engGetOpenGLMaxElementIndex() noexcept
 }
 
 
+uint32_t engGetOpenGLUniformBufferOffsetAlignment() noexcept
+{
+    CHECK_DRV_INIT();
+    return g_globalInfo.uniformBufferOffsetAlignment;
+}
+
+
+uint32_t engGetOpenGLShaderStorageBufferOffsetAlignment() noexcept
+{
+    CHECK_DRV_INIT();
+    return g_globalInfo.shaderStorageBufferOffsetAlignment;
+}
+
+
 const char* engGetOpenGLVendorName() noexcept
 {
     CHECK_DRV_INIT();
@@ -933,3 +1113,461 @@ const char* engGetOpenGLShadingLanguageName() noexcept
     CHECK_DRV_INIT();
     return g_globalInfo.pShadingLanguageName;
 }
+
+
+
+void engInvalidateOpenGLStateCache() noexcept
+{
+    g_stateCache.textureUnits.fill(UNKNOWN_STATE);
+    g_stateCache.samplerUnits.fill(UNKNOWN_STATE);
+    g_stateCache.uniformBufferBindings.fill(OpenGLIndexedBufferBinding { UNKNOWN_STATE, 0, 0 });
+    g_stateCache.storageBufferBindings.fill(OpenGLIndexedBufferBinding { UNKNOWN_STATE, 0, 0 });
+
+    for (OpenGLBufferTargetState& targetState : g_stateCache.bufferTargets) {
+        targetState.buffer = UNKNOWN_STATE;
+    }
+
+    for (OpenGLCapabilityState& capabilityState : g_stateCache.capabilities) {
+        capabilityState.isEnabled = UNKNOWN_STATE;
+    }
+
+    for (OpenGLBlendState& blendState : g_stateCache.blendStates) {
+        memset(&blendState, 0xFF, sizeof(blendState));
+    }
+
+    for (OpenGLStencilFaceState& stencilState : g_stateCache.stencilFaceStates) {
+        memset(&stencilState, 0xFF, sizeof(stencilState));
+    }
+
+    // NaN never compares equal, so float states are always reissued after invalidation
+    g_stateCache.blendColor.fill(std::numeric_limits<GLfloat>::quiet_NaN());
+    g_stateCache.polygonOffset.fill(std::numeric_limits<GLfloat>::quiet_NaN());
+    g_stateCache.lineWidth = std::numeric_limits<GLfloat>::quiet_NaN();
+    
+    g_stateCache.viewport.fill(-1);
+    g_stateCache.scissor.fill(-1);
+
+    g_stateCache.program = UNKNOWN_STATE;
+    g_stateCache.framebuffer = UNKNOWN_STATE;
+    g_stateCache.vertexArray = UNKNOWN_STATE;
+
+    g_stateCache.logicOp = UNKNOWN_STATE;
+    g_stateCache.depthFunc = UNKNOWN_STATE;
+    g_stateCache.cullFace = UNKNOWN_STATE;
+    g_stateCache.frontFace = UNKNOWN_STATE;
+
+    g_stateCache.depthMask = UNKNOWN_STATE;
+}
+
+
+void engOpenGLStateCacheForgetObject(OpenGLObjectType type, GLuint object) noexcept
+{
+    // Deleted objects are implicitly unbound by GL, while their names may be reused by newly created ones
+    const auto ForgetBinding = [object](GLuint& binding) {
+        if (binding == object) {
+            binding = UNKNOWN_STATE;
+        }
+    };
+
+    switch (type) {
+        case OpenGLObjectType::PROGRAM:
+            ForgetBinding(g_stateCache.program);
+            break;
+        case OpenGLObjectType::FRAMEBUFFER:
+            ForgetBinding(g_stateCache.framebuffer);
+            break;
+        case OpenGLObjectType::VERTEX_ARRAY:
+            ForgetBinding(g_stateCache.vertexArray);
+            break;
+        case OpenGLObjectType::TEXTURE:
+            std::for_each(g_stateCache.textureUnits.begin(), g_stateCache.textureUnits.end(), ForgetBinding);
+            break;
+        case OpenGLObjectType::SAMPLER:
+            std::for_each(g_stateCache.samplerUnits.begin(), g_stateCache.samplerUnits.end(), ForgetBinding);
+            break;
+        case OpenGLObjectType::BUFFER:
+            for (OpenGLIndexedBufferBinding& binding : g_stateCache.uniformBufferBindings) {
+                ForgetBinding(binding.buffer);
+            }
+
+            for (OpenGLIndexedBufferBinding& binding : g_stateCache.storageBufferBindings) {
+                ForgetBinding(binding.buffer);
+            }
+            
+            for (OpenGLBufferTargetState& targetState : g_stateCache.bufferTargets) {
+                ForgetBinding(targetState.buffer);
+            }
+            break;
+        default:
+            ENG_ASSERT_GRAPHICS_API_FAIL("Invalid OpenGL object type: {}", static_cast<uint32_t>(type));
+            break;
+    }
+}
+
+
+OpenGLStateCacheStatistics engGetOpenGLStateCacheStatistics() noexcept
+{
+    return g_stateCacheStatistics;
+}
+
+
+void engResetOpenGLStateCacheStatistics() noexcept
+{
+    g_stateCacheStatistics = {};
+}
+
+
+void engOpenGLUseProgram(GLuint program) noexcept
+{
+    if (UpdateCachedState(g_stateCache.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+
+void engOpenGLBindFramebuffer(GLuint framebuffer) noexcept
+{
+    if (UpdateCachedState(g_stateCache.framebuffer, framebuffer)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+
+void engOpenGLBindVertexArray(GLuint vertexArray) noexcept
+{
+    if (UpdateCachedState(g_stateCache.vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+
+void engOpenGLBindTextureUnit(GLuint unit, GLuint texture) noexcept
+{
+    if (unit >= CACHED_TEXTURE_UNITS_COUNT) {
+        IssueUncachedCall();
+        glBindTextureUnit(unit, texture);
+        return;
+    }
+
+    if (UpdateCachedState(g_stateCache.textureUnits[unit], texture)) {
+        glBindTextureUnit(unit, texture);
+    }
+}
+
+
+void engOpenGLBindSampler(GLuint unit, GLuint sampler) noexcept
+{
+    if (unit >= CACHED_TEXTURE_UNITS_COUNT) {
+        IssueUncachedCall();
+        glBindSampler(unit, sampler);
+        return;
+    }
+
+    if (UpdateCachedState(g_stateCache.samplerUnits[unit], sampler)) {
+        glBindSampler(unit, sampler);
+    }
+}
+
+
+void engOpenGLBindBuffer(GLenum target, GLuint buffer) noexcept
+{
+    for (OpenGLBufferTargetState& targetState : g_stateCache.bufferTargets) {
+        if (targetState.target == target) {
+            if (UpdateCachedState(targetState.buffer, buffer)) {
+                glBindBuffer(target, buffer);
+            }
+            
+            return;
+        }
+    }
+
+    IssueUncachedCall();
+    glBindBuffer(target, buffer);
+}
+
+
+static OpenGLIndexedBufferBinding* GetCachedIndexedBufferBinding(GLenum target, GLuint index) noexcept
+{
+    if (index >= CACHED_BUFFER_BINDINGS_COUNT) {
+        return nullptr;
+    }
+
+    switch (target) {
+        case GL_UNIFORM_BUFFER: return &g_stateCache.uniformBufferBindings[index];
+        case GL_SHADER_STORAGE_BUFFER: return &g_stateCache.storageBufferBindings[index];
+        default: return nullptr;
+    }
+}
+
+
+// Returns true if the indexed binding call must be issued
+static bool UpdateCachedIndexedBufferBinding(GLenum target, GLuint index, const OpenGLIndexedBufferBinding& binding) noexcept
+{
+    OpenGLIndexedBufferBinding* pCachedBinding = GetCachedIndexedBufferBinding(target, index);
+
+    if (pCachedBinding && !UpdateCachedState(*pCachedBinding, binding)) {
+        return false;
+    }
+
+    if (!pCachedBinding) {
+        IssueUncachedCall();
+    }
+
+    // Indexed binding also changes generic binding point of the target
+    for (OpenGLBufferTargetState& targetState : g_stateCache.bufferTargets) {
+        if (targetState.target == target) {
+            targetState.buffer = binding.buffer;
+            break;
+        }
+    }
+
+    return true;
+}
+
+
+void engOpenGLBindBufferBase(GLenum target, GLuint index, GLuint buffer) noexcept
+{
+    if (UpdateCachedIndexedBufferBinding(target, index, OpenGLIndexedBufferBinding { buffer, 0, 0 })) {
+        glBindBufferBase(target, index, buffer);
+    }
+}
+
+
+void engOpenGLBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) noexcept
+{
+    if (UpdateCachedIndexedBufferBinding(target, index, OpenGLIndexedBufferBinding { buffer, offset, size })) {
+        glBindBufferRange(target, index, buffer, offset, size);
+    }
+}
+
+
+void engOpenGLSetCapabilityEnabled(GLenum capability, bool enabled) noexcept
+{
+    if (capability == GL_BLEND) {
+        // Non indexed call changes blending for all draw buffers
+        IssueUncachedCall();
+        
+        for (OpenGLBlendState& blendState : g_stateCache.blendStates) {
+            blendState.isEnabled = enabled;
+        }
+    } else {
+        for (OpenGLCapabilityState& capabilityState : g_stateCache.capabilities) {
+            if (capabilityState.capability == capability) {
+                if (UpdateCachedState(capabilityState.isEnabled, GLuint(enabled))) {
+                    enabled ? glEnable(capability) : glDisable(capability);
+                }
+                
+                return;
+            }
+        }
+
+        IssueUncachedCall();
+    }
+
+    enabled ? glEnable(capability) : glDisable(capability);
+}
+
+
+void engOpenGLSetCapabilityEnabledIndexed(GLenum capability, GLuint index, bool enabled) noexcept
+{
+    if (capability == GL_BLEND && index < CACHED_DRAW_BUFFERS_COUNT) {
+        if (UpdateCachedState(g_stateCache.blendStates[index].isEnabled, GLuint(enabled))) {
+            enabled ? glEnablei(capability, index) : glDisablei(capability, index);
+        }
+
+        return;
+    }
+
+    IssueUncachedCall();
+    enabled ? glEnablei(capability, index) : glDisablei(capability, index);
+}
+
+
+void engOpenGLColorMaskIndexed(GLuint index, GLboolean r, GLboolean g, GLboolean b, GLboolean a) noexcept
+{
+    if (index >= CACHED_DRAW_BUFFERS_COUNT) {
+        IssueUncachedCall();
+        glColorMaski(index, r, g, b, a);
+        return;
+    }
+
+    const GLuint mask = GLuint(r != GL_FALSE) | (GLuint(g != GL_FALSE) << 1) | (GLuint(b != GL_FALSE) << 2) | (GLuint(a != GL_FALSE) << 3);
+
+    if (UpdateCachedState(g_stateCache.blendStates[index].colorMask, mask)) {
+        glColorMaski(index, r, g, b, a);
+    }
+}
+
+
+void engOpenGLBlendEquationSeparateIndexed(GLuint index, GLenum rgbMode, GLenum alphaMode) noexcept
+{
+    if (index >= CACHED_DRAW_BUFFERS_COUNT) {
+        IssueUncachedCall();
+        glBlendEquationSeparatei(index, rgbMode, alphaMode);
+        return;
+    }
+
+    OpenGLBlendState& state = g_stateCache.blendStates[index];
+
+    if (state.rgbMode == rgbMode && state.alphaMode == alphaMode) {
+        ++g_stateCacheStatistics.skippedCallsCount;
+        return;
+    }
+
+    state.rgbMode = rgbMode;
+    state.alphaMode = alphaMode;
+
+    IssueUncachedCall();
+    glBlendEquationSeparatei(index, rgbMode, alphaMode);
+}
+
+
+void engOpenGLBlendFuncSeparateIndexed(GLuint index, GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) noexcept
+{
+    if (index >= CACHED_DRAW_BUFFERS_COUNT) {
+        IssueUncachedCall();
+        glBlendFuncSeparatei(index, srcRGB, dstRGB, srcAlpha, dstAlpha);
+        return;
+    }
+
+    OpenGLBlendState& state = g_stateCache.blendStates[index];
+
+    if (state.srcRGB == srcRGB && state.dstRGB == dstRGB && state.srcAlpha == srcAlpha && state.dstAlpha == dstAlpha) {
+        ++g_stateCacheStatistics.skippedCallsCount;
+        return;
+    }
+
+    state.srcRGB = srcRGB;
+    state.dstRGB = dstRGB;
+    state.srcAlpha = srcAlpha;
+    state.dstAlpha = dstAlpha;
+
+    IssueUncachedCall();
+    glBlendFuncSeparatei(index, srcRGB, dstRGB, srcAlpha, dstAlpha);
+}
+
+
+void engOpenGLBlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) noexcept
+{
+    if (UpdateCachedState(g_stateCache.blendColor, std::array<GLfloat, 4> { r, g, b, a })) {
+        glBlendColor(r, g, b, a);
+    }
+}
+
+
+void engOpenGLLogicOp(GLenum op) noexcept
+{
+    if (UpdateCachedState(g_stateCache.logicOp, op)) {
+        glLogicOp(op);
+    }
+}
+
+
+void engOpenGLDepthMask(GLboolean enabled) noexcept
+{
+    if (UpdateCachedState(g_stateCache.depthMask, GLuint(enabled != GL_FALSE))) {
+        glDepthMask(enabled);
+    }
+}
+
+
+void engOpenGLDepthFunc(GLenum func) noexcept
+{
+    if (UpdateCachedState(g_stateCache.depthFunc, func)) {
+        glDepthFunc(func);
+    }
+}
+
+
+void engOpenGLPolygonOffsetClamp(GLfloat factor, GLfloat units, GLfloat clamp) noexcept
+{
+    if (UpdateCachedState(g_stateCache.polygonOffset, std::array<GLfloat, 3> { factor, units, clamp })) {
+        glPolygonOffsetClamp(factor, units, clamp);
+    }
+}
+
+
+void engOpenGLStencilMaskSeparate(GLenum face, GLuint mask) noexcept
+{
+    size_t facesCount = 0;
+    OpenGLStencilFaceState* pStates = GetStencilFaceStates(face, facesCount);
+
+    bool isChanged = false;
+    for (size_t i = 0; i < facesCount; ++i) {
+        isChanged = isChanged || pStates[i].mask != mask;
+        pStates[i].mask = mask;
+    }
+
+    if (!isChanged) {
+        ++g_stateCacheStatistics.skippedCallsCount;
+        return;
+    }
+
+    IssueUncachedCall();
+    glStencilMaskSeparate(face, mask);
+}
+
+
+void engOpenGLStencilOpSeparate(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass) noexcept
+{
+    size_t facesCount = 0;
+    OpenGLStencilFaceState* pStates = GetStencilFaceStates(face, facesCount);
+
+    bool isChanged = false;
+    for (size_t i = 0; i < facesCount; ++i) {
+        OpenGLStencilFaceState& state = pStates[i];
+        isChanged = isChanged || state.stencilFail != stencilFail || state.depthFail != depthFail || state.depthPass != depthPass;
+        
+        state.stencilFail = stencilFail;
+        state.depthFail = depthFail;
+        state.depthPass = depthPass;
+    }
+
+    if (!isChanged) {
+        ++g_stateCacheStatistics.skippedCallsCount;
+        return;
+    }
+
+    IssueUncachedCall();
+    glStencilOpSeparate(face, stencilFail, depthFail, depthPass);
+}
+
+
+void engOpenGLCullFace(GLenum mode) noexcept
+{
+    if (UpdateCachedState(g_stateCache.cullFace, mode)) {
+        glCullFace(mode);
+    }
+}
+
+
+void engOpenGLFrontFace(GLenum mode) noexcept
+{
+    if (UpdateCachedState(g_stateCache.frontFace, mode)) {
+        glFrontFace(mode);
+    }
+}
+
+
+void engOpenGLLineWidth(GLfloat width) noexcept
+{
+    if (UpdateCachedState(g_stateCache.lineWidth, width)) {
+        glLineWidth(width);
+    }
+}
+
+
+void engOpenGLViewport(GLint x, GLint y, GLsizei width, GLsizei height) noexcept
+{
+    if (UpdateCachedState(g_stateCache.viewport, std::array<GLint, 4> { x, y, width, height })) {
+        glViewport(x, y, width, height);
+    }
+}
+
+
+void engOpenGLScissor(GLint x, GLint y, GLsizei width, GLsizei height) noexcept
+{
+    if (UpdateCachedState(g_stateCache.scissor, std::array<GLint, 4> { x, y, width, height })) {
+        glScissor(x, y, width, height);
+    }
+}
\ No newline at end of file
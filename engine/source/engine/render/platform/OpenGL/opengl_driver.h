@@ -269,9 +269,75 @@ void engGetOpenGLViewportBoundsRange(int32_t& min, int32_t& max) noexcept;
 // Returns the maximum index that may be specified during the transfer of generic vertex attributes to the GL.
 uint32_t engGetOpenGLMaxElementIndex() noexcept;
 
+// Returns the minimum required alignment of offsets passed to glBindBufferRange for uniform and shader storage buffers.
+uint32_t engGetOpenGLUniformBufferOffsetAlignment() noexcept;
+uint32_t engGetOpenGLShaderStorageBufferOffsetAlignment() noexcept;
+
 const char* engGetOpenGLVendorName() noexcept;
 const char* engGetOpenGLRendererName() noexcept;
 const char* engGetOpenGLHardwareVersionName() noexcept;
 const char* engGetOpenGLShadingLanguageName() noexcept;
 
+
+// State cache. Shadows current context bindings and fixed function state and skips calls which don't change anything.
+// Must be used only on the thread which owns the context. Any direct GL call changing cached state must be followed by
+// engInvalidateOpenGLStateCache(), deleted objects must be reported via engOpenGLStateCacheForgetObject()
+
+struct OpenGLStateCacheStatistics
+{
+    uint32_t issuedCallsCount;
+    uint32_t skippedCallsCount;
+};
+
+
+enum class OpenGLObjectType : uint8_t
+{
+    PROGRAM,
+    FRAMEBUFFER,
+    VERTEX_ARRAY,
+    TEXTURE,
+    SAMPLER,
+    BUFFER,
+};
+
+
+void engInvalidateOpenGLStateCache() noexcept;
+void engOpenGLStateCacheForgetObject(OpenGLObjectType type, GLuint object) noexcept;
+
+// Statistics are accumulated since the last reset. Render system resets them every frame
+OpenGLStateCacheStatistics engGetOpenGLStateCacheStatistics() noexcept;
+void engResetOpenGLStateCacheStatistics() noexcept;
+
+void engOpenGLUseProgram(GLuint program) noexcept;
+void engOpenGLBindFramebuffer(GLuint framebuffer) noexcept;
+void engOpenGLBindVertexArray(GLuint vertexArray) noexcept;
+void engOpenGLBindTextureUnit(GLuint unit, GLuint texture) noexcept;
+void engOpenGLBindSampler(GLuint unit, GLuint sampler) noexcept;
+void engOpenGLBindBuffer(GLenum target, GLuint buffer) noexcept;
+void engOpenGLBindBufferBase(GLenum target, GLuint index, GLuint buffer) noexcept;
+void engOpenGLBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) noexcept;
+
+void engOpenGLSetCapabilityEnabled(GLenum capability, bool enabled) noexcept;
+void engOpenGLSetCapabilityEnabledIndexed(GLenum capability, GLuint index, bool enabled) noexcept;
+
+void engOpenGLColorMaskIndexed(GLuint index, GLboolean r, GLboolean g, GLboolean b, GLboolean a) noexcept;
+void engOpenGLBlendEquationSeparateIndexed(GLuint index, GLenum rgbMode, GLenum alphaMode) noexcept;
+void engOpenGLBlendFuncSeparateIndexed(GLuint index, GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) noexcept;
+void engOpenGLBlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) noexcept;
+void engOpenGLLogicOp(GLenum op) noexcept;
+
+void engOpenGLDepthMask(GLboolean enabled) noexcept;
+void engOpenGLDepthFunc(GLenum func) noexcept;
+void engOpenGLPolygonOffsetClamp(GLfloat factor, GLfloat units, GLfloat clamp) noexcept;
+
+void engOpenGLStencilMaskSeparate(GLenum face, GLuint mask) noexcept;
+void engOpenGLStencilOpSeparate(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass) noexcept;
+
+void engOpenGLCullFace(GLenum mode) noexcept;
+void engOpenGLFrontFace(GLenum mode) noexcept;
+void engOpenGLLineWidth(GLfloat width) noexcept;
+
+void engOpenGLViewport(GLint x, GLint y, GLsizei width, GLsizei height) noexcept;
+void engOpenGLScissor(GLint x, GLint y, GLsizei width, GLsizei height) noexcept;
+
 #endif
\ No newline at end of file
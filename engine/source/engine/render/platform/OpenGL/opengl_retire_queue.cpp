@@ -0,0 +1,175 @@
+#include "pch.h"
+#include "opengl_retire_queue.h"
+
+#include "utils/debug/assertion.h"
+
+#include <deque>
+
+
+struct OpenGLRetiredObject
+{
+    GLuint           object;
+    OpenGLObjectType type;
+};
+
+
+struct OpenGLRetiredFrame
+{
+    GLsync fence;
+    std::vector<OpenGLRetiredObject> objects;
+};
+
+
+// Objects retired since the last fence
+static std::vector<OpenGLRetiredObject> g_pendingRetiredObjects;
+// Fenced frames in submission order, so the front one is always completed first
+static std::deque<OpenGLRetiredFrame> g_retiredFrames;
+// Storage of released frames reused to avoid per frame allocations
+static std::vector<std::vector<OpenGLRetiredObject>> g_freeRetiredObjectsStorage;
+
+static uint32_t g_retiredObjectsCount = 0;
+
+
+static void DeleteObjects(OpenGLObjectType type, const GLuint* pObjects, GLsizei count) noexcept
+{
+    switch (type) {
+        case OpenGLObjectType::PROGRAM:
+            for (GLsizei i = 0; i < count; ++i) {
+                glDeleteProgram(pObjects[i]);
+            }
+            break;
+        case OpenGLObjectType::FRAMEBUFFER:
+            glDeleteFramebuffers(count, pObjects);
+            break;
+        case OpenGLObjectType::VERTEX_ARRAY:
+            glDeleteVertexArrays(count, pObjects);
+            break;
+        case OpenGLObjectType::TEXTURE:
+            glDeleteTextures(count, pObjects);
+            break;
+        case OpenGLObjectType::SAMPLER:
+            glDeleteSamplers(count, pObjects);
+            break;
+        case OpenGLObjectType::BUFFER:
+            glDeleteBuffers(count, pObjects);
+            break;
+        default:
+            ENG_ASSERT_GRAPHICS_API_FAIL("Invalid OpenGL object type: {}", static_cast<uint32_t>(type));
+            break;
+    }
+}
+
+
+// Objects are grouped by type, so each group is deleted with a single call
+static void DeleteRetiredObjects(std::vector<OpenGLRetiredObject>& objects) noexcept
+{
+    std::sort(objects.begin(), objects.end(), [](const OpenGLRetiredObject& left, const OpenGLRetiredObject& right) {
+        return left.type < right.type;
+    });
+
+    static std::vector<GLuint> names;
+
+    for (size_t groupBegin = 0; groupBegin < objects.size();) {
+        const OpenGLObjectType type = objects[groupBegin].type;
+
+        names.clear();
+
+        size_t groupEnd = groupBegin;
+        for (; groupEnd < objects.size() && objects[groupEnd].type == type; ++groupEnd) {
+            names.emplace_back(objects[groupEnd].object);
+        }
+
+        DeleteObjects(type, names.data(), static_cast<GLsizei>(names.size()));
+
+        groupBegin = groupEnd;
+    }
+
+    g_retiredObjectsCount -= static_cast<uint32_t>(objects.size());
+
+    objects.clear();
+}
+
+
+static void ReleaseRetiredFrame() noexcept
+{
+    OpenGLRetiredFrame& frame = g_retiredFrames.front();
+
+    glDeleteSync(frame.fence);
+    DeleteRetiredObjects(frame.objects);
+
+    g_freeRetiredObjectsStorage.emplace_back(std::move(frame.objects));
+    g_retiredFrames.pop_front();
+}
+
+
+void engOpenGLRetireObject(OpenGLObjectType type, GLuint object) noexcept
+{
+    if (object == 0) {
+        return;
+    }
+
+    // Retired object is never bound again, so the state cache must not skip binding of anything else to its slots
+    engOpenGLStateCacheForgetObject(type, object);
+
+    g_pendingRetiredObjects.emplace_back(OpenGLRetiredObject { object, type });
+    ++g_retiredObjectsCount;
+}
+
+
+void engOpenGLFenceRetiredObjects() noexcept
+{
+    if (g_pendingRetiredObjects.empty()) {
+        return;
+    }
+
+    OpenGLRetiredFrame frame = {};
+    frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame.objects = std::move(g_pendingRetiredObjects);
+
+    g_retiredFrames.emplace_back(std::move(frame));
+
+    g_pendingRetiredObjects.clear();
+
+    if (!g_freeRetiredObjectsStorage.empty()) {
+        g_pendingRetiredObjects = std::move(g_freeRetiredObjectsStorage.back());
+        g_freeRetiredObjectsStorage.pop_back();
+    }
+}
+
+
+void engOpenGLReleaseCompletedRetiredObjects() noexcept
+{
+    while (!g_retiredFrames.empty()) {
+        const GLenum waitResult = glClientWaitSync(g_retiredFrames.front().fence, 0, 0);
+
+        if (waitResult == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+
+        ENG_ASSERT_GRAPHICS_API(waitResult != GL_WAIT_FAILED, "Failed to wait retired objects fence");
+
+        ReleaseRetiredFrame();
+    }
+}
+
+
+void engOpenGLReleaseAllRetiredObjects() noexcept
+{
+    engOpenGLFenceRetiredObjects();
+
+    if (!g_retiredFrames.empty()) {
+        glFinish();
+    }
+
+    while (!g_retiredFrames.empty()) {
+        ReleaseRetiredFrame();
+    }
+
+    g_freeRetiredObjectsStorage.clear();
+}
+
+
+uint32_t engGetOpenGLRetiredObjectsCount() noexcept
+{
+    return g_retiredObjectsCount;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "opengl_driver.h"
+
+
+// Objects GPU may still use are not deleted right away. They are tagged with the fence of the frame which retired them
+// and deleted in bulk once the fence is signaled. Must be called by graphics context owner
+void engOpenGLRetireObject(OpenGLObjectType type, GLuint object) noexcept;
+
+// Fences objects retired since the previous call. Called once per frame after its commands are submitted
+void engOpenGLFenceRetiredObjects() noexcept;
+// Deletes objects of frames completed by GPU, never waits
+void engOpenGLReleaseCompletedRetiredObjects() noexcept;
+// Waits for GPU and deletes all retired objects. Used on termination
+void engOpenGLReleaseAllRetiredObjects() noexcept;
+
+// Objects waiting for deletion
+uint32_t engGetOpenGLRetiredObjectsCount() noexcept;
@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "dynamic_resolution.h"
+
+#include "utils/debug/assertion.h"
+
+
+// Weight of the new measurement in the smoothed frame time
+static constexpr float FRAME_TIME_SMOOTHING = 0.2f;
+// Measurements of the current scale needed before the next decision
+static constexpr uint32_t MIN_SAMPLES_COUNT = 8;
+// Scale is kept while smoothed frame time is within this fraction of the target
+static constexpr float FRAME_TIME_DEAD_BAND = 0.05f;
+// Single spikes must not drop resolution at once
+static constexpr float MAX_SCALE_STEP = 0.1f;
+
+
+void DynamicResolutionController::Reset() noexcept
+{
+    m_scale = MAX_SCALE;
+    m_smoothedFrameTimeMs = 0.f;
+    m_samplesCount = 0;
+}
+
+
+void DynamicResolutionController::Update(float gpuFrameTimeMs, float measuredScale, float targetFrameTimeMs, float minScale) noexcept
+{
+    ENG_ASSERT(targetFrameTimeMs > 0.f, "Invalid dynamic resolution target frame time: {} ms", targetFrameTimeMs);
+    ENG_ASSERT(minScale > 0.f && minScale <= MAX_SCALE, "Invalid dynamic resolution min scale: {}", minScale);
+
+    if (measuredScale != m_scale || gpuFrameTimeMs <= 0.f) {
+        return;
+    }
+
+    m_smoothedFrameTimeMs = m_samplesCount == 0 ? gpuFrameTimeMs :
+        m_smoothedFrameTimeMs + FRAME_TIME_SMOOTHING * (gpuFrameTimeMs - m_smoothedFrameTimeMs);
+
+    if (++m_samplesCount < MIN_SAMPLES_COUNT) {
+        return;
+    }
+
+    if (std::abs(m_smoothedFrameTimeMs / targetFrameTimeMs - 1.f) < FRAME_TIME_DEAD_BAND) {
+        return;
+    }
+
+    const float desiredScale = m_scale * std::sqrt(targetFrameTimeMs / m_smoothedFrameTimeMs);
+    const float scale = std::clamp(std::clamp(desiredScale, m_scale - MAX_SCALE_STEP, m_scale + MAX_SCALE_STEP), minScale, MAX_SCALE);
+
+    // Already at the limit
+    if (scale == m_scale) {
+        return;
+    }
+
+    m_scale = scale;
+    m_samplesCount = 0;
+}
+
+
+uint32_t engGetScaledResolution(uint32_t size, float scale) noexcept
+{
+    return std::clamp(static_cast<uint32_t>(size * scale + 0.5f), 1u, std::max(size, 1u));
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Picks internal resolution scale from measured GPU frame time. GPU cost is assumed to follow shaded pixels count,
+// so scale is changed by square root of target to measured time ratio. Measurements come a few frames late,
+// so the ones taken at another scale are dropped and scale is kept while smoothed time is within a dead band around the target
+class DynamicResolutionController
+{
+public:
+    static inline constexpr float MAX_SCALE = 1.f;
+
+public:
+    void Reset() noexcept;
+
+    // measuredScale is the scale of the frame the measurement was taken in
+    void Update(float gpuFrameTimeMs, float measuredScale, float targetFrameTimeMs, float minScale) noexcept;
+
+    float GetScale() const noexcept { return m_scale; }
+
+private:
+    float m_scale = MAX_SCALE;
+    float m_smoothedFrameTimeMs = 0.f;
+    uint32_t m_samplesCount = 0;
+};
+
+
+// Scaled render target size, never zero
+uint32_t engGetScaledResolution(uint32_t size, float scale) noexcept;
@@ -0,0 +1,103 @@
+#include "pch.h"
+#include "frame_packet.h"
+
+#include "utils/debug/assertion.h"
+
+
+FramePacketQueue::FramePacketQueue()
+{
+    for (size_t i = 0; i < MAX_PACKETS_IN_FLIGHT; ++i) {
+        m_freePackets[i] = &m_packetsStorage[i];
+    }
+
+    m_freePacketsCount = MAX_PACKETS_IN_FLIGHT;
+}
+
+
+FramePacket* FramePacketQueue::AcquireFreePacket() noexcept
+{
+    std::unique_lock lock(m_mutex);
+    m_freePacketCV.wait(lock, [this]() { return m_isStopped || m_freePacketsCount > 0; });
+
+    if (m_isStopped) {
+        return nullptr;
+    }
+
+    return m_freePackets[--m_freePacketsCount];
+}
+
+
+void FramePacketQueue::SubmitPacket(FramePacket* pPacket) noexcept
+{
+    ENG_ASSERT(pPacket, "pPacket is nullptr");
+
+    {
+        std::scoped_lock lock(m_mutex);
+        ENG_ASSERT(m_submittedPacketsCount < MAX_PACKETS_IN_FLIGHT, "Frame packets queue overflow");
+
+        const size_t tail = (m_submittedPacketsHead + m_submittedPacketsCount) % MAX_PACKETS_IN_FLIGHT;
+        m_submittedPackets[tail] = pPacket;
+        ++m_submittedPacketsCount;
+    }
+
+    m_submittedPacketCV.notify_one();
+}
+
+
+FramePacket* FramePacketQueue::AcquireSubmittedPacket() noexcept
+{
+    std::unique_lock lock(m_mutex);
+    m_submittedPacketCV.wait(lock, [this]() { return m_isStopped || m_submittedPacketsCount > 0; });
+
+    if (m_submittedPacketsCount == 0) {
+        return nullptr;
+    }
+
+    FramePacket* pPacket = m_submittedPackets[m_submittedPacketsHead];
+
+    m_submittedPacketsHead = (m_submittedPacketsHead + 1) % MAX_PACKETS_IN_FLIGHT;
+    --m_submittedPacketsCount;
+
+    return pPacket;
+}
+
+
+void FramePacketQueue::ReleasePacket(FramePacket* pPacket) noexcept
+{
+    ENG_ASSERT(pPacket, "pPacket is nullptr");
+
+    {
+        std::scoped_lock lock(m_mutex);
+        ENG_ASSERT(m_freePacketsCount < MAX_PACKETS_IN_FLIGHT, "Frame packets free list overflow");
+
+        m_freePackets[m_freePacketsCount++] = pPacket;
+    }
+
+    m_freePacketCV.notify_one();
+}
+
+
+void FramePacketQueue::Start() noexcept
+{
+    std::scoped_lock lock(m_mutex);
+    m_isStopped = false;
+}
+
+
+void FramePacketQueue::Stop() noexcept
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_isStopped = true;
+    }
+
+    m_freePacketCV.notify_all();
+    m_submittedPacketCV.notify_all();
+}
+
+
+bool FramePacketQueue::IsStopped() const noexcept
+{
+    std::scoped_lock lock(m_mutex);
+    return m_isStopped;
+}
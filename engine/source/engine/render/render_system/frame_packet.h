@@ -0,0 +1,136 @@
+#pragma once
+
+#include "core/window_system/window_system.h"
+
+#include "utils/data_structures/strid.h"
+#include "utils/math/common_math.h"
+
+#include <mutex>
+#include <condition_variable>
+
+
+// One instance of a mesh. Items sharing mesh and material are merged into instanced draws by the render thread
+struct FramePacketDrawItem
+{
+    glm::mat4x4 worldMatrix;
+    ds::StrID   meshName;
+    uint32_t    materialIdx;
+};
+
+
+enum class FramePacketLightType : uint8_t
+{
+    POINT,
+    SPOT,
+};
+
+
+// Dynamic light in world space. Spot cone angles are half angles in radians, they are ignored by point lights
+struct FramePacketLight
+{
+    glm::vec3            position;
+    float                range;
+    glm::vec3            color;
+    float                intensity;
+    glm::vec3            direction;
+    float                spotInnerAngle;
+    float                spotOuterAngle;
+    FramePacketLightType type;
+};
+
+
+// Immutable snapshot of everything render thread needs to draw a frame. Filled by the main thread only
+struct FramePacket
+{
+    glm::mat4x4 viewMatrix;
+    glm::mat4x4 projMatrix;
+    glm::mat4x4 viewProjMatrix;
+
+    // Sub-pixel NDC offset already applied to projMatrix
+    glm::vec2 projJitter;
+
+    float zNear;
+    float zFar;
+
+    float elapsedTime;
+    float deltaTime;
+
+    uint32_t framebufferWidth;
+    uint32_t framebufferHeight;
+
+    FrameInputTag inputTag;
+
+    std::vector<FramePacketDrawItem> drawItems;
+    std::vector<FramePacketLight> lights;
+
+    uint64_t frameIndex;
+
+    // GBuffer pass shades only visible fragments, with depth laid down by a position only prepass
+    bool isDepthPrepassEnabled;
+
+    // Instances hidden behind the previous frame depth are skipped by the depth prepass and GBuffer pass
+    bool isOcclusionCullingEnabled;
+
+    // Passes render at a fraction of the framebuffer size picked to fit GPU frame time into the target, and the result is upscaled
+    bool isDynamicResolutionEnabled;
+    float targetGPUFrameTimeMs;
+    float minResolutionScale;
+    // Scale used while dynamic resolution is disabled
+    float resolutionScale;
+
+    // Jittered frames are accumulated into a history at the framebuffer resolution instead of being upscaled bilinearly
+    bool isTemporalUpscalingEnabled;
+
+    // Visibility buffer and its resolve pass replace the GBuffer and color passes
+    bool isVisibilityBufferEnabled;
+
+    // Nothing should be rendered or presented (e.g. window is minimized)
+    bool skipRendering;
+};
+
+
+// Bounded queue of frame packets shared by the main (producer) and render (consumer) threads.
+// Packets storage is preallocated, so drawItems and lights vectors keep their capacity between frames
+class FramePacketQueue
+{
+public:
+    static inline constexpr size_t MAX_PACKETS_IN_FLIGHT = 2;
+
+public:
+    FramePacketQueue();
+
+    FramePacketQueue(const FramePacketQueue& other) = delete;
+    FramePacketQueue& operator=(const FramePacketQueue& other) = delete;
+    FramePacketQueue(FramePacketQueue&& other) noexcept = delete;
+    FramePacketQueue& operator=(FramePacketQueue&& other) noexcept = delete;
+
+    // Producer side. Blocks while all packets are in flight. Returns nullptr if queue is stopped
+    FramePacket* AcquireFreePacket() noexcept;
+    void SubmitPacket(FramePacket* pPacket) noexcept;
+
+    // Consumer side. Blocks until any packet is submitted. Returns nullptr if queue is stopped and drained
+    FramePacket* AcquireSubmittedPacket() noexcept;
+    void ReleasePacket(FramePacket* pPacket) noexcept;
+
+    void Start() noexcept;
+    void Stop() noexcept;
+
+    bool IsStopped() const noexcept;
+
+private:
+    std::array<FramePacket, MAX_PACKETS_IN_FLIGHT> m_packetsStorage;
+
+    std::array<FramePacket*, MAX_PACKETS_IN_FLIGHT> m_freePackets;
+    std::array<FramePacket*, MAX_PACKETS_IN_FLIGHT> m_submittedPackets;
+
+    size_t m_freePacketsCount = 0;
+
+    size_t m_submittedPacketsHead = 0;
+    size_t m_submittedPacketsCount = 0;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_freePacketCV;
+    std::condition_variable m_submittedPacketCV;
+
+    bool m_isStopped = true;
+};
@@ -0,0 +1,348 @@
+#include "pch.h"
+#include "render_frame_benchmark.h"
+
+#include "render_system.h"
+
+#include "core/window_system/window_system.h"
+
+#include "utils/debug/assertion.h"
+
+
+// Frames rendered with the step settings before their statistics are accumulated
+static constexpr uint32_t WARMUP_FRAMES_COUNT = 8;
+
+static constexpr uint32_t GBUFFER_LAYOUT_FRAMES_COUNT = 500;
+
+// Every lights count is measured twice: with fixed lights radius and with fixed lights per cluster density
+static constexpr uint32_t LIGHTS_COUNTS[] = { 16, 64, 256, 1024, 4096, 16384 };
+static constexpr uint32_t LIGHTS_STEPS_COUNT = 2 * _countof(LIGHTS_COUNTS);
+static constexpr uint32_t LIGHTS_FRAMES_COUNT = 64;
+static constexpr float LIGHTS_RADIUS = 0.5f;
+// Lights are spread over the cube at the scene origin
+static constexpr float LIGHTS_VOLUME_HALF_SIZE = 1.f;
+
+// Every resolution is measured with GBuffer and visibility buffer paths. Window is resized to it, so OS may clamp it to the screen
+static constexpr uint32_t VISIBILITY_RESOLUTIONS[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+static constexpr uint32_t VISIBILITY_STEPS_COUNT = 2 * _countof(VISIBILITY_RESOLUTIONS);
+static constexpr uint32_t VISIBILITY_FRAMES_COUNT = 64;
+// Overlapping layers of dense spheres in front of the camera, so that small triangles and overdraw are both present
+static constexpr uint32_t VISIBILITY_GRID_WIDTH = 32;
+static constexpr uint32_t VISIBILITY_GRID_HEIGHT = 18;
+static constexpr uint32_t VISIBILITY_GRID_LAYERS = 3;
+static constexpr float VISIBILITY_GRID_DISTANCE = 8.f;
+
+
+// Only the layout of the current build is timed, the other one is measured by rebuilding with ENG_GBUFFER_COMPACT toggled
+// Values are only used by logging, which is compiled out in release
+static void LogGBufferLayoutBenchmark(ENG_MAYBE_UNUSED double gBufferPassTimeMs, ENG_MAYBE_UNUSED double colorPassTimeMs, 
+    ENG_MAYBE_UNUSED uint32_t width, ENG_MAYBE_UNUSED uint32_t height) noexcept
+{
+    ENG_MAYBE_UNUSED const uint32_t defaultBytesPerPixel = engGetGBufferLayoutBytesPerPixel(false);
+    ENG_MAYBE_UNUSED const uint32_t compactBytesPerPixel = engGetGBufferLayoutBytesPerPixel(true);
+
+#if defined(ENG_GBUFFER_COMPACT)
+    ENG_MAYBE_UNUSED const char* pLayoutName = "compact";
+#else
+    ENG_MAYBE_UNUSED const char* pLayoutName = "default";
+#endif
+
+    ENG_LOG_INFO("GBuffer layout benchmark: default {} B/px, compact {} B/px ({:.1f}% less bandwidth)", defaultBytesPerPixel, compactBytesPerPixel,
+        100.f * (1.f - (float)compactBytesPerPixel / defaultBytesPerPixel));
+    ENG_LOG_INFO("    {} layout, {}x{}, {} frames average: GBuffer pass {:.3f} ms | color pass {:.3f} ms", pLayoutName, width, height,
+        GBUFFER_LAYOUT_FRAMES_COUNT, gBufferPassTimeMs, colorPassTimeMs);
+}
+
+
+static float GetLightsStepRadius(uint32_t step) noexcept
+{
+    const uint32_t lightsCount = LIGHTS_COUNTS[step % _countof(LIGHTS_COUNTS)];
+    const bool isFixedDensity = step >= _countof(LIGHTS_COUNTS);
+
+    // Lights volume is fixed, so radius shrinking with cube root of lights count keeps lights per cluster constant
+    return isFixedDensity ? 2.f * LIGHTS_RADIUS * std::cbrt((float)LIGHTS_COUNTS[0] / lightsCount) : LIGHTS_RADIUS;
+}
+
+
+// Same lights on every run, so results of different builds are comparable
+static void GenerateLights(std::vector<FramePacketLight>& lights, uint32_t step) noexcept
+{
+    const uint32_t lightsCount = LIGHTS_COUNTS[step % _countof(LIGHTS_COUNTS)];
+    const float radius = GetLightsStepRadius(step);
+
+    uint32_t seed = 0x9E3779B9u;
+
+    const auto random01 = [&seed]() -> float {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed & 0xFFFFFF) / (float)0x1000000;
+    };
+
+    lights.resize(lightsCount);
+
+    for (FramePacketLight& light : lights) {
+        light = {};
+        light.position.x = (2.f * random01() - 1.f) * LIGHTS_VOLUME_HALF_SIZE;
+        light.position.y = (2.f * random01() - 1.f) * LIGHTS_VOLUME_HALF_SIZE;
+        light.position.z = (2.f * random01() - 1.f) * LIGHTS_VOLUME_HALF_SIZE;
+        light.range = radius;
+        light.color = glm::vec3(random01(), random01(), random01());
+        light.intensity = 1.f;
+        light.type = FramePacketLightType::POINT;
+    }
+}
+
+
+static void LogLightsBenchmarkStep(uint32_t step, ENG_MAYBE_UNUSED double lightCullingTimeMs, ENG_MAYBE_UNUSED double lightingTimeMs, 
+    ENG_MAYBE_UNUSED float avgLightsPerLitCluster, ENG_MAYBE_UNUSED uint32_t maxLightsPerCluster, ENG_MAYBE_UNUSED uint32_t overflowedClustersCount) noexcept
+{
+    const uint32_t countIdx = step % _countof(LIGHTS_COUNTS);
+    
+    if (countIdx == 0) {
+        ENG_LOG_INFO("Clustered lighting benchmark, fixed {}, {} frames average:", 
+            step == 0 ? "lights radius" : "lights per cluster density", LIGHTS_FRAMES_COUNT);
+    }
+
+    ENG_LOG_INFO("    {:5} lights, radius {:.3f}: {:.1f} avg / {} max lights per lit cluster, {} overflowed clusters | culling {:.3f} ms | lighting {:.3f} ms",
+        LIGHTS_COUNTS[countIdx], GetLightsStepRadius(step), avgLightsPerLitCluster, maxLightsPerCluster, overflowedClustersCount,
+        lightCullingTimeMs, lightingTimeMs);
+}
+
+
+// Grid is placed in view space, so it covers the screen wherever the camera looks
+static void FillSpheresGrid(std::vector<FramePacketDrawItem>& drawItems, const glm::mat4x4& viewMatrix, const glm::mat4x4& projMatrix) noexcept
+{
+    const glm::mat4x4 invViewMatrix = glm::inverse(viewMatrix);
+    const float halfWidth = VISIBILITY_GRID_DISTANCE / projMatrix[0][0];
+    const float halfHeight = VISIBILITY_GRID_DISTANCE / projMatrix[1][1];
+    const float sphereScale = 2.f * halfWidth / VISIBILITY_GRID_WIDTH;
+
+    drawItems.clear();
+    drawItems.reserve(VISIBILITY_GRID_WIDTH * VISIBILITY_GRID_HEIGHT * VISIBILITY_GRID_LAYERS);
+
+    for (uint32_t layer = 0; layer < VISIBILITY_GRID_LAYERS; ++layer) {
+        for (uint32_t y = 0; y < VISIBILITY_GRID_HEIGHT; ++y) {
+            for (uint32_t x = 0; x < VISIBILITY_GRID_WIDTH; ++x) {
+                // Layers are shifted by a half of sphere, so farther spheres show through the gaps of nearer ones
+                const float shift = 0.5f * sphereScale * (layer % 2);
+                const glm::vec3 position(
+                    -halfWidth + sphereScale * (x + 0.5f) + shift,
+                    -halfHeight + 2.f * halfHeight * (y + 0.5f) / VISIBILITY_GRID_HEIGHT + shift,
+                    -VISIBILITY_GRID_DISTANCE - layer * sphereScale);
+
+                FramePacketDrawItem drawItem = {};
+                drawItem.worldMatrix = invViewMatrix * glm::translate(M3D_MAT4_IDENTITY, position) * glm::scale(M3D_MAT4_IDENTITY, glm::vec3(sphereScale));
+                drawItem.meshName = RenderFrameBenchmark::SPHERE_MESH_NAME;
+                drawItem.materialIdx = 0;
+
+                drawItems.emplace_back(drawItem);
+            }
+        }
+    }
+}
+
+
+static void LogVisibilityBenchmarkStep(uint32_t step, ENG_MAYBE_UNUSED uint32_t width, ENG_MAYBE_UNUSED uint32_t height, uint32_t bytesPerPixel, 
+    ENG_MAYBE_UNUSED double geometryPassTimeMs, ENG_MAYBE_UNUSED double shadingPassTimeMs, uint64_t geometryFragmentsCount) noexcept
+{
+    const bool isVisibilityBuffer = step % 2 != 0;
+
+    if (step == 0) {
+        ENG_LOG_INFO("Visibility buffer benchmark, {} spheres of {} triangles, {} frames average:", 
+            VISIBILITY_GRID_WIDTH * VISIBILITY_GRID_HEIGHT * VISIBILITY_GRID_LAYERS,
+            2 * RenderFrameBenchmark::SPHERE_RINGS_COUNT * RenderFrameBenchmark::SPHERE_SEGMENTS_COUNT, VISIBILITY_FRAMES_COUNT);
+    }
+
+    // Bandwidth isn't queryable, so geometry pass writes are estimated from shaded fragments and its render targets size
+    const uint32_t passBytesPerPixel = engGetGeometryPassTargetsBytesPerPixel(isVisibilityBuffer);
+
+    ENG_MAYBE_UNUSED const float targetsSizeMb = (float)width * height * bytesPerPixel / (1024.f * 1024.f);
+    ENG_MAYBE_UNUSED const float geometryPassWritesMb = (float)geometryFragmentsCount * passBytesPerPixel / (1024.f * 1024.f);
+
+    ENG_LOG_INFO("    {:10} {}x{}: {} B/px, {:.1f} MB targets, ~{:.1f} MB geometry pass writes | geometry pass {:.3f} ms | shading pass {:.3f} ms", 
+        isVisibilityBuffer ? "visibility" : "GBuffer", width, height, bytesPerPixel, targetsSizeMb, geometryPassWritesMb, 
+        geometryPassTimeMs, shadingPassTimeMs);
+}
+
+
+void RenderFrameBenchmark::Update(FramePacket& packet, const RenderFrameStatistics& stats, Window& window) noexcept
+{
+    switch (m_phase) {
+        case Phase::GBUFFER_LAYOUT:
+            UpdateGBufferLayout(packet, stats);
+            break;
+        case Phase::LIGHTS:
+            UpdateLights(packet, stats);
+            break;
+        case Phase::VISIBILITY:
+            UpdateVisibility(packet, stats, window);
+            break;
+        default:
+            break;
+    }
+}
+
+
+bool RenderFrameBenchmark::AcceptStatistics(const FramePacket& packet, const RenderFrameStatistics& stats) noexcept
+{
+    if (!m_isStepStarted) {
+        m_stepFirstFrameIdx = packet.frameIndex;
+        m_isStepStarted = true;
+    }
+
+    if (stats.frameIndex == m_lastStatsFrameIdx || stats.frameIndex < m_stepFirstFrameIdx + WARMUP_FRAMES_COUNT) {
+        return false;
+    }
+
+    m_lastStatsFrameIdx = stats.frameIndex;
+    return true;
+}
+
+
+void RenderFrameBenchmark::ResetStepStatistics() noexcept
+{
+    m_stepFramesCount = 0;
+
+    m_gBufferPassTimeMs = 0.0;
+    m_colorPassTimeMs = 0.0;
+    m_lightCullingTimeMs = 0.0;
+    m_clusterLightsCount = 0.0;
+    m_litClustersCount = 0;
+    m_maxLightsPerCluster = 0;
+    m_overflowedClustersCount = 0;
+    m_geometryFragmentsCount = 0;
+}
+
+
+void RenderFrameBenchmark::NextStep() noexcept
+{
+    ++m_step;
+    m_isStepStarted = false;
+
+    ResetStepStatistics();
+}
+
+
+void RenderFrameBenchmark::UpdateGBufferLayout(FramePacket& packet, const RenderFrameStatistics& stats) noexcept
+{
+    if (!AcceptStatistics(packet, stats)) {
+        return;
+    }
+
+    m_gBufferPassTimeMs += stats.gBufferPassTimeMs;
+    m_colorPassTimeMs += stats.colorPassTimeMs;
+
+    if (++m_stepFramesCount < GBUFFER_LAYOUT_FRAMES_COUNT) {
+        return;
+    }
+
+    LogGBufferLayoutBenchmark(m_gBufferPassTimeMs / m_stepFramesCount, m_colorPassTimeMs / m_stepFramesCount, stats.renderWidth, stats.renderHeight);
+
+    NextStep();
+    m_step = 0;
+    m_phase = Phase::LIGHTS;
+}
+
+
+void RenderFrameBenchmark::UpdateLights(FramePacket& packet, const RenderFrameStatistics& stats) noexcept
+{
+    if (!m_isStepStarted) {
+        GenerateLights(m_lights, m_step);
+    }
+
+    packet.lights = m_lights;
+
+    if (!AcceptStatistics(packet, stats)) {
+        return;
+    }
+
+    m_lightCullingTimeMs += stats.lightCullingTimeMs;
+    m_colorPassTimeMs += stats.colorPassTimeMs;
+    // Average is weighted by lit clusters of every frame, as if all frames were one
+    m_clusterLightsCount += (double)stats.avgLightsPerLitCluster * stats.litClustersCount;
+    m_litClustersCount += stats.litClustersCount;
+    m_maxLightsPerCluster = std::max(m_maxLightsPerCluster, stats.maxLightsPerCluster);
+    m_overflowedClustersCount = std::max(m_overflowedClustersCount, stats.overflowedClustersCount);
+
+    if (++m_stepFramesCount < LIGHTS_FRAMES_COUNT) {
+        return;
+    }
+
+    const float avgLightsPerCluster = m_litClustersCount > 0 ? (float)(m_clusterLightsCount / m_litClustersCount) : 0.f;
+
+    LogLightsBenchmarkStep(m_step, m_lightCullingTimeMs / m_stepFramesCount, m_colorPassTimeMs / m_stepFramesCount, avgLightsPerCluster, 
+        m_maxLightsPerCluster, m_overflowedClustersCount);
+
+    NextStep();
+
+    if (m_step == LIGHTS_STEPS_COUNT) {
+        m_lights.clear();
+        m_lights.shrink_to_fit();
+
+        m_step = 0;
+        m_phase = Phase::VISIBILITY;
+    }
+}
+
+
+void RenderFrameBenchmark::UpdateVisibility(FramePacket& packet, const RenderFrameStatistics& stats, Window& window) noexcept
+{
+    if (!m_isStepStarted) {
+        if (m_step == 0) {
+            m_restoredWindowWidth = window.GetWidth();
+            m_restoredWindowHeight = window.GetHeight();
+        }
+
+        // Both paths of a resolution are measured at the same size, so it's requested once
+        if (m_step % 2 == 0) {
+            const uint32_t* pResolution = VISIBILITY_RESOLUTIONS[m_step / 2];
+            window.SetSize(pResolution[0], pResolution[1]);
+        }
+
+        m_stepFramebufferWidth = packet.framebufferWidth;
+        m_stepFramebufferHeight = packet.framebufferHeight;
+    }
+
+    // Same geometry through both paths. Passes which change the shaded fragments count or resolution are disabled
+    packet.resolutionScale = 1.f;
+    packet.isDynamicResolutionEnabled = false;
+    packet.isTemporalUpscalingEnabled = false;
+    packet.isDepthPrepassEnabled = false;
+    packet.isOcclusionCullingEnabled = false;
+    packet.isVisibilityBufferEnabled = m_step % 2 != 0;
+
+    FillSpheresGrid(packet.drawItems, packet.viewMatrix, packet.projMatrix);
+
+    // Resize is seen a few frames after the request, so the step warmup restarts once it's applied
+    if (packet.framebufferWidth != m_stepFramebufferWidth || packet.framebufferHeight != m_stepFramebufferHeight) {
+        m_stepFramebufferWidth = packet.framebufferWidth;
+        m_stepFramebufferHeight = packet.framebufferHeight;
+        m_stepFirstFrameIdx = packet.frameIndex;
+
+        ResetStepStatistics();
+    }
+
+    if (!AcceptStatistics(packet, stats)) {
+        return;
+    }
+
+    m_gBufferPassTimeMs += stats.gBufferPassTimeMs;
+    m_colorPassTimeMs += stats.colorPassTimeMs;
+    m_geometryFragmentsCount += stats.gBufferFragmentsCount;
+
+    if (++m_stepFramesCount < VISIBILITY_FRAMES_COUNT) {
+        return;
+    }
+
+    LogVisibilityBenchmarkStep(m_step, stats.renderWidth, stats.renderHeight, stats.gBufferBytesPerPixel, m_gBufferPassTimeMs / m_stepFramesCount, 
+        m_colorPassTimeMs / m_stepFramesCount, m_geometryFragmentsCount / m_stepFramesCount);
+
+    NextStep();
+
+    if (m_step == VISIBILITY_STEPS_COUNT) {
+        window.SetSize(m_restoredWindowWidth, m_restoredWindowHeight);
+
+        m_step = 0;
+        m_phase = Phase::FINISHED;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "frame_packet.h"
+
+#include <cstdint>
+#include <vector>
+
+
+struct RenderFrameStatistics;
+class Window;
+
+
+// Runs render benchmarks one after another on the frames the engine renders and logs their results.
+// Benchmarks only fill frame packets and read statistics, the render system doesn't know about them.
+// Statistics are reported a few frames late, so they are matched to a benchmark step by the frame index they were measured at
+class RenderFrameBenchmark
+{
+public:
+    // Mesh drawn by the visibility buffer benchmark. It's created by the render system along with the other frame resources
+    static inline constexpr const char* SPHERE_MESH_NAME = "benchmark_sphere";
+    static inline constexpr uint32_t SPHERE_RINGS_COUNT = 32;
+    static inline constexpr uint32_t SPHERE_SEGMENTS_COUNT = 64;
+    static inline constexpr float SPHERE_RADIUS = 0.5f;
+
+public:
+    // Called after the packet is filled by the engine. Window is resized by the benchmarks which need a specific resolution
+    void Update(FramePacket& packet, const RenderFrameStatistics& stats, Window& window) noexcept;
+
+    bool IsFinished() const noexcept { return m_phase == Phase::FINISHED; }
+
+private:
+    enum class Phase : uint8_t
+    {
+        GBUFFER_LAYOUT,
+        LIGHTS,
+        VISIBILITY,
+        FINISHED,
+    };
+
+private:
+    // Starts the step on its first packet. Returns true if stats are new and were measured after the step warmup
+    bool AcceptStatistics(const FramePacket& packet, const RenderFrameStatistics& stats) noexcept;
+    void ResetStepStatistics() noexcept;
+    void NextStep() noexcept;
+
+    void UpdateGBufferLayout(FramePacket& packet, const RenderFrameStatistics& stats) noexcept;
+    void UpdateLights(FramePacket& packet, const RenderFrameStatistics& stats) noexcept;
+    void UpdateVisibility(FramePacket& packet, const RenderFrameStatistics& stats, Window& window) noexcept;
+
+private:
+    Phase m_phase = Phase::GBUFFER_LAYOUT;
+    uint32_t m_step = 0;
+
+    uint64_t m_stepFirstFrameIdx = 0;
+    uint64_t m_lastStatsFrameIdx = UINT64_MAX;
+    bool m_isStepStarted = false;
+
+    uint32_t m_stepFramesCount = 0;
+    double m_gBufferPassTimeMs = 0.0;
+    double m_colorPassTimeMs = 0.0;
+
+    // Lights of the current lights step, they replace demo lights of the packet
+    std::vector<FramePacketLight> m_lights;
+    double m_lightCullingTimeMs = 0.0;
+    double m_clusterLightsCount = 0.0;
+    uint64_t m_litClustersCount = 0;
+    uint32_t m_maxLightsPerCluster = 0;
+    uint32_t m_overflowedClustersCount = 0;
+
+    // Geometry and shading pass times are accumulated in GBuffer and color pass ones
+    uint64_t m_geometryFragmentsCount = 0;
+    uint32_t m_stepFramebufferWidth = 0;
+    uint32_t m_stepFramebufferHeight = 0;
+    uint32_t m_restoredWindowWidth = 0;
+    uint32_t m_restoredWindowHeight = 0;
+};
@@ -8,525 +8,2264 @@
 #include "render/shader_manager/shader_mng.h"
 #include "render/pipeline_manager/pipeline_mng.h"
 #include "render/mem_manager/buffer_manager.h"
+#include "render/mem_manager/upload_manager.h"
 #include "render/mesh_manager/mesh_manager.h"
 
-#include "core/camera/camera_manager.h"
 #include "core/window_system/window_system.h"
 
 #include "utils/file/file.h"
 #include "utils/debug/assertion.h"
-#include "utils/timer/timer.h"
+#include "utils/timer/startup_timeline.h"
+#include "utils/algorithm/radix_sort.h"
 
 #include "render/platform/OpenGL/opengl_driver.h"
+#include "render/platform/OpenGL/opengl_cmd_executor.h"
+#include "render/platform/OpenGL/opengl_retire_queue.h"
+
+#include "render/command_buffer/render_command_benchmark.h"
+#include "render_frame_benchmark.h"
 
 #include "auto/registers_common.h"
 
+#include <future>
+
+
+static std::unique_ptr<RenderSystem> pRenderSysInst = nullptr;
+
+
+#define INIT_CALL(CALL, ...) { StartupTimelineScopedStage stage(#CALL); if (!CALL(__VA_ARGS__)) { return false; } }
+
+
+static constexpr const char* SHADER_INCLUDE_DIR = ENG_ENGINE_DIR "/source/shaders/include";
+static constexpr const char* BASE_VS_FILEPATH = ENG_ENGINE_DIR "/source/shaders/source/base/base.vs";
+static constexpr const char* BASE_PS_FILEPATH = ENG_ENGINE_DIR "/source/shaders/source/base/base.fs";
+static constexpr const char* CLUSTER_LIGHT_CULLING_CS_FILEPATH = ENG_ENGINE_DIR "/source/shaders/source/lighting/cluster_light_culling.cs";
+static constexpr const char* HIZ_DOWNSAMPLE_CS_FILEPATH = ENG_ENGINE_DIR "/source/shaders/source/culling/hiz_downsample.cs";
+static constexpr const char* OCCLUSION_CULLING_CS_FILEPATH = ENG_ENGINE_DIR "/source/shaders/source/culling/occlusion_culling.cs";
+static constexpr const char* TEMPORAL_UPSCALE_CS_FILEPATH = ENG_ENGINE_DIR "/source/shaders/source/postprocess/temporal_upscale.cs";
+
+// Defines every program is preprocessed with, the pass define selecting program entry points is appended to them
+static std::vector<const char*> GetShaderStageDefines(const char* pPassDefine) noexcept
+{
+    std::vector<const char*> defines = {
+    #if defined(ENG_DEBUG)
+        "ENV_DEBUG",
+    #endif
+    #if defined(ENG_USE_INVERTED_Z)
+        "ENV_INVERTED_Z",
+    #endif
+    #if defined(ENG_GBUFFER_COMPACT)
+        "ENV_GBUFFER_COMPACT",
+    #endif
+    };
+
+    defines.emplace_back(pPassDefine);
+
+    return defines;
+}
+
+
+#if defined(ENG_GBUFFER_COMPACT)
+    using GBufferAlbedoTex = GBUFFER_COMPACT_ALBEDO_TEX;
+    using GBufferNormalTex = GBUFFER_COMPACT_NORMAL_TEX;
+    using CommonColorTex = COMMON_COMPACT_COLOR_TEX;
+#else
+    using GBufferAlbedoTex = GBUFFER_ALBEDO_TEX;
+    using GBufferNormalTex = GBUFFER_NORMAL_TEX;
+    using CommonColorTex = COMMON_COLOR_TEX;
+#endif
+
+
+// Render targets written and read by GBuffer and color passes in both layouts. Motion is written along with the GBuffer
+static const uint32_t DEFAULT_GBUFFER_LAYOUT_FORMATS[] = {
+    resGetTexResourceFormat(GBUFFER_ALBEDO_TEX),
+    resGetTexResourceFormat(GBUFFER_NORMAL_TEX),
+    resGetTexResourceFormat(GBUFFER_SPECULAR_TEX),
+    resGetTexResourceFormat(GBUFFER_MOTION_TEX),
+    resGetTexResourceFormat(COMMON_DEPTH_TEX),
+    resGetTexResourceFormat(COMMON_COLOR_TEX),
+};
+
+static const uint32_t COMPACT_GBUFFER_LAYOUT_FORMATS[] = {
+    resGetTexResourceFormat(GBUFFER_COMPACT_ALBEDO_TEX),
+    resGetTexResourceFormat(GBUFFER_COMPACT_NORMAL_TEX),
+    resGetTexResourceFormat(GBUFFER_MOTION_TEX),
+    resGetTexResourceFormat(COMMON_DEPTH_TEX),
+    resGetTexResourceFormat(COMMON_COMPACT_COLOR_TEX),
+};
+
+#if defined(ENG_GBUFFER_COMPACT)
+    static const auto& GBUFFER_LAYOUT_FORMATS = COMPACT_GBUFFER_LAYOUT_FORMATS;
+#else
+    static const auto& GBUFFER_LAYOUT_FORMATS = DEFAULT_GBUFFER_LAYOUT_FORMATS;
+#endif
+
+
+// Render targets of the visibility buffer path. Visibility resolve writes motion instead of the GBuffer pass
+static const uint32_t VISIBILITY_LAYOUT_FORMATS[] = {
+    resGetTexResourceFormat(COMMON_VISIBILITY_TEX),
+    resGetTexResourceFormat(GBUFFER_MOTION_TEX),
+    resGetTexResourceFormat(COMMON_DEPTH_TEX),
+    resGetTexResourceFormat(CommonColorTex),
+};
+
+
+// Motion is the last GBuffer attachment in both layouts, see base.fs
+#if defined(ENG_GBUFFER_COMPACT)
+    static constexpr uint32_t GBUFFER_MOTION_ATTACHMENT_IDX = 2;
+#else
+    static constexpr uint32_t GBUFFER_MOTION_ATTACHMENT_IDX = 3;
+#endif
+
+static constexpr uint32_t VISIBILITY_RESOLVE_MOTION_ATTACHMENT_IDX = 1;
+
+
+// Major field of command buffer sort keys
+enum RenderSortPass : uint32_t
+{
+    RENDER_SORT_PASS_DEPTH_PREPASS,
+    RENDER_SORT_PASS_GBUFFER,
+    RENDER_SORT_PASS_VISIBILITY,
+    RENDER_SORT_PASS_POST_PROCESS,
+};
+
+
+// Recording jobs are not worth their synchronization overhead below this draws count
+static constexpr uint32_t MIN_DRAWS_PER_RECORDING_JOB = 256;
+static constexpr uint32_t MAX_RECORDING_WORKERS_COUNT = 7;
+
+
+// Initial elements count of per frame streamed buffers regions, which grow geometrically on demand
+static constexpr size_t MIN_STREAM_BUFFER_CAPACITY = 1024;
+static constexpr size_t TRANSIENT_CONSTANTS_FRAME_REGION_SIZE = 64 * 1024;
+
+// Compute shaders thread groups sizes, see hiz_downsample.cs, occlusion_culling.cs and temporal_upscale.cs
+static constexpr uint32_t HIZ_DOWNSAMPLE_GROUP_SIZE = 8;
+static constexpr uint32_t OCCLUSION_CULLING_GROUP_SIZE = 64;
+static constexpr uint32_t TEMPORAL_UPSCALE_GROUP_SIZE = 8;
+
+// Light indices capacity per cluster on average. Clusters are lit by a few lights mostly, so lists are packed into one shared buffer
+static constexpr uint32_t CLUSTER_AVG_LIGHTS_COUNT = 64;
+
+
+// Render targets written by the geometry pass of each path, the rest is read by the following passes
+static const uint32_t GBUFFER_PASS_TARGETS_FORMATS[] = {
+#if defined(ENG_GBUFFER_COMPACT)
+    resGetTexResourceFormat(GBUFFER_COMPACT_ALBEDO_TEX),
+    resGetTexResourceFormat(GBUFFER_COMPACT_NORMAL_TEX),
+#else
+    resGetTexResourceFormat(GBUFFER_ALBEDO_TEX),
+    resGetTexResourceFormat(GBUFFER_NORMAL_TEX),
+    resGetTexResourceFormat(GBUFFER_SPECULAR_TEX),
+#endif
+    resGetTexResourceFormat(GBUFFER_MOTION_TEX),
+    resGetTexResourceFormat(COMMON_DEPTH_TEX),
+};
+
+static const uint32_t VISIBILITY_PASS_TARGETS_FORMATS[] = {
+    resGetTexResourceFormat(COMMON_VISIBILITY_TEX),
+    resGetTexResourceFormat(COMMON_DEPTH_TEX),
+};
+
+
+static constexpr uint32_t TEST_TEXTURE_WIDTH = 256;
+static constexpr uint32_t TEST_TEXTURE_HEIGHT = 256;
+
+
+// Results of CPU side preparation of frame resources, which doesn't require graphics context
+struct FrameResourcesSourceData
+{
+    std::string depthPrepassVsSourceCode;
+    std::string depthPrepassPsSourceCode;
+    std::string gBufferVsSourceCode;
+    std::string gBufferPsSourceCode;
+    std::string postProcVsSourceCode;
+    std::string postProcPsSourceCode;
+    std::string visibilityVsSourceCode;
+    std::string visibilityPsSourceCode;
+    std::string visibilityResolveVsSourceCode;
+    std::string visibilityResolvePsSourceCode;
+    std::string lightCullingCsSourceCode;
+    std::string hiZDownsampleCsSourceCode;
+    std::string occlusionCullingCsSourceCode;
+    std::string temporalUpscaleCsSourceCode;
+
+    std::vector<uint8_t> testTextureData;
+};
+
+
+static ShaderProgram* pDepthPrepassProgram = nullptr;
+static ShaderProgram* pGBufferProgram = nullptr;
+static ShaderProgram* pPostProcProgram = nullptr;
+static ShaderProgram* pVisibilityProgram = nullptr;
+static ShaderProgram* pVisibilityResolveProgram = nullptr;
+static ShaderProgram* pLightCullingProgram = nullptr;
+static ShaderProgram* pHiZDownsampleProgram = nullptr;
+static ShaderProgram* pOcclusionCullingProgram = nullptr;
+static ShaderProgram* pTemporalUpscaleProgram = nullptr;
+
+static Texture* pTestTexture = nullptr;
+static TextureSamplerState* pTestTextureSampler = nullptr;
+
+static MeshObj* pCubeMeshObj = nullptr;
+static MeshObj* pCubePositionsMeshObj = nullptr;
+
+static TextureSamplerState* pGBufferAlbedoSampler = nullptr;
+static TextureSamplerState* pGBufferNormalSampler = nullptr;
+static TextureSamplerState* pGBufferSpecSampler = nullptr;
+static TextureSamplerState* pGBufferDepthSampler = nullptr;
+static TextureSamplerState* pHiZSampler = nullptr;
+static TextureSamplerState* pGBufferMotionSampler = nullptr;
+static TextureSamplerState* pTemporalColorSampler = nullptr;
+static TextureSamplerState* pTemporalHistorySampler = nullptr;
+static TextureSamplerState* pVisibilitySampler = nullptr;
+
+static Pipeline* pDepthPrepassPipeline = nullptr;
+static Pipeline* pGBufferPipeline = nullptr;
+// Shades only fragments whose depth equals the one laid down by the depth prepass
+static Pipeline* pGBufferEqualDepthPipeline = nullptr;
+static Pipeline* pPostProcPipeline = nullptr;
+static Pipeline* pVisibilityPipeline = nullptr;
+static Pipeline* pVisibilityEqualDepthPipeline = nullptr;
+static Pipeline* pVisibilityResolvePipeline = nullptr;
+
+
+RenderSystem& RenderSystem::GetInstance() noexcept
+{
+    ENG_ASSERT(engIsRenderSystemInitialized(), "Render system is not initialized");
+    return *pRenderSysInst;
+}
+
+
+static void WriteInstanceData(COMMON_INSTANCE_DATA* pInstances, const FramePacket& packet, const RenderBatchedDrawItem* pBatchedDrawItems, 
+    const VisibilityGeometry& visibilityGeometry, size_t firstInstance, size_t lastInstance) noexcept
+{
+    for (size_t i = firstInstance; i < lastInstance; ++i) {
+        const RenderBatchedDrawItem& batchedDrawItem = pBatchedDrawItems[i];
+        const FramePacketDrawItem& drawItem = packet.drawItems[batchedDrawItem.drawItemIdx];
+
+        COMMON_INSTANCE_DATA instance = {};
+
+        const glm::mat4x4 worldMat = glm::transpose(drawItem.worldMatrix);
+        memcpy(instance.COMMON_INSTANCE_WORLD_MATRIX, &worldMat, sizeof(instance.COMMON_INSTANCE_WORLD_MATRIX));
+
+        // World space box enclosing the transformed object space one. Zero w marks instances which are never occlusion culled
+        if (batchedDrawItem.pMesh->HasBounds()) {
+            const glm::vec3 center = 0.5f * (batchedDrawItem.pMesh->GetBoundsMax() + batchedDrawItem.pMesh->GetBoundsMin());
+            const glm::vec3 extents = 0.5f * (batchedDrawItem.pMesh->GetBoundsMax() - batchedDrawItem.pMesh->GetBoundsMin());
+
+            const glm::mat3x3 absRotScale = glm::mat3x3(glm::abs(glm::vec3(drawItem.worldMatrix[0])), glm::abs(glm::vec3(drawItem.worldMatrix[1])), 
+                glm::abs(glm::vec3(drawItem.worldMatrix[2])));
+
+            const glm::vec3 worldCenter = glm::vec3(drawItem.worldMatrix * glm::vec4(center, 1.f));
+            const glm::vec3 worldExtents = absRotScale * extents;
+
+            instance.COMMON_INSTANCE_BOUNDS_MIN = glm::vec4(worldCenter - worldExtents, 1.f);
+            instance.COMMON_INSTANCE_BOUNDS_MAX = glm::vec4(worldCenter + worldExtents, 1.f);
+        }
+        
+        instance.COMMON_INSTANCE_MATERIAL_IDX = drawItem.materialIdx;
+        instance.COMMON_INSTANCE_BATCH_IDX = batchedDrawItem.batchIdx;
+
+        // Fields stay zero for meshes without visibility geometry, BuildInstancedBatches rejects them in visibility buffer mode
+        if (const VisibilityGeometry::MeshRange* pMeshRange = visibilityGeometry.FindMeshRange(batchedDrawItem.pMesh->GetID())) {
+            instance.COMMON_INSTANCE_FIRST_INDEX = pMeshRange->firstIndex;
+            instance.COMMON_INSTANCE_BASE_VERTEX = pMeshRange->baseVertex;
+        }
+
+        // Mapped memory may be write combined, so the instance is written at once
+        memcpy(pInstances + i, &instance, sizeof(instance));
+    }
+}
+
+
+static_assert(sizeof(COMMON_DRAW_INDIRECT_ARGS_DATA) == sizeof(RenderDrawIndexedIndirectArgs), "Occlusion culling shader writes indirect args records");
+
+
+static void WriteIndirectArgs(RenderDrawIndexedIndirectArgs* pArgs, const RenderInstancedBatch* pBatches, size_t firstBatch, size_t lastBatch) noexcept
+{
+    for (size_t i = firstBatch; i < lastBatch; ++i) {
+        const RenderInstancedBatch& batch = pBatches[i];
+
+        RenderDrawIndexedIndirectArgs args = {};
+        args.indexCount = static_cast<uint32_t>(batch.pMesh->GetGPUBufferData()->GetIndexBuffer().GetElementCount());
+        // Occlusion culling pass counts visible instances of the batch on GPU
+        args.instanceCount = 0;
+        args.firstIndex = 0;
+        args.baseVertex = 0;
+        // Vertex shader fetches visible instance index by gl_BaseInstance + gl_InstanceID
+        args.baseInstance = batch.firstInstance;
+
+        memcpy(pArgs + i, &args, sizeof(args));
+    }
+}
+
+
+// Pass draws cost one packet per vertex arrays set, regardless of draw items count.
+// Depth prepass and visibility pass fetch positions only and don't need material resources
+static void RecordGeometryDrawCommands(RenderCommandBuffer& cmdBuffer, RenderSortPass sortPass, Pipeline* pPipeline, 
+    const RenderMultiDrawGroup* pGroups, size_t firstGroup, size_t lastGroup,
+    const DynamicRingBufferAllocation& commonConstants, const DynamicRingBufferAllocation& indirectArgs) noexcept
+{
+    const uint32_t pipeline = pPipeline->GetID().Value();
+    const bool isPositionsOnly = sortPass == RENDER_SORT_PASS_DEPTH_PREPASS || sortPass == RENDER_SORT_PASS_VISIBILITY;
+
+    for (size_t i = firstGroup; i < lastGroup; ++i) {
+        const RenderMultiDrawGroup& group = pGroups[i];
+
+        const MeshObj* pMesh = isPositionsOnly ? group.pMesh->GetPositionStream() : group.pMesh;
+        const uint64_t argsOffset = indirectArgs.offset + group.firstBatch * sizeof(RenderDrawIndexedIndirectArgs);
+
+        // Materials are fetched by the shaders from instance data, so they don't split packets
+        cmdBuffer.BeginPacket(RenderSortKey::Make(sortPass, RenderSortKey::PASS_STAGE_DRAW, pipeline, 0, pMesh->GetID().Value(), 0));
+        cmdBuffer.BindPipeline(pPipeline);
+        cmdBuffer.BindConstBuffer(resGetResourceBinding(COMMON_DYN_CB).GetBinding(), commonConstants.pBuffer, commonConstants.offset, commonConstants.size);
+        if (!isPositionsOnly) {
+            cmdBuffer.BindTexture(resGetResourceBinding(TEST_TEXTURE).GetBinding(), pTestTexture, pTestTextureSampler);
+        }
+        cmdBuffer.DrawIndexedIndirect(pMesh, indirectArgs.pBuffer, argsOffset, group.batchesCount);
+        cmdBuffer.EndPacket();
+    }
+}
+
+
+static void CreateGPUQuery(RenderGPUQuery& query, GLenum target) noexcept
+{
+    glCreateQueries(target, 1, &query.renderID);
+    query.target = target;
+    query.isIssued = false;
+}
+
+
+static void DestroyGPUQuery(RenderGPUQuery& query) noexcept
+{
+    glDeleteQueries(1, &query.renderID);
+    query = {};
+}
+
+
+static void BeginGPUQuery(const RenderGPUQuery& query) noexcept
+{
+    glBeginQuery(query.target, query.renderID);
+}
+
+
+static void EndGPUQuery(RenderGPUQuery& query) noexcept
+{
+    glEndQuery(query.target);
+    query.isIssued = true;
+}
+
+
+// Timestamp queries are written once GPU reaches them, unlike time elapsed ones they may overlap other queries
+static void IssueGPUTimestamp(RenderGPUQuery& query) noexcept
+{
+    glQueryCounter(query.renderID, GL_TIMESTAMP);
+    query.isIssued = true;
+}
+
+
+// Returns false if GPU hasn't finished the query yet. Query which wasn't issued reads as zero
+static bool ReadGPUQuery(RenderGPUQuery& query, uint64_t& result) noexcept
+{
+    result = 0;
+
+    if (!query.isIssued) {
+        return true;
+    }
+
+    GLint isAvailable = GL_FALSE;
+    glGetQueryObjectiv(query.renderID, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+
+    if (!isAvailable) {
+        return false;
+    }
+
+    glGetQueryObjectui64v(query.renderID, GL_QUERY_RESULT, &result);
+    query.isIssued = false;
+
+    return true;
+}
+
+
+static uint32_t GetRenderTargetsBytesPerPixel(const uint32_t* pFormats, size_t formatsCount) noexcept
+{
+    uint64_t size = 0;
+
+    for (size_t i = 0; i < formatsCount; ++i) {
+        size += engGetTextureMemorySize(pFormats[i], 1, 1);
+    }
+
+    return static_cast<uint32_t>(size);
+}
+
+
+// Light falloff, cone and bounding sphere are precomputed on CPU, so shaders evaluate lights with a few instructions
+static void WriteLightData(COMMON_LIGHT_DATA* pLightData, const FramePacketLight& light, const glm::mat4x4& viewMatrix) noexcept
+{
+    COMMON_LIGHT_DATA lightData = {};
+
+    const glm::vec3 position = glm::vec3(viewMatrix * glm::vec4(light.position, 1.f));
+    lightData.COMMON_LIGHT_POSITION_RANGE = glm::vec4(position, light.range);
+    lightData.COMMON_LIGHT_BOUNDING_SPHERE = glm::vec4(position, light.range);
+
+    float spotScale = 0.f;
+    float spotOffset = 1.f;
+
+    glm::vec3 direction = M3D_ZEROF3;
+
+    if (light.type == FramePacketLightType::SPOT) {
+        direction = glm::normalize(glm::vec3(viewMatrix * glm::vec4(light.direction, 0.f)));
+
+        const float cosOuter = glm::cos(light.spotOuterAngle);
+        const float cosInner = glm::cos(light.spotInnerAngle);
+
+        spotScale = 1.f / glm::max(cosInner - cosOuter, 1e-4f);
+        spotOffset = -cosOuter * spotScale;
+
+        // Tightest sphere enclosing the cone. Wide cones are bounded by their base, narrow ones by the sphere through apex and base rim
+        if (light.spotOuterAngle < M3D_HALF_PI) {
+            if (light.spotOuterAngle > 0.25f * M3D_PI) {
+                lightData.COMMON_LIGHT_BOUNDING_SPHERE = glm::vec4(position + direction * (cosOuter * light.range), glm::sin(light.spotOuterAngle) * light.range);
+            } else {
+                const float radius = light.range / (2.f * cosOuter);
+                lightData.COMMON_LIGHT_BOUNDING_SPHERE = glm::vec4(position + direction * radius, radius);
+            }
+        }
+    }
+
+    lightData.COMMON_LIGHT_DIRECTION_SPOT_SCALE = glm::vec4(direction, spotScale);
+    lightData.COMMON_LIGHT_COLOR_SPOT_OFFSET = glm::vec4(light.color * light.intensity, spotOffset);
+
+    // Mapped memory may be write combined, so the light is written at once
+    memcpy(pLightData, &lightData, sizeof(lightData));
+}
+
+
+// Mesh follows pipeline, so batches sharing vertex arrays are contiguous after sorting and merge into one multi draw group
+static uint64_t MakeDrawBatchKey(uint32_t pipeline, uint32_t mesh, uint32_t material) noexcept
+{
+    ENG_ASSERT(pipeline <= 0xFFFF, "Batch key pipeline {} is out of range", pipeline);
+    ENG_ASSERT(mesh <= 0xFFFF, "Batch key mesh {} is out of range", mesh);
+
+    return ((uint64_t)pipeline << 48) | ((uint64_t)mesh << 32) | material;
+}
+
+
+static uint32_t GetDrawBatchKeyVertexArraysPart(uint64_t batchKey) noexcept
+{
+    return static_cast<uint32_t>(batchKey >> 32);
+}
+
+
+static std::string PreprocessShaderStage(const char* pStageName, const char* pFilepath, ShaderStageType type, const char* pPassDefine) noexcept
+{
+    StartupTimelineScopedStage stage(pStageName);
+
+    const std::vector<char> sourceCode = ReadTextFile(pFilepath);
+    std::vector<const char*> defines = GetShaderStageDefines(pPassDefine);
+
+    ShaderStageCreateInfo stageCreateInfo = {};
+
+    stageCreateInfo.type = type;
+
+    stageCreateInfo.pSourceCode = sourceCode.data();
+    stageCreateInfo.codeSize = sourceCode.size();
+
+    stageCreateInfo.pDefines = defines.data();
+    stageCreateInfo.definesCount = static_cast<uint32_t>(defines.size());
+
+    stageCreateInfo.pIncludeParentPath = SHADER_INCLUDE_DIR;
+
+    return ShaderManager::PreprocessSourceCode(stageCreateInfo);
+}
+
+
+static std::vector<uint8_t> GenerateTestTextureData() noexcept
+{
+    StartupTimelineScopedStage stage("GenerateTestTextureData");
+
+    constexpr size_t texWidth = TEST_TEXTURE_WIDTH;
+    constexpr size_t texWidthDiv2 = texWidth / 2;
+    constexpr size_t texHeight = TEST_TEXTURE_HEIGHT;
+    constexpr size_t texHeightDiv2 = texHeight / 2;
+    constexpr size_t texSizeInPixels = texWidth * texHeight;
+    constexpr size_t texComponentsCount = 4;
+    constexpr size_t texSizeInBytes = texSizeInPixels * texComponentsCount;
+    
+    constexpr uint8_t texColors[4][4] = {
+        { 255,   0,   0, 255 },
+        {   0, 255,   0, 255 },
+        {   0,   0, 255, 255 },
+        {   255, 0, 255, 255 },
+    };
+
+    std::vector<uint8_t> texData(texSizeInBytes);
+    for (size_t y = 0; y < texHeight; ++y) {
+        for (size_t x = 0; x < texWidth; ++x) {
+            const size_t colorIdx = (y / (texHeightDiv2 - 1) + ((y / (texHeightDiv2 - 1)) % 2)) + x / texWidthDiv2;
+
+            const size_t pixelIdx = (y * texWidth + x);
+
+            texData[texComponentsCount * pixelIdx + 0] = texColors[colorIdx][0];
+            texData[texComponentsCount * pixelIdx + 1] = texColors[colorIdx][1];
+            texData[texComponentsCount * pixelIdx + 2] = texColors[colorIdx][2];
+            texData[texComponentsCount * pixelIdx + 3] = texColors[colorIdx][3];
+        }
+    }
+
+    return texData;
+}
+
+
+// Stages source code is already preprocessed on worker threads
+static ShaderProgram* CreateProgram(const char* pName, const ShaderStageType* pTypes, const std::string* const* ppSourceCodes, uint32_t stagesCount) noexcept
+{
+    static constexpr uint32_t MAX_STAGES_COUNT = 2;
+    ENG_ASSERT(stagesCount <= MAX_STAGES_COUNT, "{} shader program has too many stages: {}", pName, stagesCount);
+
+    ShaderStageCreateInfo stageCreateInfos[MAX_STAGES_COUNT] = {};
+    const ShaderStageCreateInfo* pStages[MAX_STAGES_COUNT] = {};
+
+    for (uint32_t i = 0; i < stagesCount; ++i) {
+        stageCreateInfos[i].type = pTypes[i];
+        stageCreateInfos[i].pSourceCode = ppSourceCodes[i]->c_str();
+        stageCreateInfos[i].codeSize = ppSourceCodes[i]->size();
+        stageCreateInfos[i].isPreprocessed = true;
+
+        pStages[i] = &stageCreateInfos[i];
+    }
+
+    ShaderProgramCreateInfo programCreateInfo = {};
+    programCreateInfo.pStageCreateInfos = pStages;
+    programCreateInfo.stageCreateInfosCount = stagesCount;
+
+    ShaderProgram* pProgram = ShaderManager::GetInstance().RegisterShaderProgram();
+    ENG_ASSERT(pProgram, "Failed to register {} shader program", pName);
+    pProgram->Create(programCreateInfo);
+    ENG_ASSERT(pProgram->IsValid(), "Failed to create {} shader program", pName);
+    pProgram->SetDebugName(pName);
+
+    return pProgram;
+}
+
+
+static ShaderProgram* CreateShaderProgram(const char* pName, const std::string& vsSourceCode, const std::string& psSourceCode) noexcept
+{
+    const ShaderStageType types[] = { ShaderStageType::VERTEX, ShaderStageType::PIXEL };
+    const std::string* pSourceCodes[] = { &vsSourceCode, &psSourceCode };
+
+    return CreateProgram(pName, types, pSourceCodes, _countof(types));
+}
+
+
+static ShaderProgram* CreateComputeProgram(const char* pName, const std::string& csSourceCode) noexcept
+{
+    const ShaderStageType types[] = { ShaderStageType::COMPUTE };
+    const std::string* pSourceCodes[] = { &csSourceCode };
+
+    return CreateProgram(pName, types, pSourceCodes, _countof(types));
+}
+
+
+// Creates all resources the passes need, so that the first frame doesn't pay for shaders compilation and uploads.
+// Must be called on the thread which owns graphics context
+static bool CreateFrameResources(const FrameResourcesSourceData& sourceData, VisibilityGeometry& visibilityGeometry) noexcept
+{
+    TextureManager& texManager = TextureManager::GetInstance();
+    RenderTargetManager& rtManager = RenderTargetManager::GetInstance();
+    PipelineManager& pipelineManager = PipelineManager::GetInstance();
+    MeshDataManager& meshDataManager = MeshDataManager::GetInstance();
+    MeshManager& meshManager = MeshManager::GetInstance();
+
+    // Pipelines need valid frame buffers, they are set up by the frame graph compilation in RenderSystem::Init
+
+    pDepthPrepassProgram = CreateShaderProgram("Pass_Depth_Prepass", sourceData.depthPrepassVsSourceCode, sourceData.depthPrepassPsSourceCode);
+    pGBufferProgram = CreateShaderProgram("Pass_GBuffer", sourceData.gBufferVsSourceCode, sourceData.gBufferPsSourceCode);
+    pPostProcProgram = CreateShaderProgram("Pass_Post_Process", sourceData.postProcVsSourceCode, sourceData.postProcPsSourceCode);
+    pVisibilityProgram = CreateShaderProgram("Pass_Visibility", sourceData.visibilityVsSourceCode, sourceData.visibilityPsSourceCode);
+    pVisibilityResolveProgram = CreateShaderProgram("Pass_Visibility_Resolve", sourceData.visibilityResolveVsSourceCode, 
+        sourceData.visibilityResolvePsSourceCode);
+    pLightCullingProgram = CreateComputeProgram("Pass_Light_Culling", sourceData.lightCullingCsSourceCode);
+    pHiZDownsampleProgram = CreateComputeProgram("Pass_HiZ_Downsample", sourceData.hiZDownsampleCsSourceCode);
+    pOcclusionCullingProgram = CreateComputeProgram("Pass_Occlusion_Culling", sourceData.occlusionCullingCsSourceCode);
+    pTemporalUpscaleProgram = CreateComputeProgram("Pass_Temporal_Upscale", sourceData.temporalUpscaleCsSourceCode);
+
+    Texture2DCreateInfo texCreateInfo = {};
+    texCreateInfo.format = resGetTexResourceFormat(TEST_TEXTURE);
+    texCreateInfo.width = TEST_TEXTURE_WIDTH;
+    texCreateInfo.height = TEST_TEXTURE_HEIGHT;
+    texCreateInfo.mipmapsCount = 0;
+    texCreateInfo.inputData.format = TextureInputDataFormat::INPUT_FORMAT_RGBA;
+    texCreateInfo.inputData.dataType = TextureInputDataType::INPUT_TYPE_UNSIGNED_BYTE;
+
+    texCreateInfo.inputData.pData = sourceData.testTextureData.data();
+
+    ds::StrID testTexName = "TEST_TEXTURE";
+    pTestTexture = texManager.RegisterTexture2D(testTexName);
+    ENG_ASSERT(pTestTexture, "Failed to register texture: {}", testTexName.CStr());
+    pTestTexture->Create(texCreateInfo);
+    ENG_ASSERT(pTestTexture->IsValid(), "Failed to create texture: {}", testTexName.CStr());
+
+    pTestTextureSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(TEST_TEXTURE));
+
+    pGBufferAlbedoSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(GBufferAlbedoTex));
+    pGBufferNormalSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(GBufferNormalTex));
+    pGBufferSpecSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(GBUFFER_SPECULAR_TEX));
+    pGBufferDepthSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(COMMON_DEPTH_TEX));
+    pHiZSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(COMMON_HIZ_TEX));
+    pGBufferMotionSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(GBUFFER_MOTION_TEX));
+    pTemporalColorSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(CommonColorTex));
+    pTemporalHistorySampler = texManager.GetSampler(resGetTexResourceSamplerIdx(COMMON_TEMPORAL_HISTORY_TEX));
+    pVisibilitySampler = texManager.GetSampler(resGetTexResourceSamplerIdx(COMMON_VISIBILITY_TEX));
+
+
+    InputAssemblyStateCreateInfo depthPrepassInputAssemblyState = {};
+    depthPrepassInputAssemblyState.topology = PrimitiveTopology::TOPOLOGY_TRIANGLES;
+
+    RasterizationStateCreateInfo depthPrepassRasterizationState = {};
+    depthPrepassRasterizationState.cullMode = CullMode::CULL_MODE_BACK;
+    depthPrepassRasterizationState.depthBiasEnable = false;
+    depthPrepassRasterizationState.frontFace = FrontFace::FRONT_FACE_COUNTER_CLOCKWISE;
+    depthPrepassRasterizationState.polygonMode = PolygonMode::POLYGON_MODE_FILL;
+
+    DepthStencilStateCreateInfo depthPrepassDepthStencilState = {};
+    depthPrepassDepthStencilState.depthTestEnable = true;
+    depthPrepassDepthStencilState.depthWriteEnable = true;
+    depthPrepassDepthStencilState.depthCompareFunc = CompareFunc::FUNC_GREATER;
+    depthPrepassDepthStencilState.stencilTestEnable = false;
+
+    // Depth only frame buffer, color states are not needed
+    ColorBlendStateCreateInfo depthPrepassColorBlendState = {};
+
+    FrameBufferClearValues depthPrepassFrameBufferClearValues = {};
+    depthPrepassFrameBufferClearValues.depthClearValue = 0.f;
+
+    // Depth is loaded by the GBuffer pass and read by the color pass
+    FrameBufferAttachmentOps depthPrepassFrameBufferAttachmentOps = {};
+    depthPrepassFrameBufferAttachmentOps.depthStencilLoadOp = AttachmentLoadOp::LOAD_OP_CLEAR;
+    depthPrepassFrameBufferAttachmentOps.depthStencilStoreOp = AttachmentStoreOp::STORE_OP_STORE;
+
+    PipelineCreateInfo depthPrepassPipelineCreateInfo = {};
+    depthPrepassPipelineCreateInfo.pInputAssemblyState = &depthPrepassInputAssemblyState;
+    depthPrepassPipelineCreateInfo.pRasterizationState = &depthPrepassRasterizationState;
+    depthPrepassPipelineCreateInfo.pDepthStencilState = &depthPrepassDepthStencilState;
+    depthPrepassPipelineCreateInfo.pColorBlendState = &depthPrepassColorBlendState;
+    depthPrepassPipelineCreateInfo.pFrameBufferClearValues = &depthPrepassFrameBufferClearValues;
+    depthPrepassPipelineCreateInfo.pFrameBufferAttachmentOps = &depthPrepassFrameBufferAttachmentOps;
+    depthPrepassPipelineCreateInfo.pFrameBuffer = rtManager.GetFrameBuffer(RTFrameBufferID::DEPTH_PREPASS);
+    depthPrepassPipelineCreateInfo.pShaderProgram = pDepthPrepassProgram;
+
+    pDepthPrepassPipeline = pipelineManager.RegisterPipeline();
+    ENG_ASSERT(pDepthPrepassPipeline, "Failed to register DEPTH PREPASS pipeline");
+    pDepthPrepassPipeline->Create(depthPrepassPipelineCreateInfo);
+    ENG_ASSERT(pDepthPrepassPipeline->IsValid(), "Failed to create DEPTH PREPASS pipeline");
+
+
+    InputAssemblyStateCreateInfo gBufferInputAssemblyState = {};
+    gBufferInputAssemblyState.topology = PrimitiveTopology::TOPOLOGY_TRIANGLES;
+
+    RasterizationStateCreateInfo gBufferRasterizationState = {};
+    gBufferRasterizationState.cullMode = CullMode::CULL_MODE_BACK;
+    gBufferRasterizationState.depthBiasEnable = false;
+    gBufferRasterizationState.frontFace = FrontFace::FRONT_FACE_COUNTER_CLOCKWISE;
+    gBufferRasterizationState.polygonMode = PolygonMode::POLYGON_MODE_FILL;
+
+    DepthStencilStateCreateInfo gBufferDepthStencilState = {};
+    gBufferDepthStencilState.depthTestEnable = true;
+    gBufferDepthStencilState.depthWriteEnable = true;
+    gBufferDepthStencilState.depthCompareFunc = CompareFunc::FUNC_GREATER;
+    gBufferDepthStencilState.stencilTestEnable = false;
+
+    ColorBlendStateCreateInfo gBufferColorBlendState = {};
+    
+    ColorBlendAttachmentState gBufferAlbedoBlendState = {};
+    gBufferAlbedoBlendState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
+    ColorBlendAttachmentState gBufferNormalBlendState = {};
+    gBufferNormalBlendState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
+#if !defined(ENG_GBUFFER_COMPACT)
+    ColorBlendAttachmentState gBufferSpecularBlendState = {};
+    gBufferSpecularBlendState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
+#endif
+    ColorBlendAttachmentState gBufferMotionBlendState = {};
+    gBufferMotionBlendState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
+    
+    ColorBlendAttachmentState gBufferColorAttachmentsBlendStates[] = { 
+        gBufferAlbedoBlendState, 
+        gBufferNormalBlendState, 
+#if !defined(ENG_GBUFFER_COMPACT)
+        gBufferSpecularBlendState,
+#endif
+        gBufferMotionBlendState,
+    };
+    gBufferColorBlendState.pAttachmentStates = gBufferColorAttachmentsBlendStates;
+    gBufferColorBlendState.attachmentCount = _countof(gBufferColorAttachmentsBlendStates);
+
+    FrameBufferClearValues gBufferFrameBufferClearValues = {};
+    const FrameBufferColorAttachmentClearColor pGBufferColorAttachmentClearColors[] = {
+        { 1.f, 1.f, 0.f, 0.f },
+        { 0.f, 0.f, 0.f, 0.f },
+#if !defined(ENG_GBUFFER_COMPACT)
+        { 0.f, 0.f, 0.f, 0.f },
+#endif
+        { 0.f, 0.f, 0.f, 0.f },
+    };
+    gBufferFrameBufferClearValues.pColorAttachmentClearColors = pGBufferColorAttachmentClearColors;
+    gBufferFrameBufferClearValues.colorAttachmentsCount = _countof(pGBufferColorAttachmentClearColors);
+    gBufferFrameBufferClearValues.depthClearValue = 0.f;
+
+    // GBuffer is read by the color pass and motion by the temporal upscale pass. Frame graph discards them after that
+    const AttachmentLoadOp pGBufferColorAttachmentLoadOps[] = {
+        AttachmentLoadOp::LOAD_OP_CLEAR, 
+        AttachmentLoadOp::LOAD_OP_CLEAR, 
+#if !defined(ENG_GBUFFER_COMPACT)
+        AttachmentLoadOp::LOAD_OP_CLEAR,
+#endif
+        AttachmentLoadOp::LOAD_OP_CLEAR,
+    };
+    const AttachmentStoreOp pGBufferColorAttachmentStoreOps[] = {
+        AttachmentStoreOp::STORE_OP_STORE, 
+        AttachmentStoreOp::STORE_OP_STORE, 
+#if !defined(ENG_GBUFFER_COMPACT)
+        AttachmentStoreOp::STORE_OP_STORE,
+#endif
+        AttachmentStoreOp::STORE_OP_STORE,
+    };
+
+    FrameBufferAttachmentOps gBufferFrameBufferAttachmentOps = {};
+    gBufferFrameBufferAttachmentOps.pColorAttachmentLoadOps = pGBufferColorAttachmentLoadOps;
+    gBufferFrameBufferAttachmentOps.pColorAttachmentStoreOps = pGBufferColorAttachmentStoreOps;
+    gBufferFrameBufferAttachmentOps.colorAttachmentsCount = _countof(pGBufferColorAttachmentLoadOps);
+    gBufferFrameBufferAttachmentOps.depthStencilLoadOp = AttachmentLoadOp::LOAD_OP_CLEAR;
+    gBufferFrameBufferAttachmentOps.depthStencilStoreOp = AttachmentStoreOp::STORE_OP_STORE;
+
+    PipelineCreateInfo gBufferPipelineCreateInfo = {};
+    gBufferPipelineCreateInfo.pInputAssemblyState = &gBufferInputAssemblyState;
+    gBufferPipelineCreateInfo.pRasterizationState = &gBufferRasterizationState;
+    gBufferPipelineCreateInfo.pDepthStencilState = &gBufferDepthStencilState;
+    gBufferPipelineCreateInfo.pColorBlendState = &gBufferColorBlendState;
+    gBufferPipelineCreateInfo.pFrameBufferClearValues = &gBufferFrameBufferClearValues;
+    gBufferPipelineCreateInfo.pFrameBufferAttachmentOps = &gBufferFrameBufferAttachmentOps;
+    gBufferPipelineCreateInfo.pFrameBuffer = rtManager.GetFrameBuffer(RTFrameBufferID::GBUFFER);
+    gBufferPipelineCreateInfo.pShaderProgram = pGBufferProgram;
+
+    pGBufferPipeline = pipelineManager.RegisterPipeline();
+    ENG_ASSERT(pGBufferPipeline, "Failed to register GBUFFER pipeline");
+    pGBufferPipeline->Create(gBufferPipelineCreateInfo);
+    ENG_ASSERT(pGBufferPipeline->IsValid(), "Failed to create GBUFFER pipeline");
+
+    // Depth is complete after the prepass, so it's loaded and tested for equality without writes
+    gBufferDepthStencilState.depthWriteEnable = false;
+    gBufferDepthStencilState.depthCompareFunc = CompareFunc::FUNC_EQUAL;
+    gBufferFrameBufferAttachmentOps.depthStencilLoadOp = AttachmentLoadOp::LOAD_OP_LOAD;
+
+    pGBufferEqualDepthPipeline = pipelineManager.RegisterPipeline();
+    ENG_ASSERT(pGBufferEqualDepthPipeline, "Failed to register GBUFFER EQUAL DEPTH pipeline");
+    pGBufferEqualDepthPipeline->Create(gBufferPipelineCreateInfo);
+    ENG_ASSERT(pGBufferEqualDepthPipeline->IsValid(), "Failed to create GBUFFER EQUAL DEPTH pipeline");
+
+
+    // Visibility pass rasterizes the same geometry as the GBuffer pass, but writes a single integer target
+    DepthStencilStateCreateInfo visibilityDepthStencilState = {};
+    visibilityDepthStencilState.depthTestEnable = true;
+    visibilityDepthStencilState.depthWriteEnable = true;
+    visibilityDepthStencilState.depthCompareFunc = CompareFunc::FUNC_GREATER;
+    visibilityDepthStencilState.stencilTestEnable = false;
+
+    ColorBlendStateCreateInfo visibilityColorBlendState = {};
+
+    ColorBlendAttachmentState visibilityBlendState = {};
+    visibilityBlendState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
+
+    ColorBlendAttachmentState visibilityColorAttachmentsBlendStates[] = { visibilityBlendState };
+    visibilityColorBlendState.pAttachmentStates = visibilityColorAttachmentsBlendStates;
+    visibilityColorBlendState.attachmentCount = _countof(visibilityColorAttachmentsBlendStates);
+
+    FrameBufferClearValues visibilityFrameBufferClearValues = {};
+    const FrameBufferColorAttachmentClearColor pVisibilityColorAttachmentClearColors[] = {
+        { 0.f, 0.f, 0.f, 0.f },
+    };
+    visibilityFrameBufferClearValues.pColorAttachmentClearColors = pVisibilityColorAttachmentClearColors;
+    visibilityFrameBufferClearValues.colorAttachmentsCount = _countof(pVisibilityColorAttachmentClearColors);
+    visibilityFrameBufferClearValues.depthClearValue = 0.f;
+
+    // Integer target can't be cleared with float clear color. It isn't needed either, since background pixels are found by depth
+    const AttachmentLoadOp pVisibilityColorAttachmentLoadOps[] = { AttachmentLoadOp::LOAD_OP_DONT_CARE };
+    const AttachmentStoreOp pVisibilityColorAttachmentStoreOps[] = { AttachmentStoreOp::STORE_OP_STORE };
+
+    FrameBufferAttachmentOps visibilityFrameBufferAttachmentOps = {};
+    visibilityFrameBufferAttachmentOps.pColorAttachmentLoadOps = pVisibilityColorAttachmentLoadOps;
+    visibilityFrameBufferAttachmentOps.pColorAttachmentStoreOps = pVisibilityColorAttachmentStoreOps;
+    visibilityFrameBufferAttachmentOps.colorAttachmentsCount = _countof(pVisibilityColorAttachmentLoadOps);
+    visibilityFrameBufferAttachmentOps.depthStencilLoadOp = AttachmentLoadOp::LOAD_OP_CLEAR;
+    visibilityFrameBufferAttachmentOps.depthStencilStoreOp = AttachmentStoreOp::STORE_OP_STORE;
+
+    PipelineCreateInfo visibilityPipelineCreateInfo = {};
+    visibilityPipelineCreateInfo.pInputAssemblyState = &gBufferInputAssemblyState;
+    visibilityPipelineCreateInfo.pRasterizationState = &gBufferRasterizationState;
+    visibilityPipelineCreateInfo.pDepthStencilState = &visibilityDepthStencilState;
+    visibilityPipelineCreateInfo.pColorBlendState = &visibilityColorBlendState;
+    visibilityPipelineCreateInfo.pFrameBufferClearValues = &visibilityFrameBufferClearValues;
+    visibilityPipelineCreateInfo.pFrameBufferAttachmentOps = &visibilityFrameBufferAttachmentOps;
+    visibilityPipelineCreateInfo.pFrameBuffer = rtManager.GetFrameBuffer(RTFrameBufferID::VISIBILITY);
+    visibilityPipelineCreateInfo.pShaderProgram = pVisibilityProgram;
+
+    pVisibilityPipeline = pipelineManager.RegisterPipeline();
+    ENG_ASSERT(pVisibilityPipeline, "Failed to register VISIBILITY pipeline");
+    pVisibilityPipeline->Create(visibilityPipelineCreateInfo);
+    ENG_ASSERT(pVisibilityPipeline->IsValid(), "Failed to create VISIBILITY pipeline");
+
+    visibilityDepthStencilState.depthWriteEnable = false;
+    visibilityDepthStencilState.depthCompareFunc = CompareFunc::FUNC_EQUAL;
+    visibilityFrameBufferAttachmentOps.depthStencilLoadOp = AttachmentLoadOp::LOAD_OP_LOAD;
+
+    pVisibilityEqualDepthPipeline = pipelineManager.RegisterPipeline();
+    ENG_ASSERT(pVisibilityEqualDepthPipeline, "Failed to register VISIBILITY EQUAL DEPTH pipeline");
+    pVisibilityEqualDepthPipeline->Create(visibilityPipelineCreateInfo);
+    ENG_ASSERT(pVisibilityEqualDepthPipeline->IsValid(), "Failed to create VISIBILITY EQUAL DEPTH pipeline");
+
+
+    InputAssemblyStateCreateInfo postProcInputAssemblyState = {};
+    postProcInputAssemblyState.topology = PrimitiveTopology::TOPOLOGY_TRIANGLES;
+
+    RasterizationStateCreateInfo postProcRasterizationState = {};
+    postProcRasterizationState.cullMode = CullMode::CULL_MODE_BACK;
+    postProcRasterizationState.depthBiasEnable = false;
+    postProcRasterizationState.frontFace = FrontFace::FRONT_FACE_COUNTER_CLOCKWISE;
+    postProcRasterizationState.polygonMode = PolygonMode::POLYGON_MODE_FILL;
+
+    DepthStencilStateCreateInfo postProcDepthStencilState = {};
+    postProcDepthStencilState.depthTestEnable = false;
+    postProcDepthStencilState.stencilTestEnable = false;
+
+    ColorBlendStateCreateInfo postProcColorBlendState = {};
+
+    ColorBlendAttachmentState postProcColorBlendAttachmentState = {};
+    postProcColorBlendAttachmentState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
+
+    ColorBlendAttachmentState postProcColorAttachmentsBlendStates[] = { postProcColorBlendAttachmentState };
+    postProcColorBlendState.pAttachmentStates = postProcColorAttachmentsBlendStates;
+    postProcColorBlendState.attachmentCount = _countof(postProcColorAttachmentsBlendStates);
+
+    FrameBufferClearValues postProcFrameBufferClearValues = {};
+    const FrameBufferColorAttachmentClearColor pPostProcColorAttachmentClearColors[] = {
+        { 0.f, 0.f, 0.f, 0.f },
+    };
+    postProcFrameBufferClearValues.pColorAttachmentClearColors = pPostProcColorAttachmentClearColors;
+    postProcFrameBufferClearValues.colorAttachmentsCount = _countof(pPostProcColorAttachmentClearColors);
+
+    // Fullscreen draw overwrites every pixel, so the previous contents aren't loaded
+    const AttachmentLoadOp pPostProcColorAttachmentLoadOps[] = { AttachmentLoadOp::LOAD_OP_DONT_CARE };
+    const AttachmentStoreOp pPostProcColorAttachmentStoreOps[] = { AttachmentStoreOp::STORE_OP_STORE };
+
+    FrameBufferAttachmentOps postProcFrameBufferAttachmentOps = {};
+    postProcFrameBufferAttachmentOps.pColorAttachmentLoadOps = pPostProcColorAttachmentLoadOps;
+    postProcFrameBufferAttachmentOps.pColorAttachmentStoreOps = pPostProcColorAttachmentStoreOps;
+    postProcFrameBufferAttachmentOps.colorAttachmentsCount = _countof(pPostProcColorAttachmentLoadOps);
+    postProcFrameBufferAttachmentOps.depthStencilLoadOp = AttachmentLoadOp::LOAD_OP_DONT_CARE;
+    postProcFrameBufferAttachmentOps.depthStencilStoreOp = AttachmentStoreOp::STORE_OP_DONT_CARE;
+
+    PipelineCreateInfo postProcPipelineCreateInfo = {};
+    postProcPipelineCreateInfo.pInputAssemblyState = &postProcInputAssemblyState;
+    postProcPipelineCreateInfo.pRasterizationState = &postProcRasterizationState;
+    postProcPipelineCreateInfo.pDepthStencilState = &postProcDepthStencilState;
+    postProcPipelineCreateInfo.pColorBlendState = &postProcColorBlendState;
+    postProcPipelineCreateInfo.pFrameBufferClearValues = &postProcFrameBufferClearValues;
+    postProcPipelineCreateInfo.pFrameBufferAttachmentOps = &postProcFrameBufferAttachmentOps;
+    postProcPipelineCreateInfo.pFrameBuffer = rtManager.GetFrameBuffer(RTFrameBufferID::POST_PROCESS);
+    postProcPipelineCreateInfo.pShaderProgram = pPostProcProgram;
+
+    pPostProcPipeline = pipelineManager.RegisterPipeline();
+    ENG_ASSERT(pPostProcPipeline, "Failed to register POST PROCESS pipeline");
+    pPostProcPipeline->Create(postProcPipelineCreateInfo);
+    ENG_ASSERT(pPostProcPipeline->IsValid(), "Failed to create POST PROCESS pipeline");
+
+
+    // Visibility resolve is a fullscreen pass like the color one, which writes motion along with color
+    ColorBlendAttachmentState visibilityResolveColorAttachmentsBlendStates[] = { postProcColorBlendAttachmentState, postProcColorBlendAttachmentState };
+    
+    ColorBlendStateCreateInfo visibilityResolveColorBlendState = {};
+    visibilityResolveColorBlendState.pAttachmentStates = visibilityResolveColorAttachmentsBlendStates;
+    visibilityResolveColorBlendState.attachmentCount = _countof(visibilityResolveColorAttachmentsBlendStates);
+
+    FrameBufferClearValues visibilityResolveFrameBufferClearValues = {};
+    const FrameBufferColorAttachmentClearColor pVisibilityResolveColorAttachmentClearColors[] = {
+        { 0.f, 0.f, 0.f, 0.f },
+        { 0.f, 0.f, 0.f, 0.f },
+    };
+    visibilityResolveFrameBufferClearValues.pColorAttachmentClearColors = pVisibilityResolveColorAttachmentClearColors;
+    visibilityResolveFrameBufferClearValues.colorAttachmentsCount = _countof(pVisibilityResolveColorAttachmentClearColors);
+
+    const AttachmentLoadOp pVisibilityResolveColorAttachmentLoadOps[] = { AttachmentLoadOp::LOAD_OP_DONT_CARE, AttachmentLoadOp::LOAD_OP_DONT_CARE };
+    const AttachmentStoreOp pVisibilityResolveColorAttachmentStoreOps[] = { AttachmentStoreOp::STORE_OP_STORE, AttachmentStoreOp::STORE_OP_STORE };
+
+    FrameBufferAttachmentOps visibilityResolveFrameBufferAttachmentOps = {};
+    visibilityResolveFrameBufferAttachmentOps.pColorAttachmentLoadOps = pVisibilityResolveColorAttachmentLoadOps;
+    visibilityResolveFrameBufferAttachmentOps.pColorAttachmentStoreOps = pVisibilityResolveColorAttachmentStoreOps;
+    visibilityResolveFrameBufferAttachmentOps.colorAttachmentsCount = _countof(pVisibilityResolveColorAttachmentLoadOps);
+    visibilityResolveFrameBufferAttachmentOps.depthStencilLoadOp = AttachmentLoadOp::LOAD_OP_DONT_CARE;
+    visibilityResolveFrameBufferAttachmentOps.depthStencilStoreOp = AttachmentStoreOp::STORE_OP_DONT_CARE;
+
+    PipelineCreateInfo visibilityResolvePipelineCreateInfo = postProcPipelineCreateInfo;
+    visibilityResolvePipelineCreateInfo.pColorBlendState = &visibilityResolveColorBlendState;
+    visibilityResolvePipelineCreateInfo.pFrameBufferClearValues = &visibilityResolveFrameBufferClearValues;
+    visibilityResolvePipelineCreateInfo.pFrameBufferAttachmentOps = &visibilityResolveFrameBufferAttachmentOps;
+    visibilityResolvePipelineCreateInfo.pFrameBuffer = rtManager.GetFrameBuffer(RTFrameBufferID::VISIBILITY_RESOLVE);
+    visibilityResolvePipelineCreateInfo.pShaderProgram = pVisibilityResolveProgram;
+
+    pVisibilityResolvePipeline = pipelineManager.RegisterPipeline();
+    ENG_ASSERT(pVisibilityResolvePipeline, "Failed to register VISIBILITY RESOLVE pipeline");
+    pVisibilityResolvePipeline->Create(visibilityResolvePipelineCreateInfo);
+    ENG_ASSERT(pVisibilityResolvePipeline->IsValid(), "Failed to create VISIBILITY RESOLVE pipeline");
+
+
+    const MeshVertexAttribDesc pVertexAttribDescs[] = {
+        MeshVertexAttribDesc { 0 * sizeof(float), MeshVertexAttribDataType::TYPE_FLOAT, 0, 3, false },
+        MeshVertexAttribDesc { 3 * sizeof(float), MeshVertexAttribDataType::TYPE_FLOAT, 1, 3, false },
+        MeshVertexAttribDesc { 6 * sizeof(float), MeshVertexAttribDataType::TYPE_FLOAT, 2, 2, false },
+    };
+
+    MeshVertexLayoutCreateInfo cubeVertexLayoutCreateInfo = {};
+    cubeVertexLayoutCreateInfo.pVertexAttribDescs = pVertexAttribDescs;
+    cubeVertexLayoutCreateInfo.vertexAttribDescsCount = _countof(pVertexAttribDescs);
+
+    MeshVertexLayout* pCubeVertexLayout = meshDataManager.RegisterVertexLayout(cubeVertexLayoutCreateInfo);
+    ENG_ASSERT(pCubeVertexLayout && pCubeVertexLayout->IsValid(), "Failed to register cube mesh vertex layout");
+
+    MeshGPUBufferData* pCubeBufferData = meshDataManager.RegisterGPUBufferData("cube");
+    ENG_ASSERT(pCubeBufferData, "Failed to register cube mesh GPU data");
+
+    constexpr float CUBE_HALF_SIZE = 0.5f;
+
+    const float pCubeRawVertexData[] = {
+        // position                                     // normal                       // UV
+        // Front face
+       -CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f, -0.57735f, 0.57735f, 0.f, 0.f,
+       -CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f,  0.57735f, 0.57735f, 0.f, 1.f,
+        CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f,  0.57735f, 0.57735f, 1.f, 1.f,
+        CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f, -0.57735f, 0.57735f, 1.f, 0.f,
+
+        // Back face
+        CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f, -0.57735f, -0.57735f, 0.f, 0.f,
+        CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f,  0.57735f, -0.57735f, 0.f, 1.f,
+       -CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f,  0.57735f, -0.57735f, 1.f, 1.f,
+       -CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f, -0.57735f, -0.57735f, 1.f, 0.f,
+
+        // Left face
+       -CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f, -0.57735f, -0.57735f, 0.f, 0.f,
+       -CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f,  0.57735f, -0.57735f, 0.f, 1.f,
+       -CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f,  0.57735f,  0.57735f, 1.f, 1.f,
+       -CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f, -0.57735f,  0.57735f, 1.f, 0.f,
+
+        // Right face
+        CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f, -0.57735f,  0.57735f, 0.f, 0.f,
+        CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f,  0.57735f,  0.57735f, 0.f, 1.f,
+        CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f,  0.57735f, -0.57735f, 1.f, 1.f,
+        CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f, -0.57735f, -0.57735f, 1.f, 0.f,
+
+        // Top face
+       -CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f,  0.57735f,  0.57735f, 0.f, 0.f,
+       -CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f,  0.57735f, -0.57735f, 0.f, 1.f,
+        CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f,  0.57735f, -0.57735f, 1.f, 1.f,
+        CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f,  0.57735f,  0.57735f, 1.f, 0.f,
+
+        // Bottom face
+       -CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f, -0.57735f, -0.57735f, 0.f, 0.f,
+       -CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f, -0.57735f,  0.57735f, 0.f, 1.f,
+        CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f, -0.57735f,  0.57735f, 1.f, 1.f,
+        CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f, -0.57735f, -0.57735f, 1.f, 0.f,
+    };
+
+    const uint8_t cubeIndices[] = {
+        0, 2, 1, 0, 3, 2,
+        4, 6, 5, 4, 7, 6,
+        8, 10, 9, 8, 11, 10,
+        12, 14, 13, 12, 15, 14,
+        16, 18, 17, 16, 19, 18,
+        20, 22, 21, 20, 23, 22
+    };
+
+    MeshGPUBufferDataCreateInfo cubeGPUDataCreateInfo = {};
+    cubeGPUDataCreateInfo.pVertexData = pCubeRawVertexData;
+    cubeGPUDataCreateInfo.vertexDataSize = sizeof(pCubeRawVertexData);
+    cubeGPUDataCreateInfo.vertexSize = sizeof(pCubeRawVertexData) / 24;
+    cubeGPUDataCreateInfo.pIndexData = cubeIndices;
+    cubeGPUDataCreateInfo.indexDataSize = sizeof(cubeIndices);
+    cubeGPUDataCreateInfo.indexSize = sizeof(cubeIndices[0]);
+
+    pCubeBufferData->Create(cubeGPUDataCreateInfo);
+
+    pCubeMeshObj = meshManager.RegisterMeshObj("cube");
+    ENG_ASSERT(pCubeMeshObj, "Failed to register cube mesh object");
+    pCubeMeshObj->Create(pCubeVertexLayout, pCubeBufferData);
+    ENG_ASSERT(pCubeMeshObj->IsValid(), "Failed to create cube mesh object");
+    pCubeMeshObj->SetBounds(glm::vec3(-CUBE_HALF_SIZE), glm::vec3(CUBE_HALF_SIZE));
+
+    // Depth prepass fetches tightly packed positions instead of full vertices
+    constexpr size_t CUBE_VERTEX_ELEMENTS_COUNT = 8;
+    constexpr size_t CUBE_VERTICES_COUNT = _countof(pCubeRawVertexData) / CUBE_VERTEX_ELEMENTS_COUNT;
+
+    std::array<float, CUBE_VERTICES_COUNT * 3> cubePositions = {};
+    for (size_t i = 0; i < CUBE_VERTICES_COUNT; ++i) {
+        memcpy(&cubePositions[i * 3], &pCubeRawVertexData[i * CUBE_VERTEX_ELEMENTS_COUNT], 3 * sizeof(float));
+    }
+
+    const MeshVertexAttribDesc pPositionVertexAttribDescs[] = {
+        MeshVertexAttribDesc { 0, MeshVertexAttribDataType::TYPE_FLOAT, 0, 3, false },
+    };
+
+    MeshVertexLayoutCreateInfo positionVertexLayoutCreateInfo = {};
+    positionVertexLayoutCreateInfo.pVertexAttribDescs = pPositionVertexAttribDescs;
+    positionVertexLayoutCreateInfo.vertexAttribDescsCount = _countof(pPositionVertexAttribDescs);
+
+    MeshVertexLayout* pPositionVertexLayout = meshDataManager.RegisterVertexLayout(positionVertexLayoutCreateInfo);
+    ENG_ASSERT(pPositionVertexLayout && pPositionVertexLayout->IsValid(), "Failed to register position only vertex layout");
+
+    MeshGPUBufferData* pCubePositionsBufferData = meshDataManager.RegisterGPUBufferData("cube_positions");
+    ENG_ASSERT(pCubePositionsBufferData, "Failed to register cube positions GPU data");
+
+    MeshGPUBufferDataCreateInfo cubePositionsGPUDataCreateInfo = cubeGPUDataCreateInfo;
+    cubePositionsGPUDataCreateInfo.pVertexData = cubePositions.data();
+    cubePositionsGPUDataCreateInfo.vertexDataSize = sizeof(cubePositions);
+    cubePositionsGPUDataCreateInfo.vertexSize = 3 * sizeof(float);
+
+    pCubePositionsBufferData->Create(cubePositionsGPUDataCreateInfo);
+
+    pCubePositionsMeshObj = meshManager.RegisterMeshObj("cube_positions");
+    ENG_ASSERT(pCubePositionsMeshObj, "Failed to register cube positions mesh object");
+    pCubePositionsMeshObj->Create(pPositionVertexLayout, pCubePositionsBufferData);
+    ENG_ASSERT(pCubePositionsMeshObj->IsValid(), "Failed to create cube positions mesh object");
+
+    pCubeMeshObj->SetPositionStream(pCubePositionsMeshObj);
+
+    // Position stream has the same indices, so triangle indices written by the visibility pass match the full mesh
+    visibilityGeometry.AddMesh(pCubeMeshObj, cubeGPUDataCreateInfo);
+
+#if defined(ENG_RUN_RENDER_BENCHMARKS)
+    // UV sphere dense enough for its triangles to cover a few pixels each at the benchmark resolutions
+    constexpr uint32_t SPHERE_VERTICES_COUNT = (RenderFrameBenchmark::SPHERE_RINGS_COUNT + 1) * (RenderFrameBenchmark::SPHERE_SEGMENTS_COUNT + 1);
+    constexpr size_t SPHERE_VERTEX_ELEMENTS_COUNT = 8;
+
+    std::vector<float> sphereVertices;
+    sphereVertices.reserve(SPHERE_VERTICES_COUNT * SPHERE_VERTEX_ELEMENTS_COUNT);
+
+    std::vector<float> spherePositions;
+    spherePositions.reserve(SPHERE_VERTICES_COUNT * 3);
+
+    for (uint32_t ring = 0; ring <= RenderFrameBenchmark::SPHERE_RINGS_COUNT; ++ring) {
+        const float v = (float)ring / RenderFrameBenchmark::SPHERE_RINGS_COUNT;
+        const float theta = v * M3D_PI;
+
+        for (uint32_t segment = 0; segment <= RenderFrameBenchmark::SPHERE_SEGMENTS_COUNT; ++segment) {
+            const float u = (float)segment / RenderFrameBenchmark::SPHERE_SEGMENTS_COUNT;
+            const float phi = u * M3D_TWO_PI;
+
+            const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            const glm::vec3 position = normal * RenderFrameBenchmark::SPHERE_RADIUS;
+
+            sphereVertices.insert(sphereVertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, u, v });
+            spherePositions.insert(spherePositions.end(), { position.x, position.y, position.z });
+        }
+    }
+
+    std::vector<uint32_t> sphereIndices;
+    sphereIndices.reserve(6 * RenderFrameBenchmark::SPHERE_RINGS_COUNT * RenderFrameBenchmark::SPHERE_SEGMENTS_COUNT);
+
+    for (uint32_t ring = 0; ring < RenderFrameBenchmark::SPHERE_RINGS_COUNT; ++ring) {
+        for (uint32_t segment = 0; segment < RenderFrameBenchmark::SPHERE_SEGMENTS_COUNT; ++segment) {
+            const uint32_t v00 = ring * (RenderFrameBenchmark::SPHERE_SEGMENTS_COUNT + 1) + segment;
+            const uint32_t v01 = v00 + 1;
+            const uint32_t v10 = v00 + RenderFrameBenchmark::SPHERE_SEGMENTS_COUNT + 1;
+            const uint32_t v11 = v10 + 1;
+
+            // Counter clockwise from outside, like cube faces
+            sphereIndices.insert(sphereIndices.end(), { v00, v01, v10, v01, v11, v10 });
+        }
+    }
+
+    MeshGPUBufferDataCreateInfo sphereGPUDataCreateInfo = {};
+    sphereGPUDataCreateInfo.pVertexData = sphereVertices.data();
+    sphereGPUDataCreateInfo.vertexDataSize = sphereVertices.size() * sizeof(float);
+    sphereGPUDataCreateInfo.vertexSize = SPHERE_VERTEX_ELEMENTS_COUNT * sizeof(float);
+    sphereGPUDataCreateInfo.pIndexData = sphereIndices.data();
+    sphereGPUDataCreateInfo.indexDataSize = sphereIndices.size() * sizeof(uint32_t);
+    sphereGPUDataCreateInfo.indexSize = sizeof(uint32_t);
+
+    MeshGPUBufferData* pSphereBufferData = meshDataManager.RegisterGPUBufferData(RenderFrameBenchmark::SPHERE_MESH_NAME);
+    ENG_ASSERT(pSphereBufferData, "Failed to register benchmark sphere GPU data");
+    pSphereBufferData->Create(sphereGPUDataCreateInfo);
+
+    MeshObj* pSphereMeshObj = meshManager.RegisterMeshObj(RenderFrameBenchmark::SPHERE_MESH_NAME);
+    ENG_ASSERT(pSphereMeshObj, "Failed to register benchmark sphere mesh object");
+    pSphereMeshObj->Create(pCubeVertexLayout, pSphereBufferData);
+    ENG_ASSERT(pSphereMeshObj->IsValid(), "Failed to create benchmark sphere mesh object");
+    pSphereMeshObj->SetBounds(glm::vec3(-RenderFrameBenchmark::SPHERE_RADIUS), glm::vec3(RenderFrameBenchmark::SPHERE_RADIUS));
+
+    MeshGPUBufferDataCreateInfo spherePositionsGPUDataCreateInfo = sphereGPUDataCreateInfo;
+    spherePositionsGPUDataCreateInfo.pVertexData = spherePositions.data();
+    spherePositionsGPUDataCreateInfo.vertexDataSize = spherePositions.size() * sizeof(float);
+    spherePositionsGPUDataCreateInfo.vertexSize = 3 * sizeof(float);
+
+    MeshGPUBufferData* pSpherePositionsBufferData = meshDataManager.RegisterGPUBufferData("benchmark_sphere_positions");
+    ENG_ASSERT(pSpherePositionsBufferData, "Failed to register benchmark sphere positions GPU data");
+    pSpherePositionsBufferData->Create(spherePositionsGPUDataCreateInfo);
+
+    MeshObj* pSpherePositionsMeshObj = meshManager.RegisterMeshObj("benchmark_sphere_positions");
+    ENG_ASSERT(pSpherePositionsMeshObj, "Failed to register benchmark sphere positions mesh object");
+    pSpherePositionsMeshObj->Create(pPositionVertexLayout, pSpherePositionsBufferData);
+    ENG_ASSERT(pSpherePositionsMeshObj->IsValid(), "Failed to create benchmark sphere positions mesh object");
+
+    pSphereMeshObj->SetPositionStream(pSpherePositionsMeshObj);
+
+    visibilityGeometry.AddMesh(pSphereMeshObj, sphereGPUDataCreateInfo);
+#endif
+
+    if (!visibilityGeometry.Create()) {
+        ENG_LOG_ERROR("Failed to create visibility geometry");
+        return false;
+    }
+
+    ENG_LOG_INFO("StrID memory: {}/{} KB", ds::StrID::GetStorageSize() / 1024.f, ds::StrID::GetStorageCapacity() / 1024.f);
+
+    return true;
+}
+
+
+void RenderSystem::StartRenderThread() noexcept
+{
+    if (IsRenderThreadRunning()) {
+        ENG_LOG_GRAPHICS_API_WARN("Render thread is already running");
+        return;
+    }
+
+    engGetMainWindow().ReleaseContext();
+
+    m_framePacketQueue.Start();
+    m_renderThread = std::thread(&RenderSystem::RenderThreadLoop, this);
+}
+
+
+void RenderSystem::StopRenderThread() noexcept
+{
+    if (!IsRenderThreadRunning()) {
+        return;
+    }
+
+    m_framePacketQueue.Stop();
+    m_renderThread.join();
+
+    engGetMainWindow().MakeContextCurrent();
+}
+
+
+FramePacket* RenderSystem::AcquireFramePacket() noexcept
+{
+    return IsRenderThreadRunning() ? m_framePacketQueue.AcquireFreePacket() : nullptr;
+}
+
+
+void RenderSystem::SubmitFramePacket(FramePacket* pPacket) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(IsRenderThreadRunning(), "Attempt to submit frame packet while render thread is not running");
+    m_framePacketQueue.SubmitPacket(pPacket);
+}
+
+
+void RenderSystem::RenderThreadLoop() noexcept
+{
+    Window& window = engGetMainWindow();
+    window.MakeContextCurrent();
+
+    while (FramePacket* pPacket = m_framePacketQueue.AcquireSubmittedPacket()) {
+        RenderFramePacket(*pPacket);
+        m_framePacketQueue.ReleasePacket(pPacket);
+    }
+
+    window.ReleaseContext();
+}
+
+
+void RenderSystem::RenderFramePacket(const FramePacket& packet) noexcept
+{
+    if (packet.skipRendering) {
+        return;
+    }
+
+    m_pCurrFramePacket = &packet;
+
+    BeginFrame();
+
+    m_frameGraph.Execute();
+
+    EndFrame();
+
+    engGetMainWindow().SwapBuffers(packet.inputTag);
+
+    m_pCurrFramePacket = nullptr;
+}
+
+
+void RenderSystem::BeginFrame() noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(m_pCurrFramePacket, "Frame packet is not set");
+
+    const FramePacket& packet = *m_pCurrFramePacket;
+
+    engResetOpenGLStateCacheStatistics();
+    engResetPipelineAttachmentOpsStatistics();
+
+    engOpenGLReleaseCompletedRetiredObjects();
+
+    // Uploads requested by the previous frame and during resources creation become visible to this frame commands
+    UploadManager::GetInstance().Flush();
+
+    // Batches count isn't known before batching, but never exceeds draw items count
+    const size_t drawItemsCount = packet.drawItems.size();
+
+    m_constBufferAllocator.BeginFrame();
+    m_instanceDataRingBuffer.BeginFrame(drawItemsCount * sizeof(COMMON_INSTANCE_DATA));
+    m_indirectArgsRingBuffer.BeginFrame(drawItemsCount * sizeof(RenderDrawIndexedIndirectArgs));
+
+    m_lightDataRingBuffer.BeginFrame(std::max<size_t>(packet.lights.size(), 1) * sizeof(COMMON_LIGHT_DATA));
+    
+    // Framebuffer resize events are dispatched on the main thread, while render targets are owned by the render thread.
+    // So render system rebuilds frame graph explicitly when it sees new framebuffer size in a frame packet
+    const bool isMinimized = packet.framebufferWidth == 0 || packet.framebufferHeight == 0;
+
+    const bool isSizeChanged = packet.framebufferWidth != m_frameGraphWidth || packet.framebufferHeight != m_frameGraphHeight;
+
+    const bool isPassesSetChanged = packet.isDepthPrepassEnabled != m_isDepthPrepassEnabled || 
+        packet.isTemporalUpscalingEnabled != m_isTemporalUpscalingEnabled || packet.isVisibilityBufferEnabled != m_isVisibilityBufferEnabled;
+
+    if (!isMinimized && (isSizeChanged || isPassesSetChanged)) {
+        BuildFrameGraph(packet.framebufferWidth, packet.framebufferHeight, packet.isDepthPrepassEnabled, packet.isTemporalUpscalingEnabled, 
+            packet.isVisibilityBufferEnabled);
+    }
+
+    UpdateGPUQueriesStatistics();
+    UpdateRenderResolution(packet);
+    UpdateFrameConstants(packet);
+
+    IssueGPUTimestamp(m_gpuQueries[m_gpuQueriesIdx].frameBeginTimestamp);
+
+    PrepareLights();
+    PrepareGeometryDraws();
+
+    // Pooled render targets may be larger than the framebuffer, which is scaled down by dynamic resolution too. 
+    // So passes render into the top left region of render targets only
+    engOpenGLViewport(0, 0, m_renderWidth, m_renderHeight);
+    engOpenGLScissor(0, 0, m_renderWidth, m_renderHeight);
+    engOpenGLSetCapabilityEnabled(GL_SCISSOR_TEST, true);
+}
+
+
+void RenderSystem::EndFrame() noexcept
+{
+    IssueGPUTimestamp(m_gpuQueries[m_gpuQueriesIdx].frameEndTimestamp);
+
+    m_constBufferAllocator.EndFrame();
+    m_instanceDataRingBuffer.EndFrame();
+    m_indirectArgsRingBuffer.EndFrame();
+    m_lightDataRingBuffer.EndFrame();
+
+    m_commonConstants = {};
+    m_instances = {};
+    m_indirectArgs = {};
+    m_lights = {};
+
+    // Motion vectors of the next frame are computed against this camera
+    m_prevViewProjMatrix = m_pCurrFramePacket->viewProjMatrix;
+    m_prevProjJitter = m_pCurrFramePacket->projJitter;
+
+    // Render targets left after resize are kept for a while, so resizing back doesn't reallocate them
+    RenderTargetManager::GetInstance().UpdateTexturePool();
+
+    // Objects destroyed during the frame, e.g. render targets recreated on resize, are deleted once GPU is done with them
+    engOpenGLFenceRetiredObjects();
+
+    const OpenGLStateCacheStatistics stateCacheStats = engGetOpenGLStateCacheStatistics();
+
+    m_lastFrameStatistics.issuedStateCallsCount.store(stateCacheStats.issuedCallsCount, std::memory_order_relaxed);
+    m_lastFrameStatistics.skippedStateCallsCount.store(stateCacheStats.skippedCallsCount, std::memory_order_relaxed);
+    m_lastFrameStatistics.drawItemsCount.store(static_cast<uint32_t>(m_batchedDrawItems.size()), std::memory_order_relaxed);
+    m_lastFrameStatistics.instancedDrawCallsCount.store(static_cast<uint32_t>(m_instancedBatches.size()), std::memory_order_relaxed);
+    m_lastFrameStatistics.multiDrawCallsCount.store(static_cast<uint32_t>(m_multiDrawGroups.size()), std::memory_order_relaxed);
+    m_lastFrameStatistics.retiredObjectsCount.store(engGetOpenGLRetiredObjectsCount(), std::memory_order_relaxed);
+
+    const UploadManagerStatistics uploadStats = UploadManager::GetInstance().GetStatistics();
+    m_lastFrameStatistics.uploadedSize.store(uploadStats.uploadedSize, std::memory_order_relaxed);
+    m_lastFrameStatistics.pendingUploadSize.store(uploadStats.pendingSize, std::memory_order_relaxed);
+
+    const ConstBufferAllocatorStatistics constBufferStats = m_constBufferAllocator.GetStatistics();
+    m_lastFrameStatistics.constBuffersUtilization.store(constBufferStats.utilization, std::memory_order_relaxed);
+    m_lastFrameStatistics.constBuffersFragmentation.store(constBufferStats.fragmentation, std::memory_order_relaxed);
+
+    const FrameGraphStatistics& frameGraphStats = m_frameGraph.GetStatistics();
+    m_lastFrameStatistics.rtMemorySize.store(frameGraphStats.rtMemorySize, std::memory_order_relaxed);
+    m_lastFrameStatistics.aliasedRTMemorySize.store(frameGraphStats.aliasedRTMemorySize, std::memory_order_relaxed);
+
+    const PipelineAttachmentOpsStatistics attachmentOpsStats = engGetPipelineAttachmentOpsStatistics();
+    m_lastFrameStatistics.loadedAttachmentsCount.store(attachmentOpsStats.loadedAttachmentsCount, std::memory_order_relaxed);
+    m_lastFrameStatistics.clearedAttachmentsCount.store(attachmentOpsStats.clearedAttachmentsCount, std::memory_order_relaxed);
+    m_lastFrameStatistics.storedAttachmentsCount.store(attachmentOpsStats.storedAttachmentsCount, std::memory_order_relaxed);
+    m_lastFrameStatistics.discardedAttachmentsCount.store(attachmentOpsStats.discardedOnLoadAttachmentsCount +
+        attachmentOpsStats.discardedOnStoreAttachmentsCount + frameGraphStats.discardedAttachmentsCount, std::memory_order_relaxed);
+}
+
+
+void RenderSystem::PrepareGeometryDraws() noexcept
+{
+    const FramePacket& packet = *m_pCurrFramePacket;
+
+    const size_t drawItemsCount = packet.drawItems.size();
+
+    BuildInstancedBatches(packet);
+
+    const size_t batchesCount = m_instancedBatches.size();
+
+    if (drawItemsCount == 0) {
+        return;
+    }
+
+    m_instances = m_instanceDataRingBuffer.Allocate<COMMON_INSTANCE_DATA>(drawItemsCount);
+    ENG_ASSERT(m_instances.IsValid(), "Failed to allocate instance data");
+    
+    m_instances.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_INSTANCE_DATA_SB).GetBinding(), m_instances.offset, m_instances.size);
+
+    m_indirectArgs = m_indirectArgsRingBuffer.Allocate<RenderDrawIndexedIndirectArgs>(batchesCount);
+    ENG_ASSERT(m_indirectArgs.IsValid(), "Failed to allocate indirect args");
+
+    // Occlusion culling pass appends visible instances to batches and counts them in indirect args
+    m_indirectArgs.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_DRAW_INDIRECT_ARGS_UAV).GetBinding(), m_indirectArgs.offset, m_indirectArgs.size);
+
+    if (m_pVisibleInstancesBuffer->GetElementCount() < drawItemsCount) {
+        const size_t capacity = std::max(drawItemsCount, 2 * m_pVisibleInstancesBuffer->GetElementCount());
+
+        // Previous storage is retired until frames in flight are done with it
+        m_pVisibleInstancesBuffer->Destroy();
+
+        MemoryBufferCreateInfo visibleInstancesCreateInfo = {};
+        visibleInstancesCreateInfo.dataSize = capacity * sizeof(uint32_t);
+        visibleInstancesCreateInfo.elementSize = sizeof(uint32_t);
+        visibleInstancesCreateInfo.type = MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER;
+
+        m_pVisibleInstancesBuffer->Create(visibleInstancesCreateInfo);
+        ENG_ASSERT(m_pVisibleInstancesBuffer->IsValid(), "Failed to create visible instances buffer");
+        m_pVisibleInstancesBuffer->SetDebugName("__COMMON_VISIBLE_INSTANCES_UAV__");
+    }
+
+    m_pVisibleInstancesBuffer->BindIndexed(resGetResourceBinding(COMMON_VISIBLE_INSTANCES_UAV).GetBinding());
+
+    const DynamicRingBufferAllocation occlusionConstants = m_constBufferAllocator.AllocateTransient<COMMON_OCCLUSION_CB>();
+    COMMON_OCCLUSION_CB* pOcclusionConstBuff = occlusionConstants.As<COMMON_OCCLUSION_CB>();
+    ENG_ASSERT(pOcclusionConstBuff, "Failed to allocate occlusion culling constants");
+
+    const glm::mat4x4 hiZViewProjMat = glm::transpose(m_hiZViewProjMatrix);
+    constexpr size_t hiZViewProjMatSize = sizeof(pOcclusionConstBuff->COMMON_HIZ_VIEW_PROJ_MATRIX);
+    memcpy_s(&pOcclusionConstBuff->COMMON_HIZ_VIEW_PROJ_MATRIX, hiZViewProjMatSize, &hiZViewProjMat, hiZViewProjMatSize);
+
+    pOcclusionConstBuff->COMMON_HIZ_SCREEN_WIDTH = (float)m_hiZScreenWidth;
+    pOcclusionConstBuff->COMMON_HIZ_SCREEN_HEIGHT = (float)m_hiZScreenHeight;
+    pOcclusionConstBuff->COMMON_HIZ_LEVELS_COUNT = m_hiZLevelsCount;
+    // Instances still pass through the culling pass, since geometry passes draw visible instances only
+    pOcclusionConstBuff->COMMON_OCCLUSION_CULLING_ENABLED = packet.isOcclusionCullingEnabled && m_isHiZValid;
+    pOcclusionConstBuff->COMMON_OCCLUSION_INSTANCES_COUNT = static_cast<uint32_t>(drawItemsCount);
+
+    occlusionConstants.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_OCCLUSION_CB).GetBinding(), occlusionConstants.offset, occlusionConstants.size);
+    m_pOcclusionCountersBuffer->BindIndexed(resGetResourceBinding(COMMON_OCCLUSION_COUNTERS_UAV).GetBinding());
+
+    COMMON_INSTANCE_DATA* pInstances = m_instances.As<COMMON_INSTANCE_DATA>();
+    RenderDrawIndexedIndirectArgs* pIndirectArgs = m_indirectArgs.As<RenderDrawIndexedIndirectArgs>();
+    
+    const uint32_t jobsCount = std::clamp(static_cast<uint32_t>(drawItemsCount / MIN_DRAWS_PER_RECORDING_JOB), 1u, 
+        static_cast<uint32_t>(m_commandBuffers.size()));
+
+    // Instances and batches are split separately, since a single batch may hold most of the instances
+    m_recordingWorkers.Execute(jobsCount, [&](uint32_t jobIndex) {
+        const size_t firstInstance = drawItemsCount * jobIndex / jobsCount;
+        const size_t lastInstance = drawItemsCount * (jobIndex + 1) / jobsCount;
+
+        WriteInstanceData(pInstances, packet, m_batchedDrawItems.data(), m_visibilityGeometry, firstInstance, lastInstance);
+
+        const size_t firstBatch = batchesCount * jobIndex / jobsCount;
+        const size_t lastBatch = batchesCount * (jobIndex + 1) / jobsCount;
+
+        WriteIndirectArgs(pIndirectArgs, m_instancedBatches.data(), firstBatch, lastBatch);
+    });
+}
+
+
+void RenderSystem::RunGeometryPass(uint32_t sortPass, Pipeline* pPipeline, RenderGPUQuery& fragmentsQuery, RenderGPUQuery& timeQuery) noexcept
+{
+    const size_t drawItemsCount = m_pCurrFramePacket->drawItems.size();
+    const size_t multiDrawGroupsCount = m_multiDrawGroups.size();
+
+    const uint32_t recordingJobsCount = std::clamp(static_cast<uint32_t>(drawItemsCount / MIN_DRAWS_PER_RECORDING_JOB), 1u, 
+        static_cast<uint32_t>(m_commandBuffers.size()));
+
+    for (uint32_t i = 0; i < recordingJobsCount; ++i) {
+        m_commandBuffers[i].Clear();
+    }
+
+    // Pass level commands go to the first buffer, it's sorted along with draws of the first job
+    RenderCommandBuffer& cmdBuffer = m_commandBuffers[0];
+
+    {
+        const uint32_t pipeline = pPipeline->GetID().Value();
+
+        cmdBuffer.BeginPacket(RenderSortKey::Make(sortPass, RenderSortKey::PASS_STAGE_BEGIN, pipeline, 0, 0, 0));
+        cmdBuffer.BeginRenderPass(pPipeline);
+        cmdBuffer.EndPacket();
+
+        cmdBuffer.BeginPacket(RenderSortKey::Make(sortPass, RenderSortKey::PASS_STAGE_END, pipeline, 0, 0, 0));
+        cmdBuffer.EndRenderPass(pPipeline);
+        cmdBuffer.EndPacket();
+    }
+
+    const DynamicRingBufferAllocation& commonConstants = m_commonConstants;
+    const DynamicRingBufferAllocation& indirectArgs = m_indirectArgs;
+
+    m_recordingWorkers.Execute(recordingJobsCount, [&](uint32_t jobIndex) {
+        const size_t firstGroup = multiDrawGroupsCount * jobIndex / recordingJobsCount;
+        const size_t lastGroup = multiDrawGroupsCount * (jobIndex + 1) / recordingJobsCount;
+
+        RecordGeometryDrawCommands(m_commandBuffers[jobIndex], static_cast<RenderSortPass>(sortPass), pPipeline, 
+            m_multiDrawGroups.data(), firstGroup, lastGroup, commonConstants, indirectArgs);
+        m_commandBuffers[jobIndex].Sort();
+    });
+
+    BeginGPUQuery(fragmentsQuery);
+    BeginGPUQuery(timeQuery);
+
+    SubmitCommandBuffers(recordingJobsCount);
+
+    EndGPUQuery(timeQuery);
+    EndGPUQuery(fragmentsQuery);
+}
+
+
+void RenderSystem::UpdateGPUQueriesStatistics() noexcept
+{
+    m_gpuQueriesIdx = (m_gpuQueriesIdx + 1) % GPU_QUERIES_LATENCY;
+
+    // Oldest queries are reused by this frame. If GPU is still behind, results are dropped and statistics aren't updated
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
+
+    uint64_t depthPrepassFragmentsCount = 0;
+    uint64_t gBufferFragmentsCount = 0;
+    uint64_t depthPrepassTimeNs = 0;
+    uint64_t gBufferPassTimeNs = 0;
+    uint64_t lightCullingTimeNs = 0;
+    uint64_t colorPassTimeNs = 0;
+    uint64_t occlusionCullingTimeNs = 0;
+    uint64_t hiZPassTimeNs = 0;
+    uint64_t upscalePassTimeNs = 0;
+    uint64_t frameBeginTimestampNs = 0;
+    uint64_t frameEndTimestampNs = 0;
+
+    // Counters are copied by the culling passes, so they are complete once their queries are
+    const bool isLightCullingIssued = queries.lightCullingTime.isIssued;
+    const bool isOcclusionCullingIssued = queries.occlusionCullingTime.isIssued;
+
+    bool areQueriesRead = ReadGPUQuery(queries.depthPrepassFragments, depthPrepassFragmentsCount);
+    areQueriesRead &= ReadGPUQuery(queries.gBufferFragments, gBufferFragmentsCount);
+    areQueriesRead &= ReadGPUQuery(queries.depthPrepassTime, depthPrepassTimeNs);
+    areQueriesRead &= ReadGPUQuery(queries.gBufferPassTime, gBufferPassTimeNs);
+    areQueriesRead &= ReadGPUQuery(queries.lightCullingTime, lightCullingTimeNs);
+    areQueriesRead &= ReadGPUQuery(queries.colorPassTime, colorPassTimeNs);
+    areQueriesRead &= ReadGPUQuery(queries.occlusionCullingTime, occlusionCullingTimeNs);
+    areQueriesRead &= ReadGPUQuery(queries.hiZPassTime, hiZPassTimeNs);
+    areQueriesRead &= ReadGPUQuery(queries.upscalePassTime, upscalePassTimeNs);
+    areQueriesRead &= ReadGPUQuery(queries.frameBeginTimestamp, frameBeginTimestampNs);
+    areQueriesRead &= ReadGPUQuery(queries.frameEndTimestamp, frameEndTimestampNs);
+
+    COMMON_CLUSTER_COUNTERS clusterCounters = {};
+
+    if (areQueriesRead && isLightCullingIssued) {
+        const COMMON_CLUSTER_COUNTERS* pCounters = queries.pClusterCountersReadback->MapRead<COMMON_CLUSTER_COUNTERS>();
+        ENG_ASSERT(pCounters, "Failed to map light clusters counters");
+        
+        clusterCounters = *pCounters;
+        queries.pClusterCountersReadback->Unmap();
+    }
+
+    COMMON_OCCLUSION_COUNTERS occlusionCounters = {};
+
+    if (areQueriesRead && isOcclusionCullingIssued) {
+        const COMMON_OCCLUSION_COUNTERS* pCounters = queries.pOcclusionCountersReadback->MapRead<COMMON_OCCLUSION_COUNTERS>();
+        ENG_ASSERT(pCounters, "Failed to map occlusion culling counters");
+        
+        occlusionCounters = *pCounters;
+        queries.pOcclusionCountersReadback->Unmap();
+    }
+
+    // Overwritten along with the resolution of this frame
+    const uint64_t pixelsCount = queries.pixelsCount;
+    const uint64_t frameIndex = queries.frameIndex;
+    const float renderScale = queries.renderScale;
+    const uint32_t lightsCount = queries.lightsCount;
+    const bool isTemporalUpscaled = queries.isTemporalUpscaled;
+
+    queries.depthPrepassFragments.isIssued = false;
+    queries.gBufferFragments.isIssued = false;
+    queries.depthPrepassTime.isIssued = false;
+    queries.gBufferPassTime.isIssued = false;
+    queries.lightCullingTime.isIssued = false;
+    queries.colorPassTime.isIssued = false;
+    queries.occlusionCullingTime.isIssued = false;
+    queries.hiZPassTime.isIssued = false;
+    queries.upscalePassTime.isIssued = false;
+    queries.frameBeginTimestamp.isIssued = false;
+    queries.frameEndTimestamp.isIssued = false;
+
+    if (!areQueriesRead || pixelsCount == 0) {
+        return;
+    }
+
+    m_lastFrameStatistics.depthPrepassFragmentsCount.store(depthPrepassFragmentsCount, std::memory_order_relaxed);
+    m_lastFrameStatistics.gBufferFragmentsCount.store(gBufferFragmentsCount, std::memory_order_relaxed);
+    m_lastFrameStatistics.gBufferOverdraw.store((float)gBufferFragmentsCount / pixelsCount, std::memory_order_relaxed);
+
+    m_lastFrameStatistics.depthPrepassTimeMs.store(depthPrepassTimeNs / 1'000'000.f, std::memory_order_relaxed);
+    m_lastFrameStatistics.gBufferPassTimeMs.store(gBufferPassTimeNs / 1'000'000.f, std::memory_order_relaxed);
+    m_lastFrameStatistics.lightCullingTimeMs.store(lightCullingTimeNs / 1'000'000.f, std::memory_order_relaxed);
+    m_lastFrameStatistics.colorPassTimeMs.store(colorPassTimeNs / 1'000'000.f, std::memory_order_relaxed);
+
+    const uint32_t litClustersCount = clusterCounters.COMMON_CLUSTER_LIT_COUNT;
+    const uint32_t clusterLightsCount = std::min(clusterCounters.COMMON_CLUSTER_LIGHT_INDICES_COUNT, 
+        static_cast<uint32_t>(m_pClusterLightIndicesBuffer->GetElementCount()));
+    const float avgLightsPerLitCluster = litClustersCount > 0 ? (float)clusterLightsCount / litClustersCount : 0.f;
+
+    m_lastFrameStatistics.lightsCount.store(lightsCount, std::memory_order_relaxed);
+    m_lastFrameStatistics.litClustersCount.store(litClustersCount, std::memory_order_relaxed);
+    m_lastFrameStatistics.maxLightsPerCluster.store(clusterCounters.COMMON_CLUSTER_MAX_LIGHTS_PER_CLUSTER, std::memory_order_relaxed);
+    m_lastFrameStatistics.overflowedClustersCount.store(clusterCounters.COMMON_CLUSTER_OVERFLOWS_COUNT, std::memory_order_relaxed);
+    m_lastFrameStatistics.avgLightsPerLitCluster.store(avgLightsPerLitCluster, std::memory_order_relaxed);
+
+    m_lastFrameStatistics.occludedInstancesCount.store(occlusionCounters.COMMON_OCCLUSION_CULLED_COUNT, std::memory_order_relaxed);
+    m_lastFrameStatistics.occlusionCullingTimeMs.store(occlusionCullingTimeNs / 1'000'000.f, std::memory_order_relaxed);
+    m_lastFrameStatistics.hiZPassTimeMs.store(hiZPassTimeNs / 1'000'000.f, std::memory_order_relaxed);
+
+    m_lastFrameStatistics.upscalePassTimeMs.store(upscalePassTimeNs / 1'000'000.f, std::memory_order_relaxed);
+    m_lastFrameStatistics.isTemporalUpscaled.store(isTemporalUpscaled, std::memory_order_relaxed);
+
+    const float gpuFrameTimeMs = frameEndTimestampNs > frameBeginTimestampNs ? (frameEndTimestampNs - frameBeginTimestampNs) / 1'000'000.f : 0.f;
+    m_lastFrameStatistics.gpuFrameTimeMs.store(gpuFrameTimeMs, std::memory_order_relaxed);
+
+    // Published last, so that a reader which sees the new index sees this frame values too
+    m_lastFrameStatistics.frameIndex.store(frameIndex, std::memory_order_release);
+
+    const FramePacket& packet = *m_pCurrFramePacket;
+
+    if (packet.isDynamicResolutionEnabled) {
+        m_dynamicResolution.Update(gpuFrameTimeMs, renderScale, packet.targetGPUFrameTimeMs, packet.minResolutionScale);
+    }
+}
+
 
-static std::unique_ptr<RenderSystem> pRenderSysInst = nullptr;
+void RenderSystem::PrepareLights() noexcept
+{
+    const FramePacket& packet = *m_pCurrFramePacket;
 
+    const uint32_t lightsCount = static_cast<uint32_t>(packet.lights.size());
 
-#define INIT_CALL(CALL, ...) if (!CALL(__VA_ARGS__)) { return false; } 
+    // Empty range can't be bound, so at least one light is allocated
+    m_lights = m_lightDataRingBuffer.Allocate<COMMON_LIGHT_DATA>(std::max(lightsCount, 1u));
+    ENG_ASSERT(m_lights.IsValid(), "Failed to allocate light data");
 
+    COMMON_LIGHT_DATA* pLightData = m_lights.As<COMMON_LIGHT_DATA>();
 
-RenderSystem& RenderSystem::GetInstance() noexcept
-{
-    ENG_ASSERT(engIsRenderSystemInitialized(), "Render system is not initialized");
-    return *pRenderSysInst;
+    for (uint32_t i = 0; i < lightsCount; ++i) {
+        WriteLightData(pLightData + i, packet.lights[i], packet.viewMatrix);
+    }
+
+    m_lights.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_LIGHTS_SB).GetBinding(), m_lights.offset, m_lights.size);
+
+    const DynamicRingBufferAllocation clustersConstants = m_constBufferAllocator.AllocateTransient<COMMON_CLUSTERS_CB>();
+    COMMON_CLUSTERS_CB* pClustersConstBuff = clustersConstants.As<COMMON_CLUSTERS_CB>();
+    ENG_ASSERT(pClustersConstBuff, "Failed to allocate light clusters constants");
+
+    // Slices are distributed exponentially, so that clusters are roughly cubic in view space
+    const float zFarNearRatioLog = std::log(packet.zFar / packet.zNear);
+
+    pClustersConstBuff->COMMON_CLUSTER_GRID_SIZE_X = m_clusterGridWidth;
+    pClustersConstBuff->COMMON_CLUSTER_GRID_SIZE_Y = m_clusterGridHeight;
+    pClustersConstBuff->COMMON_LIGHTS_COUNT = lightsCount;
+    pClustersConstBuff->COMMON_CLUSTER_LIGHT_INDICES_CAPACITY = static_cast<uint32_t>(m_pClusterLightIndicesBuffer->GetElementCount());
+    pClustersConstBuff->COMMON_CLUSTER_Z_SCALE = COMMON_CLUSTER_Z_SLICES_COUNT / zFarNearRatioLog;
+    pClustersConstBuff->COMMON_CLUSTER_Z_BIAS = -COMMON_CLUSTER_Z_SLICES_COUNT * std::log(packet.zNear) / zFarNearRatioLog;
+    pClustersConstBuff->COMMON_CLUSTER_Z_NEAR = packet.zNear;
+    pClustersConstBuff->COMMON_CLUSTER_Z_FAR = packet.zFar;
+
+    clustersConstants.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_CLUSTERS_CB).GetBinding(), clustersConstants.offset, clustersConstants.size);
+
+    m_pClustersBuffer->BindIndexed(resGetResourceBinding(COMMON_CLUSTERS_UAV).GetBinding());
+    m_pClusterLightIndicesBuffer->BindIndexed(resGetResourceBinding(COMMON_CLUSTER_LIGHT_INDICES_UAV).GetBinding());
+    m_pClusterCountersBuffer->BindIndexed(resGetResourceBinding(COMMON_CLUSTER_COUNTERS_UAV).GetBinding());
+
+    // Reported along with the cluster counters of this frame
+    m_gpuQueries[m_gpuQueriesIdx].lightsCount = lightsCount;
 }
 
 
-void RenderSystem::BeginFrame() noexcept
+void RenderSystem::UpdateLightClustersGrid(uint32_t width, uint32_t height) noexcept
 {
+    const uint32_t gridWidth = (width + COMMON_CLUSTER_TILE_SIZE - 1) / COMMON_CLUSTER_TILE_SIZE;
+    const uint32_t gridHeight = (height + COMMON_CLUSTER_TILE_SIZE - 1) / COMMON_CLUSTER_TILE_SIZE;
+
+    if (gridWidth == m_clusterGridWidth && gridHeight == m_clusterGridHeight) {
+        return;
+    }
+
+    // Previous storage is retired until frames in flight are done with it
+    m_pClustersBuffer->Destroy();
+    m_pClusterLightIndicesBuffer->Destroy();
+
+    const uint64_t clustersCount = (uint64_t)gridWidth * gridHeight * COMMON_CLUSTER_Z_SLICES_COUNT;
+
+    MemoryBufferCreateInfo clustersCreateInfo = {};
+    clustersCreateInfo.dataSize = clustersCount * sizeof(COMMON_CLUSTER_DATA);
+    clustersCreateInfo.elementSize = sizeof(COMMON_CLUSTER_DATA);
+    clustersCreateInfo.type = MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER;
+
+    m_pClustersBuffer->Create(clustersCreateInfo);
+    ENG_ASSERT(m_pClustersBuffer->IsValid(), "Failed to create light clusters buffer");
+    m_pClustersBuffer->SetDebugName("__COMMON_CLUSTERS_UAV__");
+
+    MemoryBufferCreateInfo lightIndicesCreateInfo = {};
+    lightIndicesCreateInfo.dataSize = clustersCount * CLUSTER_AVG_LIGHTS_COUNT * sizeof(uint32_t);
+    lightIndicesCreateInfo.elementSize = sizeof(uint32_t);
+    lightIndicesCreateInfo.type = MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER;
+
+    m_pClusterLightIndicesBuffer->Create(lightIndicesCreateInfo);
+    ENG_ASSERT(m_pClusterLightIndicesBuffer->IsValid(), "Failed to create light clusters indices buffer");
+    m_pClusterLightIndicesBuffer->SetDebugName("__COMMON_CLUSTER_LIGHT_INDICES_UAV__");
+
+    m_clusterGridWidth = gridWidth;
+    m_clusterGridHeight = gridHeight;
 }
 
 
-void RenderSystem::EndFrame() noexcept
+void RenderSystem::RunOcclusionCullingPass() noexcept
 {
+    const uint32_t instancesCount = static_cast<uint32_t>(m_pCurrFramePacket->drawItems.size());
+
+    if (instancesCount == 0) {
+        return;
+    }
+
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
 
+    BeginGPUQuery(queries.occlusionCullingTime);
+
+    m_pOcclusionCountersBuffer->Clear();
+
+    // Command buffers record graphics pipelines only, so the dispatch goes through the state cache directly
+    pOcclusionCullingProgram->Bind();
+    m_pHiZTexture->Bind(resGetResourceBinding(COMMON_HIZ_TEX).GetBinding());
+    pHiZSampler->Bind(resGetResourceBinding(COMMON_HIZ_TEX).GetBinding());
+
+    glDispatchCompute((instancesCount + OCCLUSION_CULLING_GROUP_SIZE - 1) / OCCLUSION_CULLING_GROUP_SIZE, 1, 1);
+
+    // Geometry passes fetch visible instances in vertex shaders and take instance counts from indirect args, counters are copied for readback
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    queries.pOcclusionCountersReadback->CopySubdata(*m_pOcclusionCountersBuffer, 0, 0, sizeof(COMMON_OCCLUSION_COUNTERS));
+
+    EndGPUQuery(queries.occlusionCullingTime);
 }
 
 
 void RenderSystem::RunDepthPrepass() noexcept
 {
-
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
+    RunGeometryPass(RENDER_SORT_PASS_DEPTH_PREPASS, pDepthPrepassPipeline, queries.depthPrepassFragments, queries.depthPrepassTime);
 }
 
 
 void RenderSystem::RunGBufferPass() noexcept
 {
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
+
+    Pipeline* pPipeline = m_isDepthPrepassEnabled ? pGBufferEqualDepthPipeline : pGBufferPipeline;
+    RunGeometryPass(RENDER_SORT_PASS_GBUFFER, pPipeline, queries.gBufferFragments, queries.gBufferPassTime);
+}
+
+
+void RenderSystem::RunVisibilityPass() noexcept
+{
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
+
+    // Replaces the GBuffer pass, so its queries are reused
+    Pipeline* pPipeline = m_isDepthPrepassEnabled ? pVisibilityEqualDepthPipeline : pVisibilityPipeline;
+    RunGeometryPass(RENDER_SORT_PASS_VISIBILITY, pPipeline, queries.gBufferFragments, queries.gBufferPassTime);
+}
+
+
+void RenderSystem::RunHiZPass() noexcept
+{
+    const FramePacket& packet = *m_pCurrFramePacket;
+
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
+
+    Texture* pCommonDepthTex = m_frameGraph.GetTexture(m_frameGraphTextures.commonDepth);
+
+    BeginGPUQuery(queries.hiZPassTime);
+
+    pHiZDownsampleProgram->Bind();
+    pCommonDepthTex->Bind(resGetResourceBinding(COMMON_DEPTH_TEX).GetBinding());
+    m_pHiZTexture->Bind(resGetResourceBinding(COMMON_HIZ_TEX).GetBinding());
+    pHiZSampler->Bind(resGetResourceBinding(COMMON_HIZ_TEX).GetBinding());
+    m_commonConstants.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_DYN_CB).GetBinding(), m_commonConstants.offset, m_commonConstants.size);
+
+    // Every level is reduced from the previous one, which is fetched as texture while the current one is bound as image
+    for (uint32_t level = 0; level < m_hiZLevelsCount; ++level) {
+        const uint32_t levelWidth = std::max(m_pHiZTexture->GetWidth() >> level, 1u);
+        const uint32_t levelHeight = std::max(m_pHiZTexture->GetHeight() >> level, 1u);
+
+        const DynamicRingBufferAllocation hiZConstants = m_constBufferAllocator.AllocateTransient<COMMON_HIZ_CB>();
+        COMMON_HIZ_CB* pHiZConstBuff = hiZConstants.As<COMMON_HIZ_CB>();
+        ENG_ASSERT(pHiZConstBuff, "Failed to allocate Hi-Z downsample constants");
+
+        pHiZConstBuff->COMMON_HIZ_DST_LEVEL = level;
+
+        hiZConstants.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_HIZ_CB).GetBinding(), hiZConstants.offset, hiZConstants.size);
+        m_pHiZTexture->BindImage(resGetResourceBinding(COMMON_HIZ_UAV).GetBinding(), level);
+
+        glDispatchCompute((levelWidth + HIZ_DOWNSAMPLE_GROUP_SIZE - 1) / HIZ_DOWNSAMPLE_GROUP_SIZE, 
+            (levelHeight + HIZ_DOWNSAMPLE_GROUP_SIZE - 1) / HIZ_DOWNSAMPLE_GROUP_SIZE, 1);
+
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+
+    EndGPUQuery(queries.hiZPassTime);
+
+    // Next frame instances are tested against this frame depth
+    m_hiZViewProjMatrix = packet.viewProjMatrix;
+    m_hiZScreenWidth = m_renderWidth;
+    m_hiZScreenHeight = m_renderHeight;
+    m_isHiZValid = true;
+}
+
+
+void RenderSystem::UpdateHiZPyramid(uint32_t width, uint32_t height) noexcept
+{
+    const uint32_t levelWidth = std::max(width / 2, 1u);
+    const uint32_t levelHeight = std::max(height / 2, 1u);
+
+    if (m_pHiZTexture->IsValid() && m_pHiZTexture->GetWidth() == levelWidth && m_pHiZTexture->GetHeight() == levelHeight) {
+        return;
+    }
+
+    // Previous storage is retired until frames in flight are done with it
+    m_pHiZTexture->Destroy();
+
+    m_hiZLevelsCount = static_cast<uint32_t>(std::floor(std::log2(std::max(levelWidth, levelHeight)))) + 1;
+
+    Texture2DCreateInfo hiZCreateInfo = {};
+    hiZCreateInfo.format = resGetTexResourceFormat(COMMON_HIZ_TEX);
+    hiZCreateInfo.width = levelWidth;
+    hiZCreateInfo.height = levelHeight;
+    hiZCreateInfo.mipmapsCount = m_hiZLevelsCount - 1;
+
+    m_pHiZTexture->Create(hiZCreateInfo);
+    ENG_ASSERT(m_pHiZTexture->IsValid(), "Failed to create Hi-Z pyramid texture");
+
+    m_isHiZValid = false;
+}
+
+
+void RenderSystem::RunLightCullingPass() noexcept
+{
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
+
+    Texture* pCommonDepthTex = m_frameGraph.GetTexture(m_frameGraphTextures.commonDepth);
+
+    BeginGPUQuery(queries.lightCullingTime);
 
+    // Light lists are allocated from the counters by atomics, so they start from zero every frame
+    m_pClusterCountersBuffer->Clear();
+
+    // Command buffers record graphics pipelines only, so the dispatch goes through the state cache directly
+    pLightCullingProgram->Bind();
+    pCommonDepthTex->Bind(resGetResourceBinding(COMMON_DEPTH_TEX).GetBinding());
+    m_commonConstants.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_DYN_CB).GetBinding(), m_commonConstants.offset, m_commonConstants.size);
+
+    // Grid covers the framebuffer, tiles outside of the scaled down render region are not shaded
+    const uint32_t tilesCountX = (m_renderWidth + COMMON_CLUSTER_TILE_SIZE - 1) / COMMON_CLUSTER_TILE_SIZE;
+    const uint32_t tilesCountY = (m_renderHeight + COMMON_CLUSTER_TILE_SIZE - 1) / COMMON_CLUSTER_TILE_SIZE;
+
+    glDispatchCompute(tilesCountX, tilesCountY, 1);
+
+    // Lighting pass reads light lists from storage buffers and counters are copied for readback
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    queries.pClusterCountersReadback->CopySubdata(*m_pClusterCountersBuffer, 0, 0, sizeof(COMMON_CLUSTER_COUNTERS));
+
+    EndGPUQuery(queries.lightCullingTime);
 }
 
 
 void RenderSystem::RunColorPass() noexcept
 {
-    static Timer timer;
-    timer.Tick();
-
-    static Window& window = engGetMainWindow();
-    static Input& input = window.GetInput();
-    static TextureManager& texManager = TextureManager::GetInstance();
-    static ShaderManager& shaderManager = ShaderManager::GetInstance();
-    static RenderTargetManager& rtManager = RenderTargetManager::GetInstance();
-    static PipelineManager& pipelineManager = PipelineManager::GetInstance();
-    static MemoryBufferManager& memBufferManager = MemoryBufferManager::GetInstance();
-    static MeshDataManager& meshDataManager = MeshDataManager::GetInstance();
-    static MeshManager& meshManager = MeshManager::GetInstance();
-    static CameraManager& cameraManager = CameraManager::GetInstance();
-
-    static bool isInitialized = false;
-    static ShaderProgram* pGBufferProgram = nullptr;
-    static ShaderProgram* pPostProcProgram = nullptr;
-
-    static Texture* pTestTexture = nullptr;
-    static TextureSamplerState* pTestTextureSampler = nullptr;
-
-    static MeshObj* pCubeMeshObj = nullptr;
-
-    static Texture* pGBufferAlbedoTex = nullptr;
-    static Texture* pGBufferNormalTex = nullptr;
-    static Texture* pGBufferSpecTex = nullptr;
-    static Texture* pCommonDepthTex = nullptr;
-    static TextureSamplerState* pGBufferAlbedoSampler = nullptr;
-    static TextureSamplerState* pGBufferNormalSampler = nullptr;
-    static TextureSamplerState* pGBufferSpecSampler = nullptr;
-    static TextureSamplerState* pGBufferDepthSampler = nullptr;
-
-    static Pipeline* pGBufferPipeline = nullptr;
-    static Pipeline* pPostProcPipeline = nullptr;
-
-    static MemoryBuffer* pCommonConstBuffer = nullptr;
-    static MemoryBuffer* pCameraConstBuffer = nullptr;
-
-    static Camera* pMainCam = nullptr;
-
-    if (!isInitialized) {
-        static constexpr const char* SHADER_INCLUDE_DIR = ENG_ENGINE_DIR "/source/shaders/include";
-        static const char* GBUFFER_DEFINES[] = {
-        #if defined(ENG_DEBUG)
-            "ENV_DEBUG",
-        #endif
-            "PASS_GBUFFER"
-        };
+    // Render targets are recreated on resize, so they are not cached
+    Texture* pGBufferAlbedoTex = m_frameGraph.GetTexture(m_frameGraphTextures.gBufferAlbedo);
+    Texture* pGBufferNormalTex = m_frameGraph.GetTexture(m_frameGraphTextures.gBufferNormal);
+    Texture* pCommonDepthTex = m_frameGraph.GetTexture(m_frameGraphTextures.commonDepth);
+
+    RenderCommandBuffer& cmdBuffer = m_commandBuffers[0];
+    cmdBuffer.Clear();
+
+    const uint32_t pipeline = pPostProcPipeline->GetID().Value();
+
+    cmdBuffer.BeginPacket(RenderSortKey::Make(RENDER_SORT_PASS_POST_PROCESS, RenderSortKey::PASS_STAGE_BEGIN, pipeline, 0, 0, 0));
+    cmdBuffer.BeginRenderPass(pPostProcPipeline);
+    cmdBuffer.EndPacket();
+
+    cmdBuffer.BeginPacket(RenderSortKey::Make(RENDER_SORT_PASS_POST_PROCESS, RenderSortKey::PASS_STAGE_DRAW, pipeline, 0, 0, 0));
+    cmdBuffer.BindPipeline(pPostProcPipeline);
+    cmdBuffer.BindTexture(resGetResourceBinding(GBufferAlbedoTex).GetBinding(), pGBufferAlbedoTex, pGBufferAlbedoSampler);
+    cmdBuffer.BindTexture(resGetResourceBinding(GBufferNormalTex).GetBinding(), pGBufferNormalTex, pGBufferNormalSampler);
+#if !defined(ENG_GBUFFER_COMPACT)
+    Texture* pGBufferSpecTex = m_frameGraph.GetTexture(m_frameGraphTextures.gBufferSpecular);
+    cmdBuffer.BindTexture(resGetResourceBinding(GBUFFER_SPECULAR_TEX).GetBinding(), pGBufferSpecTex, pGBufferSpecSampler);
+#endif
+    cmdBuffer.BindTexture(resGetResourceBinding(COMMON_DEPTH_TEX).GetBinding(), pCommonDepthTex, pGBufferDepthSampler);
+    cmdBuffer.BindConstBuffer(resGetResourceBinding(COMMON_DYN_CB).GetBinding(), m_commonConstants.pBuffer, m_commonConstants.offset, m_commonConstants.size);
+    // Fullscreen triangles are generated in the vertex shader, so the last bound vertex array is kept
+    cmdBuffer.Draw(nullptr, 6, 0, 1);
+    cmdBuffer.EndPacket();
 
-        ShaderStageCreateInfo vsStageCreateInfo = {};
+    cmdBuffer.BeginPacket(RenderSortKey::Make(RENDER_SORT_PASS_POST_PROCESS, RenderSortKey::PASS_STAGE_END, pipeline, 0, 0, 0));
+    cmdBuffer.EndRenderPass(pPostProcPipeline);
+    cmdBuffer.EndPacket();
 
-        vsStageCreateInfo.type = ShaderStageType::VERTEX;
+    cmdBuffer.Sort();
 
-        const std::vector<char> vsSourceCode = ReadTextFile(ENG_ENGINE_DIR "/source/shaders/source/base/base.vs");
-        vsStageCreateInfo.pSourceCode = vsSourceCode.data();
-        vsStageCreateInfo.codeSize = vsSourceCode.size();
+    RenderGPUQuery& timeQuery = m_gpuQueries[m_gpuQueriesIdx].colorPassTime;
 
-        vsStageCreateInfo.pDefines = GBUFFER_DEFINES;
-        vsStageCreateInfo.definesCount = _countof(GBUFFER_DEFINES);
+    BeginGPUQuery(timeQuery);
+    SubmitCommandBuffers(1);
+    EndGPUQuery(timeQuery);
+}
 
-        vsStageCreateInfo.pIncludeParentPath = SHADER_INCLUDE_DIR;
 
+void RenderSystem::RunVisibilityResolvePass() noexcept
+{
+    // Render targets are recreated on resize, so they are not cached
+    Texture* pVisibilityTex = m_frameGraph.GetTexture(m_frameGraphTextures.visibility);
+    Texture* pCommonDepthTex = m_frameGraph.GetTexture(m_frameGraphTextures.commonDepth);
 
-        ShaderStageCreateInfo psStageCreateInfo = {};
+    RenderCommandBuffer& cmdBuffer = m_commandBuffers[0];
+    cmdBuffer.Clear();
 
-        psStageCreateInfo.type = ShaderStageType::PIXEL;
+    const uint32_t pipeline = pVisibilityResolvePipeline->GetID().Value();
 
-        const std::vector<char> psSourceCode = ReadTextFile(ENG_ENGINE_DIR "/source/shaders/source/base/base.fs");
-        psStageCreateInfo.pSourceCode = psSourceCode.data();
-        psStageCreateInfo.codeSize = psSourceCode.size();
+    cmdBuffer.BeginPacket(RenderSortKey::Make(RENDER_SORT_PASS_POST_PROCESS, RenderSortKey::PASS_STAGE_BEGIN, pipeline, 0, 0, 0));
+    cmdBuffer.BeginRenderPass(pVisibilityResolvePipeline);
+    cmdBuffer.EndPacket();
 
-        psStageCreateInfo.pDefines = GBUFFER_DEFINES;
-        psStageCreateInfo.definesCount = _countof(GBUFFER_DEFINES);
+    cmdBuffer.BeginPacket(RenderSortKey::Make(RENDER_SORT_PASS_POST_PROCESS, RenderSortKey::PASS_STAGE_DRAW, pipeline, 0, 0, 0));
+    cmdBuffer.BindPipeline(pVisibilityResolvePipeline);
+    cmdBuffer.BindTexture(resGetResourceBinding(COMMON_VISIBILITY_TEX).GetBinding(), pVisibilityTex, pVisibilitySampler);
+    cmdBuffer.BindTexture(resGetResourceBinding(COMMON_DEPTH_TEX).GetBinding(), pCommonDepthTex, pGBufferDepthSampler);
+    // Materials are evaluated here instead of the geometry pass
+    cmdBuffer.BindTexture(resGetResourceBinding(TEST_TEXTURE).GetBinding(), pTestTexture, pTestTextureSampler);
+    cmdBuffer.BindConstBuffer(resGetResourceBinding(COMMON_DYN_CB).GetBinding(), m_commonConstants.pBuffer, m_commonConstants.offset, m_commonConstants.size);
+    // Fullscreen triangles are generated in the vertex shader, so the last bound vertex array is kept
+    cmdBuffer.Draw(nullptr, 6, 0, 1);
+    cmdBuffer.EndPacket();
 
-        psStageCreateInfo.pIncludeParentPath = SHADER_INCLUDE_DIR;
+    cmdBuffer.BeginPacket(RenderSortKey::Make(RENDER_SORT_PASS_POST_PROCESS, RenderSortKey::PASS_STAGE_END, pipeline, 0, 0, 0));
+    cmdBuffer.EndRenderPass(pVisibilityResolvePipeline);
+    cmdBuffer.EndPacket();
 
+    cmdBuffer.Sort();
 
-        const ShaderStageCreateInfo* pGBufferStages[] = { &vsStageCreateInfo, &psStageCreateInfo };
+    m_visibilityGeometry.Bind();
 
-        ShaderProgramCreateInfo gBufferPassProgramCreateInfo = {};
-        gBufferPassProgramCreateInfo.pStageCreateInfos = pGBufferStages;
-        gBufferPassProgramCreateInfo.stageCreateInfosCount = _countof(pGBufferStages);
+    // Replaces the color pass, so its query is reused
+    RenderGPUQuery& timeQuery = m_gpuQueries[m_gpuQueriesIdx].colorPassTime;
 
-        pGBufferProgram = shaderManager.RegisterShaderProgram();
-        ENG_ASSERT(pGBufferProgram, "Failed to register GBUFFER shader program");
-        pGBufferProgram->Create(gBufferPassProgramCreateInfo);
-        ENG_ASSERT(pGBufferProgram, "Failed to create GBUFFER shader program");
-        pGBufferProgram->SetDebugName("Pass_GBuffer");
+    BeginGPUQuery(timeQuery);
+    SubmitCommandBuffers(1);
+    EndGPUQuery(timeQuery);
+}
 
-        static const char* POST_PROCESS_DEFINES[] = {
-        #if defined(ENG_DEBUG)
-            "ENV_DEBUG",
-        #endif
-            "PASS_POST_PROCESS"
-        };
 
-        vsStageCreateInfo.pDefines = POST_PROCESS_DEFINES;
-        vsStageCreateInfo.definesCount = _countof(POST_PROCESS_DEFINES);
+void RenderSystem::RunTemporalUpscalePass() noexcept
+{
+    const FramePacket& packet = *m_pCurrFramePacket;
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
 
-        psStageCreateInfo.pDefines = POST_PROCESS_DEFINES;
-        psStageCreateInfo.definesCount = _countof(POST_PROCESS_DEFINES);
+    Texture* pCommonColorTex = m_frameGraph.GetTexture(m_frameGraphTextures.commonColor);
+    Texture* pCommonDepthTex = m_frameGraph.GetTexture(m_frameGraphTextures.commonDepth);
+    Texture* pGBufferMotionTex = m_frameGraph.GetTexture(m_frameGraphTextures.gBufferMotion);
 
-        const ShaderStageCreateInfo* pPostProcStages[] = { &vsStageCreateInfo, &psStageCreateInfo };
+    Texture* pHistoryTex = m_pTemporalHistoryTextures[m_temporalHistoryIdx];
+    Texture* pOutputTex = m_pTemporalHistoryTextures[(m_temporalHistoryIdx + 1) % m_pTemporalHistoryTextures.size()];
 
-        ShaderProgramCreateInfo gPostProcPassProgramCreateInfo = {};
-        gPostProcPassProgramCreateInfo.pStageCreateInfos = pPostProcStages;
-        gPostProcPassProgramCreateInfo.stageCreateInfosCount = _countof(pPostProcStages);
+    // Ended by the post process pass, so that upscale time includes the blit of the output like it does for bilinear upscale
+    BeginGPUQuery(queries.upscalePassTime);
 
-        pPostProcProgram = shaderManager.RegisterShaderProgram();
-        ENG_ASSERT(pPostProcProgram, "Failed to register POST PROCESS shader program");
-        pPostProcProgram->Create(gPostProcPassProgramCreateInfo);
-        ENG_ASSERT(pPostProcProgram, "Failed to create POST PROCESS shader program");
-        pPostProcProgram->SetDebugName("Pass_Post_Process");
+    pTemporalUpscaleProgram->Bind();
 
+    pCommonColorTex->Bind(resGetResourceBinding(CommonColorTex).GetBinding());
+    pTemporalColorSampler->Bind(resGetResourceBinding(CommonColorTex).GetBinding());
+    pCommonDepthTex->Bind(resGetResourceBinding(COMMON_DEPTH_TEX).GetBinding());
+    pGBufferDepthSampler->Bind(resGetResourceBinding(COMMON_DEPTH_TEX).GetBinding());
+    pGBufferMotionTex->Bind(resGetResourceBinding(GBUFFER_MOTION_TEX).GetBinding());
+    pGBufferMotionSampler->Bind(resGetResourceBinding(GBUFFER_MOTION_TEX).GetBinding());
+    pHistoryTex->Bind(resGetResourceBinding(COMMON_TEMPORAL_HISTORY_TEX).GetBinding());
+    pTemporalHistorySampler->Bind(resGetResourceBinding(COMMON_TEMPORAL_HISTORY_TEX).GetBinding());
 
-        constexpr size_t texWidth = 256;
-        constexpr size_t texWidthDiv2 = texWidth / 2;
-        constexpr size_t texHeight = 256;
-        constexpr size_t texHeightDiv2 = texHeight / 2;
-        constexpr size_t texSizeInPixels = texWidth * texHeight;
-        constexpr size_t texComponentsCount = 4;
-        constexpr size_t texSizeInBytes = texSizeInPixels * texComponentsCount;
-        
-        constexpr uint8_t texColors[4][4] = {
-            { 255,   0,   0, 255 },
-            {   0, 255,   0, 255 },
-            {   0,   0, 255, 255 },
-            {   255, 0, 255, 255 },
-        };
-
-        uint8_t pTexData[texSizeInBytes] = {};
-        for (size_t y = 0; y < texHeight; ++y) {
-            for (size_t x = 0; x < texWidth; ++x) {
-                const size_t colorIdx = (y / (texHeightDiv2 - 1) + ((y / (texHeightDiv2 - 1)) % 2)) + x / texWidthDiv2;
-
-                const size_t pixelIdx = (y * texWidth + x);
-
-                pTexData[texComponentsCount * pixelIdx + 0] = texColors[colorIdx][0];
-                pTexData[texComponentsCount * pixelIdx + 1] = texColors[colorIdx][1];
-                pTexData[texComponentsCount * pixelIdx + 2] = texColors[colorIdx][2];
-                pTexData[texComponentsCount * pixelIdx + 3] = texColors[colorIdx][3];
-            }
-        }
+    m_commonConstants.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_DYN_CB).GetBinding(), m_commonConstants.offset, m_commonConstants.size);
 
-        Texture2DCreateInfo texCreateInfo = {};
-        texCreateInfo.format = resGetTexResourceFormat(TEST_TEXTURE);
-        texCreateInfo.width = texWidth;
-        texCreateInfo.height = texHeight;
-        texCreateInfo.mipmapsCount = 0;
-        texCreateInfo.inputData.format = TextureInputDataFormat::INPUT_FORMAT_RGBA;
-        texCreateInfo.inputData.dataType = TextureInputDataType::INPUT_TYPE_UNSIGNED_BYTE;
+    const DynamicRingBufferAllocation temporalConstants = m_constBufferAllocator.AllocateTransient<COMMON_TEMPORAL_CB>();
+    COMMON_TEMPORAL_CB* pTemporalConstBuff = temporalConstants.As<COMMON_TEMPORAL_CB>();
+    ENG_ASSERT(pTemporalConstBuff, "Failed to allocate temporal upscale constants");
 
-        texCreateInfo.inputData.pData = pTexData;
+    // Maps current clip space to the previous one. Both matrices are jittered, motion vector computation removes the jitter
+    const glm::mat4x4 reprojectionMat = glm::transpose(m_prevViewProjMatrix * glm::inverse(packet.viewProjMatrix));
+    constexpr size_t reprojectionMatSize = sizeof(pTemporalConstBuff->COMMON_TEMPORAL_REPROJECTION_MATRIX);
+    memcpy_s(&pTemporalConstBuff->COMMON_TEMPORAL_REPROJECTION_MATRIX, reprojectionMatSize, &reprojectionMat, reprojectionMatSize);
 
-        ds::StrID testTexName = "TEST_TEXTURE";
-        pTestTexture = texManager.RegisterTexture2D(testTexName);
-        ENG_ASSERT(pTestTexture, "Failed to register texture: {}", testTexName.CStr());
-        pTestTexture->Create(texCreateInfo);
-        ENG_ASSERT(pTestTexture->IsValid(), "Failed to create texture: {}", testTexName.CStr());
+    pTemporalConstBuff->COMMON_TEMPORAL_HISTORY_VALID = m_isTemporalHistoryValid;
 
-        pTestTextureSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(TEST_TEXTURE));
+    temporalConstants.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_TEMPORAL_CB).GetBinding(), temporalConstants.offset, temporalConstants.size);
 
-        pGBufferAlbedoTex = rtManager.GetRTTexture(RTTextureID::GBUFFER_ALBEDO);
-        pGBufferNormalTex = rtManager.GetRTTexture(RTTextureID::GBUFFER_NORMAL);
-        pGBufferSpecTex = rtManager.GetRTTexture(RTTextureID::GBUFFER_SPECULAR);
-        pCommonDepthTex = rtManager.GetRTTexture(RTTextureID::COMMON_DEPTH);
+    pOutputTex->BindImage(resGetResourceBinding(COMMON_TEMPORAL_OUTPUT_UAV).GetBinding(), 0);
 
-        pGBufferAlbedoSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(GBUFFER_ALBEDO_TEX));
-        pGBufferNormalSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(GBUFFER_NORMAL_TEX));
-        pGBufferSpecSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(GBUFFER_SPECULAR_TEX));
-        pGBufferDepthSampler = texManager.GetSampler(resGetTexResourceSamplerIdx(COMMON_DEPTH_TEX));
+    glDispatchCompute((pOutputTex->GetWidth() + TEMPORAL_UPSCALE_GROUP_SIZE - 1) / TEMPORAL_UPSCALE_GROUP_SIZE, 
+        (pOutputTex->GetHeight() + TEMPORAL_UPSCALE_GROUP_SIZE - 1) / TEMPORAL_UPSCALE_GROUP_SIZE, 1);
 
+    // Output is blitted by the post process pass and sampled as history by the next frame
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
 
-        InputAssemblyStateCreateInfo gBufferInputAssemblyState = {};
-        gBufferInputAssemblyState.topology = PrimitiveTopology::TOPOLOGY_TRIANGLES;
+    m_temporalHistoryIdx = (m_temporalHistoryIdx + 1) % m_pTemporalHistoryTextures.size();
+    m_isTemporalHistoryValid = true;
+}
 
-        RasterizationStateCreateInfo gBufferRasterizationState = {};
-        gBufferRasterizationState.cullMode = CullMode::CULL_MODE_BACK;
-        gBufferRasterizationState.depthBiasEnable = false;
-        gBufferRasterizationState.frontFace = FrontFace::FRONT_FACE_COUNTER_CLOCKWISE;
-        gBufferRasterizationState.polygonMode = PolygonMode::POLYGON_MODE_FILL;
 
-        DepthStencilStateCreateInfo gBufferDepthStencilState = {};
-        gBufferDepthStencilState.depthTestEnable = true;
-        gBufferDepthStencilState.depthWriteEnable = true;
-        gBufferDepthStencilState.depthCompareFunc = CompareFunc::FUNC_GREATER;
-        gBufferDepthStencilState.stencilTestEnable = false;
+void RenderSystem::RunPostprocessingPass() noexcept
+{
+    const FramePacket& packet = *m_pCurrFramePacket;
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
 
-        ColorBlendStateCreateInfo gBufferColorBlendState = {};
-        
-        ColorBlendAttachmentState gBufferAlbedoBlendState = {};
-        gBufferAlbedoBlendState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
-        ColorBlendAttachmentState gBufferNormalBlendState = {};
-        gBufferNormalBlendState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
-        ColorBlendAttachmentState gBufferSpecularBlendState = {};
-        gBufferSpecularBlendState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
-        
-        ColorBlendAttachmentState gBufferColorAttachmentsBlendStates[] = { gBufferAlbedoBlendState, gBufferNormalBlendState, gBufferSpecularBlendState };
-        gBufferColorBlendState.pAttachmentStates = gBufferColorAttachmentsBlendStates;
-        gBufferColorBlendState.attachmentCount = _countof(gBufferColorAttachmentsBlendStates);
-
-        FrameBufferClearValues gBufferFrameBufferClearValues = {};
-        const FrameBufferColorAttachmentClearColor pGBufferColorAttachmentClearColors[] = {
-            { 1.f, 1.f, 0.f, 0.f },
-            { 0.f, 0.f, 0.f, 0.f },
-            { 0.f, 0.f, 0.f, 0.f }
-        };
-        gBufferFrameBufferClearValues.pColorAttachmentClearColors = pGBufferColorAttachmentClearColors;
-        gBufferFrameBufferClearValues.colorAttachmentsCount = _countof(pGBufferColorAttachmentClearColors);
-        gBufferFrameBufferClearValues.depthClearValue = 0.f;
-
-        PipelineCreateInfo gBufferPipelineCreateInfo = {};
-        gBufferPipelineCreateInfo.pInputAssemblyState = &gBufferInputAssemblyState;
-        gBufferPipelineCreateInfo.pRasterizationState = &gBufferRasterizationState;
-        gBufferPipelineCreateInfo.pDepthStencilState = &gBufferDepthStencilState;
-        gBufferPipelineCreateInfo.pColorBlendState = &gBufferColorBlendState;
-        gBufferPipelineCreateInfo.pFrameBufferClearValues = &gBufferFrameBufferClearValues;
-        gBufferPipelineCreateInfo.pFrameBuffer = rtManager.GetFrameBuffer(RTFrameBufferID::GBUFFER);
-        gBufferPipelineCreateInfo.pShaderProgram = pGBufferProgram;
-
-        pGBufferPipeline = pipelineManager.RegisterPipeline();
-        ENG_ASSERT(pGBufferPipeline, "Failed to register GBUFFER pipeline");
-        pGBufferPipeline->Create(gBufferPipelineCreateInfo);
-        ENG_ASSERT(pGBufferPipeline->IsValid(), "Failed to create GBUFFER pipeline");
-
-
-        InputAssemblyStateCreateInfo postProcInputAssemblyState = {};
-        postProcInputAssemblyState.topology = PrimitiveTopology::TOPOLOGY_TRIANGLES;
-
-        RasterizationStateCreateInfo postProcRasterizationState = {};
-        postProcRasterizationState.cullMode = CullMode::CULL_MODE_BACK;
-        postProcRasterizationState.depthBiasEnable = false;
-        postProcRasterizationState.frontFace = FrontFace::FRONT_FACE_COUNTER_CLOCKWISE;
-        postProcRasterizationState.polygonMode = PolygonMode::POLYGON_MODE_FILL;
-
-        DepthStencilStateCreateInfo postProcDepthStencilState = {};
-        postProcDepthStencilState.depthTestEnable = false;
-        postProcDepthStencilState.stencilTestEnable = false;
-
-        ColorBlendStateCreateInfo postProcColorBlendState = {};
-
-        ColorBlendAttachmentState postProcColorBlendAttachmentState = {};
-        postProcColorBlendAttachmentState.colorWriteMask.value = ColorComponentFlags::MASK_ALL;
-
-        ColorBlendAttachmentState postProcColorAttachmentsBlendStates[] = { postProcColorBlendAttachmentState };
-        postProcColorBlendState.pAttachmentStates = postProcColorAttachmentsBlendStates;
-        postProcColorBlendState.attachmentCount = _countof(postProcColorAttachmentsBlendStates);
-
-        FrameBufferClearValues postProcFrameBufferClearValues = {};
-        const FrameBufferColorAttachmentClearColor pPostProcColorAttachmentClearColors[] = {
-            { 0.f, 0.f, 0.f, 0.f },
-        };
-        postProcFrameBufferClearValues.pColorAttachmentClearColors = pPostProcColorAttachmentClearColors;
-        postProcFrameBufferClearValues.colorAttachmentsCount = _countof(pPostProcColorAttachmentClearColors);
-
-        PipelineCreateInfo postProcPipelineCreateInfo = {};
-        postProcPipelineCreateInfo.pInputAssemblyState = &postProcInputAssemblyState;
-        postProcPipelineCreateInfo.pRasterizationState = &postProcRasterizationState;
-        postProcPipelineCreateInfo.pDepthStencilState = &postProcDepthStencilState;
-        postProcPipelineCreateInfo.pColorBlendState = &postProcColorBlendState;
-        postProcPipelineCreateInfo.pFrameBufferClearValues = &postProcFrameBufferClearValues;
-        postProcPipelineCreateInfo.pFrameBuffer = rtManager.GetFrameBuffer(RTFrameBufferID::POST_PROCESS);
-        postProcPipelineCreateInfo.pShaderProgram = pPostProcProgram;
-
-        pPostProcPipeline = pipelineManager.RegisterPipeline();
-        ENG_ASSERT(pPostProcPipeline, "Failed to register POST PROCESS pipeline");
-        pPostProcPipeline->Create(postProcPipelineCreateInfo);
-        ENG_ASSERT(pPostProcPipeline->IsValid(), "Failed to create POST PROCESS pipeline");
-
-
-        const MeshVertexAttribDesc pVertexAttribDescs[] = {
-            MeshVertexAttribDesc { 0 * sizeof(float), MeshVertexAttribDataType::TYPE_FLOAT, 0, 3, false },
-            MeshVertexAttribDesc { 3 * sizeof(float), MeshVertexAttribDataType::TYPE_FLOAT, 1, 3, false },
-            MeshVertexAttribDesc { 6 * sizeof(float), MeshVertexAttribDataType::TYPE_FLOAT, 2, 2, false },
-        };
-
-        MeshVertexLayoutCreateInfo cubeVertexLayoutCreateInfo = {};
-        cubeVertexLayoutCreateInfo.pVertexAttribDescs = pVertexAttribDescs;
-        cubeVertexLayoutCreateInfo.vertexAttribDescsCount = _countof(pVertexAttribDescs);
-
-        MeshVertexLayout* pCubeVertexLayout = meshDataManager.RegisterVertexLayout(cubeVertexLayoutCreateInfo);
-        ENG_ASSERT(pCubeVertexLayout && pCubeVertexLayout->IsValid(), "Failed to register cube mesh vertex layout");
-
-        MeshGPUBufferData* pCubeBufferData = meshDataManager.RegisterGPUBufferData("cube");
-        ENG_ASSERT(pCubeBufferData, "Failed to register cube mesh GPU data");
-
-        constexpr float CUBE_HALF_SIZE = 0.5f;
-
-        const float pCubeRawVertexData[] = {
-            // position                                     // normal                       // UV
-            // Front face
-           -CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f, -0.57735f, 0.57735f, 0.f, 0.f,
-           -CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f,  0.57735f, 0.57735f, 0.f, 1.f,
-            CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f,  0.57735f, 0.57735f, 1.f, 1.f,
-            CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f, -0.57735f, 0.57735f, 1.f, 0.f,
-
-            // Back face
-            CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f, -0.57735f, -0.57735f, 0.f, 0.f,
-            CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f,  0.57735f, -0.57735f, 0.f, 1.f,
-           -CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f,  0.57735f, -0.57735f, 1.f, 1.f,
-           -CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f, -0.57735f, -0.57735f, 1.f, 0.f,
-
-            // Left face
-           -CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f, -0.57735f, -0.57735f, 0.f, 0.f,
-           -CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f,  0.57735f, -0.57735f, 0.f, 1.f,
-           -CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f,  0.57735f,  0.57735f, 1.f, 1.f,
-           -CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f, -0.57735f,  0.57735f, 1.f, 0.f,
-
-            // Right face
-            CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f, -0.57735f,  0.57735f, 0.f, 0.f,
-            CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f,  0.57735f,  0.57735f, 0.f, 1.f,
-            CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f,  0.57735f, -0.57735f, 1.f, 1.f,
-            CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f, -0.57735f, -0.57735f, 1.f, 0.f,
-
-            // Top face
-           -CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f,  0.57735f,  0.57735f, 0.f, 0.f,
-           -CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f,  0.57735f, -0.57735f, 0.f, 1.f,
-            CUBE_HALF_SIZE, CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f,  0.57735f, -0.57735f, 1.f, 1.f,
-            CUBE_HALF_SIZE, CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f,  0.57735f,  0.57735f, 1.f, 0.f,
-
-            // Bottom face
-           -CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE, -0.57735f, -0.57735f, -0.57735f, 0.f, 0.f,
-           -CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE, -0.57735f, -0.57735f,  0.57735f, 0.f, 1.f,
-            CUBE_HALF_SIZE,-CUBE_HALF_SIZE, CUBE_HALF_SIZE,  0.57735f, -0.57735f,  0.57735f, 1.f, 1.f,
-            CUBE_HALF_SIZE,-CUBE_HALF_SIZE,-CUBE_HALF_SIZE,  0.57735f, -0.57735f, -0.57735f, 1.f, 0.f,
-        };
-
-        const uint8_t cubeIndices[] = {
-            0, 2, 1, 0, 3, 2,
-            4, 6, 5, 4, 7, 6,
-            8, 10, 9, 8, 11, 10,
-            12, 14, 13, 12, 15, 14,
-            16, 18, 17, 16, 19, 18,
-            20, 22, 21, 20, 23, 22
-        };
-
-        MeshGPUBufferDataCreateInfo cubeGPUDataCreateInfo = {};
-        cubeGPUDataCreateInfo.pVertexData = pCubeRawVertexData;
-        cubeGPUDataCreateInfo.vertexDataSize = sizeof(pCubeRawVertexData);
-        cubeGPUDataCreateInfo.vertexSize = sizeof(pCubeRawVertexData) / 24;
-        cubeGPUDataCreateInfo.pIndexData = cubeIndices;
-        cubeGPUDataCreateInfo.indexDataSize = sizeof(cubeIndices);
-        cubeGPUDataCreateInfo.indexSize = sizeof(cubeIndices[0]);
-
-        pCubeBufferData->Create(cubeGPUDataCreateInfo);
-
-        pCubeMeshObj = meshManager.RegisterMeshObj("cube");
-        ENG_ASSERT(pCubeMeshObj, "Failed to register cube mesh object");
-        pCubeMeshObj->Create(pCubeVertexLayout, pCubeBufferData);
-        ENG_ASSERT(pCubeMeshObj->IsValid(), "Failed to create cube mesh object");
-
-
-        MemoryBufferCreateInfo commonConstBufferCreateInfo = {};
-        commonConstBufferCreateInfo.type = MemoryBufferType::TYPE_CONSTANT_BUFFER;
-        commonConstBufferCreateInfo.dataSize = sizeof(COMMON_DYN_CB);
-        commonConstBufferCreateInfo.elementSize = sizeof(COMMON_DYN_CB);
-        commonConstBufferCreateInfo.creationFlags = static_cast<MemoryBufferCreationFlags>(
-            BUFFER_CREATION_FLAG_DYNAMIC_STORAGE | BUFFER_CREATION_FLAG_READABLE | BUFFER_CREATION_FLAG_WRITABLE);
-        commonConstBufferCreateInfo.pData = nullptr;
-
-        pCommonConstBuffer = memBufferManager.RegisterBuffer();
-        ENG_ASSERT(pCommonConstBuffer, "Failed to register common const buffer");
-        pCommonConstBuffer->Create(commonConstBufferCreateInfo);
-        ENG_ASSERT(pCommonConstBuffer->IsValid(), "Failed to create common const buffer");
-        pCommonConstBuffer->SetDebugName("__COMMON_DYN_CB__");
-
-        MemoryBufferCreateInfo cameraConstBufferCreateInfo = {};
-        cameraConstBufferCreateInfo.type = MemoryBufferType::TYPE_CONSTANT_BUFFER;
-        cameraConstBufferCreateInfo.dataSize = sizeof(COMMON_CAMERA_CB);
-        cameraConstBufferCreateInfo.elementSize = sizeof(COMMON_CAMERA_CB);
-        cameraConstBufferCreateInfo.creationFlags = static_cast<MemoryBufferCreationFlags>(
-            BUFFER_CREATION_FLAG_DYNAMIC_STORAGE | BUFFER_CREATION_FLAG_WRITABLE);
-        cameraConstBufferCreateInfo.pData = nullptr;
-
-        pCameraConstBuffer = MemoryBufferManager::GetInstance().RegisterBuffer();
-        ENG_ASSERT(pCameraConstBuffer, "Failed to register camera const buffer");
-        pCameraConstBuffer->Create(cameraConstBufferCreateInfo);
-        ENG_ASSERT(pCameraConstBuffer->IsValid(), "Failed to create camera const buffer");
-        pCameraConstBuffer->SetDebugName("__COMMON_CAMERA_CB__");
-        
-        pCameraConstBuffer->BindIndexed(resGetResourceBinding(COMMON_CAMERA_CB).GetBinding());
-        
-        pMainCam = cameraManager.RegisterCamera();
-        ENG_ASSERT(pMainCam && pMainCam->IsRegistered(), "Failed to register camera");
-        
-        pMainCam->SetPerspProjection();
-        
-        pMainCam->SetZNear(0.01f);
-        pMainCam->SetZFar(100.f);
+    RenderTargetManager& rtManager = RenderTargetManager::GetInstance();
+
+    // Blits are scissored, while the upscaled image covers the whole framebuffer
+    engOpenGLScissor(0, 0, packet.framebufferWidth, packet.framebufferHeight);
+
+    queries.isTemporalUpscaled = m_isTemporalUpscalingEnabled;
+
+    if (m_isTemporalUpscalingEnabled) {
+        // History is already at the framebuffer resolution, so it's copied as is
+        const RTFrameBufferID historyFrameBufferID = m_temporalHistoryIdx == 0 ? RTFrameBufferID::TEMPORAL_HISTORY_0 : RTFrameBufferID::TEMPORAL_HISTORY_1;
+        const FrameBuffer* pHistoryFrameBuffer = rtManager.GetFrameBuffer(historyFrameBufferID);
 
-        pMainCam->SetPosition(glm::vec3(0.f, 0.f, 2.f));
-        pMainCam->SetRotation(glm::quatLookAt(-M3D_AXIS_Z, M3D_AXIS_Y));
+        glBlitNamedFramebuffer(pHistoryFrameBuffer->GetRenderID(), 0, 0, 0, packet.framebufferWidth, packet.framebufferHeight,
+            0, 0, packet.framebufferWidth, packet.framebufferHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
-        pMainCam->SetAspectRatio(window.GetFramebufferWidth(), window.GetFramebufferHeight());
-        pMainCam->SetFovDegress(90.f);
+        EndGPUQuery(queries.upscalePassTime);
+        return;
+    }
 
-        cameraManager.SubscribeCamera<EventFramebufferResized>(*pMainCam, [](const void* pEvent) {
-            const EventFramebufferResized& event = es::EventCast<EventFramebufferResized>(pEvent);
-            const uint32_t width = event.GetWidth();
-            const uint32_t height = event.GetHeight();
+    // Blit source is the frame buffer common color is attached to by the current frame graph. Color attachment 0 is read
+    const RTFrameBufferID colorFrameBufferID = m_isVisibilityBufferEnabled ? RTFrameBufferID::VISIBILITY_RESOLVE : RTFrameBufferID::POST_PROCESS;
+    const FrameBuffer* pColorFrameBuffer = rtManager.GetFrameBuffer(colorFrameBufferID);
     
-            const float halfWidth = width * 0.5f;
-            const float halfHeight = height * 0.5f;
-            
-            if (width > 0 && height > 0) {
-                pMainCam->SetAspectRatio(width, height);
-                
-                pMainCam->SetOrthoLeft(-halfWidth);
-                pMainCam->SetOrthoRight(halfWidth);
-                pMainCam->SetOrthoBottom(-halfHeight);
-                pMainCam->SetOrthoTop(halfHeight);
+    BeginGPUQuery(queries.upscalePassTime);
+
+    // Internal resolution is upscaled with bilinear filtering
+    glBlitNamedFramebuffer(pColorFrameBuffer->GetRenderID(), 0, 0, 0, m_renderWidth, m_renderHeight,
+        0, 0, packet.framebufferWidth, packet.framebufferHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+    EndGPUQuery(queries.upscalePassTime);
+}
+
+
+void RenderSystem::BuildFrameGraph(uint32_t width, uint32_t height, bool isDepthPrepassEnabled, bool isTemporalUpscalingEnabled, 
+    bool isVisibilityBufferEnabled) noexcept
+{
+    m_frameGraph.Reset();
+
+    const FrameGraphTextureHandle backBuffer = m_frameGraph.ImportTexture("_BACK_BUFFER_", nullptr);
+
+    // Passes set may change, so handles of passes missing in the new graph (e.g. GBuffer ones in visibility buffer mode) must not survive
+    m_frameGraphTextures = {};
+
+    // Light lists live in storage buffers, the handle only orders the passes
+    const FrameGraphTextureHandle clusterLightLists = m_frameGraph.ImportTexture("_CLUSTER_LIGHT_LISTS_", nullptr);
+
+    UpdateLightClustersGrid(width, height);
+
+    // Visible instances live in storage buffers, the handle only orders the passes
+    const FrameGraphTextureHandle visibleInstances = m_frameGraph.ImportTexture("_VISIBLE_INSTANCES_", nullptr);
+
+    // Pyramid persists between frames, the culling pass reads the one built by the previous frame
+    const FrameGraphTextureHandle hiZPyramid = m_frameGraph.ImportTexture("_HIZ_PYRAMID_", m_pHiZTexture);
+
+    UpdateHiZPyramid(width, height);
+
+    // History textures persist between frames, the handle only orders the passes
+    const FrameGraphTextureHandle temporalHistory = m_frameGraph.ImportTexture("_TEMPORAL_HISTORY_", nullptr);
+
+    UpdateTemporalHistory(width, height);
+
+    // Occlusion Culling
+    m_frameGraph.AddPass("_OCCLUSION_CULLING_", [&](FrameGraphPassBuilder& builder) {
+        builder.Read(hiZPyramid);
+        m_frameGraphTextures.visibleInstances = builder.Write(visibleInstances);
+    }, [this]() { RunOcclusionCullingPass(); });
+
+    // Depth Prepass
+    if (isDepthPrepassEnabled) {
+        m_frameGraph.AddPass("_DEPTH_PREPASS_", [&](FrameGraphPassBuilder& builder) {
+            builder.Read(m_frameGraphTextures.visibleInstances);
+
+            const FrameGraphTextureHandle depth = builder.CreateTexture("_COMMON_DEPTH_", { resGetTexResourceFormat(COMMON_DEPTH_TEX), width, height });
+            m_frameGraphTextures.commonDepth = builder.WriteDepthAttachment(depth);
+
+            builder.SetFrameBuffer(RTFrameBufferID::DEPTH_PREPASS);
+        }, [this]() { RunDepthPrepass(); });
+    }
+
+    // GBuffer Pass
+    if (isVisibilityBufferEnabled) {
+        // Only instance and triangle indices are written, surface attributes are reconstructed by the resolve pass
+        m_frameGraph.AddPass("_VISIBILITY_", [&](FrameGraphPassBuilder& builder) {
+            builder.Read(m_frameGraphTextures.visibleInstances);
+
+            const FrameGraphTextureHandle visibility = builder.CreateTexture("_VISIBILITY_", { resGetTexResourceFormat(COMMON_VISIBILITY_TEX), width, height });
+            m_frameGraphTextures.visibility = builder.WriteColorAttachment(visibility, 0);
+
+            if (m_frameGraphTextures.commonDepth.IsValid()) {
+                builder.Read(m_frameGraphTextures.commonDepth);
+            } else {
+                m_frameGraphTextures.commonDepth = builder.CreateTexture("_COMMON_DEPTH_", { resGetTexResourceFormat(COMMON_DEPTH_TEX), width, height });
             }
-        });
 
-        isInitialized = true;
+            m_frameGraphTextures.commonDepth = builder.WriteDepthAttachment(m_frameGraphTextures.commonDepth);
 
-        return;
+            builder.SetFrameBuffer(RTFrameBufferID::VISIBILITY);
+        }, [this]() { RunVisibilityPass(); });
+    } else {
+        m_frameGraph.AddPass("_GBUFFER_", [&](FrameGraphPassBuilder& builder) {
+            builder.Read(m_frameGraphTextures.visibleInstances);
+
+            const FrameGraphTextureHandle albedo = builder.CreateTexture("_GBUFFER_ALBEDO_", { resGetTexResourceFormat(GBufferAlbedoTex), width, height });
+            const FrameGraphTextureHandle normal = builder.CreateTexture("_GBUFFER_NORMAL_", { resGetTexResourceFormat(GBufferNormalTex), width, height });
+
+            m_frameGraphTextures.gBufferAlbedo = builder.WriteColorAttachment(albedo, 0);
+            m_frameGraphTextures.gBufferNormal = builder.WriteColorAttachment(normal, 1);
+
+        #if !defined(ENG_GBUFFER_COMPACT)
+            const FrameGraphTextureHandle specular = builder.CreateTexture("_GBUFFER_SPECULAR_", { resGetTexResourceFormat(GBUFFER_SPECULAR_TEX), width, height });
+            m_frameGraphTextures.gBufferSpecular = builder.WriteColorAttachment(specular, 2);
+        #endif
+
+            const FrameGraphTextureHandle motion = builder.CreateTexture("_GBUFFER_MOTION_", { resGetTexResourceFormat(GBUFFER_MOTION_TEX), width, height });
+            m_frameGraphTextures.gBufferMotion = builder.WriteColorAttachment(motion, GBUFFER_MOTION_ATTACHMENT_IDX);
+
+            // Prepass depth is tested for equality, otherwise GBuffer pass lays depth down itself
+            if (m_frameGraphTextures.commonDepth.IsValid()) {
+                builder.Read(m_frameGraphTextures.commonDepth);
+            } else {
+                m_frameGraphTextures.commonDepth = builder.CreateTexture("_COMMON_DEPTH_", { resGetTexResourceFormat(COMMON_DEPTH_TEX), width, height });
+            }
+
+            m_frameGraphTextures.commonDepth = builder.WriteDepthAttachment(m_frameGraphTextures.commonDepth);
+
+            builder.SetFrameBuffer(RTFrameBufferID::GBUFFER);
+        }, [this]() { RunGBufferPass(); });
+    }
+
+    // Hi-Z Pyramid
+    m_frameGraph.AddPass("_HIZ_", [&](FrameGraphPassBuilder& builder) {
+        builder.Read(m_frameGraphTextures.commonDepth);
+        m_frameGraphTextures.hiZPyramid = builder.Write(hiZPyramid);
+    }, [this]() { RunHiZPass(); });
+
+    // Light Culling
+    m_frameGraph.AddPass("_LIGHT_CULLING_", [&](FrameGraphPassBuilder& builder) {
+        builder.Read(m_frameGraphTextures.commonDepth);
+        m_frameGraphTextures.clusterLightLists = builder.Write(clusterLightLists);
+    }, [this]() { RunLightCullingPass(); });
+
+    // Clustered Lighting Pass
+    if (isVisibilityBufferEnabled) {
+        m_frameGraph.AddPass("_VISIBILITY_RESOLVE_", [&](FrameGraphPassBuilder& builder) {
+            builder.Read(m_frameGraphTextures.clusterLightLists);
+            builder.Read(m_frameGraphTextures.visibility);
+            builder.Read(m_frameGraphTextures.commonDepth);
+
+            const FrameGraphTextureHandle color = builder.CreateTexture("_COMMON_COLOR_", { resGetTexResourceFormat(CommonColorTex), width, height });
+            m_frameGraphTextures.commonColor = builder.WriteColorAttachment(color, 0);
+
+            const FrameGraphTextureHandle motion = builder.CreateTexture("_GBUFFER_MOTION_", { resGetTexResourceFormat(GBUFFER_MOTION_TEX), width, height });
+            m_frameGraphTextures.gBufferMotion = builder.WriteColorAttachment(motion, VISIBILITY_RESOLVE_MOTION_ATTACHMENT_IDX);
+
+            builder.SetFrameBuffer(RTFrameBufferID::VISIBILITY_RESOLVE);
+        }, [this]() { RunVisibilityResolvePass(); });
+    } else {
+        m_frameGraph.AddPass("_COLOR_", [&](FrameGraphPassBuilder& builder) {
+            builder.Read(m_frameGraphTextures.clusterLightLists);
+            builder.Read(m_frameGraphTextures.gBufferAlbedo);
+            builder.Read(m_frameGraphTextures.gBufferNormal);
+        #if !defined(ENG_GBUFFER_COMPACT)
+            builder.Read(m_frameGraphTextures.gBufferSpecular);
+        #endif
+            builder.Read(m_frameGraphTextures.commonDepth);
+
+            const FrameGraphTextureHandle color = builder.CreateTexture("_COMMON_COLOR_", { resGetTexResourceFormat(CommonColorTex), width, height });
+            m_frameGraphTextures.commonColor = builder.WriteColorAttachment(color, 0);
+
+            builder.SetFrameBuffer(RTFrameBufferID::POST_PROCESS);
+        }, [this]() { RunColorPass(); });
     }
 
-    static bool isStrIDMemLoged = false;
-    if (!isStrIDMemLoged) {
-        ENG_LOG_INFO("StrID memory: {}/{} KB", ds::StrID::GetStorageSize() / 1024.f, ds::StrID::GetStorageCapacity() / 1024.f);
-        isStrIDMemLoged = true;
+    // Temporal Upscale
+    m_frameGraphTextures.temporalHistory = {};
+
+    if (isTemporalUpscalingEnabled) {
+        m_frameGraph.AddPass("_TEMPORAL_UPSCALE_", [&](FrameGraphPassBuilder& builder) {
+            builder.Read(m_frameGraphTextures.commonColor);
+            builder.Read(m_frameGraphTextures.commonDepth);
+            builder.Read(m_frameGraphTextures.gBufferMotion);
+            m_frameGraphTextures.temporalHistory = builder.Write(temporalHistory);
+        }, [this]() { RunTemporalUpscalePass(); });
     }
 
-    const float elapsedTime = timer.GetElapsedTimeInSec();
-    const float deltaTime = timer.GetDeltaTimeInSec();
+    // Post Process
+    m_frameGraph.AddPass("_POST_PROCESS_", [&](FrameGraphPassBuilder& builder) {
+        builder.Read(m_frameGraphTextures.temporalHistory.IsValid() ? m_frameGraphTextures.temporalHistory : m_frameGraphTextures.commonColor);
+        builder.Write(backBuffer);
+    }, [this]() { RunPostprocessingPass(); });
 
-    char title[256];
-    sprintf_s(title, "%.3f ms | %.1f FPS", deltaTime, 1.f / deltaTime);
-    window.SetTitle(title);
+    m_frameGraph.Compile();
 
-    glm::vec3 offset(0.f);
-    
-    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_W) * (-pMainCam->GetZDir());
-    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_S) * (pMainCam->GetZDir());
-    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_D) * (pMainCam->GetXDir());
-    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_A) * (-pMainCam->GetXDir());
-    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_E) * (pMainCam->GetYDir());
-    offset += (float)input.IsKeyPressedOrHold(KeyboardKey::KEY_Q) * (-pMainCam->GetYDir());
+    m_frameGraphWidth = width;
+    m_frameGraphHeight = height;
+    m_isDepthPrepassEnabled = isDepthPrepassEnabled;
+    m_isVisibilityBufferEnabled = isVisibilityBufferEnabled;
+
+    const uint32_t bytesPerPixel = isVisibilityBufferEnabled ? 
+        GetRenderTargetsBytesPerPixel(VISIBILITY_LAYOUT_FORMATS, _countof(VISIBILITY_LAYOUT_FORMATS)) :
+        GetRenderTargetsBytesPerPixel(GBUFFER_LAYOUT_FORMATS, _countof(GBUFFER_LAYOUT_FORMATS));
+    m_lastFrameStatistics.gBufferBytesPerPixel.store(bytesPerPixel, std::memory_order_relaxed);
+
+    // History isn't updated by frames rendered without temporal upscaling
+    if (isTemporalUpscalingEnabled != m_isTemporalUpscalingEnabled) {
+        m_isTemporalHistoryValid = false;
+    }
+
+    m_isTemporalUpscalingEnabled = isTemporalUpscalingEnabled;
+}
+
+
+void RenderSystem::UpdateTemporalHistory(uint32_t width, uint32_t height) noexcept
+{
+    RenderTargetManager& rtManager = RenderTargetManager::GetInstance();
+
+    for (size_t i = 0; i < m_pTemporalHistoryTextures.size(); ++i) {
+        Texture* pHistoryTex = m_pTemporalHistoryTextures[i];
+
+        if (pHistoryTex->IsValid() && pHistoryTex->GetWidth() == width && pHistoryTex->GetHeight() == height) {
+            continue;
+        }
+
+        // Texture is recreated at the same address, so its frame buffer wouldn't notice the new storage
+        rtManager.DetachTexture(pHistoryTex);
+        pHistoryTex->Destroy();
+
+        Texture2DCreateInfo historyCreateInfo = {};
+        historyCreateInfo.format = resGetTexResourceFormat(COMMON_TEMPORAL_HISTORY_TEX);
+        historyCreateInfo.width = width;
+        historyCreateInfo.height = height;
+        historyCreateInfo.mipmapsCount = 0;
+
+        pHistoryTex->Create(historyCreateInfo);
+        ENG_ASSERT(pHistoryTex->IsValid(), "Failed to create temporal history texture");
 
-    if (!amIsZero(offset)) {
-        pMainCam->Move(glm::normalize(offset) * deltaTime);
+        FrameBufferAttachment attachment = {};
+        attachment.pTexure = pHistoryTex;
+        attachment.type = FrameBufferAttachmentType::COLOR_ATTACHMENT;
+        attachment.index = 0;
+
+        const RTFrameBufferID frameBufferID = i == 0 ? RTFrameBufferID::TEMPORAL_HISTORY_0 : RTFrameBufferID::TEMPORAL_HISTORY_1;
+        rtManager.SetFrameBufferAttachments(frameBufferID, &attachment, 1, i == 0 ? "_TEMPORAL_HISTORY_0_" : "_TEMPORAL_HISTORY_1_");
+
+        m_isTemporalHistoryValid = false;
     }
+}
+
 
-    const float fovDegrees = pMainCam->GetFovDegrees() - input.GetMouseWheelDy();
-    if (camIsFovDegreesValid(fovDegrees)) {
-        pMainCam->SetFovDegress(fovDegrees);
+void RenderSystem::UpdateRenderResolution(const FramePacket& packet) noexcept
+{
+    if (!packet.isDynamicResolutionEnabled) {
+        m_dynamicResolution.Reset();
     }
 
-    COMMON_CAMERA_CB* pCamConstBuff = pCameraConstBuffer->MapWrite<COMMON_CAMERA_CB>();
-    ENG_ASSERT(pCamConstBuff, "Failed to map camera const buffer");
+    const float scale = packet.isDynamicResolutionEnabled ? m_dynamicResolution.GetScale() : packet.resolutionScale;
+    ENG_ASSERT(scale > 0.f && scale <= DynamicResolutionController::MAX_SCALE, "Invalid resolution scale: {}", scale);
+
+    m_renderWidth = engGetScaledResolution(packet.framebufferWidth, scale);
+    m_renderHeight = engGetScaledResolution(packet.framebufferHeight, scale);
+
+    // Results of this frame queries are matched with the resolution they were measured at
+    RenderFrameGPUQueries& queries = m_gpuQueries[m_gpuQueriesIdx];
+    queries.pixelsCount = (uint64_t)m_renderWidth * m_renderHeight;
+    queries.renderScale = scale;
+    queries.frameIndex = packet.frameIndex;
+
+    m_lastFrameStatistics.renderWidth.store(m_renderWidth, std::memory_order_relaxed);
+    m_lastFrameStatistics.renderHeight.store(m_renderHeight, std::memory_order_relaxed);
+    m_lastFrameStatistics.resolutionScale.store(scale, std::memory_order_relaxed);
+}
+
+
+void RenderSystem::UpdateFrameConstants(const FramePacket& packet) noexcept
+{
+    const DynamicRingBufferAllocation cameraConstants = m_constBufferAllocator.AllocateTransient<COMMON_CAMERA_CB>();
+    COMMON_CAMERA_CB* pCamConstBuff = cameraConstants.As<COMMON_CAMERA_CB>();
+    ENG_ASSERT(pCamConstBuff, "Failed to allocate camera constants");
 
-    const glm::mat4x4 cameraViewMat = glm::transpose(pMainCam->GetViewMatrix());
+    const glm::mat4x4 cameraViewMat = glm::transpose(packet.viewMatrix);
     constexpr size_t commonViewMatSize = sizeof(pCamConstBuff->COMMON_VIEW_MATRIX);
     memcpy_s(pCamConstBuff->COMMON_VIEW_MATRIX, commonViewMatSize, &cameraViewMat, commonViewMatSize);
     
-    const glm::mat4x4 cameraProjMat = glm::transpose(pMainCam->GetProjectionMatrix());
+    const glm::mat4x4 cameraProjMat = glm::transpose(packet.projMatrix);
     constexpr size_t commonProjMatSize = sizeof(pCamConstBuff->COMMON_PROJ_MATRIX);
     memcpy_s(&pCamConstBuff->COMMON_PROJ_MATRIX, commonProjMatSize, &cameraProjMat, commonProjMatSize);
 
-    const glm::mat4x4 cameraViewProjMat = glm::transpose(pMainCam->GetViewProjectionMatrix());
+    // View position is reconstructed from depth with it
+    const glm::mat4x4 cameraInvProjMat = glm::transpose(glm::inverse(packet.projMatrix));
+    constexpr size_t commonInvProjMatSize = sizeof(pCamConstBuff->COMMON_INV_PROJ_MATRIX);
+    memcpy_s(&pCamConstBuff->COMMON_INV_PROJ_MATRIX, commonInvProjMatSize, &cameraInvProjMat, commonInvProjMatSize);
+
+    const glm::mat4x4 cameraViewProjMat = glm::transpose(packet.viewProjMatrix);
     constexpr size_t commonViewProjMatSize = sizeof(pCamConstBuff->COMMON_VIEW_PROJ_MATRIX);
     memcpy_s(&pCamConstBuff->COMMON_VIEW_PROJ_MATRIX, commonViewProjMatSize, &cameraViewProjMat, commonViewProjMatSize);
+
+    // The first frame has no previous camera, so its motion is zero
+    if (!m_isPrevViewProjValid) {
+        m_prevViewProjMatrix = packet.viewProjMatrix;
+        m_prevProjJitter = packet.projJitter;
+        m_isPrevViewProjValid = true;
+    }
+
+    const glm::mat4x4 cameraPrevViewProjMat = glm::transpose(m_prevViewProjMatrix);
+    constexpr size_t commonPrevViewProjMatSize = sizeof(pCamConstBuff->COMMON_PREV_VIEW_PROJ_MATRIX);
+    memcpy_s(&pCamConstBuff->COMMON_PREV_VIEW_PROJ_MATRIX, commonPrevViewProjMatSize, &cameraPrevViewProjMat, commonPrevViewProjMatSize);
+
+    pCamConstBuff->COMMON_PROJ_JITTER.x = packet.projJitter.x;
+    pCamConstBuff->COMMON_PROJ_JITTER.y = packet.projJitter.y;
+    pCamConstBuff->COMMON_PREV_PROJ_JITTER.x = m_prevProjJitter.x;
+    pCamConstBuff->COMMON_PREV_PROJ_JITTER.y = m_prevProjJitter.y;
     
-    float camZNear = pMainCam->GetZNear();
-    float camZFar = pMainCam->GetZFar();
+    float camZNear = packet.zNear;
+    float camZFar = packet.zFar;
 #if defined(ENG_USE_INVERTED_Z)
     std::swap(camZNear, camZFar);
 #endif
@@ -534,67 +2273,99 @@ void RenderSystem::RunColorPass() noexcept
     pCamConstBuff->COMMON_VIEW_Z_NEAR = camZNear;
     pCamConstBuff->COMMON_VIEW_Z_FAR = camZFar;
 
-    pCameraConstBuffer->Unmap();
+    cameraConstants.pBuffer->BindIndexedRange(resGetResourceBinding(COMMON_CAMERA_CB).GetBinding(), cameraConstants.offset, cameraConstants.size);
 
-    glViewport(0, 0, window.GetFramebufferWidth(), window.GetFramebufferHeight());
+    m_commonConstants = m_constBufferAllocator.AllocateTransient<COMMON_DYN_CB>();
+    COMMON_DYN_CB* pCommonUBO = m_commonConstants.As<COMMON_DYN_CB>();
+    ENG_ASSERT(pCommonUBO, "Failed to allocate common dynamic constants");
+    
+    pCommonUBO->COMMON_ELAPSED_TIME  = packet.elapsedTime;
+    pCommonUBO->COMMON_DELTA_TIME    = packet.deltaTime;
+    pCommonUBO->COMMON_SCREEN_WIDTH  = (float)m_renderWidth;
+    pCommonUBO->COMMON_SCREEN_HEIGHT = (float)m_renderHeight;
+
+    // Depth is created in every passes set, at the full frame graph size
+    const Texture* pRTTexture = m_frameGraph.GetTexture(m_frameGraphTextures.commonDepth);
+    pCommonUBO->COMMON_RT_UV_SCALE.x = (float)m_renderWidth / pRTTexture->GetWidth();
+    pCommonUBO->COMMON_RT_UV_SCALE.y = (float)m_renderHeight / pRTTexture->GetHeight();
+}
 
-    {
-        pGBufferPipeline->ClearFrameBuffer();
-        pGBufferPipeline->Bind();
 
-        COMMON_DYN_CB* pCommonUBO = static_cast<COMMON_DYN_CB*>(pCommonConstBuffer->MapWrite());
-        ENG_ASSERT(pCommonUBO, "pCommonUBO is nullptr");
-        
-        pCommonUBO->COMMON_ELAPSED_TIME  = elapsedTime;
-        pCommonUBO->COMMON_DELTA_TIME    = deltaTime;
-        pCommonUBO->COMMON_SCREEN_WIDTH  = (float)window.GetFramebufferWidth();
-        pCommonUBO->COMMON_SCREEN_HEIGHT = (float)window.GetFramebufferHeight();
-        
-        pCommonConstBuffer->Unmap();
+void RenderSystem::SubmitCommandBuffers(uint32_t commandBuffersCount) noexcept
+{
+    RenderCommandBuffer::MergeSorted(m_commandBuffers.data(), commandBuffersCount, m_mergedPackets);
+    engOpenGLExecuteCommandPackets(m_mergedPackets.data(), m_mergedPackets.size());
+}
 
-        pCommonConstBuffer->BindIndexed(resGetResourceBinding(COMMON_DYN_CB).GetBinding());
 
-        pTestTexture->Bind(resGetResourceBinding(TEST_TEXTURE).GetBinding());
-        pTestTextureSampler->Bind(resGetResourceBinding(TEST_TEXTURE).GetBinding());
+void RenderSystem::BuildInstancedBatches(const FramePacket& packet) noexcept
+{
+    MeshManager& meshManager = MeshManager::GetInstance();
 
-        pCubeMeshObj->Bind();
+    const uint32_t pipeline = pGBufferPipeline->GetID().Value();
 
-        glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, 0, 1);
-    }
+    const size_t drawItemsCount = packet.drawItems.size();
 
-    {
-        pPostProcPipeline->ClearFrameBuffer();
-        pPostProcPipeline->Bind();
+    m_batchedDrawItems.resize(drawItemsCount);
+    m_batchedDrawItemsScratch.resize(drawItemsCount);
 
-        pGBufferAlbedoTex->Bind(resGetResourceBinding(GBUFFER_ALBEDO_TEX).GetBinding());
-        pGBufferAlbedoSampler->Bind(resGetResourceBinding(GBUFFER_ALBEDO_TEX).GetBinding());
-            
-        pGBufferNormalTex->Bind(resGetResourceBinding(GBUFFER_NORMAL_TEX).GetBinding());
-        pGBufferNormalSampler->Bind(resGetResourceBinding(GBUFFER_NORMAL_TEX).GetBinding());
-            
-        pGBufferSpecTex->Bind(resGetResourceBinding(GBUFFER_SPECULAR_TEX).GetBinding());
-        pGBufferSpecSampler->Bind(resGetResourceBinding(GBUFFER_SPECULAR_TEX).GetBinding());
-            
-        pCommonDepthTex->Bind(resGetResourceBinding(COMMON_DEPTH_TEX).GetBinding());
-        pGBufferDepthSampler->Bind(resGetResourceBinding(COMMON_DEPTH_TEX).GetBinding());
+    const MeshObj* pMesh = nullptr;
 
-        pCommonConstBuffer->BindIndexed(resGetResourceBinding(COMMON_DYN_CB).GetBinding());
+    for (size_t i = 0; i < drawItemsCount; ++i) {
+        const FramePacketDrawItem& drawItem = packet.drawItems[i];
 
-        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, 1);
-    }
+        // Draw items usually come in runs of the same mesh, so the lookup is done only when mesh changes
+        if (i == 0 || !(drawItem.meshName == packet.drawItems[i - 1].meshName)) {
+            pMesh = meshManager.GetMeshObjByName(drawItem.meshName);
+            ENG_ASSERT_GRAPHICS_API(pMesh && pMesh->IsValid(), "Invalid mesh \'{}\' in frame packet", drawItem.meshName.CStr());
+            ENG_ASSERT_GRAPHICS_API(!m_isVisibilityBufferEnabled || m_visibilityGeometry.FindMeshRange(pMesh->GetID()), 
+                "Mesh \'{}\' has no visibility geometry", drawItem.meshName.CStr());
+        }
 
-    {
-        const FrameBuffer* pPostProcFrameBuffer = rtManager.GetFrameBuffer(RTFrameBufferID::POST_PROCESS);
-        
-        glBlitNamedFramebuffer(pPostProcFrameBuffer->GetRenderID(), 0, 0, 0, window.GetWidth(), window.GetHeight(),
-            0, 0, window.GetWidth(), window.GetHeight(), GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        RenderBatchedDrawItem& batchedDrawItem = m_batchedDrawItems[i];
+        batchedDrawItem.batchKey = MakeDrawBatchKey(pipeline, pMesh->GetID().Value(), drawItem.materialIdx);
+        batchedDrawItem.pMesh = pMesh;
+        batchedDrawItem.drawItemIdx = static_cast<uint32_t>(i);
+        batchedDrawItem.batchIdx = 0;
     }
-}
 
+    // Stable sort keeps submission order of instances inside a batch
+    amRadixSort(m_batchedDrawItems.data(), m_batchedDrawItemsScratch.data(), drawItemsCount, 
+        [](const RenderBatchedDrawItem& item) { return item.batchKey; }, &m_recordingWorkers);
 
-void RenderSystem::RunPostprocessingPass() noexcept
-{
+    m_instancedBatches.clear();
+    m_multiDrawGroups.clear();
+
+    for (size_t i = 0; i < drawItemsCount; ++i) {
+        RenderBatchedDrawItem& batchedDrawItem = m_batchedDrawItems[i];
+
+        if (m_instancedBatches.empty() || m_instancedBatches.back().batchKey != batchedDrawItem.batchKey) {
+            const bool startsMultiDrawGroup = m_instancedBatches.empty() || 
+                GetDrawBatchKeyVertexArraysPart(m_instancedBatches.back().batchKey) != GetDrawBatchKeyVertexArraysPart(batchedDrawItem.batchKey);
 
+            if (startsMultiDrawGroup) {
+                RenderMultiDrawGroup group = {};
+                group.pMesh = batchedDrawItem.pMesh;
+                group.firstBatch = static_cast<uint32_t>(m_instancedBatches.size());
+                group.batchesCount = 0;
+
+                m_multiDrawGroups.emplace_back(group);
+            }
+
+            ++m_multiDrawGroups.back().batchesCount;
+
+            RenderInstancedBatch batch = {};
+            batch.batchKey = batchedDrawItem.batchKey;
+            batch.pMesh = batchedDrawItem.pMesh;
+            batch.firstInstance = static_cast<uint32_t>(i);
+            batch.instancesCount = 0;
+
+            m_instancedBatches.emplace_back(batch);
+        }
+
+        ++m_instancedBatches.back().instancesCount;
+        batchedDrawItem.batchIdx = static_cast<uint32_t>(m_instancedBatches.size() - 1);
+    }
 }
 
 
@@ -610,14 +2381,170 @@ bool RenderSystem::Init() noexcept
         return true;
     }
 
+    // CPU side work doesn't need graphics context, so it runs on worker threads while managers are initialized
+    std::future<std::string> depthPrepassVsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_DepthPrepass_VS", BASE_VS_FILEPATH, ShaderStageType::VERTEX, "PASS_DEPTH_PREPASS");
+    std::future<std::string> depthPrepassPsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_DepthPrepass_PS", BASE_PS_FILEPATH, ShaderStageType::PIXEL, "PASS_DEPTH_PREPASS");
+    std::future<std::string> gBufferVsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_GBuffer_VS", BASE_VS_FILEPATH, ShaderStageType::VERTEX, "PASS_GBUFFER");
+    std::future<std::string> gBufferPsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_GBuffer_PS", BASE_PS_FILEPATH, ShaderStageType::PIXEL, "PASS_GBUFFER");
+    std::future<std::string> postProcVsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_PostProcess_VS", BASE_VS_FILEPATH, ShaderStageType::VERTEX, "PASS_POST_PROCESS");
+    std::future<std::string> postProcPsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_PostProcess_PS", BASE_PS_FILEPATH, ShaderStageType::PIXEL, "PASS_POST_PROCESS");
+    std::future<std::string> visibilityVsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_Visibility_VS", BASE_VS_FILEPATH, ShaderStageType::VERTEX, "PASS_VISIBILITY");
+    std::future<std::string> visibilityPsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_Visibility_PS", BASE_PS_FILEPATH, ShaderStageType::PIXEL, "PASS_VISIBILITY");
+    std::future<std::string> visibilityResolveVsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_VisibilityResolve_VS", BASE_VS_FILEPATH, ShaderStageType::VERTEX, "PASS_VISIBILITY_RESOLVE");
+    std::future<std::string> visibilityResolvePsFuture = std::async(std::launch::async, PreprocessShaderStage, 
+        "PreprocessShader_VisibilityResolve_PS", BASE_PS_FILEPATH, ShaderStageType::PIXEL, "PASS_VISIBILITY_RESOLVE");
+    std::future<std::string> lightCullingCsFuture = std::async(std::launch::async, PreprocessShaderStage,
+        "PreprocessShader_LightCulling_CS", CLUSTER_LIGHT_CULLING_CS_FILEPATH, ShaderStageType::COMPUTE, "PASS_LIGHT_CULLING");
+    std::future<std::string> hiZDownsampleCsFuture = std::async(std::launch::async, PreprocessShaderStage,
+        "PreprocessShader_HiZDownsample_CS", HIZ_DOWNSAMPLE_CS_FILEPATH, ShaderStageType::COMPUTE, "PASS_HIZ_DOWNSAMPLE");
+    std::future<std::string> occlusionCullingCsFuture = std::async(std::launch::async, PreprocessShaderStage,
+        "PreprocessShader_OcclusionCulling_CS", OCCLUSION_CULLING_CS_FILEPATH, ShaderStageType::COMPUTE, "PASS_OCCLUSION_CULLING");
+    std::future<std::string> temporalUpscaleCsFuture = std::async(std::launch::async, PreprocessShaderStage,
+        "PreprocessShader_TemporalUpscale_CS", TEMPORAL_UPSCALE_CS_FILEPATH, ShaderStageType::COMPUTE, "PASS_TEMPORAL_UPSCALE");
+    
+    std::future<std::vector<uint8_t>> testTextureDataFuture = std::async(std::launch::async, GenerateTestTextureData);
+
     INIT_CALL(engInitOpenGLDriver);
     INIT_CALL(engInitShaderManager);
     INIT_CALL(engInitTextureManager);
     INIT_CALL(engInitRenderTargetManager);
     INIT_CALL(engInitPipelineManager);
     INIT_CALL(engInitMemoryBufferManager);
+    INIT_CALL(engInitUploadManager);
     INIT_CALL(engInitMeshManager);
 
+    FrameResourcesSourceData frameResourcesSourceData = {};
+    frameResourcesSourceData.depthPrepassVsSourceCode = depthPrepassVsFuture.get();
+    frameResourcesSourceData.depthPrepassPsSourceCode = depthPrepassPsFuture.get();
+    frameResourcesSourceData.gBufferVsSourceCode = gBufferVsFuture.get();
+    frameResourcesSourceData.gBufferPsSourceCode = gBufferPsFuture.get();
+    frameResourcesSourceData.postProcVsSourceCode = postProcVsFuture.get();
+    frameResourcesSourceData.postProcPsSourceCode = postProcPsFuture.get();
+    frameResourcesSourceData.visibilityVsSourceCode = visibilityVsFuture.get();
+    frameResourcesSourceData.visibilityPsSourceCode = visibilityPsFuture.get();
+    frameResourcesSourceData.visibilityResolveVsSourceCode = visibilityResolveVsFuture.get();
+    frameResourcesSourceData.visibilityResolvePsSourceCode = visibilityResolvePsFuture.get();
+    frameResourcesSourceData.lightCullingCsSourceCode = lightCullingCsFuture.get();
+    frameResourcesSourceData.hiZDownsampleCsSourceCode = hiZDownsampleCsFuture.get();
+    frameResourcesSourceData.occlusionCullingCsSourceCode = occlusionCullingCsFuture.get();
+    frameResourcesSourceData.temporalUpscaleCsSourceCode = temporalUpscaleCsFuture.get();
+    frameResourcesSourceData.testTextureData = testTextureDataFuture.get();
+
+    MemoryBufferManager& bufferManager = MemoryBufferManager::GetInstance();
+
+    // Sized by the frame graph build, since light clusters cover the framebuffer
+    m_pClustersBuffer = bufferManager.RegisterBuffer();
+    m_pClusterLightIndicesBuffer = bufferManager.RegisterBuffer();
+    ENG_ASSERT(m_pClustersBuffer && m_pClusterLightIndicesBuffer, "Failed to register light clusters buffers");
+
+    MemoryBufferCreateInfo clusterCountersCreateInfo = {};
+    clusterCountersCreateInfo.dataSize = sizeof(COMMON_CLUSTER_COUNTERS);
+    clusterCountersCreateInfo.elementSize = sizeof(COMMON_CLUSTER_COUNTERS);
+    clusterCountersCreateInfo.type = MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER;
+
+    m_pClusterCountersBuffer = bufferManager.RegisterBuffer();
+    ENG_ASSERT(m_pClusterCountersBuffer, "Failed to register light clusters counters buffer");
+    m_pClusterCountersBuffer->Create(clusterCountersCreateInfo);
+    ENG_ASSERT(m_pClusterCountersBuffer->IsValid(), "Failed to create light clusters counters buffer");
+    m_pClusterCountersBuffer->SetDebugName("__COMMON_CLUSTER_COUNTERS_UAV__");
+
+    // Sized by the frame graph build along with the framebuffer
+    const ds::StrID hiZTexName = "__COMMON_HIZ__";
+    m_pHiZTexture = TextureManager::GetInstance().RegisterTexture2D(hiZTexName);
+    ENG_ASSERT(m_pHiZTexture, "Failed to register texture: {}", hiZTexName.CStr());
+
+    // Grows with frame packet draw items count
+    m_pVisibleInstancesBuffer = bufferManager.RegisterBuffer();
+    ENG_ASSERT(m_pVisibleInstancesBuffer, "Failed to register visible instances buffer");
+
+    MemoryBufferCreateInfo occlusionCountersCreateInfo = {};
+    occlusionCountersCreateInfo.dataSize = sizeof(COMMON_OCCLUSION_COUNTERS);
+    occlusionCountersCreateInfo.elementSize = sizeof(COMMON_OCCLUSION_COUNTERS);
+    occlusionCountersCreateInfo.type = MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER;
+
+    m_pOcclusionCountersBuffer = bufferManager.RegisterBuffer();
+    ENG_ASSERT(m_pOcclusionCountersBuffer, "Failed to register occlusion culling counters buffer");
+    m_pOcclusionCountersBuffer->Create(occlusionCountersCreateInfo);
+    ENG_ASSERT(m_pOcclusionCountersBuffer->IsValid(), "Failed to create occlusion culling counters buffer");
+    m_pOcclusionCountersBuffer->SetDebugName("__COMMON_OCCLUSION_COUNTERS_UAV__");
+
+    // Sized by the frame graph build along with the framebuffer
+    for (size_t i = 0; i < m_pTemporalHistoryTextures.size(); ++i) {
+        const ds::StrID historyTexName = i == 0 ? "__COMMON_TEMPORAL_HISTORY_0__" : "__COMMON_TEMPORAL_HISTORY_1__";
+        m_pTemporalHistoryTextures[i] = TextureManager::GetInstance().RegisterTexture2D(historyTexName);
+        ENG_ASSERT(m_pTemporalHistoryTextures[i], "Failed to register texture: {}", historyTexName.CStr());
+    }
+
+    {
+        StartupTimelineScopedStage stage("BuildFrameGraph");
+
+        // Built with depth prepass and temporal upscaling in both modes, so that all frame buffers are valid for pipelines creation.
+        // Visibility buffer frame buffers keep their attachments until the graph is rebuilt in that mode again
+        const Window& window = engGetMainWindow();
+        BuildFrameGraph(window.GetFramebufferWidth(), window.GetFramebufferHeight(), true, true, true);
+        BuildFrameGraph(window.GetFramebufferWidth(), window.GetFramebufferHeight(), true, true, false);
+    }
+
+    INIT_CALL(CreateFrameResources, frameResourcesSourceData, m_visibilityGeometry);
+
+    m_constBufferAllocator.Create(MemoryBufferType::TYPE_CONSTANT_BUFFER, ConstBufferAllocator::DEFAULT_PAGE_SIZE, 
+        TRANSIENT_CONSTANTS_FRAME_REGION_SIZE, "__CONST_BUFFER_ALLOCATOR__");
+    m_instanceDataRingBuffer.Create(MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER, 
+        MIN_STREAM_BUFFER_CAPACITY * sizeof(COMMON_INSTANCE_DATA), "__COMMON_INSTANCE_DATA_SB__");
+    m_indirectArgsRingBuffer.Create(MemoryBufferType::TYPE_INDIRECT_ARGS_BUFFER, 
+        MIN_STREAM_BUFFER_CAPACITY * sizeof(RenderDrawIndexedIndirectArgs), "__INDIRECT_ARGS__");
+    m_lightDataRingBuffer.Create(MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER, 
+        MIN_STREAM_BUFFER_CAPACITY * sizeof(COMMON_LIGHT_DATA), "__COMMON_LIGHTS_SB__");
+
+    // Main and render threads are already busy
+    const uint32_t hardwareThreadsCount = std::thread::hardware_concurrency();
+    const uint32_t recordingWorkersCount = std::min(hardwareThreadsCount > 2 ? hardwareThreadsCount - 2 : 0, MAX_RECORDING_WORKERS_COUNT);
+
+    for (RenderFrameGPUQueries& queries : m_gpuQueries) {
+        CreateGPUQuery(queries.depthPrepassFragments, GL_FRAGMENT_SHADER_INVOCATIONS);
+        CreateGPUQuery(queries.gBufferFragments, GL_FRAGMENT_SHADER_INVOCATIONS);
+        CreateGPUQuery(queries.depthPrepassTime, GL_TIME_ELAPSED);
+        CreateGPUQuery(queries.gBufferPassTime, GL_TIME_ELAPSED);
+        CreateGPUQuery(queries.lightCullingTime, GL_TIME_ELAPSED);
+        CreateGPUQuery(queries.colorPassTime, GL_TIME_ELAPSED);
+        CreateGPUQuery(queries.occlusionCullingTime, GL_TIME_ELAPSED);
+        CreateGPUQuery(queries.hiZPassTime, GL_TIME_ELAPSED);
+        CreateGPUQuery(queries.upscalePassTime, GL_TIME_ELAPSED);
+        CreateGPUQuery(queries.frameBeginTimestamp, GL_TIMESTAMP);
+        CreateGPUQuery(queries.frameEndTimestamp, GL_TIMESTAMP);
+
+        clusterCountersCreateInfo.creationFlags = BUFFER_CREATION_FLAG_READABLE;
+
+        queries.pClusterCountersReadback = bufferManager.RegisterBuffer();
+        ENG_ASSERT(queries.pClusterCountersReadback, "Failed to register light clusters counters readback buffer");
+        queries.pClusterCountersReadback->Create(clusterCountersCreateInfo);
+        ENG_ASSERT(queries.pClusterCountersReadback->IsValid(), "Failed to create light clusters counters readback buffer");
+
+        occlusionCountersCreateInfo.creationFlags = BUFFER_CREATION_FLAG_READABLE;
+
+        queries.pOcclusionCountersReadback = bufferManager.RegisterBuffer();
+        ENG_ASSERT(queries.pOcclusionCountersReadback, "Failed to register occlusion culling counters readback buffer");
+        queries.pOcclusionCountersReadback->Create(occlusionCountersCreateInfo);
+        ENG_ASSERT(queries.pOcclusionCountersReadback->IsValid(), "Failed to create occlusion culling counters readback buffer");
+    }
+
+    m_recordingWorkers.Start(recordingWorkersCount);
+    m_commandBuffers.resize(recordingWorkersCount + 1);
+
+#if defined(ENG_RUN_RENDER_BENCHMARKS)
+    engRunCommandRecordingBenchmark(100'000, std::max(hardwareThreadsCount, 1u));
+    engRunSortKeysBenchmark(std::max(hardwareThreadsCount, 1u));
+#endif
+
     m_isInitialized = true;
 
     return true;
@@ -626,23 +2553,192 @@ bool RenderSystem::Init() noexcept
     
 void RenderSystem::Terminate() noexcept
 {
+    StopRenderThread();
+
+    m_recordingWorkers.Stop();
+    
+    m_mergedPackets.clear();
+    m_commandBuffers.clear();
+
+    m_batchedDrawItems.clear();
+    m_batchedDrawItemsScratch.clear();
+    m_instancedBatches.clear();
+    m_multiDrawGroups.clear();
+
+    m_constBufferAllocator.Destroy();
+    m_instanceDataRingBuffer.Destroy();
+    m_indirectArgsRingBuffer.Destroy();
+    m_lightDataRingBuffer.Destroy();
+
+    MemoryBufferManager& bufferManager = MemoryBufferManager::GetInstance();
+
+    bufferManager.UnregisterBuffer(m_pClustersBuffer);
+    bufferManager.UnregisterBuffer(m_pClusterLightIndicesBuffer);
+    bufferManager.UnregisterBuffer(m_pClusterCountersBuffer);
+
+    m_pClustersBuffer = nullptr;
+    m_pClusterLightIndicesBuffer = nullptr;
+    m_pClusterCountersBuffer = nullptr;
+
+    m_clusterGridWidth = 0;
+    m_clusterGridHeight = 0;
+
+    bufferManager.UnregisterBuffer(m_pVisibleInstancesBuffer);
+    bufferManager.UnregisterBuffer(m_pOcclusionCountersBuffer);
+
+    m_pVisibleInstancesBuffer = nullptr;
+    m_pOcclusionCountersBuffer = nullptr;
+
+    if (m_pHiZTexture) {
+        TextureManager::GetInstance().UnregisterTexture(m_pHiZTexture);
+        m_pHiZTexture = nullptr;
+    }
+
+    m_hiZViewProjMatrix = M3D_MAT4_IDENTITY;
+    m_hiZScreenWidth = 0;
+    m_hiZScreenHeight = 0;
+    m_hiZLevelsCount = 0;
+    m_isHiZValid = false;
+
+    for (Texture*& pHistoryTexture : m_pTemporalHistoryTextures) {
+        if (pHistoryTexture) {
+            RenderTargetManager::GetInstance().DetachTexture(pHistoryTexture);
+            TextureManager::GetInstance().UnregisterTexture(pHistoryTexture);
+            pHistoryTexture = nullptr;
+        }
+    }
+
+    m_temporalHistoryIdx = 0;
+    m_isTemporalHistoryValid = false;
+
+    m_prevViewProjMatrix = M3D_MAT4_IDENTITY;
+    m_prevProjJitter = M3D_ZEROF2;
+    m_isPrevViewProjValid = false;
+
+    for (RenderFrameGPUQueries& queries : m_gpuQueries) {
+        DestroyGPUQuery(queries.depthPrepassFragments);
+        DestroyGPUQuery(queries.gBufferFragments);
+        DestroyGPUQuery(queries.depthPrepassTime);
+        DestroyGPUQuery(queries.gBufferPassTime);
+        DestroyGPUQuery(queries.lightCullingTime);
+        DestroyGPUQuery(queries.colorPassTime);
+        DestroyGPUQuery(queries.occlusionCullingTime);
+        DestroyGPUQuery(queries.hiZPassTime);
+        DestroyGPUQuery(queries.upscalePassTime);
+        DestroyGPUQuery(queries.frameBeginTimestamp);
+        DestroyGPUQuery(queries.frameEndTimestamp);
+
+        bufferManager.UnregisterBuffer(queries.pClusterCountersReadback);
+        queries.pClusterCountersReadback = nullptr;
+
+        bufferManager.UnregisterBuffer(queries.pOcclusionCountersReadback);
+        queries.pOcclusionCountersReadback = nullptr;
+
+        queries.pixelsCount = 0;
+        queries.frameIndex = 0;
+        queries.renderScale = 0.f;
+        queries.lightsCount = 0;
+        queries.isTemporalUpscaled = false;
+    }
+
+    // Pooled render targets must be returned before render target manager termination
+    m_frameGraph.Reset();
+
+    m_frameGraphWidth = 0;
+    m_frameGraphHeight = 0;
+    m_isDepthPrepassEnabled = true;
+    m_isTemporalUpscalingEnabled = true;
+    m_isVisibilityBufferEnabled = false;
+
+    m_visibilityGeometry.Destroy();
+
+    m_dynamicResolution.Reset();
+    m_renderWidth = 0;
+    m_renderHeight = 0;
+
     engTerminateMeshManager();
+    engTerminateUploadManager();
     engTerminateMemoryBufferManager();
     engTerminatePipelineManager();
     engTerminateRenderTargetManager();
     engTerminateTextureManager();
     engTerminateShaderManager();
 
+    engOpenGLReleaseAllRetiredObjects();
+
     m_isInitialized = false;
 }
 
 
+RenderFrameStatistics RenderSystem::GetLastFrameStatistics() const noexcept
+{
+    RenderFrameStatistics statistics = {};
+    statistics.frameIndex = m_lastFrameStatistics.frameIndex.load(std::memory_order_acquire);
+    statistics.issuedStateCallsCount = m_lastFrameStatistics.issuedStateCallsCount.load(std::memory_order_relaxed);
+    statistics.skippedStateCallsCount = m_lastFrameStatistics.skippedStateCallsCount.load(std::memory_order_relaxed);
+    statistics.drawItemsCount = m_lastFrameStatistics.drawItemsCount.load(std::memory_order_relaxed);
+    statistics.instancedDrawCallsCount = m_lastFrameStatistics.instancedDrawCallsCount.load(std::memory_order_relaxed);
+    statistics.multiDrawCallsCount = m_lastFrameStatistics.multiDrawCallsCount.load(std::memory_order_relaxed);
+    statistics.retiredObjectsCount = m_lastFrameStatistics.retiredObjectsCount.load(std::memory_order_relaxed);
+    statistics.uploadedSize = m_lastFrameStatistics.uploadedSize.load(std::memory_order_relaxed);
+    statistics.pendingUploadSize = m_lastFrameStatistics.pendingUploadSize.load(std::memory_order_relaxed);
+    statistics.constBuffersUtilization = m_lastFrameStatistics.constBuffersUtilization.load(std::memory_order_relaxed);
+    statistics.constBuffersFragmentation = m_lastFrameStatistics.constBuffersFragmentation.load(std::memory_order_relaxed);
+    statistics.rtMemorySize = m_lastFrameStatistics.rtMemorySize.load(std::memory_order_relaxed);
+    statistics.aliasedRTMemorySize = m_lastFrameStatistics.aliasedRTMemorySize.load(std::memory_order_relaxed);
+    statistics.loadedAttachmentsCount = m_lastFrameStatistics.loadedAttachmentsCount.load(std::memory_order_relaxed);
+    statistics.clearedAttachmentsCount = m_lastFrameStatistics.clearedAttachmentsCount.load(std::memory_order_relaxed);
+    statistics.storedAttachmentsCount = m_lastFrameStatistics.storedAttachmentsCount.load(std::memory_order_relaxed);
+    statistics.discardedAttachmentsCount = m_lastFrameStatistics.discardedAttachmentsCount.load(std::memory_order_relaxed);
+    statistics.depthPrepassFragmentsCount = m_lastFrameStatistics.depthPrepassFragmentsCount.load(std::memory_order_relaxed);
+    statistics.gBufferFragmentsCount = m_lastFrameStatistics.gBufferFragmentsCount.load(std::memory_order_relaxed);
+    statistics.gBufferOverdraw = m_lastFrameStatistics.gBufferOverdraw.load(std::memory_order_relaxed);
+    statistics.depthPrepassTimeMs = m_lastFrameStatistics.depthPrepassTimeMs.load(std::memory_order_relaxed);
+    statistics.gBufferPassTimeMs = m_lastFrameStatistics.gBufferPassTimeMs.load(std::memory_order_relaxed);
+    statistics.lightCullingTimeMs = m_lastFrameStatistics.lightCullingTimeMs.load(std::memory_order_relaxed);
+    statistics.colorPassTimeMs = m_lastFrameStatistics.colorPassTimeMs.load(std::memory_order_relaxed);
+    statistics.gBufferBytesPerPixel = m_lastFrameStatistics.gBufferBytesPerPixel.load(std::memory_order_relaxed);
+    statistics.lightsCount = m_lastFrameStatistics.lightsCount.load(std::memory_order_relaxed);
+    statistics.litClustersCount = m_lastFrameStatistics.litClustersCount.load(std::memory_order_relaxed);
+    statistics.maxLightsPerCluster = m_lastFrameStatistics.maxLightsPerCluster.load(std::memory_order_relaxed);
+    statistics.overflowedClustersCount = m_lastFrameStatistics.overflowedClustersCount.load(std::memory_order_relaxed);
+    statistics.avgLightsPerLitCluster = m_lastFrameStatistics.avgLightsPerLitCluster.load(std::memory_order_relaxed);
+    statistics.occludedInstancesCount = m_lastFrameStatistics.occludedInstancesCount.load(std::memory_order_relaxed);
+    statistics.occlusionCullingTimeMs = m_lastFrameStatistics.occlusionCullingTimeMs.load(std::memory_order_relaxed);
+    statistics.hiZPassTimeMs = m_lastFrameStatistics.hiZPassTimeMs.load(std::memory_order_relaxed);
+    statistics.renderWidth = m_lastFrameStatistics.renderWidth.load(std::memory_order_relaxed);
+    statistics.renderHeight = m_lastFrameStatistics.renderHeight.load(std::memory_order_relaxed);
+    statistics.resolutionScale = m_lastFrameStatistics.resolutionScale.load(std::memory_order_relaxed);
+    statistics.gpuFrameTimeMs = m_lastFrameStatistics.gpuFrameTimeMs.load(std::memory_order_relaxed);
+    statistics.upscalePassTimeMs = m_lastFrameStatistics.upscalePassTimeMs.load(std::memory_order_relaxed);
+    statistics.isTemporalUpscaled = m_lastFrameStatistics.isTemporalUpscaled.load(std::memory_order_relaxed);
+
+    return statistics;
+}
+
+
 bool RenderSystem::IsInitialized() const noexcept
 {
     return m_isInitialized;
 }
 
 
+uint32_t engGetGBufferLayoutBytesPerPixel(bool isCompactLayout) noexcept
+{
+    return isCompactLayout ? 
+        GetRenderTargetsBytesPerPixel(COMPACT_GBUFFER_LAYOUT_FORMATS, _countof(COMPACT_GBUFFER_LAYOUT_FORMATS)) :
+        GetRenderTargetsBytesPerPixel(DEFAULT_GBUFFER_LAYOUT_FORMATS, _countof(DEFAULT_GBUFFER_LAYOUT_FORMATS));
+}
+
+
+uint32_t engGetGeometryPassTargetsBytesPerPixel(bool isVisibilityBufferEnabled) noexcept
+{
+    return isVisibilityBufferEnabled ?
+        GetRenderTargetsBytesPerPixel(VISIBILITY_PASS_TARGETS_FORMATS, _countof(VISIBILITY_PASS_TARGETS_FORMATS)) :
+        GetRenderTargetsBytesPerPixel(GBUFFER_PASS_TARGETS_FORMATS, _countof(GBUFFER_PASS_TARGETS_FORMATS));
+}
+
+
 bool engInitRenderSystem() noexcept
 {
     if (engIsRenderSystemInitialized()) {
@@ -1,6 +1,166 @@
 #pragma once
 
+#include "frame_packet.h"
+#include "dynamic_resolution.h"
+#include "visibility_geometry.h"
+
+#include "render/command_buffer/render_command_buffer.h"
+#include "render/mem_manager/const_buffer_allocator.h"
+#include "render/frame_graph/frame_graph.h"
+
+#include "utils/thread/worker_pool.h"
+
 #include <memory>
+#include <thread>
+#include <atomic>
+
+
+struct RenderFrameStatistics
+{
+    // Graphics API state changing calls, which were issued or filtered out by the state cache
+    uint32_t issuedStateCallsCount;
+    uint32_t skippedStateCallsCount;
+
+    // Frame packet draw items, indirect draw records they were merged into and multi draw calls submitting them
+    uint32_t drawItemsCount;
+    uint32_t instancedDrawCallsCount;
+    uint32_t multiDrawCallsCount;
+
+    // Destroyed graphics API objects waiting for GPU to finish frames which may use them
+    uint32_t retiredObjectsCount;
+
+    // Bytes copied from staging memory at the frame beginning and bytes deferred by the upload frame budget
+    uint64_t uploadedSize;
+    uint64_t pendingUploadSize;
+
+    // Long-lived constant blocks pages usage
+    float constBuffersUtilization;
+    float constBuffersFragmentation;
+
+    // Frame graph render targets memory without and with transient textures aliasing
+    uint64_t rtMemorySize;
+    uint64_t aliasedRTMemorySize;
+
+    // Render passes attachments actions. Discarded attachments are invalidated instead of being loaded or stored
+    uint32_t loadedAttachmentsCount;
+    uint32_t clearedAttachmentsCount;
+    uint32_t storedAttachmentsCount;
+    uint32_t discardedAttachmentsCount;
+
+    // Fragment shader invocations of geometry passes, reported a few frames late. 
+    // Overdraw is GBuffer shaded fragments per screen pixel, it's close to 1 while depth prepass is enabled.
+    // In visibility buffer mode GBuffer statistics are the ones of the visibility pass
+    uint64_t depthPrepassFragmentsCount;
+    uint64_t gBufferFragmentsCount;
+    float gBufferOverdraw;
+
+    // Passes GPU time, reported a few frames late. Color pass is the clustered lighting pass, or visibility resolve in visibility buffer mode
+    float depthPrepassTimeMs;
+    float gBufferPassTimeMs;
+    float lightCullingTimeMs;
+    float colorPassTimeMs;
+
+    // Render targets bytes written and read per pixel by GBuffer and color passes, depends on ENG_GBUFFER_COMPACT and visibility buffer mode
+    uint32_t gBufferBytesPerPixel;
+
+    // Lights of the frame and light culling results, which are reported a few frames late. Lighting cost follows lights per lit cluster,
+    // not total lights count. Overflowed clusters had lights dropped, since they didn't fit per cluster or global light lists
+    uint32_t lightsCount;
+    uint32_t litClustersCount;
+    uint32_t maxLightsPerCluster;
+    uint32_t overflowedClustersCount;
+    float avgLightsPerLitCluster;
+
+    // Instances skipped by Hi-Z occlusion culling and culling passes GPU time, reported a few frames late.
+    // Culled instances are drawn neither by the depth prepass nor by the GBuffer pass
+    uint32_t occludedInstancesCount;
+    float occlusionCullingTimeMs;
+    float hiZPassTimeMs;
+
+    // Internal resolution passes render at before upscaling to the framebuffer. GPU frame time is reported a few frames late
+    uint32_t renderWidth;
+    uint32_t renderHeight;
+    float resolutionScale;
+    float gpuFrameTimeMs;
+
+    // Upscale to the framebuffer GPU time, reported a few frames late. Temporal upscale includes history resolve
+    float upscalePassTimeMs;
+    bool isTemporalUpscaled;
+
+    // Frame packet index the statistics reported a few frames late were measured at
+    uint64_t frameIndex;
+};
+
+
+// Query which is read once GPU has finished the frame it was issued in
+struct RenderGPUQuery
+{
+    uint32_t renderID;
+    uint32_t target;
+    bool     isIssued;
+};
+
+
+// Queries issued by one frame
+struct RenderFrameGPUQueries
+{
+    RenderGPUQuery depthPrepassFragments;
+    RenderGPUQuery gBufferFragments;
+    
+    RenderGPUQuery depthPrepassTime;
+    RenderGPUQuery gBufferPassTime;
+    RenderGPUQuery lightCullingTime;
+    RenderGPUQuery colorPassTime;
+    RenderGPUQuery occlusionCullingTime;
+    RenderGPUQuery hiZPassTime;
+    RenderGPUQuery upscalePassTime;
+
+    // Whole frame GPU time, drives dynamic resolution
+    RenderGPUQuery frameBeginTimestamp;
+    RenderGPUQuery frameEndTimestamp;
+
+    // Light culling counters copied at the end of the pass. Complete once lightCullingTime query is available
+    MemoryBuffer* pClusterCountersReadback;
+    // Occlusion culling counters, complete once occlusionCullingTime query is available
+    MemoryBuffer* pOcclusionCountersReadback;
+
+    uint64_t pixelsCount;
+    uint64_t frameIndex;
+    float renderScale;
+    uint32_t lightsCount;
+    bool isTemporalUpscaled;
+};
+
+
+// Reference to a frame packet draw item. Sorted by batch key, so that identical draws become neighbours
+struct RenderBatchedDrawItem
+{
+    uint64_t       batchKey;
+    const MeshObj* pMesh;
+    uint32_t       drawItemIdx;
+    // Instanced batch the item was merged into, occlusion culling appends visible instances to it
+    uint32_t       batchIdx;
+};
+
+
+// Run of identical draws. Instance data of the batch is stored contiguously starting from firstInstance
+struct RenderInstancedBatch
+{
+    uint64_t       batchKey;
+    const MeshObj* pMesh;
+    uint32_t       firstInstance;
+    uint32_t       instancesCount;
+};
+
+
+// Run of batches sharing pipeline and vertex arrays. Submitted with one multi draw indirect call,
+// batch i of the group is described by indirect args record firstBatch + i
+struct RenderMultiDrawGroup
+{
+    const MeshObj* pMesh;
+    uint32_t       firstBatch;
+    uint32_t       batchesCount;
+};
 
 
 class RenderSystem
@@ -20,25 +180,232 @@ public:
 
     ~RenderSystem();
 
+    // Moves graphics context ownership from the calling thread to the render thread
+    void StartRenderThread() noexcept;
+    // Waits for submitted frames and returns graphics context ownership to the calling thread
+    void StopRenderThread() noexcept;
+
+    // Main thread side. Blocks while render thread is FramePacketQueue::MAX_PACKETS_IN_FLIGHT frames behind.
+    // Returns nullptr if render thread is not running
+    FramePacket* AcquireFramePacket() noexcept;
+    void SubmitFramePacket(FramePacket* pPacket) noexcept;
+
+    // Render thread side
     void BeginFrame() noexcept;
     void EndFrame() noexcept;
 
+    void RunOcclusionCullingPass() noexcept;
     void RunDepthPrepass() noexcept;
     void RunGBufferPass() noexcept;
+    void RunVisibilityPass() noexcept;
+    void RunHiZPass() noexcept;
+    void RunLightCullingPass() noexcept;
     void RunColorPass() noexcept;
+    void RunVisibilityResolvePass() noexcept;
+    void RunTemporalUpscalePass() noexcept;
     void RunPostprocessingPass() noexcept;
 
+    bool IsRenderThreadRunning() const noexcept { return m_renderThread.joinable(); }
+
+    // Statistics of the last frame rendered by the render thread. May be called from any thread
+    RenderFrameStatistics GetLastFrameStatistics() const noexcept;
+
 private:
     RenderSystem() = default;
-    
-    bool Init() noexcept; 
+
+    bool Init() noexcept;
     void Terminate() noexcept;
 
+    void RenderThreadLoop() noexcept;
+    void RenderFramePacket(const FramePacket& packet) noexcept;
+
+    // Groups frame packet draw items sharing mesh, pipeline and material into instanced batches
+    // and batches sharing vertex arrays into multi draw groups
+    void BuildInstancedBatches(const FramePacket& packet) noexcept;
+
+    // Passes are declared once, the graph is rebuilt only when render targets size, depth prepass, temporal upscaling or visibility buffer state changes
+    void BuildFrameGraph(uint32_t width, uint32_t height, bool isDepthPrepassEnabled, bool isTemporalUpscalingEnabled, 
+        bool isVisibilityBufferEnabled) noexcept;
+
+    // Batches draw items and writes instance data and indirect args shared by the depth prepass and GBuffer or visibility pass
+    void PrepareGeometryDraws() noexcept;
+    void RunGeometryPass(uint32_t sortPass, Pipeline* pPipeline, RenderGPUQuery& fragmentsQuery, RenderGPUQuery& timeQuery) noexcept;
+
+    // Reads queries issued GPU_QUERIES_LATENCY frames ago, if GPU is done with them
+    void UpdateGPUQueriesStatistics() noexcept;
+
+    // Transforms frame lights to view space and writes them with cluster grid constants
+    void PrepareLights() noexcept;
+    // Light clusters cover the framebuffer, so their buffers are resized along with the frame graph
+    void UpdateLightClustersGrid(uint32_t width, uint32_t height) noexcept;
+    // Hi-Z pyramid is half the framebuffer size, it's recreated and invalidated on resize
+    void UpdateHiZPyramid(uint32_t width, uint32_t height) noexcept;
+    // Temporal history textures are the framebuffer size, they're recreated and invalidated on resize
+    void UpdateTemporalHistory(uint32_t width, uint32_t height) noexcept;
+
+    // Picks internal resolution of the frame. Render targets are allocated at the framebuffer size, so scale changes don't reallocate them
+    void UpdateRenderResolution(const FramePacket& packet) noexcept;
+
+    // Transient constants shared by all passes of the frame
+    void UpdateFrameConstants(const FramePacket& packet) noexcept;
+
+    // Merges sorted packets of first command buffers and executes them
+    void SubmitCommandBuffers(uint32_t commandBuffersCount) noexcept;
+
     bool IsInitialized() const noexcept;
 
 private:
-    // GBuffer textures, framebuffer
-    // ...
+    FramePacketQueue m_framePacketQueue;
+    std::thread m_renderThread;
+
+    // Valid only on the render thread between BeginFrame and EndFrame
+    const FramePacket* m_pCurrFramePacket = nullptr;
+
+    // Draw commands recording is split between the render thread and these workers. Doesn't use graphics context
+    WorkerThreadPool m_recordingWorkers;
+
+    // One command buffer per recording job, storage is reused between frames
+    std::vector<RenderCommandBuffer> m_commandBuffers;
+    // Packets of all command buffers merged by sort key, executed by the render thread
+    std::vector<RenderCommandPacket> m_mergedPackets;
+
+    std::vector<RenderBatchedDrawItem> m_batchedDrawItems;
+    std::vector<RenderBatchedDrawItem> m_batchedDrawItemsScratch;
+    std::vector<RenderInstancedBatch> m_instancedBatches;
+    std::vector<RenderMultiDrawGroup> m_multiDrawGroups;
+
+    FrameGraph m_frameGraph;
+
+    struct
+    {
+        FrameGraphTextureHandle gBufferAlbedo;
+        FrameGraphTextureHandle gBufferNormal;
+        FrameGraphTextureHandle gBufferSpecular;
+        // Written by the visibility resolve pass in visibility buffer mode
+        FrameGraphTextureHandle gBufferMotion;
+        FrameGraphTextureHandle visibility;
+        FrameGraphTextureHandle commonDepth;
+        FrameGraphTextureHandle commonColor;
+        // Imported without texture, orders light culling and lighting passes
+        FrameGraphTextureHandle clusterLightLists;
+        // Imported without texture, orders occlusion culling and geometry passes
+        FrameGraphTextureHandle visibleInstances;
+        // Imported, read by occlusion culling before the Hi-Z pass of the frame rebuilds it
+        FrameGraphTextureHandle hiZPyramid;
+        // Imported without texture, orders temporal upscale and post process passes
+        FrameGraphTextureHandle temporalHistory;
+    } m_frameGraphTextures;
+
+    uint32_t m_frameGraphWidth = 0;
+    uint32_t m_frameGraphHeight = 0;
+
+    // Passes render into the top left region of this size, it's upscaled by the post process pass
+    DynamicResolutionController m_dynamicResolution;
+    uint32_t m_renderWidth = 0;
+    uint32_t m_renderHeight = 0;
+    bool m_isDepthPrepassEnabled = true;
+    bool m_isTemporalUpscalingEnabled = true;
+    bool m_isVisibilityBufferEnabled = false;
+
+    // Transient and long-lived constant blocks packed into shared uniform buffers
+    ConstBufferAllocator m_constBufferAllocator;
+    // Valid only on the render thread between BeginFrame and EndFrame
+    DynamicRingBufferAllocation m_commonConstants;
+
+    // Per frame instance data and indirect args. Regions of frames in flight are guarded by fences
+    DynamicRingBuffer m_instanceDataRingBuffer;
+    DynamicRingBuffer m_indirectArgsRingBuffer;
+    // Valid only on the render thread between BeginFrame and EndFrame
+    DynamicRingBufferAllocation m_instances;
+    DynamicRingBufferAllocation m_indirectArgs;
+
+    // Per frame view space lights
+    DynamicRingBuffer m_lightDataRingBuffer;
+    // Valid only on the render thread between BeginFrame and EndFrame
+    DynamicRingBufferAllocation m_lights;
+
+    // Written by the light culling pass and read by the lighting pass of the same frame
+    MemoryBuffer* m_pClustersBuffer = nullptr;
+    MemoryBuffer* m_pClusterLightIndicesBuffer = nullptr;
+    MemoryBuffer* m_pClusterCountersBuffer = nullptr;
+
+    uint32_t m_clusterGridWidth = 0;
+    uint32_t m_clusterGridHeight = 0;
+
+    // Farthest depth pyramid of the previous frame. Instances are reprojected with the view projection it was built with
+    Texture* m_pHiZTexture = nullptr;
+    glm::mat4x4 m_hiZViewProjMatrix = M3D_MAT4_IDENTITY;
+    uint32_t m_hiZScreenWidth = 0;
+    uint32_t m_hiZScreenHeight = 0;
+    uint32_t m_hiZLevelsCount = 0;
+    // Pyramid content is undefined until the first frame after its creation builds it
+    bool m_isHiZValid = false;
+
+    // Meshes vertices and indices the visibility resolve pass reconstructs triangles from
+    VisibilityGeometry m_visibilityGeometry;
+
+    // Indices of instances which passed occlusion culling, grouped by batch. Written by the culling pass and read by geometry passes
+    MemoryBuffer* m_pVisibleInstancesBuffer = nullptr;
+    MemoryBuffer* m_pOcclusionCountersBuffer = nullptr;
+
+    // Framebuffer sized accumulated color. The pass reads the history written by the previous frame and writes the other one
+    std::array<Texture*, 2> m_pTemporalHistoryTextures = {};
+    uint32_t m_temporalHistoryIdx = 0;
+    // History content is undefined after its creation or while temporal upscaling was disabled
+    bool m_isTemporalHistoryValid = false;
+
+    // Unjittered motion of the frame is computed against the previous frame camera
+    glm::mat4x4 m_prevViewProjMatrix = M3D_MAT4_IDENTITY;
+    glm::vec2 m_prevProjJitter = M3D_ZEROF2;
+    bool m_isPrevViewProjValid = false;
+
+    static inline constexpr size_t GPU_QUERIES_LATENCY = 3;
+
+    std::array<RenderFrameGPUQueries, GPU_QUERIES_LATENCY> m_gpuQueries = {};
+    uint32_t m_gpuQueriesIdx = 0;
+
+    struct
+    {
+        std::atomic<uint32_t> issuedStateCallsCount { 0 };
+        std::atomic<uint32_t> skippedStateCallsCount { 0 };
+        std::atomic<uint32_t> drawItemsCount { 0 };
+        std::atomic<uint32_t> instancedDrawCallsCount { 0 };
+        std::atomic<uint32_t> multiDrawCallsCount { 0 };
+        std::atomic<uint32_t> retiredObjectsCount { 0 };
+        std::atomic<uint64_t> uploadedSize { 0 };
+        std::atomic<uint64_t> pendingUploadSize { 0 };
+        std::atomic<float> constBuffersUtilization { 0.f };
+        std::atomic<float> constBuffersFragmentation { 0.f };
+        std::atomic<uint64_t> rtMemorySize { 0 };
+        std::atomic<uint64_t> aliasedRTMemorySize { 0 };
+        std::atomic<uint32_t> loadedAttachmentsCount { 0 };
+        std::atomic<uint32_t> clearedAttachmentsCount { 0 };
+        std::atomic<uint32_t> storedAttachmentsCount { 0 };
+        std::atomic<uint32_t> discardedAttachmentsCount { 0 };
+        std::atomic<uint64_t> depthPrepassFragmentsCount { 0 };
+        std::atomic<uint64_t> gBufferFragmentsCount { 0 };
+        std::atomic<float> gBufferOverdraw { 0.f };
+        std::atomic<float> depthPrepassTimeMs { 0.f };
+        std::atomic<float> gBufferPassTimeMs { 0.f };
+        std::atomic<float> lightCullingTimeMs { 0.f };
+        std::atomic<float> colorPassTimeMs { 0.f };
+        std::atomic<uint32_t> gBufferBytesPerPixel { 0 };
+        std::atomic<uint32_t> lightsCount { 0 };
+        std::atomic<uint32_t> litClustersCount { 0 };
+        std::atomic<uint32_t> maxLightsPerCluster { 0 };
+        std::atomic<uint32_t> overflowedClustersCount { 0 };
+        std::atomic<float> avgLightsPerLitCluster { 0.f };
+        std::atomic<uint32_t> occludedInstancesCount { 0 };
+        std::atomic<float> occlusionCullingTimeMs { 0.f };
+        std::atomic<float> hiZPassTimeMs { 0.f };
+        std::atomic<uint32_t> renderWidth { 0 };
+        std::atomic<uint32_t> renderHeight { 0 };
+        std::atomic<float> resolutionScale { 1.f };
+        std::atomic<float> gpuFrameTimeMs { 0.f };
+        std::atomic<float> upscalePassTimeMs { 0.f };
+        std::atomic<bool> isTemporalUpscaled { false };
+        std::atomic<uint64_t> frameIndex { 0 };
+    } m_lastFrameStatistics;
 
     bool m_isInitialized = false;
 };
@@ -46,4 +413,9 @@ private:
 
 bool engInitRenderSystem() noexcept;
 void engTerminateRenderSystem() noexcept;
-bool engIsRenderSystemInitialized() noexcept;
\ No newline at end of file
+bool engIsRenderSystemInitialized() noexcept;
+
+// Render targets bytes per pixel of either GBuffer layout, regardless of ENG_GBUFFER_COMPACT
+uint32_t engGetGBufferLayoutBytesPerPixel(bool isCompactLayout) noexcept;
+// Render targets bytes per pixel written by the GBuffer pass, or by the visibility pass in visibility buffer mode
+uint32_t engGetGeometryPassTargetsBytesPerPixel(bool isVisibilityBufferEnabled) noexcept;
@@ -0,0 +1,191 @@
+#include "pch.h"
+#include "visibility_geometry.h"
+
+#include "utils/debug/assertion.h"
+
+
+// Vertex attribute locations of meshes, see base.vs
+static constexpr uint32_t POSITION_ATTRIB_IDX = 0;
+static constexpr uint32_t NORMAL_ATTRIB_IDX = 1;
+static constexpr uint32_t TEX_COORDS_ATTRIB_IDX = 2;
+
+
+static uint32_t ReadIndex(const uint8_t* pIndexData, uint64_t indexSize, size_t i) noexcept
+{
+    switch (indexSize) {
+        case sizeof(uint8_t):
+            return pIndexData[i];
+        case sizeof(uint16_t):
+            return reinterpret_cast<const uint16_t*>(pIndexData)[i];
+        case sizeof(uint32_t):
+            return reinterpret_cast<const uint32_t*>(pIndexData)[i];
+        default:
+            ENG_ASSERT_FAIL("Invalid index size: {}", indexSize);
+            return 0;
+    }
+}
+
+
+void VisibilityGeometry::AddMesh(const MeshObj* pMesh, const MeshGPUBufferDataCreateInfo& meshData) noexcept
+{
+    ENG_ASSERT(pMesh && pMesh->IsValid(), "Invalid mesh");
+    ENG_ASSERT(!IsValid(), "Meshes can't be added to already uploaded visibility geometry");
+    ENG_ASSERT(meshData.vertexSize > 0 && meshData.indexSize > 0, "Invalid \'{}\' mesh vertex or index size", pMesh->GetName().CStr());
+
+    const uint32_t meshIdx = pMesh->GetID().Value();
+
+    if (meshIdx >= m_meshRanges.size()) {
+        m_meshRanges.resize(meshIdx + 1);
+        m_isMeshAdded.resize(meshIdx + 1, false);
+    }
+
+    ENG_ASSERT(!m_isMeshAdded[meshIdx], "Mesh \'{}\' is already added to visibility geometry", pMesh->GetName().CStr());
+
+    m_meshRanges[meshIdx] = MeshRange { static_cast<uint32_t>(m_indices.size()), static_cast<uint32_t>(m_vertices.size()) };
+    m_isMeshAdded[meshIdx] = true;
+
+    const MeshVertexLayout* pLayout = pMesh->GetVertexLayout();
+
+    const size_t verticesCount = meshData.vertexDataSize / meshData.vertexSize;
+    const uint8_t* pVertexData = static_cast<const uint8_t*>(meshData.pVertexData);
+
+    const size_t firstVertex = m_vertices.size();
+    m_vertices.resize(firstVertex + verticesCount, COMMON_VISIBILITY_VERTEX {});
+
+    for (uint64_t attrib = 0; attrib < MeshVertexLayout::MAX_VERTEX_ATTRIBS_COUNT; ++attrib) {
+        if (!pLayout->IsAttribActive(attrib)) {
+            continue;
+        }
+
+        const uint32_t attribIdx = pLayout->GetAttribIndex(attrib);
+
+        if (attribIdx != POSITION_ATTRIB_IDX && attribIdx != NORMAL_ATTRIB_IDX && attribIdx != TEX_COORDS_ATTRIB_IDX) {
+            continue;
+        }
+
+        ENG_ASSERT(pLayout->GetAttribDataType(attrib) == MeshVertexAttribDataType::TYPE_FLOAT && !pLayout->IsAttribNormalized(attrib),
+            "Visibility geometry supports float vertex attributes only (mesh: \'{}\')", pMesh->GetName().CStr());
+
+        const uint32_t offset = pLayout->GetAttribOffset(attrib);
+        const uint32_t elementsCount = std::min(pLayout->GetAttribElementCount(attrib), attribIdx == TEX_COORDS_ATTRIB_IDX ? 2u : 3u);
+
+        for (size_t i = 0; i < verticesCount; ++i) {
+            COMMON_VISIBILITY_VERTEX& vertex = m_vertices[firstVertex + i];
+
+            float pElements[3] = {};
+            memcpy(pElements, pVertexData + i * meshData.vertexSize + offset, elementsCount * sizeof(float));
+
+            switch (attribIdx) {
+                case POSITION_ATTRIB_IDX:
+                    vertex.COMMON_VISIBILITY_POSITION_U.x = pElements[0];
+                    vertex.COMMON_VISIBILITY_POSITION_U.y = pElements[1];
+                    vertex.COMMON_VISIBILITY_POSITION_U.z = pElements[2];
+                    break;
+                case NORMAL_ATTRIB_IDX:
+                    vertex.COMMON_VISIBILITY_NORMAL_V.x = pElements[0];
+                    vertex.COMMON_VISIBILITY_NORMAL_V.y = pElements[1];
+                    vertex.COMMON_VISIBILITY_NORMAL_V.z = pElements[2];
+                    break;
+                case TEX_COORDS_ATTRIB_IDX:
+                    vertex.COMMON_VISIBILITY_POSITION_U.w = pElements[0];
+                    vertex.COMMON_VISIBILITY_NORMAL_V.w = pElements[1];
+                    break;
+            }
+        }
+    }
+
+    const size_t indicesCount = meshData.indexDataSize / meshData.indexSize;
+    const uint8_t* pIndexData = static_cast<const uint8_t*>(meshData.pIndexData);
+
+    m_indices.reserve(m_indices.size() + indicesCount);
+
+    for (size_t i = 0; i < indicesCount; ++i) {
+        m_indices.push_back(ReadIndex(pIndexData, meshData.indexSize, i));
+    }
+}
+
+
+bool VisibilityGeometry::Create() noexcept
+{
+    ENG_ASSERT(!IsValid(), "Visibility geometry is already created");
+    ENG_ASSERT(!m_vertices.empty() && !m_indices.empty(), "Visibility geometry has no meshes");
+
+    MemoryBufferManager& bufferManager = MemoryBufferManager::GetInstance();
+
+    MemoryBufferCreateInfo verticesCreateInfo = {};
+    verticesCreateInfo.pData = m_vertices.data();
+    verticesCreateInfo.dataSize = m_vertices.size() * sizeof(COMMON_VISIBILITY_VERTEX);
+    verticesCreateInfo.elementSize = sizeof(COMMON_VISIBILITY_VERTEX);
+    verticesCreateInfo.type = MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER;
+
+    m_pVerticesBuffer = bufferManager.RegisterBuffer();
+    ENG_ASSERT(m_pVerticesBuffer, "Failed to register visibility vertices buffer");
+    m_pVerticesBuffer->Create(verticesCreateInfo);
+    ENG_ASSERT(m_pVerticesBuffer->IsValid(), "Failed to create visibility vertices buffer");
+    m_pVerticesBuffer->SetDebugName("__COMMON_VISIBILITY_VERTICES_SB__");
+
+    MemoryBufferCreateInfo indicesCreateInfo = {};
+    indicesCreateInfo.pData = m_indices.data();
+    indicesCreateInfo.dataSize = m_indices.size() * sizeof(uint32_t);
+    indicesCreateInfo.elementSize = sizeof(uint32_t);
+    indicesCreateInfo.type = MemoryBufferType::TYPE_UNORDERED_ACCESS_BUFFER;
+
+    m_pIndicesBuffer = bufferManager.RegisterBuffer();
+    ENG_ASSERT(m_pIndicesBuffer, "Failed to register visibility indices buffer");
+    m_pIndicesBuffer->Create(indicesCreateInfo);
+    ENG_ASSERT(m_pIndicesBuffer->IsValid(), "Failed to create visibility indices buffer");
+    m_pIndicesBuffer->SetDebugName("__COMMON_VISIBILITY_INDICES_SB__");
+
+    ENG_LOG_INFO("Visibility geometry: {} vertices, {} indices, {:.1f} KB", m_vertices.size(), m_indices.size(),
+        (verticesCreateInfo.dataSize + indicesCreateInfo.dataSize) / 1024.f);
+
+    m_vertices.clear();
+    m_vertices.shrink_to_fit();
+    m_indices.clear();
+    m_indices.shrink_to_fit();
+
+    return IsValid();
+}
+
+
+void VisibilityGeometry::Destroy() noexcept
+{
+    MemoryBufferManager& bufferManager = MemoryBufferManager::GetInstance();
+
+    if (m_pVerticesBuffer) {
+        bufferManager.UnregisterBuffer(m_pVerticesBuffer);
+        m_pVerticesBuffer = nullptr;
+    }
+
+    if (m_pIndicesBuffer) {
+        bufferManager.UnregisterBuffer(m_pIndicesBuffer);
+        m_pIndicesBuffer = nullptr;
+    }
+
+    m_vertices.clear();
+    m_indices.clear();
+    m_meshRanges.clear();
+    m_isMeshAdded.clear();
+}
+
+
+void VisibilityGeometry::Bind() const noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(IsValid(), "Visibility geometry is not created");
+
+    m_pVerticesBuffer->BindIndexed(resGetResourceBinding(COMMON_VISIBILITY_VERTICES_SB).GetBinding());
+    m_pIndicesBuffer->BindIndexed(resGetResourceBinding(COMMON_VISIBILITY_INDICES_SB).GetBinding());
+}
+
+
+const VisibilityGeometry::MeshRange* VisibilityGeometry::FindMeshRange(MeshID ID) const noexcept
+{
+    const uint32_t meshIdx = ID.Value();
+    return meshIdx < m_meshRanges.size() && m_isMeshAdded[meshIdx] ? &m_meshRanges[meshIdx] : nullptr;
+}
+
+
+bool VisibilityGeometry::IsValid() const noexcept
+{
+    return m_pVerticesBuffer && m_pVerticesBuffer->IsValid() && m_pIndicesBuffer && m_pIndicesBuffer->IsValid();
+}
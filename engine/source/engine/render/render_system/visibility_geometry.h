@@ -0,0 +1,48 @@
+#pragma once
+
+#include "render/mesh_manager/mesh_manager.h"
+
+#include "auto/registers_common.h"
+
+#include <vector>
+
+
+// Copies of meshes vertices and indices in shared storage buffers. Visibility buffer stores instance and triangle indices only,
+// so the resolve pass fetches triangles of any mesh from a single fullscreen draw. Meshes keep their own buffers for rasterization
+class VisibilityGeometry
+{
+public:
+    // Mesh location in the shared buffers, written to instance data
+    struct MeshRange
+    {
+        uint32_t firstIndex;
+        uint32_t baseVertex;
+    };
+
+public:
+    // Takes the data the mesh GPU buffers were created from. Position, normal and UV are read from float attributes 0, 1 and 2,
+    // indices keep their order, since triangles are identified by gl_PrimitiveID of the mesh draw
+    void AddMesh(const MeshObj* pMesh, const MeshGPUBufferDataCreateInfo& meshData) noexcept;
+
+    // Uploads meshes added so far and releases their CPU copies. Meshes can't be added after that
+    bool Create() noexcept;
+    void Destroy() noexcept;
+
+    void Bind() const noexcept;
+
+    // Returns nullptr for meshes which weren't added
+    const MeshRange* FindMeshRange(MeshID ID) const noexcept;
+
+    bool IsValid() const noexcept;
+
+private:
+    std::vector<COMMON_VISIBILITY_VERTEX> m_vertices;
+    std::vector<uint32_t> m_indices;
+
+    // Indexed by mesh ID value
+    std::vector<MeshRange> m_meshRanges;
+    std::vector<bool> m_isMeshAdded;
+
+    MemoryBuffer* m_pVerticesBuffer = nullptr;
+    MemoryBuffer* m_pIndicesBuffer = nullptr;
+};
@@ -2,14 +2,13 @@
 #include "rt_manager.h"
 
 #include "render/platform/OpenGL/opengl_driver.h"
+#include "render/platform/OpenGL/opengl_retire_queue.h"
 
 #include "engine/engine.h"
 #include "core/window_system/window_system.h"
 
 #include "utils/data_structures/hash.h"
 
-#include "auto/registers_common.h"
-
 
 static std::unique_ptr<RenderTargetManager> pRenderTargetMngInst = nullptr;
 
@@ -123,7 +122,7 @@ FrameBuffer &FrameBuffer::operator=(FrameBuffer &&other) noexcept
 void FrameBuffer::Bind() noexcept
 {
     ENG_ASSERT_GRAPHICS_API(IsValid(), "Attempt to bind invalid framebuffer");
-    glBindFramebuffer(GL_FRAMEBUFFER, m_renderID);
+    engOpenGLBindFramebuffer(m_renderID);
 }
 
 
@@ -192,6 +191,39 @@ void FrameBuffer::ClearDepthStencil(float depth, int32_t stencil) noexcept
 }
 
 
+void FrameBuffer::Invalidate(uint32_t colorAttachmentsMask, bool invalidateDepthStencil) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(IsValid(), "Frame buffer is invalid");
+
+    std::array<GLenum, MAX_ATTACHMENTS> attachments;
+    uint32_t attachmentsCount = 0;
+
+    for (uint32_t index = 0; index < GetColorAttachmentsCount(); ++index) {
+        if (colorAttachmentsMask & (1u << index)) {
+            attachments[attachmentsCount++] = GL_COLOR_ATTACHMENT0 + index;
+        }
+    }
+
+    if (invalidateDepthStencil) {
+        if (HasMergedDepthStencilAttachment()) {
+            attachments[attachmentsCount++] = GL_DEPTH_STENCIL_ATTACHMENT;
+        } else {
+            if (HasDepthAttachment()) {
+                attachments[attachmentsCount++] = GL_DEPTH_ATTACHMENT;
+            }
+
+            if (HasStencilAttachment()) {
+                attachments[attachmentsCount++] = GL_STENCIL_ATTACHMENT;
+            }
+        }
+    }
+
+    if (attachmentsCount > 0) {
+        glInvalidateNamedFramebufferData(m_renderID, attachmentsCount, attachments.data());
+    }
+}
+
+
 bool FrameBuffer::IsValid() const noexcept
 {
     return m_renderID != 0 && IsValidID();
@@ -246,7 +278,7 @@ bool FrameBuffer::Create(const FramebufferCreateInfo &createInfo) noexcept
 
 void FrameBuffer::Destroy() noexcept
 {
-    glDeleteFramebuffers(1, &m_renderID);
+    engOpenGLRetireObject(OpenGLObjectType::FRAMEBUFFER, m_renderID);
 
 #if defined(ENG_DEBUG)
     m_attachments.fill({nullptr, FrameBufferAttachmentType::INVALID, 0});
@@ -282,6 +314,9 @@ bool FrameBuffer::Recreate(const FramebufferCreateInfo& createInfo) noexcept
 
     bool isFirstAttachment = true;
 
+    std::array<GLenum, MAX_COLOR_ATTACHMENTS> drawBuffers;
+    uint32_t drawBuffersCount = 0;
+
     for (size_t attachmentIdx = 0; attachmentIdx < createInfo.attachmentsCount; ++attachmentIdx) {
         const FrameBufferAttachment& attachment = createInfo.pAttachments[attachmentIdx];
         Texture* pTex = attachment.pTexure;
@@ -308,6 +343,7 @@ bool FrameBuffer::Recreate(const FramebufferCreateInfo& createInfo) noexcept
         switch (attachment.type) {
             case FrameBufferAttachmentType::COLOR_ATTACHMENT:
                 ++m_attachmentsState.colorAttachmentsCount;
+                drawBuffers[drawBuffersCount++] = GetFrameBufferAttachmentGLType(attachment);
                 break;
             case FrameBufferAttachmentType::DEPTH_ATTACHMENT:
                 m_attachmentsState.depthAttachmentsCount = 1;
@@ -328,6 +364,14 @@ bool FrameBuffer::Recreate(const FramebufferCreateInfo& createInfo) noexcept
         glNamedFramebufferTexture(m_renderID, GetFrameBufferAttachmentGLType(attachment), pTex->GetRenderID(), 0);
     }
 
+    // By default only the first color attachment is written. Depth only frame buffers have no color buffers at all
+    if (drawBuffersCount > 0) {
+        glNamedFramebufferDrawBuffers(m_renderID, drawBuffersCount, drawBuffers.data());
+    } else {
+        glNamedFramebufferDrawBuffer(m_renderID, GL_NONE);
+        glNamedFramebufferReadBuffer(m_renderID, GL_NONE);
+    }
+
     if (!CheckCompleteStatus()) {
         ENG_ASSERT_GRAPHICS_API_FAIL("FrameBuffer \'{}\' is incomplete");
         Destroy();
@@ -406,17 +450,6 @@ RenderTargetManager::~RenderTargetManager()
 }
 
 
-Texture *RenderTargetManager::GetRTTexture(RTTextureID texID) noexcept
-{
-    ENG_ASSERT_GRAPHICS_API(texID < RTTextureID::COUNT, "Invalid RT texture ID");
-
-    Texture* pRTTexture = m_RTTextureStorage[static_cast<size_t>(texID)];
-    ENG_ASSERT_GRAPHICS_API(pRTTexture != nullptr, "RT texture is nullptr");
-    
-    return pRTTexture;
-}
-
-
 FrameBuffer *RenderTargetManager::GetFrameBuffer(RTFrameBufferID framebufferID) noexcept
 {
     ENG_ASSERT_GRAPHICS_API(IsValidRenderTargetFrameBufferID(framebufferID), "Invalid frame buffer ID");
@@ -488,141 +521,207 @@ void RenderTargetManager::ClearFrameBufferDepthStencil(RTFrameBufferID framebuff
 }
 
 
-bool RenderTargetManager::Init() noexcept
+void RenderTargetManager::SetFrameBufferAttachments(RTFrameBufferID framebufferID, const FrameBufferAttachment* pAttachments, 
+    uint32_t attachmentsCount, ds::StrID name) noexcept
 {
-    if (IsInitialized()) {
-        return true;
+    ENG_ASSERT_GRAPHICS_API(IsValidRenderTargetFrameBufferID(framebufferID), "Invalid frame buffer ID");
+    ENG_ASSERT_GRAPHICS_API(pAttachments && attachmentsCount > 0 && attachmentsCount <= FrameBuffer::GetMaxAttachmentsCount(), 
+        "Invalid '{}' frame buffer attachments", name.CStr());
+
+    const size_t frameBufferIdx = static_cast<size_t>(framebufferID);
+
+    FrameBuffer& frameBuffer = m_frameBufferStorage[frameBufferIdx];
+    FrameBufferAttachments& currAttachments = m_frameBufferAttachmentsStorage[frameBufferIdx];
+
+    const bool isSameAttachments = frameBuffer.IsValid() && currAttachments.attachmentsCount == attachmentsCount &&
+        std::equal(pAttachments, pAttachments + attachmentsCount, currAttachments.attachments.cbegin(), 
+            [](const FrameBufferAttachment& left, const FrameBufferAttachment& right) {
+                return left.pTexure == right.pTexure && left.type == right.type && left.index == right.index;
+            });
+
+    if (isSameAttachments) {
+        return;
     }
 
-    es::EventDispatcher& dispatcher = es::EventDispatcher::GetInstance();
+    FramebufferCreateInfo fbCreateInfo = {};
+    fbCreateInfo.ID = framebufferID;
+    fbCreateInfo.pAttachments = pAttachments;
+    fbCreateInfo.attachmentsCount = attachmentsCount;
+
+    // Old frame buffer object may still be used by GPU, it's retired by destruction
+    frameBuffer.Destroy();
+
+    if (!frameBuffer.Create(fbCreateInfo)) {
+        ENG_ASSERT_GRAPHICS_API_FAIL("Failed to initialize '{}' frame buffer", name.CStr());
+        currAttachments.attachmentsCount = 0;
+        return;
+    }
 
-    m_frameBufferResizeEventListenerID = dispatcher.Subscribe<EventFramebufferResized>([this](const void* pEvent) {
-        const EventFramebufferResized& event = es::EventCast<EventFramebufferResized>(pEvent);
-        const uint32_t width = event.GetWidth();
-        const uint32_t height = event.GetHeight();
-        
-        if (width > 0 && height > 0) {
-            OnWindowResizedEvent(width, height);
+    frameBuffer.SetDebugName(name);
+
+    std::copy(pAttachments, pAttachments + attachmentsCount, currAttachments.attachments.begin());
+    currAttachments.attachmentsCount = attachmentsCount;
+}
+
+
+Texture* RenderTargetManager::AcquirePooledTexture(const RTTextureDesc& desc) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(desc.width > 0 && desc.height > 0, "Invalid pooled texture size: {}x{}", desc.width, desc.height);
+
+    const RTTextureDesc pooledDesc = GetPooledTextureDesc(desc);
+
+    for (PooledTexture& pooledTex : m_texturePool) {
+        if (!pooledTex.isAcquired && pooledTex.desc == pooledDesc) {
+            pooledTex.isAcquired = true;
+            pooledTex.lastUsedFrame = m_poolFrameIdx;
+            return pooledTex.pTexture;
         }
-    });
+    }
 
-    m_isInitialized = true;
+    char name[64];
+    sprintf_s(name, "_RT_POOL_%u_", m_pooledTexturesCreatedCount++);
 
-    return true;
+    Texture2DCreateInfo texCreateInfo = {};
+    texCreateInfo.format = pooledDesc.format;
+    texCreateInfo.width = pooledDesc.width;
+    texCreateInfo.height = pooledDesc.height;
+    texCreateInfo.mipmapsCount = 0;
+
+    Texture* pTex = TextureManager::GetInstance().RegisterTexture2D(name);
+    ENG_ASSERT(pTex, "Failed to register texture: {}", name);
+    pTex->Create(texCreateInfo);
+    ENG_ASSERT(pTex->IsValid(), "Failed to create texture: {}", name);
+
+    m_texturePool.emplace_back(PooledTexture { pTex, pooledDesc, m_poolFrameIdx, true });
+
+    return pTex;
 }
 
 
-void RenderTargetManager::Terminate() noexcept
+void RenderTargetManager::ReleasePooledTexture(Texture* pTexture) noexcept
 {
-    ClearFrameBuffersStorage();
+    auto pooledTexIt = std::find_if(m_texturePool.begin(), m_texturePool.end(), 
+        [pTexture](const PooledTexture& pooledTex) { return pooledTex.pTexture == pTexture; });
 
-    es::EventDispatcher& dispatcher = es::EventDispatcher::GetInstance();
-    dispatcher.Unsubscribe(m_frameBufferResizeEventListenerID);
-    
-    m_isInitialized = false;
+    ENG_ASSERT_GRAPHICS_API(pooledTexIt != m_texturePool.end(), "Texture doesn't belong to render target pool");
+    ENG_ASSERT_GRAPHICS_API(pooledTexIt->isAcquired, "Double release of pooled texture '{}'", pTexture->GetName().CStr());
+
+    pooledTexIt->isAcquired = false;
+    pooledTexIt->lastUsedFrame = m_poolFrameIdx;
 }
 
 
-void RenderTargetManager::ClearFrameBuffersStorage() noexcept
+RTTextureDesc RenderTargetManager::GetPooledTextureDesc(const RTTextureDesc& desc) const noexcept
+{
+    const auto roundUp = [](uint32_t size) {
+        return (size + POOLED_TEXTURE_SIZE_GRANULARITY - 1) / POOLED_TEXTURE_SIZE_GRANULARITY * POOLED_TEXTURE_SIZE_GRANULARITY;
+    };
+
+    return RTTextureDesc { desc.format, roundUp(desc.width), roundUp(desc.height) };
+}
+
+
+void RenderTargetManager::UpdateTexturePool() noexcept
 {
-    TextureManager& texManager = TextureManager::GetInstance();
+    const auto isExpired = [this](const PooledTexture& pooledTex) {
+        return !pooledTex.isAcquired && m_poolFrameIdx - pooledTex.lastUsedFrame > POOLED_TEXTURE_MAX_IDLE_FRAMES;
+    };
 
-    for (Texture* pTex : m_RTTextureStorage) {
-        if (pTex) {
-            pTex->Destroy();
-            texManager.UnregisterTexture(pTex);
+    for (const PooledTexture& pooledTex : m_texturePool) {
+        if (isExpired(pooledTex)) {
+            DestroyPooledTexture(pooledTex.pTexture);
         }
     }
-    m_RTTextureStorage.fill(nullptr);
 
-    for (FrameBuffer& framebuffer : m_frameBufferStorage) {
-        framebuffer.Destroy();
-    }
+    m_texturePool.erase(std::remove_if(m_texturePool.begin(), m_texturePool.end(), isExpired), m_texturePool.end());
+
+    ++m_poolFrameIdx;
 }
 
 
-void RenderTargetManager::PrepareRTTextureStorage(const RTTextureCreateInfoArray& rtTexDescs) noexcept
+uint64_t RenderTargetManager::GetTexturePoolMemorySize() const noexcept
 {
-    TextureManager& texManager = TextureManager::GetInstance();
+    uint64_t size = 0;
 
-    for (size_t rtIdx = 0; rtIdx < rtTexDescs.size(); ++rtIdx) {
-        const RTTextureIntermediateCreateInfo& rtTexDesc = rtTexDescs[rtIdx];
+    for (const PooledTexture& pooledTex : m_texturePool) {
+        size += engGetTextureMemorySize(pooledTex.desc.format, pooledTex.desc.width, pooledTex.desc.height);
+    }
 
-        Texture2DCreateInfo texCreateInfo = {};
-        texCreateInfo.format = rtTexDesc.format;
-        texCreateInfo.width = rtTexDesc.width;
-        texCreateInfo.height = rtTexDesc.height;
-        texCreateInfo.mipmapsCount = rtTexDesc.mipsCount;
-    
-        Texture* pTex = texManager.RegisterTexture2D(rtTexDesc.name);
-        ENG_ASSERT(pTex, "Failed to register texture: {}", rtTexDesc.name.CStr());
-        pTex->Create(texCreateInfo);
-        ENG_ASSERT(pTex->IsValid(), "Failed to create texture: {}", rtTexDesc.name.CStr());
-    
-        m_RTTextureStorage[rtIdx] = pTex;
+    return size;
+}
+
+
+bool RenderTargetManager::Init() noexcept
+{
+    if (IsInitialized()) {
+        return true;
     }
+
+    m_isInitialized = true;
+
+    return true;
 }
 
 
-void RenderTargetManager::PrepareRTFrameBufferStorage(const RTFrameBufferCreateInfoArray &fbDescs) noexcept
+void RenderTargetManager::Terminate() noexcept
 {
-    for (size_t fbIdx = 0; fbIdx < fbDescs.size(); ++fbIdx) {
-        const RTFrameBufferIntermediateCreateInfo& fbDesc = fbDescs[fbIdx];
+    ClearFrameBuffersStorage();
+    ClearTexturePool();
 
-        FramebufferCreateInfo fbCreateInfo = {};
-        fbCreateInfo.ID = static_cast<RTFrameBufferID>(fbIdx);
-        fbCreateInfo.pAttachments = fbDesc.pAttachments;
-        fbCreateInfo.attachmentsCount = fbDesc.attachmentsCount;
+    m_poolFrameIdx = 0;
+    
+    m_isInitialized = false;
+}
 
-        FrameBuffer& frameBuffer = m_frameBufferStorage[fbIdx];
 
-        if (!frameBuffer.Create(fbCreateInfo)) {
-            ENG_ASSERT_GRAPHICS_API_FAIL("Failed to initialize \'{}\' frame buffer", fbDesc.name.CStr());
-        }
+void RenderTargetManager::ClearFrameBuffersStorage() noexcept
+{
+    for (FrameBuffer& framebuffer : m_frameBufferStorage) {
+        framebuffer.Destroy();
+    }
 
-        frameBuffer.SetDebugName(fbDesc.name);
+    for (FrameBufferAttachments& attachments : m_frameBufferAttachmentsStorage) {
+        attachments.attachmentsCount = 0;
     }
 }
 
 
-void RenderTargetManager::OnWindowResizedEvent(uint32_t width, uint32_t height) noexcept
+void RenderTargetManager::ClearTexturePool() noexcept
 {
-    RecreateFrameBuffers(width, height);
+    for (const PooledTexture& pooledTex : m_texturePool) {
+        DestroyPooledTexture(pooledTex.pTexture);
+    }
+
+    m_texturePool.clear();
 }
 
 
-void RenderTargetManager::RecreateFrameBuffers(uint32_t width, uint32_t height) noexcept
+void RenderTargetManager::DestroyPooledTexture(Texture* pTexture) noexcept
 {
-    ClearFrameBuffersStorage();
+    // Texture storage slot may be reused by a new texture, so frame buffers must not be matched against the dangling pointer
+    DetachTexture(pTexture);
 
-    RTTextureCreateInfoArray frameBufferAttachmentDescs;
-
-    frameBufferAttachmentDescs[size_t(RTTextureID::GBUFFER_ALBEDO)]   = { resGetTexResourceFormat(GBUFFER_ALBEDO_TEX), width, height, 0, ds::StrID("_GBUFFER_ALBEDO_") };
-    frameBufferAttachmentDescs[size_t(RTTextureID::GBUFFER_NORMAL)]   = { resGetTexResourceFormat(GBUFFER_NORMAL_TEX), width, height, 0, ds::StrID("_GBUFFER_NORMAL_") };
-    frameBufferAttachmentDescs[size_t(RTTextureID::GBUFFER_SPECULAR)] = { resGetTexResourceFormat(GBUFFER_SPECULAR_TEX), width, height, 0, ds::StrID("_GBUFFER_SPECULAR_") };
-    
-    frameBufferAttachmentDescs[size_t(RTTextureID::COMMON_DEPTH)] = { resGetTexResourceFormat(COMMON_DEPTH_TEX), width, height, 0, ds::StrID("_COMMON_DEPTH_") };
-    
-    frameBufferAttachmentDescs[size_t(RTTextureID::COMMON_COLOR)] = { resGetTexResourceFormat(COMMON_COLOR_TEX), width, height, 0, ds::StrID("_COMMON_COLOR_") };
+    pTexture->Destroy();
+    TextureManager::GetInstance().UnregisterTexture(pTexture);
+}
 
-    PrepareRTTextureStorage(frameBufferAttachmentDescs);
 
-    RTFrameBufferCreateInfoArray frameBufferDescs;
+void RenderTargetManager::DetachTexture(const Texture* pTexture) noexcept
+{
+    for (size_t fbIdx = 0; fbIdx < m_frameBufferStorage.size(); ++fbIdx) {
+        FrameBufferAttachments& fbAttachments = m_frameBufferAttachmentsStorage[fbIdx];
 
-    FrameBufferAttachment pGBufferAttachments[] = { 
-        { m_RTTextureStorage[size_t(RTTextureID::GBUFFER_ALBEDO)], FrameBufferAttachmentType::COLOR_ATTACHMENT, 0 },
-        { m_RTTextureStorage[size_t(RTTextureID::GBUFFER_NORMAL)], FrameBufferAttachmentType::COLOR_ATTACHMENT, 1 },
-        { m_RTTextureStorage[size_t(RTTextureID::GBUFFER_SPECULAR)], FrameBufferAttachmentType::COLOR_ATTACHMENT, 2 },
-        { m_RTTextureStorage[size_t(RTTextureID::COMMON_DEPTH)], FrameBufferAttachmentType::DEPTH_ATTACHMENT, 0 },
-    };
-    frameBufferDescs[size_t(RTFrameBufferID::GBUFFER)] = { pGBufferAttachments, _countof(pGBufferAttachments), ds::StrID("_GBUFFER_") };
+        const FrameBufferAttachment* pAttachmentsBegin = fbAttachments.attachments.data();
+        const FrameBufferAttachment* pAttachmentsEnd = pAttachmentsBegin + fbAttachments.attachmentsCount;
 
-    FrameBufferAttachment pPostProcessAttachments[] = { 
-        { m_RTTextureStorage[size_t(RTTextureID::COMMON_COLOR)], FrameBufferAttachmentType::COLOR_ATTACHMENT, 0 },
-    };
-    frameBufferDescs[size_t(RTFrameBufferID::POST_PROCESS)] = { pPostProcessAttachments, _countof(pPostProcessAttachments), ds::StrID("_POST_PROCESS_") };
+        const bool isReferenced = std::any_of(pAttachmentsBegin, pAttachmentsEnd, 
+            [pTexture](const FrameBufferAttachment& attachment) { return attachment.pTexure == pTexture; });
 
-    PrepareRTFrameBufferStorage(frameBufferDescs);
+        if (isReferenced) {
+            m_frameBufferStorage[fbIdx].Destroy();
+            fbAttachments.attachmentsCount = 0;
+        }
+    }
 }
 
 
@@ -6,28 +6,33 @@
 #include "core.h"
 
 
-enum class RTTextureID : uint32_t
+enum class RTFrameBufferID : uint16_t
 {
-    GBUFFER_ALBEDO,
-    GBUFFER_NORMAL,
-    GBUFFER_SPECULAR,
-
-    COMMON_DEPTH,
-
-    COMMON_COLOR,
+    DEPTH_PREPASS,
+    GBUFFER,
+    POST_PROCESS,
+    // Visibility buffer mode passes, used instead of GBUFFER and POST_PROCESS color pass
+    VISIBILITY,
+    VISIBILITY_RESOLVE,
+    // Temporal upscaling history textures, presented by blits. Attached by the render system, since they outlive the frame graph
+    TEMPORAL_HISTORY_0,
+    TEMPORAL_HISTORY_1,
 
     COUNT,
     INVALID,
 };
 
 
-enum class RTFrameBufferID : uint16_t
+struct RTTextureDesc
 {
-    GBUFFER,
-    POST_PROCESS,
+    uint32_t format; // Reflected from shader
+    uint32_t width;
+    uint32_t height;
 
-    COUNT,
-    INVALID,
+    bool operator==(const RTTextureDesc& other) const noexcept
+    {
+        return format == other.format && width == other.width && height == other.height;
+    }
 };
 
 
@@ -88,6 +93,9 @@ public:
     void ClearStencil(int32_t stencil) noexcept;
     void ClearDepthStencil(float depth, int32_t stencil) noexcept;
 
+    // Tells the driver that attachments contents are no longer needed, so they are neither loaded nor stored to memory
+    void Invalidate(uint32_t colorAttachmentsMask, bool invalidateDepthStencil) noexcept;
+
     bool IsValid() const noexcept;
 
     bool HasDepthAttachment() const noexcept { return GetDepthAttachmentCount() > 0; }
@@ -147,33 +155,20 @@ private:
 };
 
 
+// Owns frame buffers referenced by pipelines and the pool of render target textures.
+// Frame graph acquires pooled textures for its transient resources and defines frame buffers attachments.
+// Pooled textures sizes are rounded up to the granularity, so passes render through viewport and scissor and
+// interactive resizing within the same size bucket doesn't reallocate anything
 class RenderTargetManager
 {
     friend bool engInitRenderTargetManager() noexcept;
     friend void engTerminateRenderTargetManager() noexcept;
     friend bool engIsRenderTargetManagerInitialized() noexcept;
 
-private:
-    struct RTTextureIntermediateCreateInfo
-    {
-        uint32_t format;
-        uint32_t width;
-        uint32_t height;
-        uint32_t mipsCount;
-
-        ds::StrID name;
-    };
-
-    using RTTextureCreateInfoArray = std::array<RTTextureIntermediateCreateInfo, size_t(RTTextureID::COUNT)>;
-
-    struct RTFrameBufferIntermediateCreateInfo
-    {
-        const FrameBufferAttachment* pAttachments;
-        uint32_t                     attachmentsCount;
-        ds::StrID                    name;
-    };
-
-    using RTFrameBufferCreateInfoArray = std::array<RTFrameBufferIntermediateCreateInfo, size_t(RTFrameBufferID::COUNT)>;
+public:
+    static inline constexpr uint32_t POOLED_TEXTURE_SIZE_GRANULARITY = 128;
+    // Released textures survive this many frames, so resizing back and forth reuses them
+    static inline constexpr uint64_t POOLED_TEXTURE_MAX_IDLE_FRAMES = 120;
 
 public:
     static RenderTargetManager& GetInstance() noexcept;
@@ -186,7 +181,6 @@ public:
     RenderTargetManager(RenderTargetManager&& other) noexcept = delete;
     RenderTargetManager& operator=(RenderTargetManager&& other) noexcept = delete;
 
-    Texture* GetRTTexture(RTTextureID texID) noexcept;
     FrameBuffer* GetFrameBuffer(RTFrameBufferID framebufferID) noexcept;
     void BindFrameBuffer(RTFrameBufferID framebufferID) noexcept;
 
@@ -196,6 +190,43 @@ public:
     void ClearFrameBufferStencil(RTFrameBufferID framebufferID, int32_t stencil) noexcept;
     void ClearFrameBufferDepthStencil(RTFrameBufferID framebufferID, float depth, int32_t stencil) noexcept;
 
+    // Frame buffer keeps its address, so pipelines referencing it stay valid. Recreated only if attachments changed.
+    // Must be called on the thread owning graphics context
+    void SetFrameBufferAttachments(RTFrameBufferID framebufferID, const FrameBufferAttachment* pAttachments, uint32_t attachmentsCount, ds::StrID name) noexcept;
+
+    // Destroys frame buffers the texture is attached to, so that the next SetFrameBufferAttachments call recreates them.
+    // Must be called before storage of an attached texture is recreated in place, since attachments are matched by texture address
+    void DetachTexture(const Texture* pTexture) noexcept;
+
+    // Returns free pooled texture of the same format and size bucket or creates a new one
+    Texture* AcquirePooledTexture(const RTTextureDesc& desc) noexcept;
+    void ReleasePooledTexture(Texture* pTexture) noexcept;
+
+    // Description of the texture which is actually allocated for the requested one
+    RTTextureDesc GetPooledTextureDesc(const RTTextureDesc& desc) const noexcept;
+
+    // Called once per frame. Destroys textures idle for more than POOLED_TEXTURE_MAX_IDLE_FRAMES,
+    // frame buffers referencing them are destroyed as well
+    void UpdateTexturePool() noexcept;
+
+    // Total estimated memory of pooled textures
+    uint64_t GetTexturePoolMemorySize() const noexcept;
+
+private:
+    struct PooledTexture
+    {
+        Texture*      pTexture;
+        RTTextureDesc desc;
+        uint64_t      lastUsedFrame;
+        bool          isAcquired;
+    };
+
+    struct FrameBufferAttachments
+    {
+        std::array<FrameBufferAttachment, FrameBuffer::GetMaxAttachmentsCount()> attachments;
+        uint32_t attachmentsCount;
+    };
+
 private:
     RenderTargetManager() = default;
 
@@ -203,23 +234,23 @@ private:
     void Terminate() noexcept;
 
     void ClearFrameBuffersStorage() noexcept;
+    void ClearTexturePool() noexcept;
 
-    void PrepareRTTextureStorage(const RTTextureCreateInfoArray& rtTexDescs) noexcept;
-    void PrepareRTFrameBufferStorage(const RTFrameBufferCreateInfoArray& fbDescs) noexcept;
-
-    void OnWindowResizedEvent(uint32_t width, uint32_t height) noexcept;
-    void RecreateFrameBuffers(uint32_t width, uint32_t height) noexcept;
+    void DestroyPooledTexture(Texture* pTexture) noexcept;
 
     bool IsInitialized() const noexcept { return m_isInitialized; }
 
 private:
     using RTFrameBufferStorage = std::array<FrameBuffer, size_t(RTFrameBufferID::COUNT)>;
-    using RTTexturePtrStorage = std::array<Texture*, size_t(RTTextureID::COUNT)>;
+    using RTFrameBufferAttachmentsStorage = std::array<FrameBufferAttachments, size_t(RTFrameBufferID::COUNT)>;
 
     RTFrameBufferStorage m_frameBufferStorage = { };
-    RTTexturePtrStorage m_RTTextureStorage    = { nullptr };
+    // Attachments the frame buffers were created with, used to skip redundant recreations
+    RTFrameBufferAttachmentsStorage m_frameBufferAttachmentsStorage = { };
 
-    es::ListenerID m_frameBufferResizeEventListenerID;
+    std::vector<PooledTexture> m_texturePool;
+    uint32_t m_pooledTexturesCreatedCount = 0;
+    uint64_t m_poolFrameIdx = 0;
 
     bool m_isInitialized = false;
 };
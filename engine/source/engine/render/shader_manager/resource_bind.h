@@ -12,7 +12,10 @@ enum class ShaderResourceType : uint32_t
     TYPE_DOUBLE,
 
     TYPE_SAMPLER_2D,
+    TYPE_USAMPLER_2D,
+    TYPE_IMAGE_2D,
     TYPE_CONST_BUFFER,
+    TYPE_STORAGE_BUFFER,
 };
 
 
@@ -7,6 +7,7 @@
 #include "utils/debug/assertion.h"
 
 #include "render/platform/OpenGL/opengl_driver.h"
+#include "render/platform/OpenGL/opengl_retire_queue.h"
 
 
 static constexpr size_t ENG_MAX_SHADER_PROGRAMS_COUNT = 4096; // TODO: make it configurable
@@ -94,9 +95,6 @@ public:
 
     bool IsValid() const noexcept { return m_stageID != 0; }
 
-private:
-    static std::string PreprocessSourceCode(const ShaderStageCreateInfo& createInfo) noexcept;
-
 private:
     bool GetCompilationStatus() const noexcept;
 
@@ -126,13 +124,16 @@ bool ShaderStage::Init(const ShaderStageCreateInfo &createInfo) noexcept
         switch (type) {
             case ShaderStageType::VERTEX: return GL_VERTEX_SHADER;
             case ShaderStageType::PIXEL:  return GL_FRAGMENT_SHADER;
+            case ShaderStageType::COMPUTE: return GL_COMPUTE_SHADER;
             default: return GL_NONE;
         }
     }(createInfo.type);
     
     ENG_ASSERT_GRAPHICS_API(shaderStageGLType != GL_NONE, "Invalid ShaderStageType value: {}", static_cast<uint32_t>(createInfo.type));
 
-    const std::string preprocessedSourceCode = PreprocessSourceCode(createInfo);
+    const std::string preprocessedSourceCode = createInfo.isPreprocessed ? 
+        std::string(createInfo.pSourceCode, createInfo.codeSize) : ShaderManager::PreprocessSourceCode(createInfo);
+    
     if (preprocessedSourceCode.empty()) {
         ENG_LOG_WARN("Empty shader source code");
         return false;
@@ -167,7 +168,7 @@ void ShaderStage::Destroy() noexcept
 }
 
 
-std::string ShaderStage::PreprocessSourceCode(const ShaderStageCreateInfo& createInfo) noexcept
+std::string ShaderManager::PreprocessSourceCode(const ShaderStageCreateInfo& createInfo) noexcept
 {
     ENG_ASSERT(createInfo.pSourceCode, "Source code is nullptr");
 
@@ -249,7 +250,7 @@ ShaderProgram &ShaderProgram::operator=(ShaderProgram&& other) noexcept
 void ShaderProgram::Bind() const noexcept
 {
     ENG_ASSERT(IsValid(), "Attempt to bind invalid shader program");
-    glUseProgram(m_renderID);
+    engOpenGLUseProgram(m_renderID);
 }
 
 
@@ -369,7 +370,7 @@ void ShaderProgram::Destroy() noexcept
     m_dbgName = "_INVALID_";
 #endif
 
-    glDeleteProgram(m_renderID);
+    engOpenGLRetireObject(OpenGLObjectType::PROGRAM, m_renderID);
     m_renderID = 0;
 }
 
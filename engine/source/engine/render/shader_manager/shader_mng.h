@@ -18,6 +18,7 @@ enum class ShaderStageType : uint32_t
 {
     VERTEX,
     PIXEL,
+    COMPUTE,
     COUNT
 };
 
@@ -30,6 +31,9 @@ struct ShaderStageCreateInfo
     uint32_t codeSize;
     uint32_t definesCount;
     ShaderStageType type;
+
+    // pSourceCode is already processed by ShaderManager::PreprocessSourceCode, so defines and include path are ignored
+    bool isPreprocessed;
 };
 
 
@@ -103,6 +107,9 @@ class ShaderManager
 
 public:
     static ShaderManager& GetInstance() noexcept;
+
+    // Injects defines and resolves includes. Doesn't touch graphics API, so it's safe to call from any thread
+    static std::string PreprocessSourceCode(const ShaderStageCreateInfo& createInfo) noexcept;
     
 public:
     ShaderManager(const ShaderManager& other) = delete;
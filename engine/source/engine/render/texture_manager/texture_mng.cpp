@@ -5,6 +5,10 @@
 #include "utils/data_structures/hash.h"
 
 #include "render/platform/OpenGL/opengl_driver.h"
+#include "render/platform/OpenGL/opengl_retire_queue.h"
+
+#include "render/mem_manager/buffer_manager.h"
+#include "render/mem_manager/upload_manager.h"
 
 #include "auto/registers_common.h"
 
@@ -44,6 +48,7 @@ enum class TextureFormat
     FORMAT_RG32F,
     FORMAT_RGB32F,
     FORMAT_RGBA32F,
+    FORMAT_R11G11B10F,
     FORMAT_R8I,
     FORMAT_R8UI,
     FORMAT_R16I,
@@ -108,7 +113,7 @@ TextureSamplerState &TextureSamplerState::operator=(TextureSamplerState &&other)
 
 void TextureSamplerState::Bind(uint32_t unit) noexcept
 {
-    glBindSampler(unit, m_renderID);
+    engOpenGLBindSampler(unit, m_renderID);
 }
 
 
@@ -144,7 +149,8 @@ void TextureSamplerState::Destroy() noexcept
     m_dbgName = "_INVALID_";
 #endif
 
-    glDeleteSamplers(1, &m_renderID);
+    engOpenGLRetireObject(OpenGLObjectType::SAMPLER, m_renderID);
+
     m_renderID = 0;
 }
 
@@ -175,6 +181,7 @@ static TextureFormat ConvertShaderTexResourceFormat(uint32_t resFormat) noexcept
         case TEXTURE_FORMAT_RG32F: return TextureFormat::FORMAT_RG32F;
         case TEXTURE_FORMAT_RGB32F: return TextureFormat::FORMAT_RGB32F;
         case TEXTURE_FORMAT_RGBA32F: return TextureFormat::FORMAT_RGBA32F;
+        case TEXTURE_FORMAT_R11G11B10F: return TextureFormat::FORMAT_R11G11B10F;
         case TEXTURE_FORMAT_R8I: return TextureFormat::FORMAT_R8I;
         case TEXTURE_FORMAT_R8UI: return TextureFormat::FORMAT_R8UI;
         case TEXTURE_FORMAT_R16I: return TextureFormat::FORMAT_R16I;
@@ -236,6 +243,7 @@ static GLenum GetTextureInternalGLFormat(TextureFormat format) noexcept
         case TextureFormat::FORMAT_RG32F: return GL_RG32F;
         case TextureFormat::FORMAT_RGB32F: return GL_RGB32F;
         case TextureFormat::FORMAT_RGBA32F: return GL_RGBA32F;
+        case TextureFormat::FORMAT_R11G11B10F: return GL_R11F_G11F_B10F;
         case TextureFormat::FORMAT_R8I: return GL_R8I;
         case TextureFormat::FORMAT_R8UI: return GL_R8UI;
         case TextureFormat::FORMAT_R16I: return GL_R16I;
@@ -271,6 +279,77 @@ static GLenum GetTextureInternalGLFormat(TextureFormat format) noexcept
 }
 
 
+// Nominal texel size. Drivers may pad some formats, e.g. 3 component ones, so it's a lower bound of real memory usage
+static uint32_t GetTextureFormatTexelSize(TextureFormat format) noexcept
+{
+    switch (format) {
+        case TextureFormat::FORMAT_R8:
+        case TextureFormat::FORMAT_R8_SNORM:
+        case TextureFormat::FORMAT_R8I:
+        case TextureFormat::FORMAT_R8UI:
+        case TextureFormat::FORMAT_STENCIL1:
+        case TextureFormat::FORMAT_STENCIL4:
+        case TextureFormat::FORMAT_STENCIL8:
+            return 1;
+        case TextureFormat::FORMAT_R16:
+        case TextureFormat::FORMAT_R16_SNORM:
+        case TextureFormat::FORMAT_RG8:
+        case TextureFormat::FORMAT_RG8_SNORM:
+        case TextureFormat::FORMAT_R16F:
+        case TextureFormat::FORMAT_R16I:
+        case TextureFormat::FORMAT_R16UI:
+        case TextureFormat::FORMAT_RG8UI:
+        case TextureFormat::FORMAT_DEPTH16:
+        case TextureFormat::FORMAT_STENCIL16:
+            return 2;
+        case TextureFormat::FORMAT_RGB8_SNORM:
+        case TextureFormat::FORMAT_SRGB8:
+        case TextureFormat::FORMAT_RGB8I:
+        case TextureFormat::FORMAT_RGB8UI:
+            return 3;
+        case TextureFormat::FORMAT_RG16:
+        case TextureFormat::FORMAT_RG16_SNORM:
+        case TextureFormat::FORMAT_RGBA8:
+        case TextureFormat::FORMAT_RGBA8_SNORM:
+        case TextureFormat::FORMAT_SRGB8_ALPHA8:
+        case TextureFormat::FORMAT_RG16F:
+        case TextureFormat::FORMAT_R11G11B10F:
+        case TextureFormat::FORMAT_R32F:
+        case TextureFormat::FORMAT_R32I:
+        case TextureFormat::FORMAT_R32UI:
+        case TextureFormat::FORMAT_RG16I:
+        case TextureFormat::FORMAT_RG16UI:
+        case TextureFormat::FORMAT_RGBA8I:
+        case TextureFormat::FORMAT_DEPTH24:
+        case TextureFormat::FORMAT_DEPTH32:
+        case TextureFormat::FORMAT_DEPTH24_STENCIL8:
+            return 4;
+        case TextureFormat::FORMAT_RGB16_SNORM:
+        case TextureFormat::FORMAT_RGB16F:
+        case TextureFormat::FORMAT_RGB16I:
+        case TextureFormat::FORMAT_RGB16UI:
+            return 6;
+        case TextureFormat::FORMAT_RGBA16:
+        case TextureFormat::FORMAT_RGBA16F:
+        case TextureFormat::FORMAT_RG32F:
+        case TextureFormat::FORMAT_RG32UI:
+        case TextureFormat::FORMAT_RGBA16I:
+        case TextureFormat::FORMAT_RGBA16UI:
+        case TextureFormat::FORMAT_DEPTH32_STENCIL8:
+            return 8;
+        case TextureFormat::FORMAT_RGB32F:
+        case TextureFormat::FORMAT_RGB32I:
+        case TextureFormat::FORMAT_RGB32UI:
+            return 12;
+        case TextureFormat::FORMAT_RGBA32F:
+        case TextureFormat::FORMAT_RGBA32I:
+        case TextureFormat::FORMAT_RGBA32UI:
+            return 16;
+        default: return 0;
+    };
+}
+
+
 static GLenum GetTextureInputDataGLFormat(TextureInputDataFormat format) noexcept
 {
     switch (format) {
@@ -286,6 +365,36 @@ static GLenum GetTextureInputDataGLFormat(TextureInputDataFormat format) noexcep
 }
 
 
+static uint32_t GetTextureInputDataComponentsCount(TextureInputDataFormat format) noexcept
+{
+    switch (format) {
+        case TextureInputDataFormat::INPUT_FORMAT_R: return 1;
+        case TextureInputDataFormat::INPUT_FORMAT_RG: return 2;
+        case TextureInputDataFormat::INPUT_FORMAT_RGB: return 3;
+        case TextureInputDataFormat::INPUT_FORMAT_BGR: return 3;
+        case TextureInputDataFormat::INPUT_FORMAT_RGBA: return 4;
+        case TextureInputDataFormat::INPUT_FORMAT_DEPTH: return 1;
+        case TextureInputDataFormat::INPUT_FORMAT_STENCIL: return 1;
+        default: return 0;
+    };
+}
+
+
+static uint32_t GetTextureInputDataTypeSize(TextureInputDataType type) noexcept
+{
+    switch (type) {
+        case TextureInputDataType::INPUT_TYPE_UNSIGNED_BYTE: return sizeof(uint8_t);
+        case TextureInputDataType::INPUT_TYPE_BYTE: return sizeof(int8_t);
+        case TextureInputDataType::INPUT_TYPE_UNSIGNED_SHORT: return sizeof(uint16_t);
+        case TextureInputDataType::INPUT_TYPE_SHORT: return sizeof(int16_t);
+        case TextureInputDataType::INPUT_TYPE_UNSIGNED_INT: return sizeof(uint32_t);
+        case TextureInputDataType::INPUT_TYPE_INT: return sizeof(int32_t);
+        case TextureInputDataType::INPUT_TYPE_FLOAT: return sizeof(float);
+        default: return 0;
+    };
+}
+
+
 static GLenum GetTextureInputDataGLType(TextureInputDataType type) noexcept
 {
     switch (type) {
@@ -306,6 +415,7 @@ Texture::Texture(Texture &&other) noexcept
     std::swap(m_name, other.m_name);
     std::swap(m_ID, other.m_ID);
     std::swap(m_type, other.m_type);
+    std::swap(m_format, other.m_format);
     std::swap(m_levelsCount, other.m_levelsCount);
     std::swap(m_width, other.m_width);
     std::swap(m_height, other.m_height);
@@ -321,6 +431,7 @@ Texture& Texture::operator=(Texture &&other) noexcept
     std::swap(m_name, other.m_name);
     std::swap(m_ID, other.m_ID);
     std::swap(m_type, other.m_type);
+    std::swap(m_format, other.m_format);
     std::swap(m_levelsCount, other.m_levelsCount);
     std::swap(m_width, other.m_width);
     std::swap(m_height, other.m_height);
@@ -334,7 +445,17 @@ Texture& Texture::operator=(Texture &&other) noexcept
 void Texture::Bind(uint32_t unit) noexcept
 {
     ENG_ASSERT_GRAPHICS_API(IsValid(), "Attempt to bind invalid texture");
-    glBindTextureUnit(unit, m_renderID);
+    engOpenGLBindTextureUnit(unit, m_renderID);
+}
+
+
+void Texture::BindImage(uint32_t unit, uint32_t level) noexcept
+{
+    ENG_ASSERT_GRAPHICS_API(IsValid(), "Attempt to bind invalid texture");
+    ENG_ASSERT_GRAPHICS_API(level < m_levelsCount, "Texture '{}' level {} is out of range", m_name.CStr(), level);
+
+    const GLenum internalFormat = GetTextureInternalGLFormat(ConvertShaderTexResourceFormat(m_format));
+    glBindImageTexture(unit, m_renderID, level, GL_FALSE, 0, GL_WRITE_ONLY, internalFormat);
 }
 
 
@@ -425,6 +546,7 @@ bool Texture::Create(const Texture2DCreateInfo &createInfo) noexcept
     ENG_ASSERT(m_ID.IsValid(), "Texture \'{}\' ID is invalid. You must initialize only textures which were returned by TextureManager", m_name.CStr());
 
     m_type = GL_TEXTURE_2D;
+    m_format = createInfo.format;
     m_levelsCount = 1 + createInfo.mipmapsCount;
     m_width = createInfo.width;
     m_height = createInfo.height;
@@ -446,31 +568,72 @@ bool Texture::Create(const Texture2DCreateInfo &createInfo) noexcept
         return true;
     }
 
+    if (engIsUploadManagerInitialized()) {
+        TextureRegion2D region = {};
+        region.width = m_width;
+        region.height = m_height;
+
+        UploadManager::GetInstance().UploadTexture2D(this, region, createInfo.inputData, createInfo.mipmapsCount > 0);
+        
+        return true;
+    }
+
     const GLenum inputDataFormat = GetTextureInputDataGLFormat(createInfo.inputData.format);
     ENG_ASSERT(inputDataFormat != GL_NONE, "Invalid texture input data format: {}", static_cast<uint32_t>(createInfo.inputData.format));
 
     const GLenum inputDataType = GetTextureInputDataGLType(createInfo.inputData.dataType);
     ENG_ASSERT(inputDataType != GL_NONE, "Invalid texture input data type: {}", static_cast<uint32_t>(createInfo.inputData.dataType));
 
+    // Bound unpack buffer would make pData treated as an offset
+    engOpenGLBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     glTextureSubImage2D(m_renderID, 0, 0, 0, m_width, m_height, inputDataFormat, inputDataType, pData);
 
     if (createInfo.mipmapsCount > 0) {
-        glGenerateTextureMipmap(m_renderID);
+        GenerateMipmaps();
     }
 
     return true;
 }
 
 
+void Texture::CopyFromStagingBuffer(MemoryBuffer& stagingBuffer, uint64_t offset, const TextureRegion2D& region, 
+    TextureInputDataFormat format, TextureInputDataType dataType) noexcept
+{
+    ENG_ASSERT(IsValid(), "Texture '{}' is invalid", m_name.CStr());
+    ENG_ASSERT(stagingBuffer.IsStagingBuffer(), "Memory buffer '{}' is not staging buffer", stagingBuffer.GetDebugName().CStr());
+    ENG_ASSERT(region.level < m_levelsCount, "Texture '{}' level {} is out of range", m_name.CStr(), region.level);
+    ENG_ASSERT(region.x + region.width <= std::max(m_width >> region.level, 1u) && region.y + region.height <= std::max(m_height >> region.level, 1u),
+        "Texture '{}' copy region is out of bounds", m_name.CStr());
+
+    const GLenum inputDataFormat = GetTextureInputDataGLFormat(format);
+    ENG_ASSERT(inputDataFormat != GL_NONE, "Invalid texture input data format: {}", static_cast<uint32_t>(format));
+
+    const GLenum inputDataType = GetTextureInputDataGLType(dataType);
+    ENG_ASSERT(inputDataType != GL_NONE, "Invalid texture input data type: {}", static_cast<uint32_t>(dataType));
+
+    stagingBuffer.Bind();
+    glTextureSubImage2D(m_renderID, region.level, region.x, region.y, region.width, region.height, inputDataFormat, inputDataType, 
+        reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)));
+}
+
+
+void Texture::GenerateMipmaps() noexcept
+{
+    ENG_ASSERT(IsValid(), "Texture '{}' is invalid", m_name.CStr());
+    glGenerateTextureMipmap(m_renderID);
+}
+
+
 void Texture::Destroy() noexcept
 {
     if (!IsValid()) {
         return;
     }
 
-    glDeleteTextures(1, &m_renderID);
+    engOpenGLRetireObject(OpenGLObjectType::TEXTURE, m_renderID);
 
     m_type = 0;
+    m_format = 0;
     m_levelsCount = 0;
     m_width = 0;
     m_height = 0;
@@ -746,4 +909,38 @@ void engTerminateTextureManager() noexcept
 bool engIsTextureManagerInitialized() noexcept
 {
     return pTextureMngInst && pTextureMngInst->IsInitialized();
-}
\ No newline at end of file
+}
+
+
+uint64_t engGetTextureInputDataSize(TextureInputDataFormat format, TextureInputDataType dataType, uint32_t width, uint32_t height) noexcept
+{
+    const uint64_t texelSize = GetTextureInputDataComponentsCount(format) * GetTextureInputDataTypeSize(dataType);
+    ENG_ASSERT(texelSize > 0, "Invalid texture input data format {} or type {}", static_cast<uint32_t>(format), static_cast<uint32_t>(dataType));
+
+    if (width == 0 || height == 0) {
+        return 0;
+    }
+
+    const uint64_t rowSize = width * texelSize;
+    const uint64_t rowPitch = (rowSize + 3) & ~3ull;
+
+    // The last row isn't padded
+    return rowPitch * (height - 1) + rowSize;
+}
+
+
+uint64_t engGetTextureMemorySize(uint32_t format, uint32_t width, uint32_t height, uint32_t mipmapsCount) noexcept
+{
+    const TextureFormat convertedFormat = ConvertShaderTexResourceFormat(format);
+    ENG_ASSERT(convertedFormat != TextureFormat::FORMAT_INVALID, "Invalid reflected texture format: \'{}\'", format);
+
+    const uint64_t texelSize = GetTextureFormatTexelSize(convertedFormat);
+
+    uint64_t size = 0;
+
+    for (uint32_t level = 0; level <= mipmapsCount; ++level) {
+        size += texelSize * std::max(width >> level, 1u) * std::max(height >> level, 1u);
+    }
+
+    return size;
+}
@@ -9,6 +9,9 @@
 #include <vector>
 
 
+class MemoryBuffer;
+
+
 class TextureSamplerState
 {
     friend class TextureManager;
@@ -82,6 +85,17 @@ struct TextureInputData
 };
 
 
+struct TextureRegion2D
+{
+    uint32_t level = 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+
+// Without upload manager data is uploaded right away, otherwise it's staged and copied by the next upload manager flush
 struct Texture2DCreateInfo
 {
     TextureInputData inputData = {};
@@ -113,6 +127,14 @@ public:
     void Destroy() noexcept;
 
     void Bind(uint32_t unit) noexcept;
+    // Binds one level to image unit for shader stores, see DECLARE_UAV_TEXTURE
+    void BindImage(uint32_t unit, uint32_t level) noexcept;
+
+    // Copies region texels from staging buffer at offset. Leaves the buffer bound to pixel unpack target
+    void CopyFromStagingBuffer(MemoryBuffer& stagingBuffer, uint64_t offset, const TextureRegion2D& region, 
+        TextureInputDataFormat format, TextureInputDataType dataType) noexcept;
+
+    void GenerateMipmaps() noexcept;
 
     bool IsValid() const noexcept;
 
@@ -141,6 +163,7 @@ private:
     ds::StrID m_name = "_INVALID_";
     
     uint32_t m_type = 0;
+    uint32_t m_format = 0; // Reflected from shader
     uint32_t m_levelsCount = 0;
     
     uint32_t m_width = 0;
@@ -206,6 +229,12 @@ private:
 uint64_t amHash(const Texture& texture) noexcept;
 
 
+// Size of tightly packed texels with rows aligned to 4 bytes (default GL_UNPACK_ALIGNMENT)
+uint64_t engGetTextureInputDataSize(TextureInputDataFormat format, TextureInputDataType dataType, uint32_t width, uint32_t height) noexcept;
+// Estimated video memory size of 2D texture with reflected format
+uint64_t engGetTextureMemorySize(uint32_t format, uint32_t width, uint32_t height, uint32_t mipmapsCount = 0) noexcept;
+
+
 bool engInitTextureManager() noexcept;
 void engTerminateTextureManager() noexcept;
 bool engIsTextureManagerInitialized() noexcept;
\ No newline at end of file
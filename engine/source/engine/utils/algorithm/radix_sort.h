@@ -0,0 +1,15 @@
+#pragma once
+
+#include "utils/thread/worker_pool.h"
+
+#include <cstdint>
+
+
+// Stable LSD radix sort of elements by 64-bit key, getKey(const T&) must return uint64_t.
+// Uses 11-bit digits (6 passes at most), passes whose digit is the same for all keys are skipped.
+// pScratch must have space for count elements. If pWorkers is set, big arrays are sorted in parallel
+template <typename T, typename KeyGetter>
+void amRadixSort(T* pData, T* pScratch, size_t count, KeyGetter getKey, WorkerThreadPool* pWorkers = nullptr) noexcept;
+
+
+#include "radix_sort.hpp"
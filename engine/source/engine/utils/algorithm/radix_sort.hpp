@@ -0,0 +1,158 @@
+#include "utils/debug/assertion.h"
+
+#include <algorithm>
+#include <vector>
+#include <limits>
+
+
+namespace detail
+{
+    inline constexpr uint32_t RADIX_SORT_BITS_PER_DIGIT = 11;
+    inline constexpr uint32_t RADIX_SORT_BUCKETS_COUNT = 1u << RADIX_SORT_BITS_PER_DIGIT;
+    inline constexpr uint64_t RADIX_SORT_DIGIT_MASK = RADIX_SORT_BUCKETS_COUNT - 1;
+    inline constexpr uint32_t RADIX_SORT_DIGITS_COUNT = (64 + RADIX_SORT_BITS_PER_DIGIT - 1) / RADIX_SORT_BITS_PER_DIGIT;
+
+    // Histograms setup costs more than comparison sort of small arrays
+    inline constexpr size_t RADIX_SORT_MIN_ELEMENTS_COUNT = 1024;
+    inline constexpr size_t RADIX_SORT_MIN_ELEMENTS_PER_JOB = 16 * 1024;
+
+
+    inline uint32_t RadixSortGetDigit(uint64_t key, uint32_t digitIndex) noexcept
+    {
+        return static_cast<uint32_t>((key >> (digitIndex * RADIX_SORT_BITS_PER_DIGIT)) & RADIX_SORT_DIGIT_MASK);
+    }
+
+
+    // Layout: [job][digit][bucket]
+    inline uint32_t* RadixSortGetHistogram(std::vector<uint32_t>& histograms, uint32_t jobIndex, uint32_t digitIndex) noexcept
+    {
+        return histograms.data() + (size_t(jobIndex) * RADIX_SORT_DIGITS_COUNT + digitIndex) * RADIX_SORT_BUCKETS_COUNT;
+    }
+
+
+    template <typename T, typename KeyGetter>
+    inline void RadixSortBuildHistograms(const T* pData, size_t first, size_t last, KeyGetter& getKey, std::vector<uint32_t>& histograms, uint32_t jobIndex) noexcept
+    {
+        uint32_t* pJobHistograms = RadixSortGetHistogram(histograms, jobIndex, 0);
+
+        for (size_t i = first; i < last; ++i) {
+            const uint64_t key = getKey(pData[i]);
+
+            for (uint32_t digit = 0; digit < RADIX_SORT_DIGITS_COUNT; ++digit) {
+                ++pJobHistograms[digit * RADIX_SORT_BUCKETS_COUNT + RadixSortGetDigit(key, digit)];
+            }
+        }
+    }
+
+
+    template <typename T, typename KeyGetter>
+    inline void RadixSortBuildDigitHistogram(const T* pData, size_t first, size_t last, KeyGetter& getKey, uint32_t digitIndex, uint32_t* pHistogram) noexcept
+    {
+        std::fill(pHistogram, pHistogram + RADIX_SORT_BUCKETS_COUNT, 0u);
+
+        for (size_t i = first; i < last; ++i) {
+            ++pHistogram[RadixSortGetDigit(getKey(pData[i]), digitIndex)];
+        }
+    }
+
+
+    template <typename T, typename KeyGetter>
+    inline void RadixSortScatter(const T* pSrc, T* pDst, size_t first, size_t last, KeyGetter& getKey, uint32_t digitIndex, uint32_t* pOffsets) noexcept
+    {
+        for (size_t i = first; i < last; ++i) {
+            const uint32_t bucket = RadixSortGetDigit(getKey(pSrc[i]), digitIndex);
+            pDst[pOffsets[bucket]++] = pSrc[i];
+        }
+    }
+}
+
+
+template <typename T, typename KeyGetter>
+inline void amRadixSort(T* pData, T* pScratch, size_t count, KeyGetter getKey, WorkerThreadPool* pWorkers) noexcept
+{
+    using namespace detail;
+
+    ENG_ASSERT(count <= std::numeric_limits<uint32_t>::max(), "Radix sort supports up to 2^32 - 1 elements");
+
+    if (count < RADIX_SORT_MIN_ELEMENTS_COUNT) {
+        std::stable_sort(pData, pData + count, [&getKey](const T& left, const T& right) { return getKey(left) < getKey(right); });
+        return;
+    }
+
+    ENG_ASSERT(pData && pScratch, "Invalid radix sort buffers");
+
+    const uint32_t maxJobsCount = pWorkers ? pWorkers->GetWorkersCount() + 1 : 1;
+    const uint32_t jobsCount = std::clamp(static_cast<uint32_t>(count / RADIX_SORT_MIN_ELEMENTS_PER_JOB), 1u, maxJobsCount);
+
+    const auto GetJobRangeBegin = [count, jobsCount](uint32_t jobIndex) -> size_t {
+        return count * jobIndex / jobsCount;
+    };
+
+    // All digits histograms are built with a single read of the keys
+    std::vector<uint32_t> histograms(size_t(jobsCount) * RADIX_SORT_DIGITS_COUNT * RADIX_SORT_BUCKETS_COUNT, 0);
+
+    if (jobsCount > 1) {
+        pWorkers->Execute(jobsCount, [&](uint32_t jobIndex) {
+            RadixSortBuildHistograms(pData, GetJobRangeBegin(jobIndex), GetJobRangeBegin(jobIndex + 1), getKey, histograms, jobIndex);
+        });
+    } else {
+        RadixSortBuildHistograms(pData, 0, count, getKey, histograms, 0);
+    }
+
+    T* pSrc = pData;
+    T* pDst = pScratch;
+
+    bool isSourcePermuted = false;
+
+    const uint64_t firstKey = getKey(pData[0]);
+
+    for (uint32_t digit = 0; digit < RADIX_SORT_DIGITS_COUNT; ++digit) {
+        const uint32_t firstKeyBucket = RadixSortGetDigit(firstKey, digit);
+
+        size_t firstKeyBucketSize = 0;
+        for (uint32_t job = 0; job < jobsCount; ++job) {
+            firstKeyBucketSize += RadixSortGetHistogram(histograms, job, digit)[firstKeyBucket];
+        }
+
+        // All keys have the same digit, the pass wouldn't change the order
+        if (firstKeyBucketSize == count) {
+            continue;
+        }
+
+        // Total digit counts don't depend on elements order, but per job ones do, so they are recounted once job ranges got other elements
+        if (jobsCount > 1 && isSourcePermuted) {
+            pWorkers->Execute(jobsCount, [&](uint32_t jobIndex) {
+                RadixSortBuildDigitHistogram(pSrc, GetJobRangeBegin(jobIndex), GetJobRangeBegin(jobIndex + 1), getKey, digit, 
+                    RadixSortGetHistogram(histograms, jobIndex, digit));
+            });
+        }
+
+        // Histograms are turned into scatter offsets in place. Offsets of the same bucket grow with job index to keep sort stable
+        uint32_t offset = 0;
+        for (uint32_t bucket = 0; bucket < RADIX_SORT_BUCKETS_COUNT; ++bucket) {
+            for (uint32_t job = 0; job < jobsCount; ++job) {
+                uint32_t& bucketSize = RadixSortGetHistogram(histograms, job, digit)[bucket];
+                
+                const uint32_t jobBucketSize = bucketSize;
+                bucketSize = offset;
+                offset += jobBucketSize;
+            }
+        }
+
+        if (jobsCount > 1) {
+            pWorkers->Execute(jobsCount, [&](uint32_t jobIndex) {
+                RadixSortScatter(pSrc, pDst, GetJobRangeBegin(jobIndex), GetJobRangeBegin(jobIndex + 1), getKey, digit, 
+                    RadixSortGetHistogram(histograms, jobIndex, digit));
+            });
+        } else {
+            RadixSortScatter(pSrc, pDst, 0, count, getKey, digit, RadixSortGetHistogram(histograms, 0, digit));
+        }
+
+        std::swap(pSrc, pDst);
+        isSourcePermuted = true;
+    }
+
+    if (pSrc != pData) {
+        std::copy(pSrc, pSrc + count, pData);
+    }
+}
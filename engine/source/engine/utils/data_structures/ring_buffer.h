@@ -0,0 +1,52 @@
+#pragma once
+
+#include "utils/debug/assertion.h"
+
+#include <array>
+
+#include <cstdint>
+
+
+namespace ds
+{
+    // Fixed capacity ring buffer. When full, pushing overwrites the oldest element.
+    // Indexing is relative to the oldest stored element: [0] - oldest, [Size() - 1] - newest
+    template <typename T, size_t CAPACITY>
+    class RingBuffer
+    {
+        static_assert(CAPACITY > 0, "Ring buffer capacity must be greater than zero");
+
+    public:
+        using ValueType = T;
+
+    public:
+        static constexpr size_t GetCapacity() noexcept { return CAPACITY; }
+
+    public:
+        void Push(const ValueType& value) noexcept;
+        void Clear() noexcept;
+
+        const ValueType& operator[](size_t index) const noexcept;
+        ValueType& operator[](size_t index) noexcept;
+
+        const ValueType& Front() const noexcept { return (*this)[0]; }
+        const ValueType& Back() const noexcept { return (*this)[m_size - 1]; }
+
+        size_t GetSize() const noexcept { return m_size; }
+
+        bool IsEmpty() const noexcept { return m_size == 0; }
+        bool IsFull() const noexcept { return m_size == CAPACITY; }
+
+    private:
+        size_t GetStorageIndex(size_t index) const noexcept;
+
+    private:
+        std::array<ValueType, CAPACITY> m_storage = {};
+
+        size_t m_head = 0; // Index of the slot next value will be written to
+        size_t m_size = 0;
+    };
+}
+
+
+#include "ring_buffer.hpp"
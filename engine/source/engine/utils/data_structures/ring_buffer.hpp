@@ -0,0 +1,43 @@
+namespace ds
+{
+    template <typename T, size_t CAPACITY>
+    inline void RingBuffer<T, CAPACITY>::Push(const ValueType& value) noexcept
+    {
+        m_storage[m_head] = value;
+        m_head = (m_head + 1) % CAPACITY;
+
+        if (m_size < CAPACITY) {
+            ++m_size;
+        }
+    }
+
+
+    template <typename T, size_t CAPACITY>
+    inline void RingBuffer<T, CAPACITY>::Clear() noexcept
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+
+    template <typename T, size_t CAPACITY>
+    inline const typename RingBuffer<T, CAPACITY>::ValueType& RingBuffer<T, CAPACITY>::operator[](size_t index) const noexcept
+    {
+        return m_storage[GetStorageIndex(index)];
+    }
+
+
+    template <typename T, size_t CAPACITY>
+    inline typename RingBuffer<T, CAPACITY>::ValueType& RingBuffer<T, CAPACITY>::operator[](size_t index) noexcept
+    {
+        return m_storage[GetStorageIndex(index)];
+    }
+
+
+    template <typename T, size_t CAPACITY>
+    inline size_t RingBuffer<T, CAPACITY>::GetStorageIndex(size_t index) const noexcept
+    {
+        ENG_ASSERT(index < m_size, "Ring buffer index out of range: {} (size: {})", index, m_size);
+        return (m_head + CAPACITY - m_size + index) % CAPACITY;
+    }
+}
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "linear_allocator.h"
+
+#include "utils/debug/assertion.h"
+
+
+LinearAllocator::LinearAllocator(size_t blockSize)
+    : m_blockSize(blockSize)
+{
+    ENG_ASSERT(blockSize > 0, "Linear allocator block size must be greater than zero");
+}
+
+
+void* LinearAllocator::Allocate(size_t size, size_t alignment) noexcept
+{
+    ENG_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment must be power of two, got {}", alignment);
+
+    if (size == 0) {
+        return nullptr;
+    }
+
+    while (m_currBlockIndex < m_blocks.size()) {
+        if (uint8_t* pMemory = AllocateFromCurrBlock(size, alignment)) {
+            return pMemory;
+        }
+
+        // Tail of the block is wasted until the next reset
+        ++m_currBlockIndex;
+        m_currBlockOffset = 0;
+    }
+
+    Block block = {};
+    block.size = std::max(m_blockSize, size + alignment);
+    block.pMemory = std::make_unique<uint8_t[]>(block.size);
+
+    m_capacity += block.size;
+
+    m_blocks.emplace_back(std::move(block));
+    m_currBlockIndex = m_blocks.size() - 1;
+    m_currBlockOffset = 0;
+
+    uint8_t* pMemory = AllocateFromCurrBlock(size, alignment);
+    ENG_ASSERT(pMemory, "Failed to allocate {} bytes from the new block", size);
+
+    return pMemory;
+}
+
+
+void LinearAllocator::Reset() noexcept
+{
+    m_currBlockIndex = 0;
+    m_currBlockOffset = 0;
+    m_allocatedSize = 0;
+}
+
+
+void LinearAllocator::Release() noexcept
+{
+    m_blocks.clear();
+    m_capacity = 0;
+    
+    Reset();
+}
+
+
+uint8_t* LinearAllocator::AllocateFromCurrBlock(size_t size, size_t alignment) noexcept
+{
+    Block& block = m_blocks[m_currBlockIndex];
+
+    const uintptr_t blockBegin = reinterpret_cast<uintptr_t>(block.pMemory.get());
+    const uintptr_t allocBegin = (blockBegin + m_currBlockOffset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    const uintptr_t allocEnd = allocBegin + size;
+
+    if (allocEnd > blockBegin + block.size) {
+        return nullptr;
+    }
+
+    m_allocatedSize += allocEnd - (blockBegin + m_currBlockOffset);
+    m_currBlockOffset = allocEnd - blockBegin;
+
+    return reinterpret_cast<uint8_t*>(allocBegin);
+}
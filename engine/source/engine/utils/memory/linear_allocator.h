@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+
+// Bump allocator over a list of memory blocks. Allocations can't be freed individually, Reset() frees all of them at once
+// and keeps blocks for reuse. Blocks never move, so returned pointers are valid until Reset() or Release(). Not thread safe
+class LinearAllocator
+{
+public:
+    static inline constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+public:
+    explicit LinearAllocator(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    LinearAllocator(const LinearAllocator& other) = delete;
+    LinearAllocator& operator=(const LinearAllocator& other) = delete;
+    LinearAllocator(LinearAllocator&& other) noexcept = default;
+    LinearAllocator& operator=(LinearAllocator&& other) noexcept = default;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept;
+
+    template <typename T>
+    T* Allocate(size_t count = 1) noexcept { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+    void Reset() noexcept;
+    void Release() noexcept;
+
+    // Bytes handed out since the last reset (including alignment padding)
+    size_t GetAllocatedSize() const noexcept { return m_allocatedSize; }
+    size_t GetCapacity() const noexcept { return m_capacity; }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> pMemory;
+        size_t size;
+    };
+
+    uint8_t* AllocateFromCurrBlock(size_t size, size_t alignment) noexcept;
+
+private:
+    std::vector<Block> m_blocks;
+
+    size_t m_blockSize = DEFAULT_BLOCK_SIZE;
+
+    size_t m_currBlockIndex = 0;
+    size_t m_currBlockOffset = 0;
+
+    size_t m_allocatedSize = 0;
+    size_t m_capacity = 0;
+};
@@ -0,0 +1,128 @@
+#include "pch.h"
+#include "worker_pool.h"
+
+#include "utils/debug/assertion.h"
+
+
+WorkerThreadPool::~WorkerThreadPool()
+{
+    Stop();
+}
+
+
+void WorkerThreadPool::Start(uint32_t workersCount) noexcept
+{
+    ENG_ASSERT(m_workers.empty(), "Worker thread pool is already started");
+
+    m_isStopped = false;
+
+    m_workers.reserve(workersCount);
+    for (uint32_t i = 0; i < workersCount; ++i) {
+        m_workers.emplace_back(&WorkerThreadPool::WorkerLoop, this);
+    }
+}
+
+
+void WorkerThreadPool::Stop() noexcept
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_isStopped = true;
+    }
+
+    m_jobsCV.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+
+    m_workers.clear();
+}
+
+
+void WorkerThreadPool::Execute(uint32_t jobsCount, const JobFunc& job) noexcept
+{
+    if (jobsCount == 0) {
+        return;
+    }
+
+    if (m_workers.empty() || jobsCount == 1) {
+        for (uint32_t i = 0; i < jobsCount; ++i) {
+            job(i);
+        }
+
+        return;
+    }
+
+    {
+        std::unique_lock lock(m_mutex);
+        // Workers which were late for the previous batch must leave it before its job is replaced
+        m_doneCV.wait(lock, [this]() { return m_activeWorkersCount == 0; });
+
+        m_pJob = &job;
+        m_jobsCount = jobsCount;
+        
+        m_nextJobIndex.store(0, std::memory_order_relaxed);
+        m_completedJobsCount.store(0, std::memory_order_relaxed);
+
+        ++m_batchIndex;
+    }
+
+    m_jobsCV.notify_all();
+
+    RunJobs(job, jobsCount);
+
+    std::unique_lock lock(m_mutex);
+    m_doneCV.wait(lock, [this, jobsCount]() { 
+        return m_completedJobsCount.load(std::memory_order_acquire) == jobsCount && m_activeWorkersCount == 0; 
+    });
+
+    m_pJob = nullptr;
+    m_jobsCount = 0;
+}
+
+
+void WorkerThreadPool::WorkerLoop() noexcept
+{
+    uint64_t lastBatchIndex = 0;
+
+    while (true) {
+        const JobFunc* pJob = nullptr;
+        uint32_t jobsCount = 0;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_jobsCV.wait(lock, [this, lastBatchIndex]() { return m_isStopped || (m_pJob && m_batchIndex != lastBatchIndex); });
+
+            if (m_isStopped) {
+                return;
+            }
+
+            lastBatchIndex = m_batchIndex;
+            
+            pJob = m_pJob;
+            jobsCount = m_jobsCount;
+            
+            ++m_activeWorkersCount;
+        }
+
+        RunJobs(*pJob, jobsCount);
+
+        {
+            std::scoped_lock lock(m_mutex);
+            --m_activeWorkersCount;
+        }
+
+        m_doneCV.notify_all();
+    }
+}
+
+
+void WorkerThreadPool::RunJobs(const JobFunc& job, uint32_t jobsCount) noexcept
+{
+    for (uint32_t jobIndex = m_nextJobIndex.fetch_add(1, std::memory_order_relaxed); jobIndex < jobsCount;
+        jobIndex = m_nextJobIndex.fetch_add(1, std::memory_order_relaxed)) {
+        job(jobIndex);
+        m_completedJobsCount.fetch_add(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+
+// Persistent worker threads executing batches of indexed jobs. The calling thread takes part in execution too
+class WorkerThreadPool
+{
+public:
+    using JobFunc = std::function<void(uint32_t jobIndex)>;
+
+public:
+    WorkerThreadPool() = default;
+    ~WorkerThreadPool();
+
+    WorkerThreadPool(const WorkerThreadPool& other) = delete;
+    WorkerThreadPool& operator=(const WorkerThreadPool& other) = delete;
+    WorkerThreadPool(WorkerThreadPool&& other) noexcept = delete;
+    WorkerThreadPool& operator=(WorkerThreadPool&& other) noexcept = delete;
+
+    void Start(uint32_t workersCount) noexcept;
+    void Stop() noexcept;
+
+    // Calls job for every index in [0, jobsCount) and blocks until all of them are completed. Not reentrant
+    void Execute(uint32_t jobsCount, const JobFunc& job) noexcept;
+
+    uint32_t GetWorkersCount() const noexcept { return static_cast<uint32_t>(m_workers.size()); }
+
+private:
+    void WorkerLoop() noexcept;
+    void RunJobs(const JobFunc& job, uint32_t jobsCount) noexcept;
+
+private:
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobsCV;
+    std::condition_variable m_doneCV;
+
+    const JobFunc* m_pJob = nullptr;
+    uint32_t m_jobsCount = 0;
+    
+    std::atomic<uint32_t> m_nextJobIndex { 0 };
+    std::atomic<uint32_t> m_completedJobsCount { 0 };
+    
+    uint64_t m_batchIndex = 0;
+    uint32_t m_activeWorkersCount = 0;
+
+    bool m_isStopped = true;
+};
@@ -0,0 +1,45 @@
+#include "pch.h"
+#include "fixed_timestep.h"
+
+#include "utils/debug/assertion.h"
+
+#include <cmath>
+
+
+void FixedTimestepScheduler::SetTickRate(double ticksPerSec) noexcept
+{
+    ENG_ASSERT(ticksPerSec > 0.0, "Invalid simulation tick rate: {}", ticksPerSec);
+
+    m_tickRate = ticksPerSec;
+    m_stepTimeSec = 1.0 / ticksPerSec;
+    m_accumulatorSec = 0.0;
+}
+
+
+uint32_t FixedTimestepScheduler::Advance(double frameTimeSec) noexcept
+{
+    m_accumulatorSec += std::max(frameTimeSec, 0.0);
+
+    uint32_t stepsCount = static_cast<uint32_t>(std::floor(m_accumulatorSec / m_stepTimeSec));
+
+    if (m_maxStepsPerFrame > 0 && stepsCount > m_maxStepsPerFrame) {
+        const double droppedTimeSec = (stepsCount - m_maxStepsPerFrame) * m_stepTimeSec;
+        
+        m_accumulatorSec -= droppedTimeSec;
+        m_totalDroppedTimeSec += droppedTimeSec;
+
+        stepsCount = m_maxStepsPerFrame;
+    }
+
+    m_accumulatorSec -= stepsCount * m_stepTimeSec;
+    m_totalStepsCount += stepsCount;
+
+    return stepsCount;
+}
+
+
+float FixedTimestepScheduler::GetInterpolationAlpha() const noexcept
+{
+    // Accumulator stays below the step, but the ratio may still round up to 1 in float
+    return std::clamp(static_cast<float>(m_accumulatorSec / m_stepTimeSec), 0.f, std::nextafter(1.f, 0.f));
+}
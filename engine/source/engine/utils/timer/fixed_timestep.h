@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Splits variable frame time into fixed simulation steps. Leftover time is kept in the accumulator
+// and exposed as interpolation alpha between the last two simulated states
+class FixedTimestepScheduler
+{
+public:
+    FixedTimestepScheduler() = default;
+
+    void SetTickRate(double ticksPerSec) noexcept;
+    double GetTickRate() const noexcept { return m_tickRate; }
+
+    // 0 - unlimited. Time that doesn't fit into the max steps count is dropped (simulation slows down
+    // instead of spiraling when a single step costs more than its duration)
+    void SetMaxStepsPerFrame(uint32_t stepsCount) noexcept { m_maxStepsPerFrame = stepsCount; }
+    uint32_t GetMaxStepsPerFrame() const noexcept { return m_maxStepsPerFrame; }
+
+    // Adds frame time to accumulator and returns the number of fixed steps to simulate this frame
+    uint32_t Advance(double frameTimeSec) noexcept;
+
+    double GetStepTimeInSec() const noexcept { return m_stepTimeSec; }
+
+    // Share of the step accumulated after the last simulated one, in [0, 1)
+    float GetInterpolationAlpha() const noexcept;
+
+    uint64_t GetTotalStepsCount() const noexcept { return m_totalStepsCount; }
+    double GetTotalDroppedTimeInSec() const noexcept { return m_totalDroppedTimeSec; }
+
+private:
+    double m_tickRate = 60.0;
+    double m_stepTimeSec = 1.0 / 60.0;
+
+    double m_accumulatorSec = 0.0;
+    double m_totalDroppedTimeSec = 0.0;
+
+    uint64_t m_totalStepsCount = 0;
+
+    uint32_t m_maxStepsPerFrame = 5;
+};
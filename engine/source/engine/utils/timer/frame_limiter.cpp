@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "frame_limiter.h"
+
+#include <thread>
+#include <cmath>
+
+
+namespace chr = std::chrono;
+
+
+static constexpr chr::milliseconds SLEEP_QUANTUM(1);
+
+
+FrameLimiter::FrameLimiter()
+    : m_frameDeadline(chr::steady_clock::now()),
+    m_targetFrameDuration(chr::steady_clock::duration::zero())
+{
+}
+
+
+void FrameLimiter::SetTargetFPS(uint32_t fps) noexcept
+{
+    m_targetFPS = fps;
+
+    m_targetFrameDuration = fps > 0 ?
+        chr::duration_cast<chr::steady_clock::duration>(chr::duration<double>(1.0 / fps)) : chr::steady_clock::duration::zero();
+
+    m_frameDeadline = chr::steady_clock::now() + m_targetFrameDuration;
+}
+
+
+void FrameLimiter::Wait() noexcept
+{
+    m_lastSleepTimeSec = 0.0;
+
+    if (!IsEnabled()) {
+        return;
+    }
+
+    const chr::steady_clock::time_point now = chr::steady_clock::now();
+
+    if (now < m_frameDeadline) {
+        PreciseSleep(chr::duration<double>(m_frameDeadline - now).count());
+
+        // Spin the rest of the frame
+        while (chr::steady_clock::now() < m_frameDeadline) {
+            std::this_thread::yield();
+        }
+
+        m_frameDeadline += m_targetFrameDuration;
+    } else {
+        // Frame took longer than target. Don't try to catch up, start pacing from the current moment
+        m_frameDeadline = now + m_targetFrameDuration;
+    }
+}
+
+
+void FrameLimiter::PreciseSleep(double seconds) noexcept
+{
+    while (seconds > m_sleepEstimateSec) {
+        const chr::steady_clock::time_point sleepStart = chr::steady_clock::now();
+        std::this_thread::sleep_for(SLEEP_QUANTUM);
+        const double sleepTime = chr::duration<double>(chr::steady_clock::now() - sleepStart).count();
+
+        seconds -= sleepTime;
+        m_lastSleepTimeSec += sleepTime;
+
+        ++m_sleepSamplesCount;
+        const double delta = sleepTime - m_sleepMeanSec;
+        m_sleepMeanSec += delta / m_sleepSamplesCount;
+        m_sleepM2 += delta * (sleepTime - m_sleepMeanSec);
+
+        const double sleepStdDev = std::sqrt(m_sleepM2 / (m_sleepSamplesCount - 1));
+        m_sleepEstimateSec = m_sleepMeanSec + sleepStdDev;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+
+#include <cstdint>
+
+
+// Caps frame rate with hybrid sleep/spin waiting. OS sleep is used while remaining time is greater than
+// estimated sleep overshoot, rest of the frame is busy-waited to hit the deadline precisely
+class FrameLimiter
+{
+public:
+    FrameLimiter();
+
+    void SetTargetFPS(uint32_t fps) noexcept;
+    uint32_t GetTargetFPS() const noexcept { return m_targetFPS; }
+
+    // Blocks until target frame duration since previous Wait() call is reached
+    void Wait() noexcept;
+
+    // Time spent in OS sleep during the last Wait() call. Spinning is not included
+    double GetLastSleepTimeInSec() const noexcept { return m_lastSleepTimeSec; }
+
+    bool IsEnabled() const noexcept { return m_targetFPS > 0; }
+
+private:
+    void PreciseSleep(double seconds) noexcept;
+
+private:
+    std::chrono::steady_clock::time_point m_frameDeadline;
+    std::chrono::steady_clock::duration   m_targetFrameDuration;
+
+    double m_lastSleepTimeSec = 0.0;
+
+    // Running estimation of a single short OS sleep duration (Welford's algorithm)
+    double   m_sleepEstimateSec = 5e-3;
+    double   m_sleepMeanSec = 5e-3;
+    double   m_sleepM2 = 0.0;
+    uint64_t m_sleepSamplesCount = 1;
+
+    uint32_t m_targetFPS = 0;
+};
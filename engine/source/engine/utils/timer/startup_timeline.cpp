@@ -0,0 +1,85 @@
+#include "pch.h"
+#include "startup_timeline.h"
+
+#include "utils/debug/assertion.h"
+
+#include <mutex>
+#include <thread>
+
+
+namespace chr = std::chrono;
+
+
+struct StartupStage
+{
+    const char* pName;
+    
+    chr::steady_clock::time_point startTime;
+    chr::steady_clock::time_point endTime;
+
+    std::thread::id threadID;
+};
+
+
+static std::mutex timelineMutex;
+static std::vector<StartupStage> timelineStages;
+static chr::steady_clock::time_point timelineOrigin = chr::steady_clock::now();
+static std::thread::id timelineOwnerThreadID;
+
+
+static double GetDurationInMillisec(const chr::steady_clock::time_point& A, const chr::steady_clock::time_point& B) noexcept
+{
+    return chr::duration<double, std::milli>(B - A).count();
+}
+
+
+void StartupTimeline::Begin() noexcept
+{
+    std::scoped_lock lock(timelineMutex);
+
+    timelineStages.clear();
+    timelineOrigin = chr::steady_clock::now();
+    timelineOwnerThreadID = std::this_thread::get_id();
+}
+
+
+void StartupTimeline::AddStage(const char* pName, const chr::steady_clock::time_point& startTime, const chr::steady_clock::time_point& endTime) noexcept
+{
+    std::scoped_lock lock(timelineMutex);
+    timelineStages.emplace_back(StartupStage { pName, startTime, endTime, std::this_thread::get_id() });
+}
+
+
+void StartupTimeline::LogReport() noexcept
+{
+    std::scoped_lock lock(timelineMutex);
+
+    std::sort(timelineStages.begin(), timelineStages.end(), [](const StartupStage& left, const StartupStage& right) {
+        return left.startTime < right.startTime;
+    });
+
+    chr::steady_clock::time_point timelineEnd = timelineOrigin;
+
+    ENG_LOG_INFO("Startup timeline (start ms | duration ms | thread | stage):");
+
+    for (const StartupStage& stage : timelineStages) {
+        ENG_LOG_INFO("    {} | {} | {} | {}", GetDurationInMillisec(timelineOrigin, stage.startTime), GetDurationInMillisec(stage.startTime, stage.endTime),
+            stage.threadID == timelineOwnerThreadID ? "main" : "worker", stage.pName);
+        
+        timelineEnd = std::max(timelineEnd, stage.endTime);
+    }
+
+    ENG_LOG_INFO("Startup total: {} ms", GetDurationInMillisec(timelineOrigin, timelineEnd));
+}
+
+
+StartupTimelineScopedStage::StartupTimelineScopedStage(const char* pName)
+    : m_startTime(chr::steady_clock::now()), m_pName(pName)
+{
+}
+
+
+StartupTimelineScopedStage::~StartupTimelineScopedStage()
+{
+    StartupTimeline::AddStage(m_pName, m_startTime, chr::steady_clock::now());
+}
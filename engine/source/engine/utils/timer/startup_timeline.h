@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+
+
+// Collects durations of engine startup stages (possibly from several threads) and reports them as a timeline
+class StartupTimeline
+{
+public:
+    // Resets collected stages and sets the timeline origin
+    static void Begin() noexcept;
+    
+    static void AddStage(const char* pName, const std::chrono::steady_clock::time_point& startTime, 
+        const std::chrono::steady_clock::time_point& endTime) noexcept;
+
+    static void LogReport() noexcept;
+};
+
+
+class StartupTimelineScopedStage
+{
+public:
+    StartupTimelineScopedStage(const char* pName);
+    ~StartupTimelineScopedStage();
+
+    StartupTimelineScopedStage(const StartupTimelineScopedStage& other) = delete;
+    StartupTimelineScopedStage& operator=(const StartupTimelineScopedStage& other) = delete;
+
+private:
+    std::chrono::steady_clock::time_point m_startTime;
+    const char* m_pName = nullptr;
+};
@@ -1,6 +1,12 @@
 #include "pch.h"
 #include "timer.h"
 
+#if defined(ENG_OS_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#endif
+
 
 namespace chr = std::chrono;
 
@@ -49,3 +55,23 @@ double Timer::GetDeltaTimeInMillisec() const noexcept
 {
     return GetDuration<chr::milliseconds>(m_prevTime, m_curTime);
 }
+
+
+double engGetProcessCPUTimeInSec() noexcept
+{
+    FILETIME creationTime = {};
+    FILETIME exitTime = {};
+    FILETIME kernelTime = {};
+    FILETIME userTime = {};
+
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0.0;
+    }
+
+    const auto toTicks = [](const FILETIME& time) -> uint64_t {
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+
+    // FILETIME is in 100 ns units
+    return (toTicks(kernelTime) + toTicks(userTime)) * 100e-9;
+}
\ No newline at end of file
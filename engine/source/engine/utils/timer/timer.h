@@ -21,4 +21,9 @@ private:
     
     std::chrono::steady_clock::time_point m_prevTime;
     std::chrono::steady_clock::time_point m_curTime;
-};
\ No newline at end of file
+};
+
+
+// User and kernel time consumed by all threads of the process. Divided by wall time it gives CPU load in cores,
+// which includes driver threads the main loop can't see
+double engGetProcessCPUTimeInSec() noexcept;
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <registers_common.fx>
+#include <common_math.fx>
+
+
+// Octahedral mapping of unit vector to [-1, 1] square
+vec2 OctEncode(in vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+
+    if (n.z < 0.f) {
+        const vec2 signs = vec2(n.x >= 0.f ? 1.f : -1.f, n.y >= 0.f ? 1.f : -1.f);
+        n.xy = (1.f - abs(n.yx)) * signs;
+    }
+
+    return n.xy;
+}
+
+
+vec3 OctDecode(in vec2 e)
+{
+    vec3 n = vec3(e, 1.f - abs(e.x) - abs(e.y));
+
+    const float t = max(-n.z, 0.f);
+    n.x += n.x >= 0.f ? -t : t;
+    n.y += n.y >= 0.f ? -t : t;
+
+    return normalize(n);
+}
+
+
+// RG16 is unsigned, so encoded normal is remapped to [0, 1]
+vec2 EncodeGBufferNormal(in vec3 n)
+{
+    return OctEncode(n) * 0.5f + 0.5f;
+}
+
+
+vec3 DecodeGBufferNormal(in vec2 encoded)
+{
+    return OctDecode(encoded * 2.f - 1.f);
+}
+
+
+// 6 bits of roughness and 2 bits of metalness share albedo alpha channel
+float PackRoughnessMetalness(in float roughness, in float metalness)
+{
+    const float packed = round(clamp(roughness, 0.f, 1.f) * 63.f) * 4.f + round(clamp(metalness, 0.f, 1.f) * 3.f);
+    return packed / 255.f;
+}
+
+
+vec2 UnpackRoughnessMetalness(in float packed)
+{
+    const float value = round(packed * 255.f);
+    return vec2(floor(value / 4.f) / 63.f, mod(value, 4.f) / 3.f);
+}
+
+
+// Screen UV is in [0, 1] over the framebuffer, not scaled by COMMON_RT_UV_SCALE
+vec3 ReconstructViewPosition(in vec2 screenUV, in float depth)
+{
+#if defined(ENV_INVERTED_Z)
+    // Inverted Z builds set clip depth range to [0, 1]
+    const float ndcZ = depth;
+#else
+    const float ndcZ = depth * 2.f - 1.f;
+#endif
+
+    const vec4 viewPos = TransformVec4(vec4(screenUV * 2.f - 1.f, ndcZ, 1.f), COMMON_INV_PROJ_MATRIX);
+    return viewPos.xyz / viewPos.w;
+}
+
+#endif
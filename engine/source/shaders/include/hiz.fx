@@ -0,0 +1,93 @@
+#ifndef HIZ_H
+#define HIZ_H
+
+#include <registers_common.fx>
+#include <common_math.fx>
+
+
+// Pyramid keeps the farthest depth, so a box nearer than it may still be visible somewhere in the texel
+#if defined(ENV_INVERTED_Z)
+    #define HIZ_FARTHEST(a, b) min(a, b)
+    #define HIZ_NEAREST(a, b) max(a, b)
+#else
+    #define HIZ_FARTHEST(a, b) max(a, b)
+    #define HIZ_NEAREST(a, b) min(a, b)
+#endif
+
+
+float ClipToDepth(in vec4 clipPos)
+{
+#if defined(ENV_INVERTED_Z)
+    // Inverted Z builds set clip depth range to [0, 1]
+    return clipPos.z / clipPos.w;
+#else
+    return clipPos.z / clipPos.w * 0.5f + 0.5f;
+#endif
+}
+
+
+// Level L texel covers 2^(L + 1) framebuffer pixels, texels of odd sized levels edges cover the remainder
+ivec2 GetHiZTexel(in ivec2 pixel, in int level)
+{
+    return min(pixel >> (level + 1), textureSize(COMMON_HIZ_TEX, level) - 1);
+}
+
+
+// Tests world space box against the pyramid of the previous frame. The box is reprojected with the view projection the pyramid was built with,
+// so it's occluded only if it was hidden in the previous frame at its current position. Boxes which were off screen or crossed
+// the near plane can't be tested and are visible
+bool IsOccludedByHiZ(in vec3 boundsMin, in vec3 boundsMax)
+{
+    vec2 ndcMin = vec2(1.f);
+    vec2 ndcMax = vec2(-1.f);
+
+#if defined(ENV_INVERTED_Z)
+    float nearestDepth = 0.f;
+#else
+    float nearestDepth = 1.f;
+#endif
+
+    for (uint i = 0; i < 8; ++i) {
+        const vec3 corner = vec3((i & 1) != 0 ? boundsMax.x : boundsMin.x, (i & 2) != 0 ? boundsMax.y : boundsMin.y, (i & 4) != 0 ? boundsMax.z : boundsMin.z);
+        const vec4 clipPos = TransformVec4(vec4(corner, 1.f), COMMON_HIZ_VIEW_PROJ_MATRIX);
+
+        if (clipPos.w <= 0.f) {
+            return false;
+        }
+
+        const vec2 ndc = clipPos.xy / clipPos.w;
+
+        ndcMin = min(ndcMin, ndc);
+        ndcMax = max(ndcMax, ndc);
+        nearestDepth = HIZ_NEAREST(nearestDepth, ClipToDepth(clipPos));
+    }
+
+    if (any(lessThan(ndcMin, vec2(-1.f))) || any(greaterThan(ndcMax, vec2(1.f)))) {
+        return false;
+    }
+
+    const vec2 screenSize = vec2(COMMON_HIZ_SCREEN_WIDTH, COMMON_HIZ_SCREEN_HEIGHT);
+
+    const ivec2 pixelMin = ivec2(min((ndcMin * 0.5f + 0.5f) * screenSize, screenSize - 1.f));
+    const ivec2 pixelMax = ivec2(min((ndcMax * 0.5f + 0.5f) * screenSize, screenSize - 1.f));
+
+    // Coarsest level where the box spans at most 2x2 texels
+    const int extent = max(max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y), 1);
+    const int level = clamp(int(ceil(log2(float(extent)))) - 1, 0, int(COMMON_HIZ_LEVELS_COUNT) - 1);
+
+    const ivec2 texelMin = GetHiZTexel(pixelMin, level);
+    const ivec2 texelMax = GetHiZTexel(pixelMax, level);
+
+    float farthestDepth = texelFetch(COMMON_HIZ_TEX, texelMin, level).r;
+    farthestDepth = HIZ_FARTHEST(farthestDepth, texelFetch(COMMON_HIZ_TEX, ivec2(texelMax.x, texelMin.y), level).r);
+    farthestDepth = HIZ_FARTHEST(farthestDepth, texelFetch(COMMON_HIZ_TEX, ivec2(texelMin.x, texelMax.y), level).r);
+    farthestDepth = HIZ_FARTHEST(farthestDepth, texelFetch(COMMON_HIZ_TEX, texelMax, level).r);
+
+#if defined(ENV_INVERTED_Z)
+    return nearestDepth < farthestDepth;
+#else
+    return nearestDepth > farthestDepth;
+#endif
+}
+
+#endif
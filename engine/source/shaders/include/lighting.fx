@@ -0,0 +1,107 @@
+#ifndef LIGHTING_H
+#define LIGHTING_H
+
+#include <registers_common.fx>
+#include <common_math.fx>
+
+
+#if defined(ENV_INVERTED_Z)
+    #define DEPTH_CLEAR_VALUE 0.f
+#else
+    #define DEPTH_CLEAR_VALUE 1.f
+#endif
+
+
+#define AMBIENT_INTENSITY 0.03f
+
+
+uint GetClusterSlice(in float viewDepth)
+{
+    const float slice = floor(log(viewDepth) * COMMON_CLUSTER_Z_SCALE + COMMON_CLUSTER_Z_BIAS);
+    return uint(clamp(slice, 0.f, float(COMMON_CLUSTER_Z_SLICES_COUNT - 1)));
+}
+
+
+// View depth of the near bound of the slice. Slice COMMON_CLUSTER_Z_SLICES_COUNT bound is the far plane
+float GetClusterSliceDepth(in uint slice)
+{
+    return COMMON_CLUSTER_Z_NEAR * pow(COMMON_CLUSTER_Z_FAR / COMMON_CLUSTER_Z_NEAR, float(slice) / float(COMMON_CLUSTER_Z_SLICES_COUNT));
+}
+
+
+uint GetClusterIndex(in uvec2 tile, in uint slice)
+{
+    return (slice * COMMON_CLUSTER_GRID_SIZE_Y + tile.y) * COMMON_CLUSTER_GRID_SIZE_X + tile.x;
+}
+
+
+uint GetClusterIndex(in vec2 fragCoord, in float viewDepth)
+{
+    return GetClusterIndex(uvec2(fragCoord) / COMMON_CLUSTER_TILE_SIZE, GetClusterSlice(viewDepth));
+}
+
+
+bool IsSphereIntersectsAABB(in vec4 sphere, in vec3 aabbMin, in vec3 aabbMax)
+{
+    const vec3 closestPoint = clamp(sphere.xyz, aabbMin, aabbMax);
+    const vec3 offset = closestPoint - sphere.xyz;
+
+    return dot(offset, offset) <= sphere.w * sphere.w;
+}
+
+
+// Lambert diffuse and normalized Blinn-Phong specular. Distance falloff is inverse square windowed to reach zero at the light range
+vec3 EvaluateLight(in COMMON_LIGHT_DATA light, in vec3 viewPos, in vec3 N, in vec3 V, in vec3 albedo, in float roughness, in float metalness)
+{
+    const vec3 toLight = light.COMMON_LIGHT_POSITION_RANGE.xyz - viewPos;
+    const float distSqr = dot(toLight, toLight);
+    const float range = light.COMMON_LIGHT_POSITION_RANGE.w;
+
+    if (distSqr >= range * range) {
+        return ZEROF3;
+    }
+
+    const vec3 L = toLight * inversesqrt(distSqr);
+    const float NdotL = dot(N, L);
+
+    if (NdotL <= 0.f) {
+        return ZEROF3;
+    }
+
+    const float distRatio = distSqr / (range * range);
+    const float window = clamp(1.f - distRatio * distRatio, 0.f, 1.f);
+    const float distAttenuation = window * window / (distSqr + 1.f);
+
+    const float cosAngle = dot(-L, light.COMMON_LIGHT_DIRECTION_SPOT_SCALE.xyz);
+    const float spotAttenuation = clamp(cosAngle * light.COMMON_LIGHT_DIRECTION_SPOT_SCALE.w + light.COMMON_LIGHT_COLOR_SPOT_OFFSET.w, 0.f, 1.f);
+
+    const vec3 H = normalize(L + V);
+    const float shininess = exp2(10.f * (1.f - roughness) + 1.f);
+    const float specular = (shininess + 8.f) / (8.f * M_PI) * pow(max(dot(N, H), 0.f), shininess);
+
+    const vec3 specularColor = lerp(vec3(0.04f), albedo, metalness);
+    const vec3 diffuseColor = albedo * (1.f - metalness);
+
+    const vec3 radiance = light.COMMON_LIGHT_COLOR_SPOT_OFFSET.rgb * (distAttenuation * spotAttenuation * NdotL);
+
+    return radiance * (diffuseColor / M_PI + specularColor * specular);
+}
+
+
+// Shades only lights of the cluster the fragment belongs to, so the cost doesn't depend on total lights count
+vec3 EvaluateClusteredLighting(in vec2 fragCoord, in vec3 viewPos, in vec3 N, in vec3 albedo, in float roughness, in float metalness)
+{
+    const COMMON_CLUSTER_DATA cluster = COMMON_CLUSTERS[GetClusterIndex(fragCoord, -viewPos.z)];
+    const vec3 V = normalize(-viewPos);
+
+    vec3 color = albedo * AMBIENT_INTENSITY;
+
+    for (uint i = 0; i < cluster.COMMON_CLUSTER_LIGHTS_COUNT; ++i) {
+        const uint lightIdx = COMMON_CLUSTER_LIGHT_INDICES[cluster.COMMON_CLUSTER_LIGHTS_OFFSET + i];
+        color += EvaluateLight(COMMON_LIGHTS[lightIdx], viewPos, N, V, albedo, roughness, metalness);
+    }
+
+    return color;
+}
+
+#endif
@@ -16,6 +16,172 @@ DECLARE_SRV_TEXTURE(sampler2D, COMMON_COLOR_TEX, 4, TEXTURE_FORMAT_RGBA16F, COMM
 
 DECLARE_SRV_TEXTURE(sampler2D, TEST_TEXTURE, 4, TEXTURE_FORMAT_RGBA8, COMMON_SMP_REPEAT_NEAREST_IDX);
 
+// Compact layout, used instead of the above targets in ENV_GBUFFER_COMPACT builds. Albedo alpha holds packed roughness and metalness,
+// normal is octahedral encoded, specular target is dropped and view position is reconstructed from COMMON_DEPTH_TEX
+DECLARE_SRV_TEXTURE(sampler2D, GBUFFER_COMPACT_ALBEDO_TEX, 0, TEXTURE_FORMAT_RGBA8, COMMON_SMP_CLAMP_LINEAR_IDX);
+DECLARE_SRV_TEXTURE(sampler2D, GBUFFER_COMPACT_NORMAL_TEX, 1, TEXTURE_FORMAT_RG16, COMMON_SMP_CLAMP_LINEAR_IDX);
+DECLARE_SRV_TEXTURE(sampler2D, COMMON_COMPACT_COLOR_TEX, 4, TEXTURE_FORMAT_R11G11B10F, COMMON_SMP_CLAMP_LINEAR_IDX);
+
+// Screen UV offset from the previous frame position to the current one, without projection jitter. Written by the GBuffer pass in both layouts
+DECLARE_SRV_TEXTURE(sampler2D, GBUFFER_MOTION_TEX, 6, TEXTURE_FORMAT_RG16F, COMMON_SMP_CLAMP_NEAREST_IDX);
+
+
+// Farthest depth of the previous level texels. Level 0 is built from COMMON_DEPTH_TEX at half of the framebuffer resolution.
+// The pyramid outlives the frame, occlusion culling of the next frame tests instance bounds against it
+DECLARE_SRV_TEXTURE(sampler2D, COMMON_HIZ_TEX, 5, TEXTURE_FORMAT_R32F, COMMON_SMP_CLAMP_MIP_NEAREST_IDX);
+DECLARE_UAV_TEXTURE(image2D, COMMON_HIZ_UAV, 0, TEXTURE_FORMAT_R32F);
+
+
+// Accumulated color at the framebuffer resolution. Two textures are swapped every frame: the previous one is sampled,
+// the current one is written by the temporal upscale pass and presented
+DECLARE_SRV_TEXTURE(sampler2D, COMMON_TEMPORAL_HISTORY_TEX, 7, TEXTURE_FORMAT_RGBA16F, COMMON_SMP_CLAMP_LINEAR_IDX);
+DECLARE_UAV_TEXTURE(image2D, COMMON_TEMPORAL_OUTPUT_UAV, 1, TEXTURE_FORMAT_RGBA16F);
+
+
+// Visibility buffer, alternative to the GBuffer targets. R is the instance index, G is the triangle index within its mesh.
+// The target isn't cleared, background pixels are found by COMMON_DEPTH_TEX. Integer textures must be sampled with nearest filtering
+DECLARE_SRV_TEXTURE(usampler2D, COMMON_VISIBILITY_TEX, 8, TEXTURE_FORMAT_RG32UI, COMMON_SMP_CLAMP_NEAREST_IDX);
+
+
+DECLARE_STRUCT(COMMON_INSTANCE_DATA)
+{
+    vec4 COMMON_INSTANCE_WORLD_MATRIX[3];
+    // World space bounding box. Min corner W is zero for instances which are never occlusion culled
+    vec4 COMMON_INSTANCE_BOUNDS_MIN;
+    vec4 COMMON_INSTANCE_BOUNDS_MAX;
+    uint COMMON_INSTANCE_MATERIAL_IDX;
+    // Instanced batch drawing the instance, indexes COMMON_DRAW_INDIRECT_ARGS
+    uint COMMON_INSTANCE_BATCH_IDX;
+    // Mesh location in COMMON_VISIBILITY_INDICES and COMMON_VISIBILITY_VERTICES, visibility resolve pass fetches triangles by them
+    uint COMMON_INSTANCE_FIRST_INDEX;
+    uint COMMON_INSTANCE_BASE_VERTEX;
+};
+
+
+// Vertex attributes packed into two vec4, UV is split between their W components
+DECLARE_STRUCT(COMMON_VISIBILITY_VERTEX)
+{
+    vec4 COMMON_VISIBILITY_POSITION_U;
+    vec4 COMMON_VISIBILITY_NORMAL_V;
+};
+
+
+// Matches DrawElementsIndirectCommand layout
+DECLARE_STRUCT(COMMON_DRAW_INDIRECT_ARGS_DATA)
+{
+    uint COMMON_DRAW_INDEX_COUNT;
+    uint COMMON_DRAW_INSTANCE_COUNT;
+    uint COMMON_DRAW_FIRST_INDEX;
+    int  COMMON_DRAW_BASE_VERTEX;
+    uint COMMON_DRAW_BASE_INSTANCE;
+};
+
+
+DECLARE_STRUCT(COMMON_OCCLUSION_COUNTERS)
+{
+    uint COMMON_OCCLUSION_CULLED_COUNT;
+};
+
+
+DECLARE_SRV_STRUCTURED_BUFFER(COMMON_INSTANCE_DATA_SB, 0)
+{
+    COMMON_INSTANCE_DATA COMMON_INSTANCES[];
+};
+
+
+// Written by the occlusion culling pass. Indices of visible instances of a batch are packed starting from its base instance,
+// geometry passes fetch instance data through them
+DECLARE_UAV_STRUCTURED_BUFFER(COMMON_VISIBLE_INSTANCES_UAV, 5)
+{
+    uint COMMON_VISIBLE_INSTANCES[];
+};
+
+
+// Indirect args of the frame batches. Instance counts are zero until occlusion culling counts visible instances
+DECLARE_UAV_STRUCTURED_BUFFER(COMMON_DRAW_INDIRECT_ARGS_UAV, 6)
+{
+    COMMON_DRAW_INDIRECT_ARGS_DATA COMMON_DRAW_INDIRECT_ARGS[];
+};
+
+
+DECLARE_UAV_STRUCTURED_BUFFER(COMMON_OCCLUSION_COUNTERS_UAV, 7)
+{
+    COMMON_OCCLUSION_COUNTERS COMMON_OCCLUSION_COUNTERS_DATA;
+};
+
+
+// Vertices and indices of all meshes in shared buffers, so that the visibility resolve pass reaches any triangle from a fullscreen draw.
+// Indices are relative to the mesh base vertex
+DECLARE_SRV_STRUCTURED_BUFFER(COMMON_VISIBILITY_VERTICES_SB, 8)
+{
+    COMMON_VISIBILITY_VERTEX COMMON_VISIBILITY_VERTICES[];
+};
+
+
+DECLARE_SRV_STRUCTURED_BUFFER(COMMON_VISIBILITY_INDICES_SB, 9)
+{
+    uint COMMON_VISIBILITY_INDICES[];
+};
+
+
+// Clusters are COMMON_CLUSTER_TILE_SIZE pixels wide screen tiles split into exponentially distributed view depth slices
+DECLARE_CONSTANT(uint, COMMON_CLUSTER_TILE_SIZE, 64);
+DECLARE_CONSTANT(uint, COMMON_CLUSTER_Z_SLICES_COUNT, 24);
+// Lights affecting one cluster above this count are dropped
+DECLARE_CONSTANT(uint, COMMON_CLUSTER_MAX_LIGHTS_COUNT, 256);
+
+
+// Positions and directions are in view space. Spot cone falloff is saturate(cos * scale + offset),
+// point lights have zero scale and unit offset. Bounding sphere encloses light volume and is used for culling only
+DECLARE_STRUCT(COMMON_LIGHT_DATA)
+{
+    vec4 COMMON_LIGHT_POSITION_RANGE;
+    vec4 COMMON_LIGHT_BOUNDING_SPHERE;
+    vec4 COMMON_LIGHT_DIRECTION_SPOT_SCALE;
+    vec4 COMMON_LIGHT_COLOR_SPOT_OFFSET;
+};
+
+
+DECLARE_STRUCT(COMMON_CLUSTER_DATA)
+{
+    uint COMMON_CLUSTER_LIGHTS_OFFSET;
+    uint COMMON_CLUSTER_LIGHTS_COUNT;
+};
+
+
+DECLARE_STRUCT(COMMON_CLUSTER_COUNTERS)
+{
+    uint COMMON_CLUSTER_LIGHT_INDICES_COUNT;
+    uint COMMON_CLUSTER_LIT_COUNT;
+    uint COMMON_CLUSTER_MAX_LIGHTS_PER_CLUSTER;
+    uint COMMON_CLUSTER_OVERFLOWS_COUNT;
+};
+
+
+DECLARE_SRV_STRUCTURED_BUFFER(COMMON_LIGHTS_SB, 1)
+{
+    COMMON_LIGHT_DATA COMMON_LIGHTS[];
+};
+
+
+// Written by the light culling pass, read by the lighting pass
+DECLARE_UAV_STRUCTURED_BUFFER(COMMON_CLUSTERS_UAV, 2)
+{
+    COMMON_CLUSTER_DATA COMMON_CLUSTERS[];
+};
+
+
+DECLARE_UAV_STRUCTURED_BUFFER(COMMON_CLUSTER_LIGHT_INDICES_UAV, 3)
+{
+    uint COMMON_CLUSTER_LIGHT_INDICES[];
+};
+
+
+DECLARE_UAV_STRUCTURED_BUFFER(COMMON_CLUSTER_COUNTERS_UAV, 4)
+{
+    COMMON_CLUSTER_COUNTERS COMMON_CLUSTER_COUNTERS_DATA;
+};
+
 
 DECLARE_CBV(COMMON_DYN_CB, 0)
 {
@@ -23,6 +189,10 @@ DECLARE_CBV(COMMON_DYN_CB, 0)
     float COMMON_SCREEN_HEIGHT;
     float COMMON_ELAPSED_TIME;
     float COMMON_DELTA_TIME;
+
+    // Render targets are pooled with padding, screen UVs must be scaled to sample them
+    vec2  COMMON_RT_UV_SCALE;
+    vec2  _PAD2;
 };
 
 
@@ -30,11 +200,74 @@ DECLARE_CBV(COMMON_CAMERA_CB, 1)
 {
     vec4  COMMON_VIEW_PROJ_MATRIX[4];
     vec4  COMMON_PROJ_MATRIX[4];
+    vec4  COMMON_INV_PROJ_MATRIX[4];
     vec4  COMMON_VIEW_MATRIX[3];
 
+    // Previous frame view projection, geometry is assumed static, so motion comes from the camera only
+    vec4  COMMON_PREV_VIEW_PROJ_MATRIX[4];
+
     float COMMON_VIEW_Z_NEAR;
     float COMMON_VIEW_Z_FAR;
+
+    // Sub-pixel NDC offsets baked into the current and previous projections, zero while temporal upscaling is disabled
+    vec2  COMMON_PROJ_JITTER;
+    vec2  COMMON_PREV_PROJ_JITTER;
     vec2  _PAD1;
 };
 
+
+DECLARE_CBV(COMMON_CLUSTERS_CB, 2)
+{
+    uint  COMMON_CLUSTER_GRID_SIZE_X;
+    uint  COMMON_CLUSTER_GRID_SIZE_Y;
+    uint  COMMON_LIGHTS_COUNT;
+    uint  COMMON_CLUSTER_LIGHT_INDICES_CAPACITY;
+
+    // Slice of positive view depth d is floor(log(d) * COMMON_CLUSTER_Z_SCALE + COMMON_CLUSTER_Z_BIAS).
+    // Near and far are view depths of the first and the last slices bounds, they are not swapped in inverted Z builds
+    float COMMON_CLUSTER_Z_SCALE;
+    float COMMON_CLUSTER_Z_BIAS;
+    float COMMON_CLUSTER_Z_NEAR;
+    float COMMON_CLUSTER_Z_FAR;
+};
+
+
+DECLARE_CBV(COMMON_OCCLUSION_CB, 3)
+{
+    // View projection of the frame COMMON_HIZ_TEX was built in. Bounds are reprojected with it into the previous frame depth
+    vec4  COMMON_HIZ_VIEW_PROJ_MATRIX[4];
+
+    // Framebuffer size the pyramid was built for
+    float COMMON_HIZ_SCREEN_WIDTH;
+    float COMMON_HIZ_SCREEN_HEIGHT;
+    uint  COMMON_HIZ_LEVELS_COUNT;
+    // Zero while there is no pyramid of the previous frame or culling is disabled, all instances are visible then
+    uint  COMMON_OCCLUSION_CULLING_ENABLED;
+
+    uint  COMMON_OCCLUSION_INSTANCES_COUNT;
+    uint  _PAD3;
+    vec2  _PAD4;
+};
+
+
+DECLARE_CBV(COMMON_TEMPORAL_CB, 4)
+{
+    // Maps current frame clip position to the previous frame one, both jittered. Reprojects background, which has no motion vectors
+    vec4  COMMON_TEMPORAL_REPROJECTION_MATRIX[4];
+
+    // Zero on the first frame after history creation or re-enabling, the current frame is output as is then
+    uint  COMMON_TEMPORAL_HISTORY_VALID;
+    uint  _PAD5;
+    vec2  _PAD6;
+};
+
+
+DECLARE_CBV(COMMON_HIZ_CB, 5)
+{
+    // Level of COMMON_HIZ_UAV written by the Hi-Z downsample dispatch, it reduces the previous level of COMMON_HIZ_TEX
+    uint  COMMON_HIZ_DST_LEVEL;
+    uint  _PAD7;
+    vec2  _PAD8;
+};
+
 #endif
\ No newline at end of file
@@ -80,6 +80,8 @@ DECLARE_CONSTANT(uint, TEXTURE_FORMAT_STENCIL16, 50);
 DECLARE_CONSTANT(uint, TEXTURE_FORMAT_DEPTH24_STENCIL8, 51);
 DECLARE_CONSTANT(uint, TEXTURE_FORMAT_DEPTH32_STENCIL8, 52);
 
-DECLARE_CONSTANT(uint, TEXTURE_FORMAT_COUNT, 53);
+DECLARE_CONSTANT(uint, TEXTURE_FORMAT_R11G11B10F, 53);
+
+DECLARE_CONSTANT(uint, TEXTURE_FORMAT_COUNT, 54);
 
 #endif
\ No newline at end of file
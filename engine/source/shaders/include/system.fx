@@ -14,10 +14,27 @@
     layout(binding = BINDING) uniform TYPE NAME
 
 
+// Storage images are write only, so they don't need format layout qualifier. FORMAT is reflected to bind image units
+#define DECLARE_UAV_TEXTURE(TYPE, NAME, BINDING, FORMAT) \
+    layout(binding = BINDING) writeonly uniform TYPE NAME
+
+
 #define DECLARE_CBV(NAME, BINDING) \
     layout(std140, binding = BINDING) uniform NAME
 
 
+#define DECLARE_SRV_STRUCTURED_BUFFER(NAME, BINDING) \
+    layout(std430, binding = BINDING) readonly buffer NAME
+
+
+#define DECLARE_UAV_STRUCTURED_BUFFER(NAME, BINDING) \
+    layout(std430, binding = BINDING) buffer NAME
+
+
+#define DECLARE_STRUCT(NAME) \
+    struct NAME
+
+
 #define REFLECT_INCLUDE(NAME)
 
 
@@ -0,0 +1,31 @@
+#ifndef TEMPORAL_H
+#define TEMPORAL_H
+
+#include <registers_common.fx>
+#include <common_math.fx>
+
+
+// Screen UV offset from the previous frame position to the current one. Jitter of both frames is removed,
+// so static pixels have zero motion while the projection is shifted every frame
+vec2 ComputeMotionVector(in vec4 currClipPos, in vec4 prevClipPos)
+{
+    const vec2 currNDC = currClipPos.xy / currClipPos.w - COMMON_PROJ_JITTER;
+    const vec2 prevNDC = prevClipPos.xy / prevClipPos.w - COMMON_PREV_PROJ_JITTER;
+
+    return (currNDC - prevNDC) * 0.5f;
+}
+
+
+// Accumulation happens on compressed color, so that single bright samples don't dominate the neighbourhood and flicker
+vec3 CompressTemporalColor(in vec3 color)
+{
+    return color / (1.f + max(color.r, max(color.g, color.b)));
+}
+
+
+vec3 DecompressTemporalColor(in vec3 color)
+{
+    return color / max(1.f - max(color.r, max(color.g, color.b)), 1e-4f);
+}
+
+#endif
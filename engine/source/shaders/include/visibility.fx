@@ -0,0 +1,80 @@
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+
+#include <registers_common.fx>
+#include <common_math.fx>
+
+
+// Attributes of the surface point a visibility buffer pixel sees, interpolated from the vertices of its triangle
+struct VisibilitySurface
+{
+    vec3 worldPos;
+    vec3 worldNormal;
+    vec2 texCoords;
+};
+
+
+float Cross2(in vec2 a, in vec2 b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+
+// Barycentrics of the pixel at ndc within the triangle given by clip positions. Screen space weights are perspective corrected,
+// so attributes are interpolated the same way the rasterizer does it
+vec3 ComputeVisibilityBarycentrics(in vec4 clipPos0, in vec4 clipPos1, in vec4 clipPos2, in vec2 ndc)
+{
+    const vec3 invW = 1.f / vec3(clipPos0.w, clipPos1.w, clipPos2.w);
+
+    const vec2 ndc0 = clipPos0.xy * invW.x;
+    const vec2 ndc1 = clipPos1.xy * invW.y;
+    const vec2 ndc2 = clipPos2.xy * invW.z;
+
+    const vec2 edge1 = ndc1 - ndc0;
+    const vec2 edge2 = ndc2 - ndc0;
+    const vec2 offset = ndc - ndc0;
+
+    // Rasterized triangles are never degenerate in screen space
+    const float invArea = 1.f / Cross2(edge1, edge2);
+
+    const float b1 = Cross2(offset, edge2) * invArea;
+    const float b2 = Cross2(edge1, offset) * invArea;
+
+    const vec3 perspectiveWeights = vec3(1.f - b1 - b2, b1, b2) * invW;
+    return perspectiveWeights / (perspectiveWeights.x + perspectiveWeights.y + perspectiveWeights.z);
+}
+
+
+// Fetches triangle of the instance from the shared geometry buffers and interpolates its attributes at ndc
+VisibilitySurface ReconstructVisibilitySurface(in uvec2 visibility, in vec2 ndc)
+{
+    const COMMON_INSTANCE_DATA instance = COMMON_INSTANCES[visibility.x];
+    const uint firstIndex = instance.COMMON_INSTANCE_FIRST_INDEX + visibility.y * 3;
+
+    vec3 worldPos[3];
+    vec4 clipPos[3];
+    vec3 normals[3];
+    vec2 texCoords[3];
+
+    for (uint i = 0; i < 3; ++i) {
+        const uint vertexIdx = instance.COMMON_INSTANCE_BASE_VERTEX + COMMON_VISIBILITY_INDICES[firstIndex + i];
+        const COMMON_VISIBILITY_VERTEX vertex = COMMON_VISIBILITY_VERTICES[vertexIdx];
+
+        // Transformed exactly like the visibility pass vertex shader does, so the pixel lies within the triangle
+        worldPos[i] = TransformVec3(vec4(vertex.COMMON_VISIBILITY_POSITION_U.xyz, 1.f), instance.COMMON_INSTANCE_WORLD_MATRIX);
+        clipPos[i] = TransformVec4(vec4(worldPos[i], 1.f), COMMON_VIEW_PROJ_MATRIX);
+        normals[i] = normalize(TransformVec3(vec4(vertex.COMMON_VISIBILITY_NORMAL_V.xyz, 0.f), instance.COMMON_INSTANCE_WORLD_MATRIX));
+        texCoords[i] = vec2(vertex.COMMON_VISIBILITY_POSITION_U.w, vertex.COMMON_VISIBILITY_NORMAL_V.w);
+    }
+
+    const vec3 b = ComputeVisibilityBarycentrics(clipPos[0], clipPos[1], clipPos[2], ndc);
+
+    VisibilitySurface surface;
+    surface.worldPos = worldPos[0] * b.x + worldPos[1] * b.y + worldPos[2] * b.z;
+    surface.worldNormal = normalize(normals[0] * b.x + normals[1] * b.y + normals[2] * b.z);
+    surface.texCoords = texCoords[0] * b.x + texCoords[1] * b.y + texCoords[2] * b.z;
+
+    return surface;
+}
+
+#endif
@@ -2,55 +2,137 @@
 
 #include <registers_common.fx>
 #include <common_math.fx>
+#include <gbuffer.fx>
+#include <lighting.fx>
+#include <temporal.fx>
+#include <visibility.fx>
 
 
 #if defined(PASS_GBUFFER)
     layout(location = 0) in vec3 fs_in_normal;
     layout(location = 1) in vec2 fs_in_texCoords;
-#elif defined(PASS_POST_PROCESS)
+    layout(location = 2) in vec4 fs_in_currClipPos;
+    layout(location = 3) in vec4 fs_in_prevClipPos;
+#elif defined(PASS_VISIBILITY)
+    layout(location = 0) flat in uint fs_in_instanceIdx;
+#elif defined(PASS_POST_PROCESS) || defined(PASS_VISIBILITY_RESOLVE)
     layout(location = 0) in vec2 fs_in_texCoords;
 #endif
 
 
-#if defined(PASS_GBUFFER)
+#if defined(PASS_GBUFFER) && defined(ENV_GBUFFER_COMPACT)
+    layout(location = 0) out vec4 fs_out_albedo;
+    layout(location = 1) out vec2 fs_out_normal;
+    layout(location = 2) out vec2 fs_out_motion;
+#elif defined(PASS_GBUFFER)
     layout(location = 0) out vec4 fs_out_albedo;
     layout(location = 1) out vec4 fs_out_normal;
     layout(location = 2) out vec4 fs_out_specular;
+    layout(location = 3) out vec2 fs_out_motion;
+#elif defined(PASS_VISIBILITY)
+    layout(location = 0) out uvec2 fs_out_visibility;
 #elif defined(PASS_POST_PROCESS)
     layout(location = 0) out vec4 fs_out_merge_color;
+#elif defined(PASS_VISIBILITY_RESOLVE)
+    // Resolve replaces both GBuffer and color passes, so it writes motion for the temporal upscale pass too
+    layout(location = 0) out vec4 fs_out_merge_color;
+    layout(location = 1) out vec2 fs_out_motion;
+#endif
+
+// PASS_DEPTH_PREPASS writes depth only, so it has neither inputs nor outputs
+
+
+// Albedo target clear color, which the color pass outputs for background. Visibility buffer has no albedo, so it's kept here
+#define GBUFFER_CLEAR_ALBEDO vec3(1.f, 1.f, 0.f)
+
+
+#if defined(PASS_GBUFFER) || defined(PASS_VISIBILITY_RESOLVE)
+    // Both geometry paths shade the same surface, one from interpolated vertex outputs, the other from reconstructed ones
+    void EvaluateMaterial(in vec2 texCoords, out vec3 albedo, out vec2 roughnessMetalness)
+    {
+        albedo = texture(TEST_TEXTURE, texCoords).rgb * abs(sin(COMMON_ELAPSED_TIME));
+        roughnessMetalness = lerp(vec2(1.f, 0.f), vec2(0.f, 1.f), texCoords.x);
+    }
 #endif
 
 
 void main()
 {
 #if defined(PASS_GBUFFER)
-    const vec4 albedo = texture(TEST_TEXTURE, fs_in_texCoords);
+    vec3 albedo;
+    vec2 roughnessMetalness;
+    EvaluateMaterial(fs_in_texCoords, albedo, roughnessMetalness);
+
+    #if defined(ENV_GBUFFER_COMPACT)
+        fs_out_albedo = vec4(albedo, PackRoughnessMetalness(roughnessMetalness.x, roughnessMetalness.y));
+        fs_out_normal = EncodeGBufferNormal(normalize(fs_in_normal));
+    #else
+        fs_out_albedo = vec4(albedo, 1.f);
+        // RGBA8 is unsigned, so the normal is remapped to [0, 1]
+        fs_out_normal = vec4(normalize(fs_in_normal) * 0.5f + 0.5f, 1.f);
+        fs_out_specular = vec4(roughnessMetalness, 0.f, 1.f);
+    #endif
 
-    fs_out_albedo = albedo * abs(sin(COMMON_ELAPSED_TIME));
-    fs_out_normal = vec4(normalize(fs_in_normal), 1.f);
-    fs_out_specular = vec4(lerp(vec2(1.f, 0.f), vec2(0.f, 1.f), fs_in_texCoords.x), 0.f, 1.f);
+    fs_out_motion = ComputeMotionVector(fs_in_currClipPos, fs_in_prevClipPos);
+#elif defined(PASS_VISIBILITY)
+    fs_out_visibility = uvec2(fs_in_instanceIdx, uint(gl_PrimitiveID));
 #elif defined(PASS_POST_PROCESS)
-    vec2 uv = fs_in_texCoords * 2.f;
-    
-    if (gl_FragCoord.y >= COMMON_SCREEN_HEIGHT * 0.5f) {
-        uv.y -= 1.f;
-    }
+    const vec2 screenUV = fs_in_texCoords;
+    const vec2 uv = screenUV * COMMON_RT_UV_SCALE;
+
+    const float depth = texture(COMMON_DEPTH_TEX, uv).r;
+
+    #if defined(ENV_GBUFFER_COMPACT)
+        const vec4 albedoRoughMetal = texture(GBUFFER_COMPACT_ALBEDO_TEX, uv);
 
-    if (gl_FragCoord.x >= COMMON_SCREEN_WIDTH * 0.5f) {
-        uv.x -= 1.f;
+        const vec3 albedo = albedoRoughMetal.rgb;
+        const vec3 normal = DecodeGBufferNormal(texture(GBUFFER_COMPACT_NORMAL_TEX, uv).rg);
+        const vec2 roughnessMetalness = UnpackRoughnessMetalness(albedoRoughMetal.a);
+    #else
+        const vec3 albedo = texture(GBUFFER_ALBEDO_TEX, uv).rgb;
+        const vec3 normal = normalize(texture(GBUFFER_NORMAL_TEX, uv).xyz * 2.f - 1.f);
+        const vec2 roughnessMetalness = texture(GBUFFER_SPECULAR_TEX, uv).rg;
+    #endif
+
+    // Background keeps GBuffer clear color
+    if (depth == DEPTH_CLEAR_VALUE) {
+        fs_out_merge_color = vec4(albedo, 1.f);
+        return;
     }
 
-    const vec4 albedo   = texture(GBUFFER_ALBEDO_TEX, uv);
-    const vec4 normal   = texture(GBUFFER_NORMAL_TEX, uv);
-    const vec4 specular = texture(GBUFFER_SPECULAR_TEX, uv);
-    const float depth   = texture(COMMON_DEPTH_TEX, uv).r;
-    
-    const float t = step(COMMON_SCREEN_WIDTH * 0.5f, gl_FragCoord.x);
-
-    if (gl_FragCoord.y > COMMON_SCREEN_HEIGHT * 0.5f) {
-        fs_out_merge_color = lerp(normal, albedo, t);
-    } else {
-        fs_out_merge_color = lerp(vec4(depth, depth, depth, 1.f), specular, t);
+    const vec3 viewPos = ReconstructViewPosition(screenUV, depth);
+    const vec3 viewNormal = normalize(TransformVec3(vec4(normal, 0.f), COMMON_VIEW_MATRIX));
+
+    const vec3 color = EvaluateClusteredLighting(gl_FragCoord.xy, viewPos, viewNormal, albedo, roughnessMetalness.x, roughnessMetalness.y);
+    fs_out_merge_color = vec4(color, 1.f);
+#elif defined(PASS_VISIBILITY_RESOLVE)
+    const vec2 screenUV = fs_in_texCoords;
+    // Fullscreen draw covers the render region only, so pixel coordinates address render targets directly
+    const ivec2 texel = ivec2(gl_FragCoord.xy);
+
+    const float depth = texelFetch(COMMON_DEPTH_TEX, texel, 0).r;
+
+    // Temporal upscale pass reprojects background by depth, so its motion is never read
+    if (depth == DEPTH_CLEAR_VALUE) {
+        fs_out_merge_color = vec4(GBUFFER_CLEAR_ALBEDO, 1.f);
+        fs_out_motion = ZEROF2;
+        return;
     }
+
+    const uvec2 visibility = texelFetch(COMMON_VISIBILITY_TEX, texel, 0).rg;
+    const VisibilitySurface surface = ReconstructVisibilitySurface(visibility, screenUV * 2.f - 1.f);
+
+    vec3 albedo;
+    vec2 roughnessMetalness;
+    EvaluateMaterial(surface.texCoords, albedo, roughnessMetalness);
+
+    const vec3 viewPos = ReconstructViewPosition(screenUV, depth);
+    const vec3 viewNormal = normalize(TransformVec3(vec4(surface.worldNormal, 0.f), COMMON_VIEW_MATRIX));
+
+    const vec3 color = EvaluateClusteredLighting(gl_FragCoord.xy, viewPos, viewNormal, albedo, roughnessMetalness.x, roughnessMetalness.y);
+    fs_out_merge_color = vec4(color, 1.f);
+
+    const vec4 wpos = vec4(surface.worldPos, 1.f);
+    fs_out_motion = ComputeMotionVector(TransformVec4(wpos, COMMON_VIEW_PROJ_MATRIX), TransformVec4(wpos, COMMON_PREV_VIEW_PROJ_MATRIX));
 #endif
 }
\ No newline at end of file
@@ -4,17 +4,38 @@
 #include <common_math.fx>
 
 
-#if defined(PASS_GBUFFER)
+// Visibility resolve shades the scene by a fullscreen draw, like the post process pass
+#if defined(PASS_POST_PROCESS) || defined(PASS_VISIBILITY_RESOLVE)
+    #define FULLSCREEN_PASS
+#endif
+
+
+#if defined(PASS_GBUFFER) || defined(PASS_DEPTH_PREPASS) || defined(PASS_VISIBILITY)
     layout(location = 0) in vec3 vs_in_position;
+#endif
+
+#if defined(PASS_GBUFFER)
     layout(location = 1) in vec3 vs_in_normal;
     layout(location = 2) in vec2 vs_in_texCoords;
 #endif
 
 
+#if defined(PASS_GBUFFER) || defined(PASS_DEPTH_PREPASS) || defined(PASS_VISIBILITY)
+    // GBuffer and visibility passes test depth written by the depth prepass for equality, so all of them must compute bit exact positions
+    invariant gl_Position;
+#endif
+
+
 #if defined(PASS_GBUFFER)
     layout(location = 0) out vec3 vs_out_normal;
     layout(location = 1) out vec2 vs_out_texCoords;
-#elif defined(PASS_POST_PROCESS)
+    // Clip positions are divided per fragment, since the perspective divide is not linear across triangles
+    layout(location = 2) out vec4 vs_out_currClipPos;
+    layout(location = 3) out vec4 vs_out_prevClipPos;
+#elif defined(PASS_VISIBILITY)
+    // Instance index isn't known to the pixel shader otherwise
+    layout(location = 0) flat out uint vs_out_instanceIdx;
+#elif defined(FULLSCREEN_PASS)
     layout(location = 0) out vec2 vs_out_texCoords;
 #endif
 
@@ -25,14 +46,16 @@ struct Vertex
     vec3 position;
     vec3 normal;
     vec2 texCoords;
-#elif defined(PASS_POST_PROCESS)
+#elif defined(FULLSCREEN_PASS)
     vec4 position;
     vec2 texCoords;
+#elif defined(PASS_DEPTH_PREPASS) || defined(PASS_VISIBILITY)
+    vec3 position;
 #endif
 };
 
 
-#if defined(PASS_POST_PROCESS)
+#if defined(FULLSCREEN_PASS)
     Vertex vertices[6] = Vertex[6](
         Vertex(vec4(-1.0f, -1.0f, 0.5f, 1.0f), vec2(0.0f, 0.0f)),
         Vertex(vec4( 1.0f, -1.0f, 0.5f, 1.0f), vec2(1.0f, 0.0f)),
@@ -47,12 +70,27 @@ struct Vertex
 
 void main()
 {
-#if defined(PASS_GBUFFER)
-    vs_out_normal    = normalize(vs_in_normal);
-    vs_out_texCoords = vs_in_texCoords;
+#if defined(PASS_GBUFFER) || defined(PASS_DEPTH_PREPASS) || defined(PASS_VISIBILITY)
+    // gl_InstanceID doesn't include base instance, which is used as offset of the instanced batch.
+    // Occlusion culling packs indices of visible instances of the batch starting from it
+    const uint instanceIdx = COMMON_VISIBLE_INSTANCES[gl_BaseInstance + gl_InstanceID];
+    const COMMON_INSTANCE_DATA instance = COMMON_INSTANCES[instanceIdx];
+
+    #if defined(PASS_GBUFFER)
+        vs_out_normal    = normalize(TransformVec3(vec4(vs_in_normal, 0.0f), instance.COMMON_INSTANCE_WORLD_MATRIX));
+        vs_out_texCoords = vs_in_texCoords;
+    #elif defined(PASS_VISIBILITY)
+        vs_out_instanceIdx = instanceIdx;
+    #endif
 
-    const vec4 wpos = vec4(vs_in_position, 1.0f);
+    const vec4 wpos = vec4(TransformVec3(vec4(vs_in_position, 1.0f), instance.COMMON_INSTANCE_WORLD_MATRIX), 1.0f);
     gl_Position = TransformVec4(wpos, COMMON_VIEW_PROJ_MATRIX);
+
+    #if defined(PASS_GBUFFER)
+        // Instances have no previous world matrices, so geometry is treated as static
+        vs_out_currClipPos = gl_Position;
+        vs_out_prevClipPos = TransformVec4(wpos, COMMON_PREV_VIEW_PROJ_MATRIX);
+    #endif
 #else
     vs_out_texCoords = vertices[gl_VertexID].texCoords;
     gl_Position      = vertices[gl_VertexID].position;
@@ -0,0 +1,49 @@
+#version 460 core
+
+#include <registers_common.fx>
+#include <hiz.fx>
+
+
+// One thread per destination texel, the pyramid is built by one dispatch per level
+#define THREAD_GROUP_SIZE 8
+
+
+layout(local_size_x = THREAD_GROUP_SIZE, local_size_y = THREAD_GROUP_SIZE, local_size_z = 1) in;
+
+
+// Texels outside of the source region are clamped to its edge, so they never bring in depth of pixels which weren't rendered this frame
+float LoadSourceDepth(in ivec2 texel, in ivec2 srcSize, in int dstLevel)
+{
+    const ivec2 srcTexel = min(texel, srcSize - 1);
+    return dstLevel == 0 ? texelFetch(COMMON_DEPTH_TEX, srcTexel, 0).r : texelFetch(COMMON_HIZ_TEX, srcTexel, dstLevel - 1).r;
+}
+
+
+void main()
+{
+    const int dstLevel = int(COMMON_HIZ_DST_LEVEL);
+
+    const ivec2 dstSize = imageSize(COMMON_HIZ_UAV);
+    const ivec2 dstTexel = ivec2(gl_GlobalInvocationID.xy);
+
+    if (any(greaterThanEqual(dstTexel, dstSize))) {
+        return;
+    }
+
+    // Level 0 covers the render region of the pooled depth target, which is smaller than the framebuffer under dynamic resolution
+    const ivec2 srcSize = dstLevel == 0 ? ivec2(COMMON_SCREEN_WIDTH, COMMON_SCREEN_HEIGHT) : textureSize(COMMON_HIZ_TEX, dstLevel - 1);
+
+    // Level sizes are rounded down, so the last texels of a row or column also cover the odd remainder of the source
+    const ivec2 srcMin = dstTexel * 2;
+    const ivec2 srcMax = max(mix(srcMin + 1, srcSize - 1, equal(dstTexel, dstSize - 1)), srcMin);
+
+    float depth = LoadSourceDepth(srcMin, srcSize, dstLevel);
+
+    for (int y = srcMin.y; y <= srcMax.y; ++y) {
+        for (int x = srcMin.x; x <= srcMax.x; ++x) {
+            depth = HIZ_FARTHEST(depth, LoadSourceDepth(ivec2(x, y), srcSize, dstLevel));
+        }
+    }
+
+    imageStore(COMMON_HIZ_UAV, dstTexel, vec4(depth));
+}
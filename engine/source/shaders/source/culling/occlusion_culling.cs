@@ -0,0 +1,36 @@
+#version 460 core
+
+#include <registers_common.fx>
+#include <hiz.fx>
+
+
+// One thread per instance of the frame
+#define THREAD_GROUP_SIZE 64
+
+
+layout(local_size_x = THREAD_GROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+
+void main()
+{
+    const uint instanceIdx = gl_GlobalInvocationID.x;
+
+    if (instanceIdx >= COMMON_OCCLUSION_INSTANCES_COUNT) {
+        return;
+    }
+
+    const COMMON_INSTANCE_DATA instance = COMMON_INSTANCES[instanceIdx];
+
+    const bool isCullable = COMMON_OCCLUSION_CULLING_ENABLED != 0 && instance.COMMON_INSTANCE_BOUNDS_MIN.w != 0.f;
+
+    if (isCullable && IsOccludedByHiZ(instance.COMMON_INSTANCE_BOUNDS_MIN.xyz, instance.COMMON_INSTANCE_BOUNDS_MAX.xyz)) {
+        atomicAdd(COMMON_OCCLUSION_COUNTERS_DATA.COMMON_OCCLUSION_CULLED_COUNT, 1);
+        return;
+    }
+
+    // Visible instances of the batch are appended in arbitrary order, which doesn't matter for opaque geometry
+    const uint batchIdx = instance.COMMON_INSTANCE_BATCH_IDX;
+    const uint slot = atomicAdd(COMMON_DRAW_INDIRECT_ARGS[batchIdx].COMMON_DRAW_INSTANCE_COUNT, 1);
+
+    COMMON_VISIBLE_INSTANCES[COMMON_DRAW_INDIRECT_ARGS[batchIdx].COMMON_DRAW_BASE_INSTANCE + slot] = instanceIdx;
+}
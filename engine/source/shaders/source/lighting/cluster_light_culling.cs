@@ -0,0 +1,215 @@
+#version 460 core
+
+#include <registers_common.fx>
+#include <common_math.fx>
+#include <gbuffer.fx>
+#include <lighting.fx>
+
+
+// One work group per screen tile, each thread reduces depth of PIXELS_PER_THREAD x PIXELS_PER_THREAD pixels
+#define THREAD_GROUP_SIZE   16
+#define THREADS_COUNT       (THREAD_GROUP_SIZE * THREAD_GROUP_SIZE)
+#define PIXELS_PER_THREAD   (COMMON_CLUSTER_TILE_SIZE / THREAD_GROUP_SIZE)
+
+// Lights intersecting the whole tile depth range. If there are more, every slice tests all lights
+#define TILE_MAX_LIGHTS_COUNT 1024
+
+
+layout(local_size_x = THREAD_GROUP_SIZE, local_size_y = THREAD_GROUP_SIZE, local_size_z = 1) in;
+
+
+// Positive floats keep their order when compared as uints
+shared uint s_tileMinDepth;
+shared uint s_tileMaxDepth;
+
+shared uint s_tileLights[TILE_MAX_LIGHTS_COUNT];
+shared uint s_tileLightsCount;
+
+shared uint s_clusterLights[COMMON_CLUSTER_MAX_LIGHTS_COUNT];
+shared uint s_clusterLightsCount;
+shared uint s_clusterLightsOffset;
+
+
+// View space direction through the screen point, scaled to unit view depth
+vec3 GetViewRay(in vec2 screenUV)
+{
+    const vec3 viewPos = ReconstructViewPosition(screenUV, 0.5f);
+    return viewPos / -viewPos.z;
+}
+
+
+void main()
+{
+    const uint threadIdx = gl_LocalInvocationIndex;
+    const uvec2 tile = gl_WorkGroupID.xy;
+    const vec2 screenSize = vec2(COMMON_SCREEN_WIDTH, COMMON_SCREEN_HEIGHT);
+
+    if (threadIdx == 0) {
+        s_tileMinDepth = floatBitsToUint(COMMON_CLUSTER_Z_FAR);
+        s_tileMaxDepth = 0;
+        s_tileLightsCount = 0;
+    }
+
+    barrier();
+
+    // Background pixels are not lit, so they don't extend tile depth bounds
+    float minDepth = COMMON_CLUSTER_Z_FAR;
+    float maxDepth = 0.f;
+
+    const uvec2 firstPixel = tile * COMMON_CLUSTER_TILE_SIZE + gl_LocalInvocationID.xy * PIXELS_PER_THREAD;
+
+    for (uint y = 0; y < PIXELS_PER_THREAD; ++y) {
+        for (uint x = 0; x < PIXELS_PER_THREAD; ++x) {
+            const uvec2 pixel = firstPixel + uvec2(x, y);
+
+            if (any(greaterThanEqual(vec2(pixel), screenSize))) {
+                continue;
+            }
+
+            const float depth = texelFetch(COMMON_DEPTH_TEX, ivec2(pixel), 0).r;
+
+            if (depth == DEPTH_CLEAR_VALUE) {
+                continue;
+            }
+
+            const vec2 screenUV = (vec2(pixel) + 0.5f) / screenSize;
+            const float viewDepth = clamp(-ReconstructViewPosition(screenUV, depth).z, COMMON_CLUSTER_Z_NEAR, COMMON_CLUSTER_Z_FAR);
+
+            minDepth = min(minDepth, viewDepth);
+            maxDepth = max(maxDepth, viewDepth);
+        }
+    }
+
+    if (maxDepth > 0.f) {
+        atomicMin(s_tileMinDepth, floatBitsToUint(minDepth));
+        atomicMax(s_tileMaxDepth, floatBitsToUint(maxDepth));
+    }
+
+    barrier();
+
+    const bool isTileEmpty = s_tileMaxDepth == 0;
+    const float tileMinDepth = uintBitsToFloat(s_tileMinDepth);
+    const float tileMaxDepth = uintBitsToFloat(s_tileMaxDepth);
+
+    const uint minSlice = GetClusterSlice(tileMinDepth);
+    const uint maxSlice = GetClusterSlice(tileMaxDepth);
+
+    // Tile side planes are described by corner rays, their X and Y grow linearly with view depth
+    const vec2 tileMinUV = vec2(tile * COMMON_CLUSTER_TILE_SIZE) / screenSize;
+    const vec2 tileMaxUV = min(vec2((tile + 1) * COMMON_CLUSTER_TILE_SIZE) / screenSize, ONEF2);
+
+    const vec3 rays[4] = vec3[4](
+        GetViewRay(tileMinUV),
+        GetViewRay(vec2(tileMaxUV.x, tileMinUV.y)),
+        GetViewRay(vec2(tileMinUV.x, tileMaxUV.y)),
+        GetViewRay(tileMaxUV)
+    );
+
+    vec2 raysMin = rays[0].xy;
+    vec2 raysMax = rays[0].xy;
+
+    for (uint i = 1; i < 4; ++i) {
+        raysMin = min(raysMin, rays[i].xy);
+        raysMax = max(raysMax, rays[i].xy);
+    }
+
+    if (!isTileEmpty) {
+        const vec3 tileAABBMin = vec3(min(raysMin * tileMinDepth, raysMin * tileMaxDepth), -tileMaxDepth);
+        const vec3 tileAABBMax = vec3(max(raysMax * tileMinDepth, raysMax * tileMaxDepth), -tileMinDepth);
+
+        for (uint i = threadIdx; i < COMMON_LIGHTS_COUNT; i += THREADS_COUNT) {
+            if (IsSphereIntersectsAABB(COMMON_LIGHTS[i].COMMON_LIGHT_BOUNDING_SPHERE, tileAABBMin, tileAABBMax)) {
+                const uint idx = atomicAdd(s_tileLightsCount, 1);
+
+                if (idx < TILE_MAX_LIGHTS_COUNT) {
+                    s_tileLights[idx] = i;
+                }
+            }
+        }
+    }
+
+    barrier();
+
+    const bool isTileListValid = s_tileLightsCount <= TILE_MAX_LIGHTS_COUNT;
+    const uint candidatesCount = isTileListValid ? s_tileLightsCount : COMMON_LIGHTS_COUNT;
+
+    for (uint slice = 0; slice < COMMON_CLUSTER_Z_SLICES_COUNT; ++slice) {
+        const uint clusterIdx = GetClusterIndex(tile, slice);
+
+        // Fragments of the tile never fall into slices outside of its depth bounds
+        if (isTileEmpty || slice < minSlice || slice > maxSlice) {
+            if (threadIdx == 0) {
+                COMMON_CLUSTERS[clusterIdx] = COMMON_CLUSTER_DATA(0, 0);
+            }
+
+            continue;
+        }
+
+        const float sliceMinDepth = max(GetClusterSliceDepth(slice), tileMinDepth);
+        const float sliceMaxDepth = min(GetClusterSliceDepth(slice + 1), tileMaxDepth);
+
+        const vec3 clusterAABBMin = vec3(min(raysMin * sliceMinDepth, raysMin * sliceMaxDepth), -sliceMaxDepth);
+        const vec3 clusterAABBMax = vec3(max(raysMax * sliceMinDepth, raysMax * sliceMaxDepth), -sliceMinDepth);
+
+        if (threadIdx == 0) {
+            s_clusterLightsCount = 0;
+        }
+
+        barrier();
+
+        for (uint i = threadIdx; i < candidatesCount; i += THREADS_COUNT) {
+            const uint lightIdx = isTileListValid ? s_tileLights[i] : i;
+
+            if (IsSphereIntersectsAABB(COMMON_LIGHTS[lightIdx].COMMON_LIGHT_BOUNDING_SPHERE, clusterAABBMin, clusterAABBMax)) {
+                const uint idx = atomicAdd(s_clusterLightsCount, 1);
+
+                if (idx < COMMON_CLUSTER_MAX_LIGHTS_COUNT) {
+                    s_clusterLights[idx] = lightIdx;
+                }
+            }
+        }
+
+        barrier();
+
+        if (threadIdx == 0) {
+            const uint intersectedLightsCount = s_clusterLightsCount;
+            uint lightsCount = min(intersectedLightsCount, COMMON_CLUSTER_MAX_LIGHTS_COUNT);
+            uint lightsOffset = 0;
+
+            bool isOverflowed = intersectedLightsCount > COMMON_CLUSTER_MAX_LIGHTS_COUNT;
+
+            if (lightsCount > 0) {
+                lightsOffset = atomicAdd(COMMON_CLUSTER_COUNTERS_DATA.COMMON_CLUSTER_LIGHT_INDICES_COUNT, lightsCount);
+
+                // Light indices buffer is full, the cluster stays unlit
+                if (lightsOffset + lightsCount > COMMON_CLUSTER_LIGHT_INDICES_CAPACITY) {
+                    lightsCount = 0;
+                    isOverflowed = true;
+                }
+            }
+
+            if (lightsCount > 0) {
+                atomicAdd(COMMON_CLUSTER_COUNTERS_DATA.COMMON_CLUSTER_LIT_COUNT, 1);
+                atomicMax(COMMON_CLUSTER_COUNTERS_DATA.COMMON_CLUSTER_MAX_LIGHTS_PER_CLUSTER, intersectedLightsCount);
+            }
+
+            if (isOverflowed) {
+                atomicAdd(COMMON_CLUSTER_COUNTERS_DATA.COMMON_CLUSTER_OVERFLOWS_COUNT, 1);
+            }
+
+            COMMON_CLUSTERS[clusterIdx] = COMMON_CLUSTER_DATA(lightsOffset, lightsCount);
+
+            s_clusterLightsOffset = lightsOffset;
+            s_clusterLightsCount = lightsCount;
+        }
+
+        barrier();
+
+        for (uint i = threadIdx; i < s_clusterLightsCount; i += THREADS_COUNT) {
+            COMMON_CLUSTER_LIGHT_INDICES[s_clusterLightsOffset + i] = s_clusterLights[i];
+        }
+
+        // Shared lists are reused by the next slice
+        barrier();
+    }
+}
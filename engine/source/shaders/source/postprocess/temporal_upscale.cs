@@ -0,0 +1,170 @@
+#version 460 core
+
+#include <registers_common.fx>
+#include <common_math.fx>
+#include <lighting.fx>
+#include <temporal.fx>
+
+
+// One thread per output pixel, output is at the framebuffer resolution while inputs are at the render one
+#define THREAD_GROUP_SIZE 8
+
+// Weight of the current frame in the accumulated color, when its closest sample lies exactly at the output pixel center
+#define TEMPORAL_CURRENT_WEIGHT 0.1f
+// Neighbourhood box half size in standard deviations. History outside of it is clamped, which removes ghosting
+#define TEMPORAL_VARIANCE_CLIP_GAMMA 1.25f
+
+
+#if defined(ENV_GBUFFER_COMPACT)
+    #define TEMPORAL_COLOR_TEX COMMON_COMPACT_COLOR_TEX
+#else
+    #define TEMPORAL_COLOR_TEX COMMON_COLOR_TEX
+#endif
+
+#if defined(ENV_INVERTED_Z)
+    #define IS_DEPTH_CLOSER(a, b) ((a) > (b))
+#else
+    #define IS_DEPTH_CLOSER(a, b) ((a) < (b))
+#endif
+
+
+layout(local_size_x = THREAD_GROUP_SIZE, local_size_y = THREAD_GROUP_SIZE, local_size_z = 1) in;
+
+
+// Background isn't rasterized, so it has no motion vectors and is reprojected with the camera movement
+vec2 ComputeBackgroundMotion(in vec2 renderUV, in float depth)
+{
+#if defined(ENV_INVERTED_Z)
+    // Inverted Z builds set clip depth range to [0, 1]
+    const float ndcZ = depth;
+#else
+    const float ndcZ = depth * 2.f - 1.f;
+#endif
+
+    const vec4 currClipPos = vec4(renderUV * 2.f - 1.f, ndcZ, 1.f);
+    return ComputeMotionVector(currClipPos, TransformVec4(currClipPos, COMMON_TEMPORAL_REPROJECTION_MATRIX));
+}
+
+
+// Catmull-Rom filter of 4x4 texels folded into 9 bilinear taps. Bilinear history resampling blurs the image a bit more every frame
+vec3 SampleHistory(in vec2 uv)
+{
+    const vec2 historySize = vec2(textureSize(COMMON_TEMPORAL_HISTORY_TEX, 0));
+
+    const vec2 samplePos = uv * historySize;
+    const vec2 texPos1 = floor(samplePos - 0.5f) + 0.5f;
+    const vec2 f = samplePos - texPos1;
+
+    const vec2 w0 = f * (-0.5f + f * (1.f - 0.5f * f));
+    const vec2 w1 = 1.f + f * f * (-2.5f + 1.5f * f);
+    const vec2 w2 = f * (0.5f + f * (2.f - 1.5f * f));
+    const vec2 w3 = f * f * (-0.5f + 0.5f * f);
+
+    const vec2 w12 = w1 + w2;
+
+    const vec2 uv0 = (texPos1 - 1.f) / historySize;
+    const vec2 uv12 = (texPos1 + w2 / w12) / historySize;
+    const vec2 uv3 = (texPos1 + 2.f) / historySize;
+
+    vec3 color = ZEROF3;
+
+    color += textureLod(COMMON_TEMPORAL_HISTORY_TEX, vec2(uv0.x,  uv0.y), 0.f).rgb * w0.x * w0.y;
+    color += textureLod(COMMON_TEMPORAL_HISTORY_TEX, vec2(uv12.x, uv0.y), 0.f).rgb * w12.x * w0.y;
+    color += textureLod(COMMON_TEMPORAL_HISTORY_TEX, vec2(uv3.x,  uv0.y), 0.f).rgb * w3.x * w0.y;
+
+    color += textureLod(COMMON_TEMPORAL_HISTORY_TEX, vec2(uv0.x,  uv12.y), 0.f).rgb * w0.x * w12.y;
+    color += textureLod(COMMON_TEMPORAL_HISTORY_TEX, vec2(uv12.x, uv12.y), 0.f).rgb * w12.x * w12.y;
+    color += textureLod(COMMON_TEMPORAL_HISTORY_TEX, vec2(uv3.x,  uv12.y), 0.f).rgb * w3.x * w12.y;
+
+    color += textureLod(COMMON_TEMPORAL_HISTORY_TEX, vec2(uv0.x,  uv3.y), 0.f).rgb * w0.x * w3.y;
+    color += textureLod(COMMON_TEMPORAL_HISTORY_TEX, vec2(uv12.x, uv3.y), 0.f).rgb * w12.x * w3.y;
+    color += textureLod(COMMON_TEMPORAL_HISTORY_TEX, vec2(uv3.x,  uv3.y), 0.f).rgb * w3.x * w3.y;
+
+    // Negative lobes may overshoot on sharp edges
+    return max(color, ZEROF3);
+}
+
+
+void main()
+{
+    const ivec2 outputTexel = ivec2(gl_GlobalInvocationID.xy);
+    const ivec2 outputSize = imageSize(COMMON_TEMPORAL_OUTPUT_UAV);
+
+    if (any(greaterThanEqual(outputTexel, outputSize))) {
+        return;
+    }
+
+    const vec2 renderSize = vec2(COMMON_SCREEN_WIDTH, COMMON_SCREEN_HEIGHT);
+    const ivec2 maxRenderTexel = ivec2(renderSize) - 1;
+
+    const vec2 outputUV = (vec2(outputTexel) + 0.5f) / vec2(outputSize);
+
+    // Render samples see the scene shifted by the jitter, so the output pixel center is located among them with the jitter added.
+    // Position is in render texels, with texel centers at integer coordinates
+    const vec2 samplePos = (outputUV + COMMON_PROJ_JITTER * 0.5f) * renderSize - 0.5f;
+    const ivec2 centerTexel = ivec2(floor(samplePos + 0.5f));
+
+    vec3 filteredColor = ZEROF3;
+    float filterWeightSum = 0.f;
+    float maxSampleWeight = 0.f;
+
+    vec3 colorMoment1 = ZEROF3;
+    vec3 colorMoment2 = ZEROF3;
+
+    // Motion is taken from the closest sample, so that edges of foreground objects don't drag background history along
+    ivec2 closestTexel = clamp(centerTexel, ivec2(0), maxRenderTexel);
+    float closestDepth = texelFetch(COMMON_DEPTH_TEX, closestTexel, 0).r;
+
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            // Pooled render targets are larger than the render region, so texels are clamped to it explicitly
+            const ivec2 texel = clamp(centerTexel + ivec2(x, y), ivec2(0), maxRenderTexel);
+            const vec3 color = CompressTemporalColor(texelFetch(TEMPORAL_COLOR_TEX, texel, 0).rgb);
+
+            // Gaussian fit of Blackman-Harris window, which reconstructs the output pixel from jittered samples
+            const vec2 offset = vec2(texel) - samplePos;
+            const float weight = exp(-2.29f * dot(offset, offset));
+
+            filteredColor += color * weight;
+            filterWeightSum += weight;
+            maxSampleWeight = max(maxSampleWeight, weight);
+
+            colorMoment1 += color;
+            colorMoment2 += color * color;
+
+            const float depth = texelFetch(COMMON_DEPTH_TEX, texel, 0).r;
+
+            if (IS_DEPTH_CLOSER(depth, closestDepth)) {
+                closestDepth = depth;
+                closestTexel = texel;
+            }
+        }
+    }
+
+    const vec3 currColor = filteredColor / filterWeightSum;
+
+    const vec3 colorMean = colorMoment1 / 9.f;
+    const vec3 colorStdDev = sqrt(max(colorMoment2 / 9.f - colorMean * colorMean, ZEROF3));
+
+    const vec3 minColor = colorMean - TEMPORAL_VARIANCE_CLIP_GAMMA * colorStdDev;
+    const vec3 maxColor = colorMean + TEMPORAL_VARIANCE_CLIP_GAMMA * colorStdDev;
+
+    const vec2 motion = closestDepth == DEPTH_CLEAR_VALUE ?
+        ComputeBackgroundMotion((vec2(closestTexel) + 0.5f) / renderSize, closestDepth) : texelFetch(GBUFFER_MOTION_TEX, closestTexel, 0).rg;
+
+    const vec2 historyUV = outputUV - motion;
+
+    const bool isHistoryValid = COMMON_TEMPORAL_HISTORY_VALID != 0 &&
+        all(greaterThanEqual(historyUV, ZEROF2)) && all(lessThanEqual(historyUV, ONEF2));
+
+    vec3 color = currColor;
+
+    if (isHistoryValid) {
+        const vec3 historyColor = clamp(CompressTemporalColor(SampleHistory(historyUV)), minColor, maxColor);
+
+        // Output pixels far from every sample of this frame are reconstructed mostly from history
+        color = lerp(historyColor, currColor, TEMPORAL_CURRENT_WEIGHT * maxSampleWeight);
+    }
+
+    imageStore(COMMON_TEMPORAL_OUTPUT_UAV, outputTexel, vec4(DecompressTemporalColor(color), 1.f));
+}
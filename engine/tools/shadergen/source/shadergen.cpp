@@ -32,6 +32,8 @@ static const char* TranslateGLSLToEngineResourceType(const fs::path& filepath, c
 {
     static const std::unordered_map<std::string, const char*> GLSLToEngineResTypeMap = {
         { "sampler2D", "ShaderResourceType::TYPE_SAMPLER_2D" },
+        { "usampler2D", "ShaderResourceType::TYPE_USAMPLER_2D" },
+        { "image2D", "ShaderResourceType::TYPE_IMAGE_2D" },
         { "bool", "ShaderResourceType::TYPE_BOOL" },
         { "int", "ShaderResourceType::TYPE_INT" },
         { "uint", "ShaderResourceType::TYPE_UINT" },
@@ -193,7 +195,7 @@ static std::string RemoveTextComments(const std::vector<char>& fileContent) noex
 
 static std::vector<std::cmatch> FindConstantDeclarationMatches(const char* pFileContent, size_t fileSize) noexcept
 {
-    static std::regex CONSTANT_PATTERN(R"(DECLARE_CONSTANT\(([^,]+), ([^,]+), ([^,]+)\))");
+    static std::regex CONSTANT_PATTERN(R"(DECLARE_CONSTANT\(([^,]+), ([^,]+), ([^,\)]+)\))");
     
     return FindPatternMatches(CONSTANT_PATTERN, pFileContent, fileSize);
 }
@@ -209,7 +211,7 @@ static std::vector<std::cmatch> FindIncludesDeclarationMatches(const char* pFile
 
 static std::vector<std::cmatch> FindSrvVariableDeclarationMatches(const char* pFileContent, size_t fileSize) noexcept
 {
-    static std::regex SRV_VAR_PATTERN(R"(DECLARE_SRV_VARIABLE\(([^,]+), ([^,]+), ([^,]+), ([^,]+)\))");
+    static std::regex SRV_VAR_PATTERN(R"(DECLARE_SRV_VARIABLE\(([^,]+), ([^,]+), ([^,]+), ([^,\)]+)\))");
 
     return FindPatternMatches(SRV_VAR_PATTERN, pFileContent, fileSize);
 }
@@ -217,12 +219,20 @@ static std::vector<std::cmatch> FindSrvVariableDeclarationMatches(const char* pF
 
 static std::vector<std::cmatch> FindSrvTextureDeclarationMatches(const char* pFileContent, size_t fileSize) noexcept
 {
-    static std::regex SRV_TEXTURE_PATTERN(R"(DECLARE_SRV_TEXTURE\(([^,]+), ([^,]+), ([^,]+), ([^,]+), ([^,]+)\))");
+    static std::regex SRV_TEXTURE_PATTERN(R"(DECLARE_SRV_TEXTURE\(([^,]+), ([^,]+), ([^,]+), ([^,]+), ([^,\)]+)\))");
     
     return FindPatternMatches(SRV_TEXTURE_PATTERN, pFileContent, fileSize);
 }
 
 
+static std::vector<std::cmatch> FindUavTextureDeclarationMatches(const char* pFileContent, size_t fileSize) noexcept
+{
+    static std::regex UAV_TEXTURE_PATTERN(R"(DECLARE_UAV_TEXTURE\(([^,]+), ([^,]+), ([^,]+), ([^,\)]+)\))");
+    
+    return FindPatternMatches(UAV_TEXTURE_PATTERN, pFileContent, fileSize);
+}
+
+
 static std::vector<std::cmatch> FindConstantBufferDeclarationMatches(const char* pFileContent, size_t fileSize) noexcept
 {
     static std::regex CB_PATTERN(R"(DECLARE_CBV\(([^,]+), ([^,]+)\)\s*\{\s*([^{}]+)\s*\})");
@@ -231,6 +241,23 @@ static std::vector<std::cmatch> FindConstantBufferDeclarationMatches(const char*
 }
 
 
+static std::vector<std::cmatch> FindStructDeclarationMatches(const char* pFileContent, size_t fileSize) noexcept
+{
+    static std::regex STRUCT_PATTERN(R"(DECLARE_STRUCT\(([^,\)]+)\)\s*\{\s*([^{}]+)\s*\})");
+    
+    return FindPatternMatches(STRUCT_PATTERN, pFileContent, fileSize);
+}
+
+
+// Read only (SRV) and read write (UAV) structured buffers are reflected the same way
+static std::vector<std::cmatch> FindStructuredBufferDeclarationMatches(const char* pFileContent, size_t fileSize) noexcept
+{
+    static std::regex STRUCTURED_BUFFER_PATTERN(R"(DECLARE_(?:SRV|UAV)_STRUCTURED_BUFFER\(([^,]+), ([^,\)]+)\)\s*\{\s*([^{}]+)\s*\})");
+    
+    return FindPatternMatches(STRUCTURED_BUFFER_PATTERN, pFileContent, fileSize);
+}
+
+
 static std::vector<std::cmatch> FindConstantBufferMembersDeclarationMatches(const char* pCBContent, size_t cbContentSize) noexcept
 {
     static std::regex CB_CONTENT_PATTERN(R"(\b([a-zA-Z0-9]+)\s+([a-zA-Z0-9_]+)(\[[^\]]*\])?(?=\s*;))");
@@ -239,6 +266,26 @@ static std::vector<std::cmatch> FindConstantBufferMembersDeclarationMatches(cons
 }
 
 
+static void FillStructMembersDeclaration(std::stringstream& ss, const std::vector<std::cmatch>& membersMatches, const fs::path& filepath) noexcept
+{
+    for (const std::cmatch& memberMatch : membersMatches) {
+        const char* pMemberType = TranslateGLSLToEngineConstantPrimitiveType(filepath, memberMatch[1].str());
+        assert(pMemberType);
+        
+        const std::string memberName = memberMatch[2].str();
+
+        ss << "    " << pMemberType << ' ' << memberName;
+
+        const std::string memberArrayCapture = memberMatch[3].str();
+        if (!memberArrayCapture.empty()) {
+            ss << memberArrayCapture;
+        }
+
+        ss << ";\n";
+    }
+}
+
+
 static void FillIncludesDeclaration(std::stringstream& ss, const char* pFileContent, size_t fileSize, const fs::path& filepath) noexcept
 {
     CHECK_FILE_CONTENT_PARAMS(filepath, pFileContent, fileSize);
@@ -279,6 +326,32 @@ static void FillConstantDeclaration(std::stringstream& ss, const char* pFileCont
 }
 
 
+static void FillStructDeclaration(std::stringstream& ss, const char* pFileContent, size_t fileSize, const fs::path& filepath) noexcept
+{
+    CHECK_FILE_CONTENT_PARAMS(filepath, pFileContent, fileSize);
+
+    const std::vector<std::cmatch> structDeclMatches = FindStructDeclarationMatches(pFileContent, fileSize);
+
+    for (const std::cmatch& match : structDeclMatches) {
+        const std::string name = match[1].str();
+        const std::string content = match[2].str();
+
+        const std::vector<std::cmatch> structContentsMatches = FindConstantBufferMembersDeclarationMatches(content.c_str(), content.size());
+        
+        ss << "struct " << name << " {\n";
+        
+        FillStructMembersDeclaration(ss, structContentsMatches, filepath);
+
+        ss << "};\n"
+        "\n";
+    }
+
+    if (!structDeclMatches.empty()) {
+        ss << '\n';
+    }
+}
+
+
 static void FillSrvVariablesDeclaration(std::stringstream& ss, const char* pFileContent, size_t fileSize, const fs::path& filepath) noexcept
 {
     CHECK_FILE_CONTENT_PARAMS(filepath, pFileContent, fileSize);
@@ -335,6 +408,59 @@ static void FillSrvTextureDeclaration(std::stringstream& ss, const char* pFileCo
 }
 
 
+// Storage images have no sampler, format is reflected to bind texture levels to image units
+static void FillUavTextureDeclaration(std::stringstream& ss, const char* pFileContent, size_t fileSize, const fs::path& filepath) noexcept
+{
+    CHECK_FILE_CONTENT_PARAMS(filepath, pFileContent, fileSize);
+
+    const std::vector<std::cmatch> uavTexturesDeclMatches = FindUavTextureDeclarationMatches(pFileContent, fileSize);
+
+    for (const std::cmatch& match : uavTexturesDeclMatches) {
+        const char* pType = TranslateGLSLToEngineResourceType(filepath, match[1].str());
+        assert(pType);
+
+        const std::string name = match[2].str();
+        const std::string binding = match[3].str();
+        const std::string format = match[4].str();
+
+        ss <<
+        "struct " << name << " {\n"
+        "    inline static constexpr ShaderResourceBindStruct<" << pType << "> _BINDING = { -1, " << binding << " };\n"
+        "    inline static constexpr uint32_t _FORMAT = " << format << ";\n"
+        "};\n"
+        "\n";
+    }
+
+    if (!uavTexturesDeclMatches.empty()) {
+        ss << '\n';
+    }
+}
+
+
+// Contents of structured buffers are runtime sized arrays or single instances of DECLARE_STRUCT types, so only binding is reflected
+static void FillStructuredBufferDeclaration(std::stringstream& ss, const char* pFileContent, size_t fileSize, const fs::path& filepath) noexcept
+{
+    CHECK_FILE_CONTENT_PARAMS(filepath, pFileContent, fileSize);
+
+    const std::vector<std::cmatch> buffersDeclMatches = FindStructuredBufferDeclarationMatches(pFileContent, fileSize);
+
+    for (const std::cmatch& match : buffersDeclMatches) {
+        const std::string name = match[1].str();
+        const std::string binding = match[2].str();
+
+        ss <<
+        "struct " << name << " {\n"
+        "    inline static constexpr ShaderResourceBindStruct<ShaderResourceType::TYPE_STORAGE_BUFFER> _BINDING = { -1, " << binding << " };\n"
+        "};\n"
+        "\n";
+    }
+
+    if (!buffersDeclMatches.empty()) {
+        ss << '\n';
+    }
+}
+
+
 static void FillConstantBufferDeclaration(std::stringstream& ss, const char* pFileContent, size_t fileSize, const fs::path& filepath) noexcept
 {
     CHECK_FILE_CONTENT_PARAMS(filepath, pFileContent, fileSize);
@@ -356,21 +482,7 @@ static void FillConstantBufferDeclaration(std::stringstream& ss, const char* pFi
             ss << '\n';
         }
 
-        for (const std::cmatch& memberMatch : constBuffContentsMatches) {
-            const char* pMemberType = TranslateGLSLToEngineConstantPrimitiveType(filepath, memberMatch[1].str());
-            assert(pMemberType);
-            
-            const std::string memberName = memberMatch[2].str();
-
-            ss << "    " << pMemberType << ' ' << memberName;
-
-            const std::string memberArrayCapture = memberMatch[3].str();
-            if (!memberArrayCapture.empty()) {
-                ss << memberArrayCapture;
-            }
-
-            ss << ";\n";
-        }
+        FillStructMembersDeclaration(ss, constBuffContentsMatches, filepath);
 
         ss << "};\n"
         "\n";
@@ -432,8 +544,11 @@ void GenerateAutoFile(const ShaderGenInputParams& inputParams) noexcept
 
     FillIncludesDeclaration(ss, commentLessFileContent.c_str(), commentLessFileContent.length() + 1, inputParams.inputFilepath);
     FillConstantDeclaration(ss, commentLessFileContent.c_str(), commentLessFileContent.length() + 1, inputParams.inputFilepath);
+    FillStructDeclaration(ss, commentLessFileContent.c_str(), commentLessFileContent.length() + 1, inputParams.inputFilepath);
     FillSrvVariablesDeclaration(ss, commentLessFileContent.c_str(), commentLessFileContent.length() + 1, inputParams.inputFilepath);
     FillSrvTextureDeclaration(ss, commentLessFileContent.c_str(), commentLessFileContent.length() + 1, inputParams.inputFilepath);
+    FillUavTextureDeclaration(ss, commentLessFileContent.c_str(), commentLessFileContent.length() + 1, inputParams.inputFilepath);
+    FillStructuredBufferDeclaration(ss, commentLessFileContent.c_str(), commentLessFileContent.length() + 1, inputParams.inputFilepath);
     FillConstantBufferDeclaration(ss, commentLessFileContent.c_str(), commentLessFileContent.length() + 1, inputParams.inputFilepath);
 
     ss << '\n';